@@ -14,6 +14,7 @@ SOURCES += \
     fortdrv.c \
     fortmod.c \
     fortpkt.c \
+    fortpktq.c \
     fortpool.c \
     fortps.c \
     fortscb.c \
@@ -53,6 +54,7 @@ HEADERS += \
     fortdrv.h \
     fortmod.h \
     fortpkt.h \
+    fortpktq.h \
     fortpool.h \
     fortps.h \
     fortscb.h \
@@ -19,7 +19,7 @@ static_assert((FORT_CONF_RULE_GLOBAL_MAX + FORT_CONF_RULE_SET_MAX) < 256,
 
 static_assert(sizeof(FORT_TRAF) == sizeof(UINT64), "FORT_TRAF size mismatch");
 static_assert(sizeof(FORT_APP_FLAGS) == sizeof(UINT16), "FORT_APP_FLAGS size mismatch");
-static_assert(sizeof(FORT_APP_DATA) == 2 * sizeof(UINT32), "FORT_APP_DATA size mismatch");
+static_assert(sizeof(FORT_APP_DATA) == 3 * sizeof(UINT32), "FORT_APP_DATA size mismatch");
 
 static int bit_scan_forward(ULONG mask)
 {
@@ -255,7 +255,8 @@ static BOOL fort_conf_ip_included_check(PCFORT_CONF_ADDR_LIST addr_list,
         UINT32 zones_mask, BOOL list_is_empty, BOOL isIPv6)
 {
     return (!list_is_empty && fort_conf_ip_inlist(remote_ip, addr_list, isIPv6))
-            || (zone_func != NULL && zone_func(ctx, zones_mask, remote_ip, isIPv6));
+            || (zones_mask != 0 && zone_func != NULL
+                    && zone_func(ctx, zones_mask, remote_ip, isIPv6));
 }
 
 FORT_API BOOL fort_conf_ip_included(PCFORT_CONF conf, fort_conf_zones_ip_included_func zone_func,
@@ -356,7 +357,7 @@ static BOOL fort_conf_app_wild_equal(PCFORT_APP_ENTRY app_entry, PCFORT_APP_PATH
 typedef BOOL fort_conf_app_equal_func(PCFORT_APP_ENTRY app_entry, PCFORT_APP_PATH path);
 
 static FORT_APP_DATA fort_conf_app_find_loop(PCFORT_CONF conf, PCFORT_APP_PATH path,
-        UINT32 apps_off, UINT16 apps_n, fort_conf_app_equal_func *app_equal_func)
+        UINT32 apps_off, UINT32 apps_n, fort_conf_app_equal_func *app_equal_func)
 {
     const FORT_APP_DATA app_data = { 0 };
 
@@ -464,6 +465,27 @@ FORT_API BOOL fort_conf_app_group_blocked(const FORT_CONF_FLAGS conf_flags, FORT
     return conf_flags.group_blocked;
 }
 
+FORT_API PCFORT_SPEED_LIMIT fort_conf_app_limits_ref(PCFORT_CONF conf)
+{
+    return (PCFORT_SPEED_LIMIT) (conf->data + conf->app_limits_off);
+}
+
+FORT_API UCHAR fort_conf_app_limit_io_bits(PCFORT_CONF conf, UINT16 limit_id)
+{
+    if (limit_id == 0 || limit_id > conf->app_limits_n)
+        return 0;
+
+    PCFORT_SPEED_LIMIT limits = fort_conf_app_limits_ref(conf) + (limit_id - 1) * 2;
+
+    return (limits[0].bps != 0 ? 0x01 : 0) /* inbound */
+            | (limits[1].bps != 0 ? 0x02 : 0); /* outbound */
+}
+
+FORT_API PCFORT_TRAF_QUOTA fort_conf_quotas_ref(PCFORT_CONF conf)
+{
+    return (PCFORT_TRAF_QUOTA) (conf->data + conf->quotas_off);
+}
+
 inline static BOOL fort_conf_rules_rt_conn_filtered_zones(
         PCFORT_CONF_RULES_RT rules_rt, PFORT_CONF_META_CONN conn, PCFORT_CONF_RULE rule)
 {
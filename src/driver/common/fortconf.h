@@ -21,6 +21,8 @@
 #define FORT_CONF_RULE_SET_DEPTH_MAX    8
 #define FORT_CONF_ZONE_MAX              32
 #define FORT_CONF_GROUP_MAX             16
+#define FORT_CONF_APP_LIMIT_MAX         1024
+#define FORT_CONF_QUOTA_MAX             1024
 #define FORT_CONF_APPS_LEN_MAX          (64 * 1024 * 1024)
 #define FORT_CONF_APP_PATH_MAX          1024
 #define FORT_CONF_APP_PATH_MAX_SIZE     (FORT_CONF_APP_PATH_MAX * sizeof(WCHAR))
@@ -92,6 +94,62 @@ typedef const FORT_SERVICE_INFO_LIST *PCFORT_SERVICE_INFO_LIST;
 #define FORT_SERVICE_INFO_LIST_MIN_SIZE                                                            \
     (FORT_SERVICE_INFO_LIST_DATA_OFF + FORT_SERVICE_INFO_MAX_SIZE)
 
+#define FORT_PENDING_APP_COUNT_MAX         4096
+#define FORT_PENDING_APP_PACKET_COUNT_MAX  3
+#define FORT_PENDING_EXPIRE_SECS           60
+#define FORT_PENDING_EXPIRE_SECS_MAX       3600
+
+typedef struct fort_pending_limits
+{
+    UINT16 apps_max; /* 0 - keep the current value */
+    UINT16 app_packets_max; /* 0 - keep the current value */
+    UINT16 expire_secs; /* 0 - keep the current value */
+} FORT_PENDING_LIMITS, *PFORT_PENDING_LIMITS;
+
+typedef const FORT_PENDING_LIMITS *PCFORT_PENDING_LIMITS;
+
+typedef struct fort_pool_stat
+{
+    UINT32 pools_n;
+    UINT32 pools_size;
+    UINT32 used_size;
+    UINT32 free_size;
+    UINT32 free_max_size; /* largest free block, fragmentation = 1 - free_max_size / free_size */
+} FORT_POOL_STAT, *PFORT_POOL_STAT;
+
+typedef struct fort_device_pool_stat
+{
+    FORT_POOL_STAT conf; /* apps of the config */
+    FORT_POOL_STAT ps_tree; /* names of the processes */
+} FORT_DEVICE_POOL_STAT, *PFORT_DEVICE_POOL_STAT;
+
+typedef struct fort_pending_decision
+{
+    UINT16 allow : 1;
+
+    UINT16 path_len;
+    WCHAR path[2];
+} FORT_PENDING_DECISION, *PFORT_PENDING_DECISION;
+
+typedef const FORT_PENDING_DECISION *PCFORT_PENDING_DECISION;
+
+#define FORT_PENDING_DECISION_PATH_OFF offsetof(FORT_PENDING_DECISION, path)
+#define FORT_PENDING_DECISION_MAX_SIZE                                                             \
+    (FORT_PENDING_DECISION_PATH_OFF + FORT_CONF_APP_PATH_MAX_SIZE)
+
+typedef struct fort_pending_decision_list
+{
+    FORT_PENDING_LIMITS limits;
+
+    UINT16 decisions_n;
+
+    FORT_PENDING_DECISION data[1];
+} FORT_PENDING_DECISION_LIST, *PFORT_PENDING_DECISION_LIST;
+
+typedef const FORT_PENDING_DECISION_LIST *PCFORT_PENDING_DECISION_LIST;
+
+#define FORT_PENDING_DECISION_LIST_DATA_OFF offsetof(FORT_PENDING_DECISION_LIST, data)
+
 typedef struct fort_conf_proto_list
 {
     UINT8 proto_n;
@@ -352,6 +410,9 @@ typedef struct fort_app_data
 
     UINT16 accept_zones;
     UINT16 reject_zones;
+
+    UINT16 limit_id; /* 1-based index of the app's speed limits pair, 0 - not limited */
+    UINT16 quota_id; /* 1-based index of the app's traffic quota, 0 - no quota */
 } FORT_APP_DATA, *PFORT_APP_DATA;
 
 typedef struct fort_app_entry
@@ -379,6 +440,24 @@ typedef struct fort_speed_limit
 
 typedef const FORT_SPEED_LIMIT *PCFORT_SPEED_LIMIT;
 
+#define FORT_CONF_APP_LIMITS_SIZE(n) ((n) * 2 * sizeof(FORT_SPEED_LIMIT)) /* in/out-bound pairs */
+
+typedef struct fort_traf_quota
+{
+    UINT32 key; /* stable id to keep the used bytes on conf updates */
+    UCHAR throttle_group; /* 1-based app group index to throttle into when exceeded, 0 - block */
+
+    UINT64 day_bytes; /* 0 - unlimited */
+    UINT64 month_bytes; /* 0 - unlimited */
+
+    UINT64 day_used; /* bytes already used in the current day */
+    UINT64 month_used; /* bytes already used in the current month */
+} FORT_TRAF_QUOTA, *PFORT_TRAF_QUOTA;
+
+typedef const FORT_TRAF_QUOTA *PCFORT_TRAF_QUOTA;
+
+#define FORT_CONF_QUOTAS_SIZE(n) ((n) * sizeof(FORT_TRAF_QUOTA))
+
 typedef struct fort_conf_group
 {
     UINT16 group_bits;
@@ -390,6 +469,8 @@ typedef struct fort_conf_group
     UINT32 limit_io_bits;
 
     FORT_SPEED_LIMIT limits[FORT_CONF_GROUP_MAX * 2]; /* in/out-bound pairs */
+
+    UINT16 quota_ids[FORT_CONF_GROUP_MAX]; /* 1-based indexes of the groups' traffic quotas */
 } FORT_CONF_GROUP, *PFORT_CONF_GROUP;
 
 typedef const FORT_CONF_GROUP *PCFORT_CONF_GROUP;
@@ -402,7 +483,12 @@ typedef struct fort_conf
 
     UINT16 wild_apps_n;
     UINT16 prefix_apps_n;
-    UINT16 exe_apps_n;
+    UINT32 exe_apps_n;
+
+    UINT16 app_limits_n;
+    UINT16 quotas_n;
+
+    UCHAR quota_month_start; /* day of month (1-28), when the monthly quotas are reset */
 
     UINT32 addr_groups_off;
 
@@ -410,6 +496,9 @@ typedef struct fort_conf
     UINT32 prefix_apps_off;
     UINT32 exe_apps_off;
 
+    UINT32 app_limits_off; /* in/out-bound pairs of FORT_SPEED_LIMIT */
+    UINT32 quotas_off; /* FORT_TRAF_QUOTA of apps and groups */
+
     char data[4];
 } FORT_CONF, *PFORT_CONF;
 
@@ -519,6 +608,12 @@ FORT_API FORT_APP_DATA fort_conf_app_find(PCFORT_CONF conf, PCFORT_APP_PATH path
 
 FORT_API BOOL fort_conf_app_group_blocked(const FORT_CONF_FLAGS conf_flags, FORT_APP_DATA app_data);
 
+FORT_API PCFORT_SPEED_LIMIT fort_conf_app_limits_ref(PCFORT_CONF conf);
+
+FORT_API UCHAR fort_conf_app_limit_io_bits(PCFORT_CONF conf, UINT16 limit_id);
+
+FORT_API PCFORT_TRAF_QUOTA fort_conf_quotas_ref(PCFORT_CONF conf);
+
 FORT_API BOOL fort_conf_rules_rt_conn_filtered(
         PCFORT_CONF_RULES_RT rules_rt, PFORT_CONF_META_CONN conn, UINT16 rule_id);
 
@@ -30,6 +30,7 @@ enum FortConnReason {
     FORT_CONN_REASON_RULE_GLOB_PRE,
     FORT_CONN_REASON_RULE_GLOB_POST,
     FORT_CONN_REASON_ASK_LIMIT,
+    FORT_CONN_REASON_APP_QUOTA,
     FORT_CONN_REASON_ASK_PENDING = 15 /* must be last one! */
 };
 
@@ -224,6 +224,8 @@ enum {
     FORT_IOCTL_INDEX_SETZONEFLAG,
     FORT_IOCTL_INDEX_SETRULES,
     FORT_IOCTL_INDEX_SETRULEFLAG,
+    FORT_IOCTL_INDEX_SETPENDING,
+    FORT_IOCTL_INDEX_GETPOOLSTAT,
     FORT_IOCTL_INDEX_COUNT,
 };
 
@@ -238,5 +240,7 @@ enum {
 #define FORT_IOCTL_SETZONEFLAG FORT_CTL_CODE(FORT_IOCTL_INDEX_SETZONEFLAG, FILE_WRITE_DATA)
 #define FORT_IOCTL_SETRULES    FORT_CTL_CODE(FORT_IOCTL_INDEX_SETRULES, FILE_WRITE_DATA)
 #define FORT_IOCTL_SETRULEFLAG FORT_CTL_CODE(FORT_IOCTL_INDEX_SETRULEFLAG, FILE_WRITE_DATA)
+#define FORT_IOCTL_SETPENDING  FORT_CTL_CODE(FORT_IOCTL_INDEX_SETPENDING, FILE_WRITE_DATA)
+#define FORT_IOCTL_GETPOOLSTAT FORT_CTL_CODE(FORT_IOCTL_INDEX_GETPOOLSTAT, FILE_READ_DATA)
 
 #endif // FORTIOCTL_H
@@ -2,8 +2,16 @@
 
 #include "fortcnf.h"
 
+#if defined(_M_AMD64) || defined(__x86_64__)
+#    include <emmintrin.h>
+#    define FORT_CONF_EXE_INDEX_SSE2
+#endif
+
 #define FORT_DEVICE_CONF_POOL_TAG 'CwfF'
 
+#define FORT_CONF_EXE_TAG_EMPTY   0x00
+#define FORT_CONF_EXE_TAG_DELETED 0x01
+
 /* Synchronize with tommy_hashdyn_node! */
 typedef struct fort_conf_exe_node
 {
@@ -33,9 +41,33 @@ static void fort_conf_mem_free(PVOID p)
     }
 }
 
-FORT_API void fort_device_conf_open(PFORT_DEVICE_CONF device_conf)
+FORT_API NTSTATUS fort_device_conf_open(PFORT_DEVICE_CONF device_conf)
 {
     KeInitializeSpinLock(&device_conf->ref_lock);
+    KeInitializeEvent(&device_conf->ref_set_event, SynchronizationEvent, TRUE);
+
+    for (int i = 0; i < 2; ++i) {
+        PFORT_CONF_EPOCH epoch = &device_conf->epochs[i];
+
+        epoch->rundown =
+                ExAllocateCacheAwareRundownProtection(NonPagedPoolNx, FORT_DEVICE_CONF_POOL_TAG);
+        if (epoch->rundown == NULL)
+            return STATUS_INSUFFICIENT_RESOURCES;
+    }
+
+    return STATUS_SUCCESS;
+}
+
+FORT_API void fort_device_conf_close(PFORT_DEVICE_CONF device_conf)
+{
+    for (int i = 0; i < 2; ++i) {
+        PFORT_CONF_EPOCH epoch = &device_conf->epochs[i];
+
+        if (epoch->rundown != NULL) {
+            ExFreeCacheAwareRundownProtection(epoch->rundown);
+            epoch->rundown = NULL;
+        }
+    }
 }
 
 FORT_API UINT16 fort_device_flag_set(PFORT_DEVICE_CONF device_conf, UINT16 flag, BOOL on)
@@ -54,6 +86,116 @@ FORT_API UINT16 fort_device_flag(PFORT_DEVICE_CONF device_conf, UINT16 flag)
     return fort_device_flags(device_conf) & flag;
 }
 
+inline static UINT8 fort_conf_exe_index_tag(UINT32 path_hash)
+{
+    return (UINT8) (0x80 | (path_hash >> 25));
+}
+
+/* Get the bit mask of the group's slots with the tag */
+inline static UINT32 fort_conf_exe_index_match(const UINT8 *tags, UINT8 tag)
+{
+#ifdef FORT_CONF_EXE_INDEX_SSE2
+    const __m128i group_tags = _mm_loadu_si128((const __m128i *) tags);
+
+    return (UINT32) _mm_movemask_epi8(_mm_cmpeq_epi8(group_tags, _mm_set1_epi8((char) tag)));
+#else
+    UINT32 mask = 0;
+
+    for (int i = 0; i < FORT_CONF_EXE_INDEX_GROUP_SIZE; ++i) {
+        mask |= (UINT32) (tags[i] == tag) << i;
+    }
+
+    return mask;
+#endif
+}
+
+static UINT32 fort_conf_exe_index_find_slot(
+        PCFORT_CONF_EXE_INDEX exe_index, PCFORT_APP_PATH path, UINT32 path_hash)
+{
+    const UINT8 tag = fort_conf_exe_index_tag(path_hash);
+
+    UINT32 group = path_hash & exe_index->groups_mask;
+
+    for (;;) {
+        const UINT32 group_off = group * FORT_CONF_EXE_INDEX_GROUP_SIZE;
+        const UINT8 *tags = exe_index->tags + group_off;
+
+        UINT32 match = fort_conf_exe_index_match(tags, tag);
+
+        while (match != 0) {
+            const UINT32 slot_index = group_off + tommy_ctz_u32(match);
+            PCFORT_CONF_EXE_SLOT slot = &exe_index->slots[slot_index];
+
+            if (slot->path_hash == path_hash && fort_conf_app_exe_equal(slot->app_entry, path))
+                return slot_index;
+
+            match &= match - 1;
+        }
+
+        /* The probing ends on the group with an empty slot */
+        if (fort_conf_exe_index_match(tags, FORT_CONF_EXE_TAG_EMPTY) != 0)
+            return FORT_CONF_EXE_INDEX_NOT_FOUND;
+
+        group = (group + 1) & exe_index->groups_mask;
+    }
+}
+
+static void fort_conf_exe_index_insert(
+        PFORT_CONF_EXE_INDEX exe_index, PFORT_APP_ENTRY app_entry, UINT32 path_hash)
+{
+    UINT32 group = path_hash & exe_index->groups_mask;
+
+    for (;;) {
+        const UINT32 group_off = group * FORT_CONF_EXE_INDEX_GROUP_SIZE;
+        UINT8 *tags = exe_index->tags + group_off;
+
+        const UINT32 match = fort_conf_exe_index_match(tags, FORT_CONF_EXE_TAG_EMPTY);
+
+        if (match != 0) {
+            const UINT32 slot_index = group_off + tommy_ctz_u32(match);
+            PFORT_CONF_EXE_SLOT slot = &exe_index->slots[slot_index];
+
+            exe_index->tags[slot_index] = fort_conf_exe_index_tag(path_hash);
+
+            slot->path_hash = path_hash;
+            slot->app_entry = app_entry;
+            return;
+        }
+
+        group = (group + 1) & exe_index->groups_mask;
+    }
+}
+
+static BOOL fort_conf_exe_index_remove(
+        PFORT_CONF_EXE_INDEX exe_index, PCFORT_APP_PATH path, UINT32 path_hash)
+{
+    if (exe_index->tags == NULL)
+        return FALSE;
+
+    const UINT32 slot_index = fort_conf_exe_index_find_slot(exe_index, path, path_hash);
+    if (slot_index == FORT_CONF_EXE_INDEX_NOT_FOUND)
+        return FALSE;
+
+    /* Keep the probing chain: don't mark the slot as empty */
+    exe_index->tags[slot_index] = FORT_CONF_EXE_TAG_DELETED;
+    exe_index->slots[slot_index].app_entry = NULL;
+
+    return TRUE;
+}
+
+static void fort_conf_exe_index_done(PFORT_CONF_EXE_INDEX exe_index)
+{
+    if (exe_index->tags != NULL) {
+        tommy_free(exe_index->tags);
+        exe_index->tags = NULL;
+    }
+
+    if (exe_index->slots != NULL) {
+        tommy_free(exe_index->slots);
+        exe_index->slots = NULL;
+    }
+}
+
 static PFORT_CONF_EXE_NODE fort_conf_ref_exe_find_node(
         PFORT_CONF_REF conf_ref, PCFORT_APP_PATH path, tommy_key_t path_hash)
 {
@@ -70,6 +212,28 @@ static PFORT_CONF_EXE_NODE fort_conf_ref_exe_find_node(
     return NULL;
 }
 
+static PCFORT_APP_ENTRY fort_conf_ref_exe_find_entry(
+        PFORT_CONF_REF conf_ref, PCFORT_APP_PATH path, tommy_key_t path_hash)
+{
+    PCFORT_CONF_EXE_INDEX exe_index = &conf_ref->exe_index;
+
+    if (exe_index->tags != NULL) {
+        const UINT32 slot_index =
+                fort_conf_exe_index_find_slot(exe_index, path, (UINT32) path_hash);
+
+        if (slot_index != FORT_CONF_EXE_INDEX_NOT_FOUND)
+            return exe_index->slots[slot_index].app_entry;
+
+        /* No apps were added after the index is built */
+        if (conf_ref->exe_overlay_n == 0)
+            return NULL;
+    }
+
+    PCFORT_CONF_EXE_NODE node = fort_conf_ref_exe_find_node(conf_ref, path, path_hash);
+
+    return (node != NULL) ? node->app_entry : NULL;
+}
+
 FORT_API FORT_APP_DATA fort_conf_exe_find(PCFORT_CONF conf, PVOID context, PCFORT_APP_PATH path)
 {
     UNUSED(conf);
@@ -81,10 +245,10 @@ FORT_API FORT_APP_DATA fort_conf_exe_find(PCFORT_CONF conf, PVOID context, PCFOR
 
     KIRQL oldIrql = ExAcquireSpinLockShared(&conf_ref->conf_lock);
     {
-        PCFORT_CONF_EXE_NODE node = fort_conf_ref_exe_find_node(conf_ref, path, path_hash);
+        PCFORT_APP_ENTRY app_entry = fort_conf_ref_exe_find_entry(conf_ref, path, path_hash);
 
-        if (node != NULL) {
-            app_data = node->app_entry->app_data;
+        if (app_entry != NULL) {
+            app_data = app_entry->app_data;
         }
     }
     ExReleaseSpinLockShared(&conf_ref->conf_lock, oldIrql);
@@ -105,7 +269,7 @@ static void fort_conf_ref_exe_new_path(
     if (exe_node != NULL) {
         tommy_list_remove_existing(&conf_ref->free_nodes, exe_node);
     } else {
-        const UINT16 index = conf->exe_apps_n;
+        const UINT32 index = conf->exe_apps_n;
 
         tommy_arrayof_grow(exe_nodes, index + 1);
 
@@ -115,6 +279,10 @@ static void fort_conf_ref_exe_new_path(
     tommy_hashdyn_insert(exe_map, exe_node, entry, path_hash);
 
     ++conf->exe_apps_n;
+
+    if (conf_ref->exe_index.tags != NULL) {
+        ++conf_ref->exe_overlay_n;
+    }
 }
 
 static NTSTATUS fort_conf_ref_exe_new_entry(PFORT_CONF_REF conf_ref, PCFORT_APP_ENTRY app_entry,
@@ -200,9 +368,9 @@ static void fort_conf_ref_exe_fill(PFORT_CONF_REF conf_ref, PCFORT_CONF conf)
 {
     const char *app_entries = (const char *) (conf->data + conf->exe_apps_off);
 
-    const int count = conf->exe_apps_n;
+    const UINT32 count = conf->exe_apps_n;
 
-    for (int i = 0; i < count; ++i) {
+    for (UINT32 i = 0; i < count; ++i) {
         PCFORT_APP_ENTRY entry = (PCFORT_APP_ENTRY) app_entries;
 
         fort_conf_ref_exe_add_entry(conf_ref, entry, TRUE);
@@ -211,6 +379,38 @@ static void fort_conf_ref_exe_fill(PFORT_CONF_REF conf_ref, PCFORT_CONF conf)
     }
 }
 
+static void fort_conf_ref_exe_index_build(PFORT_CONF_REF conf_ref)
+{
+    const UINT32 count = conf_ref->conf.exe_apps_n;
+    if (count == 0)
+        return;
+
+    /* Keep the load factor under 7/8 to have an empty slot in each probing chain */
+    UINT32 groups_count = 1;
+    while ((UINT64) groups_count * FORT_CONF_EXE_INDEX_GROUP_SIZE * 7 / 8 <= count) {
+        groups_count <<= 1;
+    }
+
+    const UINT32 slots_count = groups_count * FORT_CONF_EXE_INDEX_GROUP_SIZE;
+
+    PFORT_CONF_EXE_INDEX exe_index = &conf_ref->exe_index;
+
+    exe_index->groups_mask = groups_count - 1;
+    exe_index->tags = tommy_calloc(slots_count, sizeof(UINT8));
+    exe_index->slots = tommy_malloc(slots_count * sizeof(FORT_CONF_EXE_SLOT));
+
+    if (exe_index->tags == NULL || exe_index->slots == NULL) {
+        fort_conf_exe_index_done(exe_index); /* use the exe map only */
+        return;
+    }
+
+    for (UINT32 i = 0; i < count; ++i) {
+        PCFORT_CONF_EXE_NODE node = tommy_arrayof_ref(&conf_ref->exe_nodes, i);
+
+        fort_conf_exe_index_insert(exe_index, node->app_entry, (UINT32) node->path_hash);
+    }
+}
+
 static void fort_conf_ref_exe_del_path(PFORT_CONF_REF conf_ref, PCFORT_APP_PATH path)
 {
     const tommy_key_t path_hash = (tommy_key_t) tommy_hash_u64(0, path->buffer, path->len);
@@ -226,6 +426,11 @@ static void fort_conf_ref_exe_del_path(PFORT_CONF_REF conf_ref, PCFORT_APP_PATH
                 --conf->exe_apps_n;
             }
 
+            /* Delete from exe index or its overlay */
+            if (!fort_conf_exe_index_remove(&conf_ref->exe_index, path, (UINT32) path_hash)) {
+                --conf_ref->exe_overlay_n;
+            }
+
             /* Delete from pool */
             {
                 PFORT_APP_ENTRY entry = node->app_entry;
@@ -253,14 +458,15 @@ FORT_API void fort_conf_ref_exe_del_entry(PFORT_CONF_REF conf_ref, PCFORT_APP_EN
 
 static void fort_conf_ref_init(PFORT_CONF_REF conf_ref)
 {
-    conf_ref->refcount = 0;
-
     fort_pool_list_init(&conf_ref->pool_list);
     tommy_list_init(&conf_ref->free_nodes);
 
     tommy_arrayof_init(&conf_ref->exe_nodes, sizeof(FORT_CONF_EXE_NODE));
     tommy_hashdyn_init(&conf_ref->exe_map);
 
+    RtlZeroMemory(&conf_ref->exe_index, sizeof(FORT_CONF_EXE_INDEX));
+    conf_ref->exe_overlay_n = 0;
+
     conf_ref->conf_lock = 0;
 }
 
@@ -276,7 +482,12 @@ FORT_API PFORT_CONF_REF fort_conf_ref_new(PCFORT_CONF conf, ULONG len)
         fort_conf_ref_init(conf_ref);
         fort_pool_init(&conf_ref->pool_list, len - conf_len);
 
+        /* The exe apps are counted again on fill */
+        conf_ref->conf.exe_apps_n = 0;
+
         fort_conf_ref_exe_fill(conf_ref, conf);
+
+        fort_conf_ref_exe_index_build(conf_ref);
     }
 
     return conf_ref;
@@ -286,29 +497,23 @@ static void fort_conf_ref_del(PFORT_CONF_REF conf_ref)
 {
     fort_pool_done(&conf_ref->pool_list);
 
+    fort_conf_exe_index_done(&conf_ref->exe_index);
+
     tommy_hashdyn_done(&conf_ref->exe_map);
     tommy_arrayof_done(&conf_ref->exe_nodes);
 
     tommy_free(conf_ref);
 }
 
-static void fort_conf_ref_put_locked(PFORT_DEVICE_CONF device_conf, PFORT_CONF_REF conf_ref)
-{
-    const UINT32 refcount = --conf_ref->refcount;
-
-    if (refcount == 0 && conf_ref != device_conf->ref) {
-        fort_conf_ref_del(conf_ref);
-    }
-}
-
 FORT_API void fort_conf_ref_put(PFORT_DEVICE_CONF device_conf, PFORT_CONF_REF conf_ref)
 {
-    KLOCK_QUEUE_HANDLE lock_queue;
-    KeAcquireInStackQueuedSpinLock(&device_conf->ref_lock, &lock_queue);
-    {
-        fort_conf_ref_put_locked(device_conf, conf_ref);
+    /* The reader's epoch can't be switched out before it leaves */
+    PFORT_CONF_EPOCH epoch = &device_conf->epochs[0];
+    if (epoch->ref != conf_ref) {
+        epoch = &device_conf->epochs[1];
     }
-    KeReleaseInStackQueuedSpinLock(&lock_queue);
+
+    ExReleaseRundownProtectionCacheAware(epoch->rundown);
 }
 
 FORT_API PFORT_CONF_REF fort_conf_ref_take(PFORT_DEVICE_CONF device_conf)
@@ -316,19 +521,28 @@ FORT_API PFORT_CONF_REF fort_conf_ref_take(PFORT_DEVICE_CONF device_conf)
     if (device_conf->ref == NULL)
         return NULL;
 
-    PFORT_CONF_REF conf_ref;
+    for (;;) {
+        const LONG index = (device_conf->ref_epoch & 1);
+        PFORT_CONF_EPOCH epoch = &device_conf->epochs[index];
 
-    KLOCK_QUEUE_HANDLE lock_queue;
-    KeAcquireInStackQueuedSpinLock(&device_conf->ref_lock, &lock_queue);
-    {
-        conf_ref = device_conf->ref;
-        if (conf_ref != NULL) {
-            ++conf_ref->refcount;
+        /* Fails only when the epoch is already switched out: retry with the new one */
+        if (!ExAcquireRundownProtectionCacheAware(epoch->rundown))
+            continue;
+
+        /* The epoch may be switched out, run down and re-initialized before the acquiring:
+         * then its conf_ref is already released, retry with the current epoch */
+        if ((device_conf->ref_epoch & 1) != index) {
+            ExReleaseRundownProtectionCacheAware(epoch->rundown);
+            continue;
         }
-    }
-    KeReleaseInStackQueuedSpinLock(&lock_queue);
 
-    return conf_ref;
+        PFORT_CONF_REF conf_ref = epoch->ref;
+        if (conf_ref == NULL) {
+            ExReleaseRundownProtectionCacheAware(epoch->rundown);
+        }
+
+        return conf_ref;
+    }
 }
 
 static void fort_device_flags_conf_set(PFORT_DEVICE_CONF device_conf, FORT_CONF_FLAGS conf_flags)
@@ -342,7 +556,13 @@ FORT_API FORT_CONF_FLAGS fort_conf_ref_set(PFORT_DEVICE_CONF device_conf, PFORT_
 {
     FORT_CONF_FLAGS old_conf_flags;
 
-    const PFORT_CONF_REF old_conf_ref = fort_conf_ref_take(device_conf);
+    KeWaitForSingleObject(&device_conf->ref_set_event, Executive, KernelMode, FALSE, NULL);
+
+    const LONG old_index = (device_conf->ref_epoch & 1);
+    PFORT_CONF_EPOCH old_epoch = &device_conf->epochs[old_index];
+    PFORT_CONF_EPOCH new_epoch = &device_conf->epochs[old_index ^ 1];
+
+    const PFORT_CONF_REF old_conf_ref = old_epoch->ref;
 
     if (old_conf_ref != NULL) {
         old_conf_flags = old_conf_ref->conf.flags;
@@ -376,16 +596,47 @@ FORT_API FORT_CONF_FLAGS fort_conf_ref_set(PFORT_DEVICE_CONF device_conf, PFORT_
         }
 
         device_conf->conf_flags = conf_flags;
-
-        if (old_conf_ref != NULL) {
-            fort_conf_ref_put_locked(device_conf, old_conf_ref);
-        }
     }
     KeReleaseInStackQueuedSpinLock(&lock_queue);
 
+    /* Publish the new conf_ref and switch the readers to the new epoch */
+    new_epoch->ref = conf_ref;
+
+    InterlockedExchange(&device_conf->ref_epoch, old_index ^ 1);
+
+    /* Wait for the grace period: the old epoch's readers leave */
+    ExWaitForRundownProtectionReleaseCacheAware(old_epoch->rundown);
+
+    old_epoch->ref = NULL;
+    ExReInitializeRundownProtectionCacheAware(old_epoch->rundown);
+
+    if (old_conf_ref != NULL) {
+        fort_conf_ref_del(old_conf_ref);
+    }
+
+    KeSetEvent(&device_conf->ref_set_event, IO_NO_INCREMENT, FALSE);
+
     return old_conf_flags;
 }
 
+FORT_API void fort_conf_ref_pool_stat(PFORT_DEVICE_CONF device_conf, PFORT_POOL_STAT stat)
+{
+    PFORT_CONF_REF conf_ref = fort_conf_ref_take(device_conf);
+
+    if (conf_ref == NULL) {
+        RtlZeroMemory(stat, sizeof(FORT_POOL_STAT));
+        return;
+    }
+
+    KIRQL oldIrql = ExAcquireSpinLockShared(&conf_ref->conf_lock);
+    {
+        fort_pool_stat(&conf_ref->pool_list, stat);
+    }
+    ExReleaseSpinLockShared(&conf_ref->conf_lock, oldIrql);
+
+    fort_conf_ref_put(device_conf, conf_ref);
+}
+
 FORT_API FORT_CONF_FLAGS fort_conf_ref_flags_set(
         PFORT_DEVICE_CONF device_conf, FORT_CONF_FLAGS conf_flags)
 {
@@ -436,27 +687,34 @@ FORT_API void fort_conf_zones_set(PFORT_DEVICE_CONF device_conf, PFORT_CONF_ZONE
     ExReleaseSpinLockExclusive(&device_conf->lock, oldIrql);
 }
 
-inline static void fort_conf_zone_flag_set_locked(
+inline static BOOL fort_conf_zone_flag_set_locked(
         PFORT_CONF_ZONES zones, PCFORT_CONF_ZONE_FLAG zone_flag)
 {
     const UINT32 zone_mask = (1u << (zone_flag->zone_id - 1));
+    const UINT32 old_enabled_mask = zones->enabled_mask;
 
     if (zone_flag->enabled) {
         zones->enabled_mask |= zone_mask;
     } else {
         zones->enabled_mask &= ~zone_mask;
     }
+
+    return zones->enabled_mask != old_enabled_mask;
 }
 
-FORT_API void fort_conf_zone_flag_set(
+FORT_API BOOL fort_conf_zone_flag_set(
         PFORT_DEVICE_CONF device_conf, PCFORT_CONF_ZONE_FLAG zone_flag)
 {
+    BOOL changed = FALSE;
+
     KIRQL oldIrql = ExAcquireSpinLockExclusive(&device_conf->lock);
     PFORT_CONF_ZONES zones = device_conf->zones;
     if (zones != NULL) {
-        fort_conf_zone_flag_set_locked(zones, zone_flag);
+        changed = fort_conf_zone_flag_set_locked(zones, zone_flag);
     }
     ExReleaseSpinLockExclusive(&device_conf->lock, oldIrql);
+
+    return changed;
 }
 
 FORT_API BOOL fort_devconf_zones_ip_included(
@@ -511,27 +769,37 @@ FORT_API void fort_conf_rules_set(PFORT_DEVICE_CONF device_conf, PFORT_CONF_RULE
     ExReleaseSpinLockExclusive(&device_conf->lock, oldIrql);
 }
 
-inline static void fort_conf_rule_flag_set_locked(
+inline static BOOL fort_conf_rule_flag_set_locked(
         PFORT_CONF_RULES rules, PCFORT_CONF_RULE_FLAG rule_flag)
 {
     if (rule_flag->rule_id > rules->max_rule_id)
-        return;
+        return FALSE;
 
     const FORT_CONF_RULES_RT rules_rt = fort_conf_rules_rt_make(rules, /*zones=*/NULL);
     PFORT_CONF_RULE rule = fort_conf_rules_rt_rule(&rules_rt, rule_flag->rule_id);
 
-    rule->enabled = rule_flag->enabled;
+    const UCHAR enabled = (rule_flag->enabled != 0);
+    if (rule->enabled == enabled)
+        return FALSE;
+
+    rule->enabled = enabled;
+
+    return TRUE;
 }
 
-FORT_API void fort_conf_rule_flag_set(
+FORT_API BOOL fort_conf_rule_flag_set(
         PFORT_DEVICE_CONF device_conf, PCFORT_CONF_RULE_FLAG rule_flag)
 {
+    BOOL changed = FALSE;
+
     KIRQL oldIrql = ExAcquireSpinLockExclusive(&device_conf->lock);
     PFORT_CONF_RULES rules = device_conf->rules;
     if (rules != NULL) {
-        fort_conf_rule_flag_set_locked(rules, rule_flag);
+        changed = fort_conf_rule_flag_set_locked(rules, rule_flag);
     }
     ExReleaseSpinLockExclusive(&device_conf->lock, oldIrql);
+
+    return changed;
 }
 
 FORT_API BOOL fort_devconf_rules_conn_filtered(
@@ -11,15 +11,38 @@
 #define FORT_SVCHOST_PREFIX_SIZE                                                                   \
     (sizeof(FORT_SVCHOST_PREFIX) - sizeof(WCHAR)) /* skip terminating zero */
 
-typedef struct fort_conf_ref
+#define FORT_CONF_EXE_INDEX_GROUP_SIZE 16 /* slots' tags matched at once */
+#define FORT_CONF_EXE_INDEX_NOT_FOUND  ((UINT32) -1)
+
+typedef struct fort_conf_exe_slot
+{
+    UINT32 path_hash;
+    PFORT_APP_ENTRY app_entry;
+} FORT_CONF_EXE_SLOT, *PFORT_CONF_EXE_SLOT;
+
+typedef const FORT_CONF_EXE_SLOT *PCFORT_CONF_EXE_SLOT;
+
+/* Immutable open-addressing index of the published exe apps */
+typedef struct fort_conf_exe_index
 {
-    UINT32 volatile refcount;
+    UINT32 groups_mask; /* groups count - 1 */
+
+    UINT8 *tags; /* per slot: 0 - empty, 1 - deleted, else 0x80 | 7 high bits of path hash */
+    PFORT_CONF_EXE_SLOT slots;
+} FORT_CONF_EXE_INDEX, *PFORT_CONF_EXE_INDEX;
 
+typedef const FORT_CONF_EXE_INDEX *PCFORT_CONF_EXE_INDEX;
+
+typedef struct fort_conf_ref
+{
     FORT_POOL_LIST pool_list;
     tommy_list free_nodes;
 
     tommy_arrayof exe_nodes;
-    tommy_hashdyn exe_map;
+    tommy_hashdyn exe_map; /* all exe apps: the index's overlay for updates */
+
+    FORT_CONF_EXE_INDEX exe_index;
+    UINT32 exe_overlay_n; /* count of exe apps added after the index is built */
 
     EX_SPIN_LOCK conf_lock;
 
@@ -37,6 +60,15 @@ typedef struct fort_conf_ref
 #define FORT_DEVICE_POWER_OFF           0x40
 #define FORT_DEVICE_SHUTDOWN_REGISTERED 0x80
 
+/* Readers of the conf enter the current epoch and see its conf_ref.
+ * The publisher switches the epoch and waits for the old epoch's readers to leave,
+ * then frees the old conf_ref. */
+typedef struct fort_conf_epoch
+{
+    PFORT_CONF_REF ref;
+    PEX_RUNDOWN_REF_CACHE_AWARE rundown; /* per-processor counters */
+} FORT_CONF_EPOCH, *PFORT_CONF_EPOCH;
+
 typedef struct fort_device_conf
 {
     UINT16 volatile flags;
@@ -47,6 +79,10 @@ typedef struct fort_device_conf
     PFORT_CONF_REF volatile ref;
     KSPIN_LOCK ref_lock;
 
+    LONG volatile ref_epoch;
+    FORT_CONF_EPOCH epochs[2];
+    KEVENT ref_set_event; /* serializes the conf_ref publishers */
+
     PFORT_CONF_ZONES zones;
     PFORT_CONF_RULES rules;
 
@@ -57,7 +93,9 @@ typedef struct fort_device_conf
 extern "C" {
 #endif
 
-FORT_API void fort_device_conf_open(PFORT_DEVICE_CONF device_conf);
+FORT_API NTSTATUS fort_device_conf_open(PFORT_DEVICE_CONF device_conf);
+
+FORT_API void fort_device_conf_close(PFORT_DEVICE_CONF device_conf);
 
 FORT_API UINT16 fort_device_flag_set(PFORT_DEVICE_CONF device_conf, UINT16 flag, BOOL on);
 
@@ -81,6 +119,8 @@ FORT_API PFORT_CONF_REF fort_conf_ref_take(PFORT_DEVICE_CONF device_conf);
 
 FORT_API FORT_CONF_FLAGS fort_conf_ref_set(PFORT_DEVICE_CONF device_conf, PFORT_CONF_REF conf_ref);
 
+FORT_API void fort_conf_ref_pool_stat(PFORT_DEVICE_CONF device_conf, PFORT_POOL_STAT stat);
+
 FORT_API FORT_CONF_FLAGS fort_conf_ref_flags_set(
         PFORT_DEVICE_CONF device_conf, const FORT_CONF_FLAGS conf_flags);
 
@@ -88,7 +128,7 @@ FORT_API PFORT_CONF_ZONES fort_conf_zones_new(PCFORT_CONF_ZONES zones, ULONG len
 
 FORT_API void fort_conf_zones_set(PFORT_DEVICE_CONF device_conf, PFORT_CONF_ZONES zones);
 
-FORT_API void fort_conf_zone_flag_set(
+FORT_API BOOL fort_conf_zone_flag_set(
         PFORT_DEVICE_CONF device_conf, PCFORT_CONF_ZONE_FLAG zone_flag);
 
 FORT_API BOOL fort_devconf_zones_ip_included(
@@ -101,7 +141,7 @@ FORT_API PFORT_CONF_RULES fort_conf_rules_new(PCFORT_CONF_RULES rules, ULONG len
 
 FORT_API void fort_conf_rules_set(PFORT_DEVICE_CONF device_conf, PFORT_CONF_RULES rules);
 
-FORT_API void fort_conf_rule_flag_set(
+FORT_API BOOL fort_conf_rule_flag_set(
         PFORT_DEVICE_CONF device_conf, PCFORT_CONF_RULE_FLAG rule_flag);
 
 FORT_API BOOL fort_devconf_rules_conn_filtered(
@@ -126,19 +126,26 @@ static FORT_APP_DATA fort_callout_ale_conf_app_data(
     return app_data;
 }
 
-inline static BOOL fort_callout_ale_associate_flow(
-        PCFORT_CALLOUT_ARG ca, PFORT_CALLOUT_ALE_EXTRA cx, FORT_APP_FLAGS app_flags)
+inline static BOOL fort_callout_ale_associate_flow(PCFORT_CALLOUT_ARG ca,
+        PFORT_CALLOUT_ALE_EXTRA cx, PFORT_CONF_REF conf_ref, FORT_APP_DATA app_data)
 {
     const UINT64 flow_id = ca->inMetaValues->flowHandle;
 
     PFORT_CONF_META_CONN conn = &cx->conn;
 
-    const UCHAR group_index = (UCHAR) app_flags.group_index;
+    const UCHAR group_index = (UCHAR) app_data.flags.group_index;
+    const UINT16 limit_id = app_data.limit_id;
+    const UCHAR limit_io_bits = fort_conf_app_limit_io_bits(&conf_ref->conf, limit_id);
 
     BOOL log_stat = FALSE;
 
-    const NTSTATUS status =
-            fort_flow_associate(&fort_device()->stat, flow_id, conn, group_index, &log_stat);
+    const NTSTATUS status = fort_flow_associate(&fort_device()->stat, flow_id, conn, group_index,
+            limit_id, limit_io_bits, app_data.quota_id, &log_stat);
+
+    if (status == FORT_STATUS_FLOW_QUOTA) {
+        conn->reason = FORT_CONN_REASON_APP_QUOTA;
+        return TRUE; /* block Quota */
+    }
 
     if (!NT_SUCCESS(status)) {
         if (status != FORT_STATUS_FLOW_BLOCK) {
@@ -237,17 +244,46 @@ inline static BOOL fort_callout_ale_add_pending(PCFORT_CALLOUT_ARG ca, PFORT_CAL
     return TRUE; /* drop (pending) */
 }
 
+inline static BOOL fort_callout_ale_check_pending(
+        PCFORT_CALLOUT_ARG ca, PFORT_CALLOUT_ALE_EXTRA cx)
+{
+    PFORT_CONF_META_CONN conn = &cx->conn;
+
+    const UCHAR verdict = fort_pending_app_verdict(&fort_device()->pending, &conn->real_path);
+
+    switch (verdict) {
+    case FORT_PENDING_VERDICT_ALLOW:
+        return FALSE; /* allow (answered) */
+    case FORT_PENDING_VERDICT_UNKNOWN:
+        return fort_callout_ale_add_pending(ca, cx);
+    }
+
+    /* The re-authorized operation of the asked app isn't pended again */
+    if (conn->is_reauth) {
+        conn->reason = FORT_CONN_REASON_REAUTH;
+        return TRUE; /* block (pending, denied or unanswered) */
+    }
+
+    if (verdict == FORT_PENDING_VERDICT_DENY) {
+        conn->reason = FORT_CONN_REASON_ASK_LIMIT;
+        return TRUE; /* block (denied) */
+    }
+
+    return fort_callout_ale_add_pending(ca, cx);
+}
+
 inline static BOOL fort_callout_ale_process_flow(PCFORT_CALLOUT_ARG ca, PFORT_CALLOUT_ALE_EXTRA cx,
-        FORT_CONF_FLAGS conf_flags, FORT_APP_DATA app_data)
+        PFORT_CONF_REF conf_ref, FORT_CONF_FLAGS conf_flags, FORT_APP_DATA app_data)
 {
     if (app_data.found == 0 && conf_flags.ask_to_connect) {
-        return fort_callout_ale_add_pending(ca, cx);
+        if (fort_callout_ale_check_pending(ca, cx))
+            return TRUE;
     }
 
     if (!conf_flags.log_stat)
         return FALSE;
 
-    return fort_callout_ale_associate_flow(ca, cx, app_data.flags);
+    return fort_callout_ale_associate_flow(ca, cx, conf_ref, app_data);
 }
 
 inline static BOOL fort_callout_ale_conn_zone_filtered(
@@ -396,7 +432,7 @@ inline static void fort_callout_ale_check_app(PCFORT_CALLOUT_ARG ca, PFORT_CALLO
 
     if (fort_callout_ale_allowed(cx, conf_flags, app_data)) {
 
-        if (fort_callout_ale_process_flow(ca, cx, conf_flags, app_data))
+        if (fort_callout_ale_process_flow(ca, cx, conf_ref, conf_flags, app_data))
             return;
 
         cx->conn.blocked = FALSE; /* allow */
@@ -784,7 +820,10 @@ static void fort_callout_transport_classify(const FWPS_INCOMING_VALUES0 *inFixed
     if (fort_callout_transport_classify_packet(classifyOut, &ca))
         return;
 
-    fort_flow_classify(&fort_device()->stat, flowContext, ca.dataSize, inbound);
+    if (fort_flow_classify(&fort_device()->stat, flowContext, ca.dataSize, inbound)) {
+        fort_callout_classify_block(classifyOut); /* block Quota */
+        return;
+    }
 
     fort_callout_classify_permit(filter, classifyOut); /* permit */
 }
@@ -1140,6 +1179,9 @@ FORT_API NTSTATUS fort_callout_force_reauth(const FORT_CONF_FLAGS old_conf_flags
     /* Run the log_timer */
     fort_timer_set_running(&fort_device()->log_timer, /*run=*/conf_flags.log_stat);
 
+    /* Run the pending_timer */
+    fort_timer_set_running(&fort_device()->pending_timer, /*run=*/conf_flags.ask_to_connect);
+
     /* Reauth provider filters */
     status = fort_callout_force_reauth_prov(old_conf_flags, conf_flags);
 
@@ -1218,6 +1260,9 @@ FORT_API void fort_callout_timer(void)
     /* Get current Unix time */
     fort_callout_update_system_time(stat, buf, &irp_info);
 
+    /* Reset the traffic quotas on the day/month change */
+    fort_stat_quota_time_update(stat, stat->system_time);
+
     /* Flush traffic statistics */
     fort_callout_flush_stat_traf(stat, buf, &irp_info);
 
@@ -1237,3 +1282,9 @@ FORT_API void fort_callout_timer(void)
         fort_request_complete_info(&irp_info, STATUS_SUCCESS);
     }
 }
+
+FORT_API void fort_callout_pending_timer(void)
+{
+    /* Expire the unanswered pending apps */
+    fort_pending_expire(&fort_device()->pending);
+}
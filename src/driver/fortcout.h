@@ -17,6 +17,8 @@ FORT_API NTSTATUS fort_callout_force_reauth(const FORT_CONF_FLAGS old_conf_flags
 
 FORT_API void fort_callout_timer(void);
 
+FORT_API void fort_callout_pending_timer(void);
+
 #ifdef __cplusplus
 } // extern "C"
 #endif
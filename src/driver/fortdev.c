@@ -241,9 +241,39 @@ static NTSTATUS fort_device_control_getlog(PFORT_DEVICE_CONTROL_ARG dca)
     return status;
 }
 
-inline static NTSTATUS fort_device_control_app_conf(
+inline static BOOL fort_device_control_app_changed(
         PFORT_CONF_REF conf_ref, PCFORT_APP_ENTRY app_entry, BOOL is_adding)
 {
+    const FORT_APP_PATH path = {
+        .len = app_entry->path_len,
+        .buffer = app_entry->path,
+    };
+
+    const FORT_APP_DATA app_data = fort_conf_exe_find(&conf_ref->conf, conf_ref, &path);
+
+    if (!app_data.found)
+        return is_adding;
+
+    if (!is_adding || app_entry->app_data.is_new)
+        return TRUE;
+
+    const FORT_APP_DATA *new_data = &app_entry->app_data;
+
+    return !RtlEqualMemory(&app_data.flags, &new_data->flags, sizeof(FORT_APP_FLAGS))
+            || app_data.rule_id != new_data->rule_id
+            || app_data.accept_zones != new_data->accept_zones
+            || app_data.reject_zones != new_data->reject_zones
+            || app_data.limit_id != new_data->limit_id
+            || app_data.quota_id != new_data->quota_id;
+}
+
+inline static NTSTATUS fort_device_control_app_conf(
+        PFORT_CONF_REF conf_ref, PCFORT_APP_ENTRY app_entry, BOOL is_adding, BOOL *changed)
+{
+    /* Skip the entries which don't change the classification of existing connections */
+    if (!fort_device_control_app_changed(conf_ref, app_entry, is_adding))
+        return STATUS_SUCCESS;
+
     NTSTATUS status;
 
     if (is_adding) {
@@ -253,15 +283,61 @@ inline static NTSTATUS fort_device_control_app_conf(
         status = STATUS_SUCCESS;
     }
 
+    if (NT_SUCCESS(status)) {
+        *changed = TRUE;
+    }
+
     return status;
 }
 
-static NTSTATUS fort_device_control_app(PFORT_DEVICE_CONTROL_ARG dca, BOOL is_adding)
+static BOOL fort_device_control_apps_valid(const char *data, ULONG len)
 {
-    PCFORT_APP_ENTRY app_entry = dca->buffer;
-    const ULONG len = dca->in_len;
+    /* The app entries are packed one after another */
+    do {
+        PCFORT_APP_ENTRY app_entry = (PCFORT_APP_ENTRY) data;
 
-    if (len < sizeof(FORT_APP_ENTRY) || len < FORT_CONF_APP_ENTRY_SIZE(app_entry->path_len))
+        if (len < FORT_CONF_APP_ENTRY_PATH_OFF)
+            return FALSE;
+
+        const ULONG entry_size = FORT_CONF_APP_ENTRY_SIZE(app_entry->path_len);
+        if (len < entry_size)
+            return FALSE;
+
+        data += entry_size;
+        len -= entry_size;
+    } while (len != 0);
+
+    return TRUE;
+}
+
+static NTSTATUS fort_device_control_apps_conf(
+        PFORT_CONF_REF conf_ref, const char *data, ULONG len, BOOL is_adding, BOOL *changed)
+{
+    /* Validate the whole batch before applying any entry */
+    if (!fort_device_control_apps_valid(data, len))
+        return STATUS_UNSUCCESSFUL;
+
+    do {
+        PCFORT_APP_ENTRY app_entry = (PCFORT_APP_ENTRY) data;
+
+        const ULONG entry_size = FORT_CONF_APP_ENTRY_SIZE(app_entry->path_len);
+
+        /* Fails on the lack of resources only: the caller re-sends the full conf */
+        const NTSTATUS status =
+                fort_device_control_app_conf(conf_ref, app_entry, is_adding, changed);
+        if (!NT_SUCCESS(status))
+            return status;
+
+        data += entry_size;
+        len -= entry_size;
+    } while (len != 0);
+
+    return STATUS_SUCCESS;
+}
+
+FORT_API NTSTATUS fort_device_apps_conf(const char *data, ULONG len, BOOL is_adding)
+{
+    if (len < sizeof(FORT_APP_ENTRY))
         return STATUS_UNSUCCESSFUL;
 
     PFORT_CONF_REF conf_ref = fort_conf_ref_take(&fort_device()->conf);
@@ -269,17 +345,25 @@ static NTSTATUS fort_device_control_app(PFORT_DEVICE_CONTROL_ARG dca, BOOL is_ad
     if (conf_ref == NULL)
         return STATUS_INVALID_PARAMETER;
 
-    const NTSTATUS status = fort_device_control_app_conf(conf_ref, app_entry, is_adding);
+    BOOL changed = FALSE;
+    const NTSTATUS status =
+            fort_device_control_apps_conf(conf_ref, data, len, is_adding, &changed);
 
     fort_conf_ref_put(&fort_device()->conf, conf_ref);
 
-    if (NT_SUCCESS(status)) {
+    /* Reauth once for the whole batch, including the applied part of a failed one */
+    if (changed) {
         fort_device_reauth_queue();
     }
 
     return status;
 }
 
+static NTSTATUS fort_device_control_app(PFORT_DEVICE_CONTROL_ARG dca, BOOL is_adding)
+{
+    return fort_device_apps_conf(dca->buffer, dca->in_len, is_adding);
+}
+
 static NTSTATUS fort_device_control_addapp(PFORT_DEVICE_CONTROL_ARG dca)
 {
     return fort_device_control_app(dca, /*is_adding=*/TRUE);
@@ -322,9 +406,10 @@ static NTSTATUS fort_device_control_setzoneflag(PFORT_DEVICE_CONTROL_ARG dca)
     if (len == sizeof(FORT_CONF_ZONE_FLAG)) {
         PFORT_DEVICE_CONF device_conf = &fort_device()->conf;
 
-        fort_conf_zone_flag_set(device_conf, zone_flag);
-
-        fort_device_conf_reauth_queue(device_conf);
+        /* Existing connections are affected only when the flag is changed */
+        if (fort_conf_zone_flag_set(device_conf, zone_flag)) {
+            fort_device_conf_reauth_queue(device_conf);
+        }
 
         return STATUS_SUCCESS;
     }
@@ -364,9 +449,10 @@ static NTSTATUS fort_device_control_setruleflag(PFORT_DEVICE_CONTROL_ARG dca)
     if (len == sizeof(FORT_CONF_RULE_FLAG)) {
         PFORT_DEVICE_CONF device_conf = &fort_device()->conf;
 
-        fort_conf_rule_flag_set(device_conf, rule_flag);
-
-        fort_device_conf_reauth_queue(device_conf);
+        /* Existing connections are affected only when the flag is changed */
+        if (fort_conf_rule_flag_set(device_conf, rule_flag)) {
+            fort_device_conf_reauth_queue(device_conf);
+        }
 
         return STATUS_SUCCESS;
     }
@@ -380,6 +466,41 @@ static_assert(FORT_CTL_INDEX_FROM_CODE(FORT_IOCTL_SETRULEFLAG) == FORT_IOCTL_IND
 typedef NTSTATUS(FORT_DEVICE_CONTROL_PROCESS_FUNC)(PFORT_DEVICE_CONTROL_ARG dca);
 typedef FORT_DEVICE_CONTROL_PROCESS_FUNC *PFORT_DEVICE_CONTROL_PROCESS_FUNC;
 
+static NTSTATUS fort_device_control_setpending(PFORT_DEVICE_CONTROL_ARG dca)
+{
+    PCFORT_PENDING_DECISION_LIST decisions = dca->buffer;
+    const ULONG len = dca->in_len;
+
+    if (len >= FORT_PENDING_DECISION_LIST_DATA_OFF) {
+        PFORT_PENDING pending = &fort_device()->pending;
+
+        fort_pending_set_limits(pending, &decisions->limits);
+
+        fort_pending_decide(pending, decisions,
+                /*data_len=*/len - FORT_PENDING_DECISION_LIST_DATA_OFF);
+
+        return STATUS_SUCCESS;
+    }
+
+    return STATUS_UNSUCCESSFUL;
+}
+
+static NTSTATUS fort_device_control_getpoolstat(PFORT_DEVICE_CONTROL_ARG dca)
+{
+    PFORT_DEVICE_POOL_STAT pool_stat = dca->buffer;
+    const ULONG out_len = dca->out_len;
+
+    if (out_len < sizeof(FORT_DEVICE_POOL_STAT))
+        return STATUS_BUFFER_TOO_SMALL;
+
+    fort_conf_ref_pool_stat(&fort_device()->conf, &pool_stat->conf);
+    fort_pstree_pool_stat(&fort_device()->ps_tree, &pool_stat->ps_tree);
+
+    dca->irp_info->info = sizeof(FORT_DEVICE_POOL_STAT);
+
+    return STATUS_SUCCESS;
+}
+
 static PFORT_DEVICE_CONTROL_PROCESS_FUNC fortDeviceControlProcess_funcList[] = {
     &fort_device_control_validate, // FORT_IOCTL_VALIDATE
     &fort_device_control_setservices, // FORT_IOCTL_SETSERVICES
@@ -392,6 +513,8 @@ static PFORT_DEVICE_CONTROL_PROCESS_FUNC fortDeviceControlProcess_funcList[] = {
     &fort_device_control_setzoneflag, // FORT_IOCTL_SETZONEFLAG
     &fort_device_control_setrules, // FORT_IOCTL_SETRULES
     &fort_device_control_setruleflag, // FORT_IOCTL_SETRULEFLAG
+    &fort_device_control_setpending, // FORT_IOCTL_SETPENDING
+    &fort_device_control_getpoolstat, // FORT_IOCTL_GETPOOLSTAT
 };
 
 static NTSTATUS fort_device_control_process(PFORT_DEVICE_CONTROL_ARG dca)
@@ -504,12 +627,17 @@ FORT_API NTSTATUS fort_device_load(PVOID device_param)
 
     fort_worker_func_set(&fort_device()->worker, FORT_WORKER_REAUTH, &fort_device_reauth);
 
-    fort_device_conf_open(&fort_device()->conf);
+    status = fort_device_conf_open(&fort_device()->conf);
+    if (!NT_SUCCESS(status))
+        return status;
+
     fort_buffer_open(&fort_device()->buffer);
     fort_stat_open(&fort_device()->stat);
     fort_pending_open(&fort_device()->pending);
     fort_shaper_open(&fort_device()->shaper);
     fort_timer_open(&fort_device()->log_timer, 500, /*flags=*/0, &fort_callout_timer);
+    fort_timer_open(&fort_device()->pending_timer, FORT_PENDING_TICK_MS, /*flags=*/0,
+            &fort_callout_pending_timer);
     fort_pstree_open(&fort_device()->ps_tree);
 
     /* Register filters provider */
@@ -550,6 +678,7 @@ FORT_API void fort_device_unload(void)
 
     /* Stop timers */
     fort_timer_close(&fort_device()->log_timer);
+    fort_timer_close(&fort_device()->pending_timer);
 
     /* Stop worker threads */
     fort_worker_unregister(&fort_device()->worker);
@@ -568,6 +697,9 @@ FORT_API void fort_device_unload(void)
     /* Uninstall callouts */
     fort_callout_remove();
 
+    /* Close conf */
+    fort_device_conf_close(&fort_device()->conf);
+
     /* Unregister filters provider */
     if (fort_device_flag(&fort_device()->conf, FORT_DEVICE_BOOT_FILTER) == 0) {
         fort_prov_trans_unregister();
@@ -30,6 +30,7 @@ typedef struct fort_device
     FORT_SHAPER shaper;
     FORT_PSTREE ps_tree;
     FORT_TIMER log_timer;
+    FORT_TIMER pending_timer;
     FORT_WORKER worker;
 } FORT_DEVICE, *PFORT_DEVICE;
 
@@ -41,6 +42,8 @@ FORT_API PFORT_DEVICE fort_device(void);
 
 FORT_API void fort_device_set(PFORT_DEVICE device);
 
+FORT_API NTSTATUS fort_device_apps_conf(const char *data, ULONG len, BOOL is_adding);
+
 FORT_API NTSTATUS fort_device_create(PDEVICE_OBJECT device, PIRP irp);
 
 FORT_API NTSTATUS fort_device_close(PDEVICE_OBJECT device, PIRP irp);
@@ -24,6 +24,7 @@
 #include "fortcnf.c"
 #include "fortdbg.c"
 #include "fortmod.c"
+#include "fortpktq.c"
 #include "fortpkt.c"
 #include "fortpool.c"
 #include "fortps.c"
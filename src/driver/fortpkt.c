@@ -11,8 +11,6 @@
 
 #define FORT_PACKET_FLUSH_ALL 0xFFFFFFFF
 
-#define FORT_QUEUE_INITIAL_TOKEN_COUNT 1500
-
 #define HTONL(l) _byteswap_ulong(l)
 
 typedef void FORT_SHAPER_PACKET_FOREACH_FUNC(PFORT_SHAPER, PFORT_FLOW_PACKET);
@@ -414,320 +412,323 @@ static void fort_shaper_packet_inject(PFORT_SHAPER shaper, PFORT_FLOW_PACKET pkt
     }
 }
 
+inline static PFORT_FLOW_PACKET fort_shaper_flow_packet(PFORT_QUEUE_PACKET qpkt)
+{
+    return CONTAINING_RECORD(qpkt, FORT_FLOW_PACKET, qpkt);
+}
+
 static void fort_shaper_packet_foreach(
-        PFORT_SHAPER shaper, PFORT_FLOW_PACKET pkt, FORT_SHAPER_PACKET_FOREACH_FUNC *func)
+        PFORT_SHAPER shaper, PFORT_QUEUE_PACKET qpkt, FORT_SHAPER_PACKET_FOREACH_FUNC *func)
 {
-    while (pkt != NULL) {
-        PFORT_FLOW_PACKET pkt_next = pkt->next;
+    while (qpkt != NULL) {
+        PFORT_QUEUE_PACKET qpkt_next = qpkt->next;
 
-        func(shaper, pkt);
+        func(shaper, fort_shaper_flow_packet(qpkt));
 
-        pkt = pkt_next;
+        qpkt = qpkt_next;
     }
 }
 
-inline static BOOL fort_shaper_packet_list_is_empty(PFORT_PACKET_LIST pkt_list)
+static PFORT_QUEUE_PACKET fort_shaper_queue_get_packets(
+        PFORT_PACKET_QUEUE queue, PFORT_QUEUE_PACKET pkt)
 {
-    return (pkt_list->packet_head == NULL);
-}
+    KLOCK_QUEUE_HANDLE lock_queue;
+    KeAcquireInStackQueuedSpinLock(&queue->lock, &lock_queue);
 
-static void fort_shaper_packet_list_add_chain(
-        PFORT_PACKET_LIST pkt_list, PFORT_FLOW_PACKET pkt_head, PFORT_FLOW_PACKET pkt_tail)
-{
-    if (pkt_list->packet_tail == NULL) {
-        pkt_list->packet_head = pkt_head;
-    } else {
-        pkt_list->packet_tail->next = pkt_head;
-    }
+    pkt = fort_packet_queue_get_packets(queue, pkt);
 
-    pkt_list->packet_tail = pkt_tail;
+    KeReleaseInStackQueuedSpinLock(&lock_queue);
+
+    return pkt;
 }
 
-static PFORT_FLOW_PACKET fort_shaper_packet_list_get(
-        PFORT_PACKET_LIST pkt_list, PFORT_FLOW_PACKET pkt)
+static PFORT_QUEUE_PACKET fort_shaper_queue_get_flow_packets(
+        PFORT_PACKET_QUEUE queue, PFORT_FLOW flow, PFORT_QUEUE_PACKET pkt)
 {
-    if (pkt_list->packet_head != NULL) {
-        pkt_list->packet_tail->next = pkt;
-        pkt = pkt_list->packet_head;
+    KLOCK_QUEUE_HANDLE lock_queue;
+    KeAcquireInStackQueuedSpinLock(&queue->lock, &lock_queue);
 
-        pkt_list->packet_head = pkt_list->packet_tail = NULL;
-    }
+    pkt = fort_packet_queue_get_flow_packets(queue, flow, pkt);
+
+    KeReleaseInStackQueuedSpinLock(&lock_queue);
 
     return pkt;
 }
 
-static void fort_shaper_packet_list_cut_chain(PFORT_PACKET_LIST pkt_list, PFORT_FLOW_PACKET pkt)
+static BOOL fort_shaper_queue_is_empty(PFORT_PACKET_QUEUE queue)
 {
-    pkt_list->packet_head = pkt->next;
-    pkt->next = NULL;
+    BOOL res;
 
-    if (pkt_list->packet_head == NULL) {
-        pkt_list->packet_tail = NULL;
+    KLOCK_QUEUE_HANDLE lock_queue;
+    KeAcquireInStackQueuedSpinLock(&queue->lock, &lock_queue);
+    {
+        res = fort_packet_queue_is_empty(queue);
     }
+    KeReleaseInStackQueuedSpinLock(&lock_queue);
+
+    return res;
 }
 
-static void fort_shaper_packet_list_cut_packet(PFORT_PACKET_LIST pkt_list, PFORT_FLOW_PACKET pkt,
-        PFORT_FLOW_PACKET pkt_prev, PFORT_FLOW_PACKET pkt_next)
+static BOOL fort_shaper_queue_process(PFORT_SHAPER shaper, PFORT_PACKET_QUEUE queue)
 {
-    if (pkt_prev != NULL) {
-        pkt_prev->next = pkt_next;
-    } else {
-        pkt_list->packet_head = pkt_next;
+    PFORT_QUEUE_PACKET pkt_chain = NULL;
+    BOOL is_active = FALSE;
+
+    KLOCK_QUEUE_HANDLE lock_queue;
+    KeAcquireInStackQueuedSpinLock(&queue->lock, &lock_queue);
+
+    if (!fort_packet_queue_is_empty(queue)) {
+        const LARGE_INTEGER now = KeQueryPerformanceCounter(NULL);
+
+        pkt_chain = fort_packet_queue_process(queue, now, shaper->qpcFrequency);
+
+        is_active = !fort_packet_queue_is_empty(queue);
     }
 
-    if (pkt_next == NULL) {
-        pkt_list->packet_tail = pkt_prev;
+    KeReleaseInStackQueuedSpinLock(&lock_queue);
+
+    if (pkt_chain != NULL) {
+        fort_shaper_packet_foreach(shaper, pkt_chain, &fort_shaper_packet_inject);
     }
+
+    return is_active;
 }
 
-static PFORT_FLOW_PACKET fort_shaper_packet_list_get_flow_packets(
-        PFORT_PACKET_LIST pkt_list, PFORT_FLOW flow, PFORT_FLOW_PACKET pkt_chain)
+inline static PFORT_PACKET_QUEUE fort_shaper_create_queue(PFORT_SHAPER shaper, int queue_index)
 {
-    PFORT_FLOW_PACKET pkt_prev = NULL;
-    PFORT_FLOW_PACKET pkt = pkt_list->packet_head;
+    PFORT_PACKET_QUEUE queue = shaper->queues[queue_index];
+    if (queue != NULL)
+        return queue;
 
-    while (pkt != NULL) {
-        PFORT_FLOW_PACKET pkt_next = pkt->next;
+    queue = fort_mem_alloc(sizeof(FORT_PACKET_QUEUE), FORT_PACKET_POOL_TAG);
+    if (queue == NULL)
+        return NULL;
 
-        if (pkt->flow == flow) {
-            fort_shaper_packet_list_cut_packet(pkt_list, pkt, pkt_prev, pkt_next);
+    RtlZeroMemory(queue, sizeof(FORT_PACKET_QUEUE));
 
-            pkt->next = pkt_chain;
-            pkt_chain = pkt;
-        } else {
-            pkt_prev = pkt;
-        }
+    KeInitializeSpinLock(&queue->lock);
 
-        pkt = pkt_next;
-    }
+    shaper->queues[queue_index] = queue;
 
-    return pkt_chain;
+    return queue;
 }
 
-static void fort_shaper_queue_advance_available(
-        PFORT_SHAPER shaper, PFORT_PACKET_QUEUE queue, const LARGE_INTEGER now)
+static void fort_shaper_create_queues(
+        PFORT_SHAPER shaper, PCFORT_SPEED_LIMIT limits, UINT32 limit_io_bits)
 {
-    const LARGE_INTEGER last_tick = queue->last_tick;
-    queue->last_tick = now;
+    const LARGE_INTEGER now = KeQueryPerformanceCounter(NULL);
 
-    const UINT64 bps = queue->limit.bps;
+    for (int i = 0; limit_io_bits != 0; ++i) {
+        const BOOL queue_exists = (limit_io_bits & 1) != 0;
+        limit_io_bits >>= 1;
 
-    /* Advance the available bytes */
-    const UINT64 accumulated =
-            (bps * (now.QuadPart - last_tick.QuadPart)) / shaper->qpcFrequency.QuadPart;
+        if (!queue_exists)
+            continue;
 
-    queue->available_bytes += accumulated;
+        PFORT_PACKET_QUEUE queue = fort_shaper_create_queue(shaper, i);
+        if (queue == NULL)
+            continue;
 
-    const UINT64 max_available = bps;
-    if (queue->available_bytes > max_available) {
-        queue->available_bytes = max_available;
+        fort_packet_queue_init(queue, &limits[i], now);
     }
+}
 
-    if (fort_shaper_packet_list_is_empty(&queue->bandwidth_list)
-            && queue->available_bytes > FORT_QUEUE_INITIAL_TOKEN_COUNT) {
-        queue->available_bytes = FORT_QUEUE_INITIAL_TOKEN_COUNT;
-    }
+static void fort_shaper_free_queues(PFORT_SHAPER shaper)
+{
+    for (int i = 0; i < FORT_CONF_GROUP_MAX; ++i) {
+        PFORT_PACKET_QUEUE queue = shaper->queues[i];
+        if (queue == NULL)
+            continue;
 
-    /*
-    LOG("Shaper: BAND: queued=%d avail=%d ms=%d\n", (UINT32) queue->queued_bytes,
-            (UINT32) queue->available_bytes,
-            (UINT32) (((now.QuadPart - last_tick.QuadPart) * 1000)
-                    / shaper->qpcFrequency.QuadPart));
-    */
+        fort_mem_free(queue, FORT_PACKET_POOL_TAG);
+    }
 }
 
-static void fort_shaper_queue_process_bandwidth(
-        PFORT_SHAPER shaper, PFORT_PACKET_QUEUE queue, const LARGE_INTEGER now)
+static PFORT_SPEED_LIMIT fort_shaper_app_limits_new(PCFORT_CONF conf)
 {
-    UNUSED(shaper);
+    const UINT16 app_limits_n = conf->app_limits_n;
+    if (app_limits_n == 0)
+        return NULL;
 
-    /* Move packets to the latency queue as the accumulated available bytes will allow */
-    PFORT_FLOW_PACKET pkt_chain = queue->bandwidth_list.packet_head;
-    if (pkt_chain == NULL)
-        return;
+    const ULONG size = FORT_CONF_APP_LIMITS_SIZE(app_limits_n);
 
-    PFORT_FLOW_PACKET pkt_tail = NULL;
-    PFORT_FLOW_PACKET pkt = pkt_chain;
-    do {
-        const UINT64 pkt_length = pkt->data_length;
+    PFORT_SPEED_LIMIT app_limits = fort_mem_alloc(size, FORT_PACKET_POOL_TAG);
+    if (app_limits == NULL)
+        return NULL;
 
-        if (queue->available_bytes < pkt_length)
-            break;
+    RtlCopyMemory(app_limits, fort_conf_app_limits_ref(conf), size);
 
-        queue->available_bytes -= pkt_length;
-        queue->queued_bytes -= pkt_length;
+    return app_limits;
+}
 
-        pkt->latency_start = now;
+inline static void fort_shaper_app_limits_free(PFORT_SPEED_LIMIT app_limits)
+{
+    if (app_limits != NULL) {
+        fort_mem_free(app_limits, FORT_PACKET_POOL_TAG);
+    }
+}
+
+static BOOL fort_shaper_proc_queues_grow_locked(PFORT_SHAPER shaper, tommy_size_t count)
+{
+    const tommy_size_t size = tommy_arrayof_size(&shaper->proc_queues);
+    if (count <= size)
+        return TRUE;
 
-        pkt_tail = pkt;
-        pkt = pkt->next;
-    } while (pkt != NULL);
+    if (!fort_tommy_arrayof_grow(&shaper->proc_queues, count))
+        return FALSE;
 
-    if (pkt_tail != NULL) {
-        fort_shaper_packet_list_cut_chain(&queue->bandwidth_list, pkt_tail);
+    for (tommy_size_t i = size; i < count; ++i) {
+        PFORT_PROC_QUEUE proc_queue = tommy_arrayof_ref(&shaper->proc_queues, i);
 
-        fort_shaper_packet_list_add_chain(&queue->latency_list, pkt_chain, pkt_tail);
+        KeInitializeSpinLock(&proc_queue->queue.lock);
     }
+
+    return TRUE;
 }
 
-static PFORT_FLOW_PACKET fort_shaper_queue_process_latency(
-        PFORT_SHAPER shaper, PFORT_PACKET_QUEUE queue, const LARGE_INTEGER now)
+static PFORT_PROC_QUEUE fort_shaper_proc_queue_get_locked(PFORT_SHAPER shaper, UINT16 proc_index,
+        UINT16 limit_id, BOOL inbound, PFORT_QUEUE_PACKET *pkt_chain)
 {
-    PFORT_FLOW_PACKET pkt_chain = queue->latency_list.packet_head;
-    if (pkt_chain == NULL)
+    if (limit_id == 0 || limit_id > shaper->app_limits_n)
         return NULL;
 
-    const UINT32 latency_ms = queue->limit.latency_ms;
-
-    if (latency_ms == 0) {
-        fort_shaper_packet_list_cut_chain(&queue->latency_list, queue->latency_list.packet_tail);
-
-        return pkt_chain;
-    }
+    const UINT16 io_index = (inbound ? 0 : 1);
+    const tommy_size_t queue_index = (tommy_size_t) proc_index * 2 + io_index;
 
-    const UINT64 qpcFrequency = shaper->qpcFrequency.QuadPart;
-    const UINT64 qpcFrequencyHalfMs = qpcFrequency / 2000LL;
+    if (!fort_shaper_proc_queues_grow_locked(shaper, queue_index + 1))
+        return NULL;
 
-    PFORT_FLOW_PACKET pkt_tail = NULL;
-    PFORT_FLOW_PACKET pkt = pkt_chain;
-    do {
-        /* Round to the closest ms instead of truncating
-         * by adding 1/2 of a ms to the elapsed ticks */
-        const ULONG elapsed_ms = (ULONG) (((now.QuadPart - pkt->latency_start.QuadPart) * 1000LL
-                                                  + qpcFrequencyHalfMs)
-                / qpcFrequency);
+    PFORT_PROC_QUEUE proc_queue = tommy_arrayof_ref(&shaper->proc_queues, queue_index);
 
-        if (elapsed_ms < latency_ms)
-            break;
+    /* The process index may be reused by another process with other limits */
+    if (proc_queue->limit_id != limit_id) {
+        PCFORT_SPEED_LIMIT limit = &shaper->app_limits[(limit_id - 1) * 2 + io_index];
+        const LARGE_INTEGER now = KeQueryPerformanceCounter(NULL);
 
-        pkt_tail = pkt;
-        pkt = pkt->next;
-    } while (pkt != NULL);
+        KLOCK_QUEUE_HANDLE lock_queue;
+        KeAcquireInStackQueuedSpinLock(&proc_queue->queue.lock, &lock_queue);
+        {
+            /* Take the previous process's packets and reset the queued bytes */
+            *pkt_chain = fort_shaper_queue_get_packets(&proc_queue->queue, *pkt_chain);
 
-    if (pkt_tail != NULL) {
-        fort_shaper_packet_list_cut_chain(&queue->latency_list, pkt_tail);
+            fort_packet_queue_init(&proc_queue->queue, limit, now);
+        }
+        KeReleaseInStackQueuedSpinLock(&lock_queue);
 
-        return pkt_chain;
+        proc_queue->limit_id = limit_id;
     }
 
-    return NULL;
+    return proc_queue;
 }
 
-static PFORT_FLOW_PACKET fort_shaper_queue_get_packets(
-        PFORT_PACKET_QUEUE queue, PFORT_FLOW_PACKET pkt)
+static PFORT_PROC_QUEUE fort_shaper_proc_queue_get(
+        PFORT_SHAPER shaper, PFORT_FLOW flow, BOOL inbound)
 {
-    KLOCK_QUEUE_HANDLE lock_queue;
-    KeAcquireInStackQueuedSpinLock(&queue->lock, &lock_queue);
-
-    queue->queued_bytes = 0;
+    if ((fort_shaper_flags(shaper) & FORT_SHAPER_APP_LIMITS) == 0)
+        return NULL;
 
-    pkt = fort_shaper_packet_list_get(&queue->latency_list, pkt);
-    pkt = fort_shaper_packet_list_get(&queue->bandwidth_list, pkt);
+    PFORT_PROC_QUEUE proc_queue;
+    PFORT_QUEUE_PACKET pkt_chain = NULL;
 
+    KLOCK_QUEUE_HANDLE lock_queue;
+    KeAcquireInStackQueuedSpinLock(&shaper->lock, &lock_queue);
+    {
+        proc_queue = fort_shaper_proc_queue_get_locked(
+                shaper, flow->opt.proc_index, flow->limit_id, inbound, &pkt_chain);
+    }
     KeReleaseInStackQueuedSpinLock(&lock_queue);
 
-    return pkt;
+    /* Drop the stale packets */
+    if (pkt_chain != NULL) {
+        fort_shaper_packet_foreach(shaper, pkt_chain, &fort_shaper_packet_drop);
+    }
+
+    return proc_queue;
 }
 
-static PFORT_FLOW_PACKET fort_shaper_queue_get_flow_packets(
-        PFORT_PACKET_QUEUE queue, PFORT_FLOW flow, PFORT_FLOW_PACKET pkt)
+static void fort_shaper_proc_queue_active_add_locked(
+        PFORT_SHAPER shaper, PFORT_PROC_QUEUE proc_queue)
 {
-    KLOCK_QUEUE_HANDLE lock_queue;
-    KeAcquireInStackQueuedSpinLock(&queue->lock, &lock_queue);
-
-    pkt = fort_shaper_packet_list_get_flow_packets(&queue->bandwidth_list, flow, pkt);
-    pkt = fort_shaper_packet_list_get_flow_packets(&queue->latency_list, flow, pkt);
+    if (proc_queue->active)
+        return;
 
-    KeReleaseInStackQueuedSpinLock(&lock_queue);
+    proc_queue->active = TRUE;
 
-    return pkt;
+    /* Add to active chain */
+    proc_queue->next_active = shaper->proc_active;
+    shaper->proc_active = proc_queue;
 }
 
-inline static BOOL fort_shaper_queue_is_empty(PFORT_PACKET_QUEUE queue)
+static void fort_shaper_proc_queue_active_add(PFORT_SHAPER shaper, PFORT_PROC_QUEUE proc_queue)
 {
-    return fort_shaper_packet_list_is_empty(&queue->bandwidth_list)
-            && fort_shaper_packet_list_is_empty(&queue->latency_list);
+    KLOCK_QUEUE_HANDLE lock_queue;
+    KeAcquireInStackQueuedSpinLock(&shaper->lock, &lock_queue);
+    {
+        fort_shaper_proc_queue_active_add_locked(shaper, proc_queue);
+    }
+    KeReleaseInStackQueuedSpinLock(&lock_queue);
 }
 
-static BOOL fort_shaper_queue_process(PFORT_SHAPER shaper, PFORT_PACKET_QUEUE queue)
+static void fort_shaper_proc_queues_reactivate_locked(
+        PFORT_SHAPER shaper, PFORT_PROC_QUEUE proc_queue)
 {
-    PFORT_FLOW_PACKET pkt_chain = NULL;
-    BOOL is_active = FALSE;
-
-    KLOCK_QUEUE_HANDLE lock_queue;
-    KeAcquireInStackQueuedSpinLock(&queue->lock, &lock_queue);
-
-    if (!fort_shaper_queue_is_empty(queue)) {
-        const LARGE_INTEGER now = KeQueryPerformanceCounter(NULL);
+    while (proc_queue != NULL) {
+        PFORT_PROC_QUEUE proc_next = proc_queue->next_active;
 
-        fort_shaper_queue_advance_available(shaper, queue, now);
-        fort_shaper_queue_process_bandwidth(shaper, queue, now);
+        proc_queue->active = FALSE;
 
-        pkt_chain = fort_shaper_queue_process_latency(shaper, queue, now);
+        if (!fort_shaper_queue_is_empty(&proc_queue->queue)) {
+            fort_shaper_proc_queue_active_add_locked(shaper, proc_queue);
+        }
 
-        is_active = !fort_shaper_queue_is_empty(queue);
+        proc_queue = proc_next;
     }
-
-    KeReleaseInStackQueuedSpinLock(&lock_queue);
-
-    if (pkt_chain != NULL) {
-        fort_shaper_packet_foreach(shaper, pkt_chain, &fort_shaper_packet_inject);
-    }
-
-    return is_active;
 }
 
-inline static PFORT_PACKET_QUEUE fort_shaper_create_queue(PFORT_SHAPER shaper, int queue_index)
+static PFORT_QUEUE_PACKET fort_shaper_proc_queues_get_flow_packets(
+        PFORT_SHAPER shaper, PFORT_FLOW flow, UCHAR speed_limit, PFORT_QUEUE_PACKET pkt_chain)
 {
-    PFORT_PACKET_QUEUE queue = shaper->queues[queue_index];
-    if (queue != NULL)
-        return queue;
+    KLOCK_QUEUE_HANDLE lock_queue;
+    KeAcquireInStackQueuedSpinLock(&shaper->lock, &lock_queue);
 
-    queue = fort_mem_alloc(sizeof(FORT_PACKET_QUEUE), FORT_PACKET_POOL_TAG);
-    if (queue == NULL)
-        return NULL;
+    const tommy_size_t size = tommy_arrayof_size(&shaper->proc_queues);
+    const tommy_size_t queue_index = (tommy_size_t) flow->opt.proc_index * 2;
 
-    RtlZeroMemory(queue, sizeof(FORT_PACKET_QUEUE));
+    for (int i = 0; i < 2; ++i) {
+        if ((speed_limit & (1 << i)) == 0 || queue_index + i >= size)
+            continue;
 
-    KeInitializeSpinLock(&queue->lock);
+        PFORT_PROC_QUEUE proc_queue = tommy_arrayof_ref(&shaper->proc_queues, queue_index + i);
 
-    shaper->queues[queue_index] = queue;
+        pkt_chain = fort_shaper_queue_get_flow_packets(&proc_queue->queue, flow, pkt_chain);
+    }
 
-    return queue;
+    KeReleaseInStackQueuedSpinLock(&lock_queue);
+
+    return pkt_chain;
 }
 
-static void fort_shaper_create_queues(
-        PFORT_SHAPER shaper, PCFORT_SPEED_LIMIT limits, UINT32 limit_io_bits)
+static PFORT_QUEUE_PACKET fort_shaper_flush_proc_queues(PFORT_SHAPER shaper)
 {
-    const LARGE_INTEGER now = KeQueryPerformanceCounter(NULL);
+    PFORT_QUEUE_PACKET pkt_chain = NULL;
 
-    for (int i = 0; limit_io_bits != 0; ++i) {
-        const BOOL queue_exists = (limit_io_bits & 1) != 0;
-        limit_io_bits >>= 1;
+    KLOCK_QUEUE_HANDLE lock_queue;
+    KeAcquireInStackQueuedSpinLock(&shaper->lock, &lock_queue);
 
-        if (!queue_exists)
-            continue;
+    const tommy_size_t size = tommy_arrayof_size(&shaper->proc_queues);
 
-        PFORT_PACKET_QUEUE queue = fort_shaper_create_queue(shaper, i);
-        if (queue == NULL)
-            continue;
+    for (tommy_size_t i = 0; i < size; ++i) {
+        PFORT_PROC_QUEUE proc_queue = tommy_arrayof_ref(&shaper->proc_queues, i);
 
-        queue->limit = limits[i];
+        /* Re-initialize the queue's limit on next use */
+        proc_queue->limit_id = 0;
 
-        queue->available_bytes = FORT_QUEUE_INITIAL_TOKEN_COUNT;
-        queue->last_tick = now;
+        pkt_chain = fort_shaper_queue_get_packets(&proc_queue->queue, pkt_chain);
     }
-}
 
-static void fort_shaper_free_queues(PFORT_SHAPER shaper)
-{
-    for (int i = 0; i < FORT_CONF_GROUP_MAX; ++i) {
-        PFORT_PACKET_QUEUE queue = shaper->queues[i];
-        if (queue == NULL)
-            continue;
+    KeReleaseInStackQueuedSpinLock(&lock_queue);
 
-        fort_mem_free(queue, FORT_PACKET_POOL_TAG);
-    }
+    return pkt_chain;
 }
 
 inline static void fort_shaper_thread_set_event(PFORT_SHAPER shaper)
@@ -758,7 +759,7 @@ inline static ULONG fort_shaper_thread_process_queues(PFORT_SHAPER shaper, ULONG
     return new_active_io_bits;
 }
 
-inline static BOOL fort_shaper_thread_process(PFORT_SHAPER shaper)
+inline static BOOL fort_shaper_thread_process_groups(PFORT_SHAPER shaper)
 {
     ULONG active_io_bits =
             fort_shaper_io_bits_set(&shaper->active_io_bits, FORT_PACKET_FLUSH_ALL, FALSE);
@@ -777,6 +778,47 @@ inline static BOOL fort_shaper_thread_process(PFORT_SHAPER shaper)
     return FALSE;
 }
 
+inline static BOOL fort_shaper_thread_process_procs(PFORT_SHAPER shaper)
+{
+    PFORT_PROC_QUEUE proc_head;
+    BOOL is_active;
+
+    KLOCK_QUEUE_HANDLE lock_queue;
+    KeAcquireInStackQueuedSpinLock(&shaper->lock, &lock_queue);
+    {
+        /* Detach the active chain, the queues stay marked as active */
+        proc_head = shaper->proc_active;
+        shaper->proc_active = NULL;
+    }
+    KeReleaseInStackQueuedSpinLock(&lock_queue);
+
+    if (proc_head == NULL)
+        return FALSE;
+
+    PFORT_PROC_QUEUE proc_queue = proc_head;
+    for (; proc_queue != NULL; proc_queue = proc_queue->next_active) {
+        fort_shaper_queue_process(shaper, &proc_queue->queue);
+    }
+
+    KeAcquireInStackQueuedSpinLock(&shaper->lock, &lock_queue);
+    {
+        fort_shaper_proc_queues_reactivate_locked(shaper, proc_head);
+
+        is_active = (shaper->proc_active != NULL);
+    }
+    KeReleaseInStackQueuedSpinLock(&lock_queue);
+
+    return is_active;
+}
+
+inline static BOOL fort_shaper_thread_process(PFORT_SHAPER shaper)
+{
+    const BOOL groups_active = fort_shaper_thread_process_groups(shaper);
+    const BOOL procs_active = fort_shaper_thread_process_procs(shaper);
+
+    return groups_active || procs_active;
+}
+
 static void fort_shaper_thread_loop(PVOID context)
 {
     PFORT_SHAPER shaper = context;
@@ -805,9 +847,10 @@ static void fort_shaper_thread_close(PFORT_SHAPER shaper)
     fort_thread_wait(&shaper->thread);
 }
 
-inline static PFORT_FLOW_PACKET fort_shaper_flush_queues(PFORT_SHAPER shaper, UINT32 group_io_bits)
+inline static PFORT_QUEUE_PACKET fort_shaper_flush_queues(
+        PFORT_SHAPER shaper, UINT32 group_io_bits)
 {
-    PFORT_FLOW_PACKET pkt_chain = NULL;
+    PFORT_QUEUE_PACKET pkt_chain = NULL;
 
     for (int i = 0; group_io_bits != 0; ++i) {
         const BOOL queue_exists = (group_io_bits & 1) != 0;
@@ -834,7 +877,19 @@ static void fort_shaper_flush(PFORT_SHAPER shaper, UINT32 group_io_bits, BOOL dr
     group_io_bits &= fort_shaper_io_bits_set(&shaper->active_io_bits, group_io_bits, FALSE);
 
     /* Collect packets from Queues */
-    PFORT_FLOW_PACKET pkt_chain = fort_shaper_flush_queues(shaper, group_io_bits);
+    PFORT_QUEUE_PACKET pkt_chain = fort_shaper_flush_queues(shaper, group_io_bits);
+
+    /* Process the packets */
+    if (pkt_chain != NULL) {
+        fort_shaper_packet_foreach(
+                shaper, pkt_chain, (drop ? &fort_shaper_packet_drop : &fort_shaper_packet_inject));
+    }
+}
+
+static void fort_shaper_flush_procs(PFORT_SHAPER shaper, BOOL drop)
+{
+    /* Collect packets from Queues */
+    PFORT_QUEUE_PACKET pkt_chain = fort_shaper_flush_proc_queues(shaper);
 
     /* Process the packets */
     if (pkt_chain != NULL) {
@@ -848,6 +903,8 @@ FORT_API void fort_shaper_open(PFORT_SHAPER shaper)
     const LARGE_INTEGER now = KeQueryPerformanceCounter(&shaper->qpcFrequency);
     shaper->randomSeed = now.LowPart;
 
+    tommy_arrayof_init(&shaper->proc_queues, sizeof(FORT_PROC_QUEUE));
+
     KeInitializeSpinLock(&shaper->lock);
 
     KeInitializeEvent(&shaper->thread_event, SynchronizationEvent, FALSE);
@@ -863,6 +920,10 @@ FORT_API void fort_shaper_close(PFORT_SHAPER shaper)
 
     fort_shaper_drop_packets(shaper);
     fort_shaper_free_queues(shaper);
+
+    tommy_arrayof_done(&shaper->proc_queues);
+
+    fort_shaper_app_limits_free(shaper->app_limits);
 }
 
 FORT_API void fort_shaper_conf_update(PFORT_SHAPER shaper, PCFORT_CONF_IO conf_io)
@@ -876,6 +937,9 @@ FORT_API void fort_shaper_conf_update(PFORT_SHAPER shaper, PCFORT_CONF_IO conf_i
             : 0;
     UINT32 flush_io_bits;
 
+    PFORT_SPEED_LIMIT app_limits = fort_shaper_app_limits_new(&conf_io->conf);
+    const UINT16 app_limits_n = (app_limits != NULL) ? conf_io->conf.app_limits_n : 0;
+
     KLOCK_QUEUE_HANDLE lock_queue;
     KeAcquireInStackQueuedSpinLock(&shaper->lock, &lock_queue);
     {
@@ -886,10 +950,24 @@ FORT_API void fort_shaper_conf_update(PFORT_SHAPER shaper, PCFORT_CONF_IO conf_i
         shaper->limit_io_bits = limit_io_bits;
 
         fort_shaper_io_bits_exchange(&shaper->group_io_bits, group_io_bits);
+
+        /* Swap the app limits */
+        PFORT_SPEED_LIMIT old_app_limits = shaper->app_limits;
+
+        shaper->app_limits = app_limits;
+        shaper->app_limits_n = app_limits_n;
+
+        app_limits = old_app_limits;
     }
     KeReleaseInStackQueuedSpinLock(&lock_queue);
 
+    fort_shaper_flags_set(
+            shaper, FORT_SHAPER_APP_LIMITS, (conf_flags->filter_enabled && app_limits_n != 0));
+
     fort_shaper_flush(shaper, flush_io_bits, /*drop=*/FALSE);
+    fort_shaper_flush_procs(shaper, /*drop=*/FALSE);
+
+    fort_shaper_app_limits_free(app_limits);
 }
 
 void fort_shaper_conf_flags_update(PFORT_SHAPER shaper, const FORT_CONF_FLAGS conf_flags)
@@ -897,6 +975,7 @@ void fort_shaper_conf_flags_update(PFORT_SHAPER shaper, const FORT_CONF_FLAGS co
     const UINT32 group_io_bits =
             conf_flags.filter_enabled ? fort_bits_duplicate16((UINT16) conf_flags.group_bits) : 0;
     UINT32 flush_io_bits;
+    BOOL app_limited;
 
     KLOCK_QUEUE_HANDLE lock_queue;
     KeAcquireInStackQueuedSpinLock(&shaper->lock, &lock_queue);
@@ -905,10 +984,18 @@ void fort_shaper_conf_flags_update(PFORT_SHAPER shaper, const FORT_CONF_FLAGS co
 
         fort_shaper_io_bits_exchange(
                 &shaper->group_io_bits, (shaper->limit_io_bits & group_io_bits));
+
+        app_limited = (conf_flags.filter_enabled && shaper->app_limits_n != 0);
     }
     KeReleaseInStackQueuedSpinLock(&lock_queue);
 
+    fort_shaper_flags_set(shaper, FORT_SHAPER_APP_LIMITS, app_limited);
+
     fort_shaper_flush(shaper, flush_io_bits, /*drop=*/FALSE);
+
+    if (!app_limited) {
+        fort_shaper_flush_procs(shaper, /*drop=*/FALSE);
+    }
 }
 
 static void fort_shaper_packet_queue_add_packet(
@@ -917,34 +1004,13 @@ static void fort_shaper_packet_queue_add_packet(
     KLOCK_QUEUE_HANDLE lock_queue;
     KeAcquireInStackQueuedSpinLock(&queue->lock, &lock_queue);
     {
-        queue->queued_bytes += pkt->data_length;
-
-        fort_shaper_packet_list_add_chain(&queue->bandwidth_list, pkt, pkt);
+        fort_packet_queue_add_packet(queue, &pkt->qpkt);
 
         fort_shaper_io_bits_set(&shaper->active_io_bits, queue_bit, TRUE);
     }
     KeReleaseInStackQueuedSpinLock(&lock_queue);
 }
 
-inline static BOOL fort_shaper_packet_queue_check_plr(PFORT_SHAPER shaper, PFORT_PACKET_QUEUE queue)
-{
-    const UINT16 plr = queue->limit.plr;
-    if (plr > 0) {
-        const ULONG random = RtlRandomEx(&shaper->randomSeed) % 10000; /* PLR range is 0-10000 */
-        if (random < plr)
-            return FALSE;
-    }
-    return TRUE;
-}
-
-inline static BOOL fort_shaper_packet_queue_check_buffer(
-        PFORT_PACKET_QUEUE queue, ULONG data_length)
-{
-    const UINT32 buffer_bytes = queue->limit.buffer_bytes;
-
-    return buffer_bytes == 0 || (UINT64) buffer_bytes >= (queue->queued_bytes + data_length);
-}
-
 static BOOL fort_shaper_packet_queue_check_packet(
         PFORT_SHAPER shaper, PFORT_PACKET_QUEUE queue, ULONG data_length)
 {
@@ -953,26 +1019,42 @@ static BOOL fort_shaper_packet_queue_check_packet(
     KLOCK_QUEUE_HANDLE lock_queue;
     KeAcquireInStackQueuedSpinLock(&queue->lock, &lock_queue);
     {
-        res = fort_shaper_packet_queue_check_plr(shaper, queue)
-                && fort_shaper_packet_queue_check_buffer(queue, data_length);
+        res = fort_packet_queue_check_plr(queue, &shaper->randomSeed)
+                && fort_packet_queue_check_buffer(queue, data_length);
     }
     KeReleaseInStackQueuedSpinLock(&lock_queue);
 
     return res;
 }
 
-inline static NTSTATUS fort_shaper_packet_queue(
-        PFORT_SHAPER shaper, PCFORT_CALLOUT_ARG ca, PFORT_FLOW flow)
+inline static PFORT_PACKET_QUEUE fort_shaper_group_queue_get(
+        PFORT_SHAPER shaper, PFORT_FLOW flow, BOOL inbound, UINT32 *queue_bit)
 {
-    const UINT16 queue_index = flow->opt.group_index * 2 + (ca->inbound ? 0 : 1);
+    const UINT16 queue_index = flow->opt.group_index * 2 + (inbound ? 0 : 1);
 
     const UINT32 group_io_bits = fort_shaper_io_bits(&shaper->group_io_bits);
 
-    const UINT32 queue_bit = (1 << queue_index);
-    if ((group_io_bits & queue_bit) == 0)
-        return STATUS_NO_SUCH_GROUP;
+    *queue_bit = (1 << queue_index);
+    if ((group_io_bits & *queue_bit) == 0)
+        return NULL;
+
+    return shaper->queues[queue_index];
+}
+
+inline static NTSTATUS fort_shaper_packet_queue(
+        PFORT_SHAPER shaper, PCFORT_CALLOUT_ARG ca, PFORT_FLOW flow, UCHAR flow_flags)
+{
+    PFORT_PROC_QUEUE proc_queue = NULL;
+    PFORT_PACKET_QUEUE queue;
+    UINT32 queue_bit = 0;
+
+    if ((flow_flags & FORT_FLOW_SPEED_LIMIT_PROC) != 0) {
+        proc_queue = fort_shaper_proc_queue_get(shaper, flow, ca->inbound);
+        queue = (proc_queue != NULL) ? &proc_queue->queue : NULL;
+    } else {
+        queue = fort_shaper_group_queue_get(shaper, flow, ca->inbound, &queue_bit);
+    }
 
-    PFORT_PACKET_QUEUE queue = shaper->queues[queue_index];
     if (queue == NULL)
         return STATUS_NO_SUCH_GROUP;
 
@@ -994,12 +1076,16 @@ inline static NTSTATUS fort_shaper_packet_queue(
         return status;
     }
 
-    pkt->flow = flow;
-    pkt->data_length = ca->dataSize;
+    pkt->qpkt.flow = flow;
+    pkt->qpkt.data_length = ca->dataSize;
 
     /* Add the Packet to Queue */
     fort_shaper_packet_queue_add_packet(shaper, queue, pkt, queue_bit);
 
+    if (proc_queue != NULL) {
+        fort_shaper_proc_queue_active_add(shaper, proc_queue);
+    }
+
     /* Packets in transport layer must be re-injected in DCP/thread due to locking */
     fort_shaper_thread_set_event(shaper);
 
@@ -1038,24 +1124,14 @@ FORT_API BOOL fort_shaper_packet_process(PFORT_SHAPER shaper, PFORT_CALLOUT_ARG
     if (fort_packet_injected_by_self(ca))
         return FALSE;
 
-    const NTSTATUS status = fort_shaper_packet_queue(shaper, ca, flow);
+    const NTSTATUS status = fort_shaper_packet_queue(shaper, ca, flow, flow_flags);
 
     return NT_SUCCESS(status);
 }
 
-FORT_API void fort_shaper_drop_flow_packets(PFORT_SHAPER shaper, UINT64 flowContext)
+static PFORT_QUEUE_PACKET fort_shaper_group_queues_get_flow_packets(
+        PFORT_SHAPER shaper, PFORT_FLOW flow, UCHAR speed_limit, PFORT_QUEUE_PACKET pkt_chain)
 {
-    PFORT_FLOW flow = (PFORT_FLOW) flowContext;
-
-    const UCHAR flow_flags = fort_flow_flags(flow);
-    const UCHAR speed_limit = (flow_flags & FORT_FLOW_SPEED_LIMIT_FLAGS);
-
-    if (speed_limit == 0)
-        return;
-
-    /* Collect flow's packets from Queues */
-    PFORT_FLOW_PACKET pkt_chain = NULL;
-
     UINT32 active_io_bits = fort_shaper_io_bits(&shaper->active_io_bits)
             & (speed_limit << (flow->opt.group_index * 2));
 
@@ -1073,6 +1149,28 @@ FORT_API void fort_shaper_drop_flow_packets(PFORT_SHAPER shaper, UINT64 flowCont
         pkt_chain = fort_shaper_queue_get_flow_packets(queue, flow, pkt_chain);
     }
 
+    return pkt_chain;
+}
+
+FORT_API void fort_shaper_drop_flow_packets(PFORT_SHAPER shaper, UINT64 flowContext)
+{
+    PFORT_FLOW flow = (PFORT_FLOW) flowContext;
+
+    const UCHAR flow_flags = fort_flow_flags(flow);
+    const UCHAR speed_limit = (flow_flags & FORT_FLOW_SPEED_LIMIT_FLAGS);
+
+    if (speed_limit == 0)
+        return;
+
+    /* Collect flow's packets from Queues */
+    PFORT_QUEUE_PACKET pkt_chain;
+
+    if ((speed_limit & FORT_FLOW_SPEED_LIMIT_PROC) != 0) {
+        pkt_chain = fort_shaper_proc_queues_get_flow_packets(shaper, flow, speed_limit, NULL);
+    } else {
+        pkt_chain = fort_shaper_group_queues_get_flow_packets(shaper, flow, speed_limit, NULL);
+    }
+
     /* Drop the packets */
     if (pkt_chain != NULL) {
         fort_shaper_packet_foreach(shaper, pkt_chain, &fort_shaper_packet_drop);
@@ -1082,136 +1180,244 @@ FORT_API void fort_shaper_drop_flow_packets(PFORT_SHAPER shaper, UINT64 flowCont
 FORT_API void fort_shaper_drop_packets(PFORT_SHAPER shaper)
 {
     fort_shaper_flush(shaper, FORT_PACKET_FLUSH_ALL, /*drop=*/TRUE);
+    fort_shaper_flush_procs(shaper, /*drop=*/TRUE);
 }
 
-static PFORT_PENDING_PROC fort_pending_proc_find_locked(PFORT_PENDING pending, UINT32 process_id)
+#define FORT_PENDING_APP_SIZE(path_len) (offsetof(FORT_PENDING_APP, path) + (path_len))
+
+inline static tommy_key_t fort_pending_app_hash(PCFORT_APP_PATH path)
 {
-    PFORT_PENDING_PROC proc = pending->procs_head;
+    return (tommy_key_t) tommy_hash_u64(0, path->buffer, path->len);
+}
+
+inline static tommy_list *fort_pending_expire_slot(PFORT_PENDING pending, UINT32 expire_tick)
+{
+    return &pending->expire_wheel[expire_tick % FORT_PENDING_WHEEL_SIZE];
+}
+
+static PFORT_PENDING_APP fort_pending_app_find_locked(
+        PFORT_PENDING pending, PCFORT_APP_PATH path, tommy_key_t app_hash)
+{
+    tommy_hashdyn_node *node = tommy_hashdyn_bucket(&pending->apps_map, app_hash);
+
+    while (node != NULL) {
+        PFORT_PENDING_APP app = node->data;
+
+        if (node->index == app_hash && app->path_len == path->len
+                && fort_mem_eql(app->path, path->buffer, path->len))
+            return app;
 
-    for (; proc != NULL; proc = proc->next) {
-        if (proc->process_id == process_id)
-            return proc;
+        node = node->next;
     }
 
     return NULL;
 }
 
-static BOOL fort_pending_proc_check_limits(PFORT_PENDING pending, UINT32 process_id)
+static BOOL fort_pending_app_check_limits(
+        PFORT_PENDING pending, PCFORT_APP_PATH path, tommy_key_t app_hash)
 {
-    UINT16 proc_count = 0;
-    UINT16 packet_count = 0;
+    BOOL res;
 
     KLOCK_QUEUE_HANDLE lock_queue;
     KeAcquireInStackQueuedSpinLock(&pending->lock, &lock_queue);
+    {
+        PFORT_PENDING_APP app = fort_pending_app_find_locked(pending, path, app_hash);
 
-    proc_count = pending->proc_count;
-
-    PFORT_PENDING_PROC proc = fort_pending_proc_find_locked(pending, process_id);
-    if (proc != NULL) {
-        packet_count = proc->packet_count;
+        res = (app != NULL) ? (app->packet_count < pending->app_packets_max)
+                            : (pending->app_count < pending->apps_max);
     }
-
     KeReleaseInStackQueuedSpinLock(&lock_queue);
 
-    return proc_count < FORT_PENDING_PROC_COUNT_MAX
-            && packet_count < FORT_PENDING_PROC_PACKET_COUNT_MAX;
+    return res;
 }
 
-static PFORT_PENDING_PROC fort_pending_proc_get_locked(PFORT_PENDING pending, UINT32 process_id)
+static PFORT_PENDING_APP fort_pending_app_new_locked(
+        PFORT_PENDING pending, PCFORT_APP_PATH path, tommy_key_t app_hash)
 {
-    PFORT_PENDING_PROC proc;
+    if (pending->app_count >= pending->apps_max)
+        return NULL;
 
-    if (pending->proc_free != NULL) {
-        proc = pending->proc_free;
-        pending->proc_free = proc->next;
-    } else {
-        const tommy_size_t size = tommy_arrayof_size(&pending->procs);
+    PFORT_PENDING_APP app = fort_mem_alloc(FORT_PENDING_APP_SIZE(path->len), FORT_PACKET_POOL_TAG);
+    if (app == NULL)
+        return NULL;
 
-        /* TODO: tommy_arrayof_grow(): check calloc()'s result for NULL */
-        if (tommy_arrayof_grow(&pending->procs, size + 1), 0)
-            return NULL;
+    app->packets_head = NULL;
+    app->packet_count = 0;
+    app->path_len = path->len;
+    app->verdict = FORT_PENDING_VERDICT_NONE;
+    app->expire_tick = pending->tick + pending->expire_ticks;
 
-        proc = tommy_arrayof_ref(&pending->procs, size);
-    }
+    RtlCopyMemory(app->path, path->buffer, path->len);
+
+    tommy_hashdyn_insert(&pending->apps_map, &app->app_node, app, app_hash);
+
+    tommy_list_insert_tail(
+            fort_pending_expire_slot(pending, app->expire_tick), &app->expire_node, app);
 
-    proc->packets_head = NULL;
-    proc->packet_count = 0;
-    proc->process_id = process_id;
+    ++pending->app_count;
 
-    proc->next = pending->procs_head;
-    pending->procs_head = proc;
+    return app;
+}
+
+static void fort_pending_app_reschedule_locked(PFORT_PENDING pending, PFORT_PENDING_APP app)
+{
+    tommy_list_remove_existing(
+            fort_pending_expire_slot(pending, app->expire_tick), &app->expire_node);
 
-    pending->proc_count++;
+    app->expire_tick = pending->tick + pending->expire_ticks;
 
-    return proc;
+    tommy_list_insert_tail(
+            fort_pending_expire_slot(pending, app->expire_tick), &app->expire_node, app);
 }
 
-static PFORT_PENDING_PROC fort_pending_proc_get_check(PFORT_PENDING pending, UINT32 process_id)
+static PFORT_PENDING_APP fort_pending_app_get_locked(
+        PFORT_PENDING pending, PCFORT_APP_PATH path, tommy_key_t app_hash)
 {
-    PFORT_PENDING_PROC proc = fort_pending_proc_find_locked(pending, process_id);
+    PFORT_PENDING_APP app = fort_pending_app_find_locked(pending, path, app_hash);
 
-    if (proc == NULL) {
-        return fort_pending_proc_get_locked(pending, process_id);
+    if (app == NULL) {
+        return fort_pending_app_new_locked(pending, path, app_hash);
     }
 
-    if (proc->packet_count >= FORT_PENDING_PROC_PACKET_COUNT_MAX)
+    /* The decided or expired app is asked again */
+    if (app->verdict != FORT_PENDING_VERDICT_NONE) {
+        app->verdict = FORT_PENDING_VERDICT_NONE;
+
+        fort_pending_app_reschedule_locked(pending, app);
+    }
+
+    if (app->packet_count >= pending->app_packets_max)
         return NULL;
 
-    return proc;
+    return app;
+}
+
+static void fort_pending_app_take_packets_locked(
+        PFORT_PENDING pending, PFORT_PENDING_APP app, PFORT_PENDING_PACKET *pkt_chain)
+{
+    /* Move the app's packets to the chain */
+    PFORT_PENDING_PACKET pkt = app->packets_head;
+
+    while (pkt != NULL) {
+        PFORT_PENDING_PACKET pkt_next = pkt->next;
+
+        pkt->next = *pkt_chain;
+        *pkt_chain = pkt;
+
+        pkt = pkt_next;
+    }
+
+    app->packets_head = NULL;
+
+    pending->packet_count -= app->packet_count;
+
+    app->packet_count = 0;
+}
+
+static void fort_pending_app_del_locked(
+        PFORT_PENDING pending, PFORT_PENDING_APP app, PFORT_PENDING_PACKET *pkt_chain)
+{
+    fort_pending_app_take_packets_locked(pending, app, pkt_chain);
+
+    tommy_hashdyn_remove_existing(&pending->apps_map, &app->app_node);
+
+    tommy_list_remove_existing(
+            fort_pending_expire_slot(pending, app->expire_tick), &app->expire_node);
+
+    --pending->app_count;
+
+    fort_mem_free(app, FORT_PACKET_POOL_TAG);
 }
 
-static void fort_pending_proc_put_locked(PFORT_PENDING pending, PFORT_PENDING_PROC proc)
+static void fort_pending_app_set_verdict_locked(PFORT_PENDING pending, PFORT_PENDING_APP app,
+        UCHAR verdict, PFORT_PENDING_PACKET *pkt_chain)
 {
-    pending->proc_count--;
+    fort_pending_app_take_packets_locked(pending, app, pkt_chain);
+
+    app->verdict = verdict;
 
-    proc->next = pending->proc_free;
-    pending->proc_free = proc;
+    /* Keep the verdict till the pended operations are re-authorized */
+    fort_pending_app_reschedule_locked(pending, app);
 }
 
-static NTSTATUS fort_pending_proc_add_packet_locked(PFORT_PENDING pending, PCFORT_CALLOUT_ARG ca,
-        PFORT_CALLOUT_ALE_EXTRA cx, PFORT_PENDING_PACKET pkt)
+static NTSTATUS fort_pending_app_add_packet_locked(PFORT_PENDING pending, PCFORT_CALLOUT_ARG ca,
+        PCFORT_CONF_META_CONN conn, tommy_key_t app_hash, PFORT_PENDING_PACKET pkt)
 {
-    /* Create the Pending Process */
-    PFORT_PENDING_PROC proc = fort_pending_proc_get_check(pending, cx->conn.process_id);
-    if (proc == NULL)
+    /* Get the Pending App */
+    PFORT_PENDING_APP app = fort_pending_app_get_locked(pending, &conn->real_path, app_hash);
+    if (app == NULL)
         return STATUS_INSUFFICIENT_RESOURCES;
 
     const NTSTATUS status =
             FwpsPendOperation0(ca->inMetaValues->completionHandle, &pkt->completion_context);
 
     if (!NT_SUCCESS(status)) {
-        if (proc->packet_count == 0) {
-            fort_pending_proc_put_locked(pending, proc);
+        if (app->packet_count == 0) {
+            PFORT_PENDING_PACKET pkt_chain = NULL;
+            fort_pending_app_del_locked(pending, app, &pkt_chain);
         }
         return status;
     }
 
-    proc->packet_count++;
+    app->process_id = conn->process_id;
+    app->packet_count++;
 
-    pkt->next = proc->packets_head;
-    proc->packets_head = pkt;
+    pkt->next = app->packets_head;
+    app->packets_head = pkt;
+
+    pending->packet_count++;
 
     return STATUS_SUCCESS;
 }
 
-static NTSTATUS fort_pending_proc_add_packet(PFORT_PENDING pending, PCFORT_CALLOUT_ARG ca,
-        PFORT_CALLOUT_ALE_EXTRA cx, PFORT_PENDING_PACKET pkt)
+static NTSTATUS fort_pending_app_add_packet(PFORT_PENDING pending, PCFORT_CALLOUT_ARG ca,
+        PCFORT_CONF_META_CONN conn, tommy_key_t app_hash, PFORT_PENDING_PACKET pkt)
 {
     NTSTATUS status;
 
     KLOCK_QUEUE_HANDLE lock_queue;
     KeAcquireInStackQueuedSpinLock(&pending->lock, &lock_queue);
 
-    status = fort_pending_proc_add_packet_locked(pending, ca, cx, pkt);
+    status = fort_pending_app_add_packet_locked(pending, ca, conn, app_hash, pkt);
 
     KeReleaseInStackQueuedSpinLock(&lock_queue);
 
     return status;
 }
 
+static void fort_pending_packets_complete(PFORT_PENDING_PACKET pkt_chain, BOOL allow)
+{
+    while (pkt_chain != NULL) {
+        PFORT_PENDING_PACKET pkt = pkt_chain;
+        pkt_chain = pkt->next;
+
+        /* Re-authorize the pended operation */
+        FwpsCompleteOperation0(pkt->completion_context, NULL);
+
+        /* The injected packet is freed on injection completion */
+        if (allow && pkt->io.netBufList != NULL && NT_SUCCESS(fort_packet_inject(&pkt->io)))
+            continue;
+
+        fort_pending_packet_free(pkt);
+    }
+}
+
+static UINT16 fort_pending_expire_ticks(UINT16 expire_secs)
+{
+    if (expire_secs > FORT_PENDING_EXPIRE_SECS_MAX) {
+        expire_secs = FORT_PENDING_EXPIRE_SECS_MAX;
+    }
+
+    return (UINT16) ((expire_secs * 1000 + FORT_PENDING_TICK_MS - 1) / FORT_PENDING_TICK_MS);
+}
+
 static void fort_pending_init(PFORT_PENDING pending)
 {
-    tommy_arrayof_init(&pending->procs, sizeof(FORT_PENDING_PROC));
+    tommy_hashdyn_init(&pending->apps_map);
+
+    for (int i = 0; i < FORT_PENDING_WHEEL_SIZE; ++i) {
+        tommy_list_init(&pending->expire_wheel[i]);
+    }
 }
 
 FORT_API void fort_pending_open(PFORT_PENDING pending)
@@ -1225,47 +1431,53 @@ FORT_API void fort_pending_open(PFORT_PENDING pending)
     FwpsInjectionHandleCreate0(
             AF_INET6, FWPS_INJECTION_TYPE_TRANSPORT, &pending->injection_transport6_out_id);
 
+    pending->apps_max = FORT_PENDING_APP_COUNT_MAX;
+    pending->app_packets_max = FORT_PENDING_APP_PACKET_COUNT_MAX;
+    pending->expire_ticks = fort_pending_expire_ticks(FORT_PENDING_EXPIRE_SECS);
+
     fort_pending_init(pending);
 
     KeInitializeSpinLock(&pending->lock);
 }
 
-static void fort_pending_done(PFORT_PENDING pending)
+static void fort_pending_clear_locked(PFORT_PENDING pending, PFORT_PENDING_PACKET *pkt_chain)
 {
-    tommy_arrayof_done(&pending->procs);
-}
+    for (int i = 0; i < FORT_PENDING_WHEEL_SIZE && pending->app_count != 0; ++i) {
+        tommy_list *slot = &pending->expire_wheel[i];
 
-FORT_API void fort_pending_close(PFORT_PENDING pending)
-{
-    fort_pending_done(pending);
+        while (!tommy_list_empty(slot)) {
+            PFORT_PENDING_APP app = tommy_list_head(slot)->data;
 
-    FwpsInjectionHandleDestroy0(pending->injection_transport4_in_id);
-    FwpsInjectionHandleDestroy0(pending->injection_transport4_out_id);
-    FwpsInjectionHandleDestroy0(pending->injection_transport6_in_id);
-    FwpsInjectionHandleDestroy0(pending->injection_transport6_out_id);
+            fort_pending_app_del_locked(pending, app, pkt_chain);
+        }
+    }
 }
 
-static void fort_pending_clear_locked(PFORT_PENDING pending)
+FORT_API void fort_pending_clear(PFORT_PENDING pending)
 {
-    if (pending->proc_count == 0)
-        return;
+    PFORT_PENDING_PACKET pkt_chain = NULL;
 
-    pending->proc_count = 0;
-    pending->proc_free = NULL;
-    pending->procs_head = NULL;
+    KLOCK_QUEUE_HANDLE lock_queue;
+    KeAcquireInStackQueuedSpinLock(&pending->lock, &lock_queue);
 
-    fort_pending_done(pending);
-    fort_pending_init(pending);
+    fort_pending_clear_locked(pending, &pkt_chain);
+
+    KeReleaseInStackQueuedSpinLock(&lock_queue);
+
+    /* Complete the operations outside of the lock: they are re-authorized synchronously */
+    fort_pending_packets_complete(pkt_chain, /*allow=*/FALSE);
 }
 
-FORT_API void fort_pending_clear(PFORT_PENDING pending)
+FORT_API void fort_pending_close(PFORT_PENDING pending)
 {
-    KLOCK_QUEUE_HANDLE lock_queue;
-    KeAcquireInStackQueuedSpinLock(&pending->lock, &lock_queue);
+    fort_pending_clear(pending);
 
-    fort_pending_clear_locked(pending);
+    tommy_hashdyn_done(&pending->apps_map);
 
-    KeReleaseInStackQueuedSpinLock(&lock_queue);
+    FwpsInjectionHandleDestroy0(pending->injection_transport4_in_id);
+    FwpsInjectionHandleDestroy0(pending->injection_transport4_out_id);
+    FwpsInjectionHandleDestroy0(pending->injection_transport6_in_id);
+    FwpsInjectionHandleDestroy0(pending->injection_transport6_out_id);
 }
 
 FORT_API BOOL fort_pending_add_packet(
@@ -1273,12 +1485,16 @@ FORT_API BOOL fort_pending_add_packet(
 {
     NTSTATUS status;
 
+    PCFORT_CONF_META_CONN conn = &cx->conn;
+
     /* Skip self injected packet */
     if (fort_packet_injected_by_self(ca))
         return FALSE;
 
-    /* Check the Process's Limits */
-    if (!fort_pending_proc_check_limits(pending, cx->conn.process_id))
+    /* Check the App's Limits */
+    const tommy_key_t app_hash = fort_pending_app_hash(&conn->real_path);
+
+    if (!fort_pending_app_check_limits(pending, &conn->real_path, app_hash))
         return FALSE;
 
     /* Create the Packet */
@@ -1292,8 +1508,8 @@ FORT_API BOOL fort_pending_add_packet(
 
     status = fort_packet_fill(ca, &pkt->io, ipsec_flag | FORT_PACKET_TYPE_PENDING);
     if (NT_SUCCESS(status)) {
-        /* Add the Packet to Pending Process */
-        status = fort_pending_proc_add_packet(pending, ca, cx, pkt);
+        /* Add the Packet to Pending App */
+        status = fort_pending_app_add_packet(pending, ca, conn, app_hash, pkt);
     }
 
     if (!NT_SUCCESS(status)) {
@@ -1303,3 +1519,139 @@ FORT_API BOOL fort_pending_add_packet(
 
     return TRUE;
 }
+
+FORT_API void fort_pending_set_limits(PFORT_PENDING pending, PCFORT_PENDING_LIMITS limits)
+{
+    KLOCK_QUEUE_HANDLE lock_queue;
+    KeAcquireInStackQueuedSpinLock(&pending->lock, &lock_queue);
+
+    if (limits->apps_max != 0) {
+        pending->apps_max = limits->apps_max;
+    }
+
+    if (limits->app_packets_max != 0) {
+        pending->app_packets_max = limits->app_packets_max;
+    }
+
+    /* The already pending apps keep their expiration ticks */
+    if (limits->expire_secs != 0) {
+        pending->expire_ticks = fort_pending_expire_ticks(limits->expire_secs);
+    }
+
+    KeReleaseInStackQueuedSpinLock(&lock_queue);
+}
+
+static void fort_pending_decide_app_locked(PFORT_PENDING pending, PCFORT_PENDING_DECISION decision,
+        PFORT_PENDING_PACKET *allow_chain, PFORT_PENDING_PACKET *deny_chain)
+{
+    const FORT_APP_PATH path = {
+        .len = decision->path_len,
+        .buffer = decision->path,
+    };
+
+    const tommy_key_t app_hash = fort_pending_app_hash(&path);
+
+    PFORT_PENDING_APP app = fort_pending_app_find_locked(pending, &path, app_hash);
+    if (app == NULL)
+        return; /* the verdict is already expired */
+
+    fort_pending_app_set_verdict_locked(pending, app,
+            decision->allow ? FORT_PENDING_VERDICT_ALLOW : FORT_PENDING_VERDICT_DENY,
+            decision->allow ? allow_chain : deny_chain);
+}
+
+FORT_API void fort_pending_decide(
+        PFORT_PENDING pending, PCFORT_PENDING_DECISION_LIST decisions, UINT32 data_len)
+{
+    PFORT_PENDING_PACKET allow_chain = NULL;
+    PFORT_PENDING_PACKET deny_chain = NULL;
+
+    const char *data = (const char *) &decisions->data;
+    UINT16 n = decisions->decisions_n;
+
+    KLOCK_QUEUE_HANDLE lock_queue;
+    KeAcquireInStackQueuedSpinLock(&pending->lock, &lock_queue);
+
+    while (n-- > 0 && data_len > FORT_PENDING_DECISION_PATH_OFF) {
+        PCFORT_PENDING_DECISION decision = (PCFORT_PENDING_DECISION) data;
+
+        const UINT32 decision_size =
+                FORT_PENDING_DECISION_PATH_OFF + FORT_CONF_STR_DATA_SIZE(decision->path_len);
+
+        if (decision_size > data_len)
+            break;
+
+        fort_pending_decide_app_locked(pending, decision, &allow_chain, &deny_chain);
+
+        data += decision_size;
+        data_len -= decision_size;
+    }
+
+    KeReleaseInStackQueuedSpinLock(&lock_queue);
+
+    fort_pending_packets_complete(allow_chain, /*allow=*/TRUE);
+    fort_pending_packets_complete(deny_chain, /*allow=*/FALSE);
+}
+
+static void fort_pending_expire_slot_locked(
+        PFORT_PENDING pending, tommy_list *slot, PFORT_PENDING_PACKET *pkt_chain)
+{
+    tommy_node *node = tommy_list_head(slot);
+
+    while (node != NULL) {
+        PFORT_PENDING_APP app = node->data;
+
+        node = node->next;
+
+        /* The app is expiring on the next wheel's turn */
+        if ((LONG) (app->expire_tick - pending->tick) > 0)
+            continue;
+
+        if (app->verdict == FORT_PENDING_VERDICT_NONE) {
+            /* The unanswered app is denied */
+            fort_pending_app_set_verdict_locked(
+                    pending, app, FORT_PENDING_VERDICT_EXPIRED, pkt_chain);
+        } else {
+            fort_pending_app_del_locked(pending, app, pkt_chain);
+        }
+    }
+}
+
+FORT_API void fort_pending_expire(PFORT_PENDING pending)
+{
+    PFORT_PENDING_PACKET pkt_chain = NULL;
+
+    KLOCK_QUEUE_HANDLE lock_queue;
+    KeAcquireInStackQueuedSpinLock(&pending->lock, &lock_queue);
+
+    const UINT32 tick = ++pending->tick;
+
+    if (pending->app_count != 0) {
+        fort_pending_expire_slot_locked(
+                pending, fort_pending_expire_slot(pending, tick), &pkt_chain);
+    }
+
+    KeReleaseInStackQueuedSpinLock(&lock_queue);
+
+    fort_pending_packets_complete(pkt_chain, /*allow=*/FALSE);
+}
+
+FORT_API UCHAR fort_pending_app_verdict(PFORT_PENDING pending, PCFORT_APP_PATH path)
+{
+    UCHAR verdict = FORT_PENDING_VERDICT_UNKNOWN;
+
+    const tommy_key_t app_hash = fort_pending_app_hash(path);
+
+    KLOCK_QUEUE_HANDLE lock_queue;
+    KeAcquireInStackQueuedSpinLock(&pending->lock, &lock_queue);
+    {
+        PFORT_PENDING_APP app = fort_pending_app_find_locked(pending, path, app_hash);
+
+        if (app != NULL) {
+            verdict = app->verdict;
+        }
+    }
+    KeReleaseInStackQueuedSpinLock(&lock_queue);
+
+    return verdict;
+}
@@ -5,6 +5,7 @@
 
 #include "common/fortconf.h"
 #include "fortcoutarg.h"
+#include "fortpktq.h"
 #include "forttds.h"
 #include "fortthr.h"
 
@@ -57,41 +58,9 @@ typedef struct fort_flow_packet
 {
     FORT_PACKET_IO io; /* must be first! */
 
-    struct fort_flow_packet *next;
-
-    PVOID flow; /* to drop on flow deletion */
-
-    LARGE_INTEGER latency_start; /* Time it was placed in the latency queue */
-    UINT32 data_length; /* Size of the packet (in bytes) */
+    FORT_QUEUE_PACKET qpkt;
 } FORT_FLOW_PACKET, *PFORT_FLOW_PACKET;
 
-typedef struct fort_packet_list
-{
-    PFORT_FLOW_PACKET packet_head;
-    PFORT_FLOW_PACKET packet_tail;
-} FORT_PACKET_LIST, *PFORT_PACKET_LIST;
-
-typedef struct fort_packet_queue
-{
-    /* All packets are first buffered into the bandwidth queue and released
-     * at the appropriate rate for the configured bandwidth into the latency queue.
-     * When they are added to the latency queue they are timestamped when they
-     * entered and they are released when the appropriate latency has expired.
-     * Only the bandwidth queue is affected by the queue buffer size.
-     * The latency queue has no limit.
-     */
-    FORT_PACKET_LIST bandwidth_list;
-    FORT_PACKET_LIST latency_list;
-
-    FORT_SPEED_LIMIT limit;
-
-    UINT64 queued_bytes; /* accumulated size of queued packets */
-    UINT64 available_bytes; /* accumulated bytes available for sending */
-    LARGE_INTEGER last_tick; /* last time the queue was checked */
-
-    KSPIN_LOCK lock;
-} FORT_PACKET_QUEUE, *PFORT_PACKET_QUEUE;
-
 typedef struct fort_pending_packet
 {
     FORT_PACKET_IO io; /* must be first! */
@@ -101,19 +70,33 @@ typedef struct fort_pending_packet
     HANDLE completion_context;
 } FORT_PENDING_PACKET, *PFORT_PENDING_PACKET;
 
-#define FORT_PENDING_PROC_COUNT_MAX        1024
-#define FORT_PENDING_PROC_PACKET_COUNT_MAX 3
+#define FORT_PENDING_TICK_MS    500 /* period of the pending timer, which expires the apps */
+#define FORT_PENDING_WHEEL_SIZE 64
+
+/* The verdict is kept till the app's expiration to check its re-authorized connections */
+#define FORT_PENDING_VERDICT_NONE    0 /* the app is pending */
+#define FORT_PENDING_VERDICT_ALLOW   1
+#define FORT_PENDING_VERDICT_DENY    2
+#define FORT_PENDING_VERDICT_EXPIRED 3
+#define FORT_PENDING_VERDICT_UNKNOWN 4 /* the app isn't found */
 
-typedef struct fort_pending_proc
+typedef struct fort_pending_app
 {
-    struct fort_pending_proc *next;
+    tommy_hashdyn_node app_node;
+    tommy_node expire_node;
 
     PFORT_PENDING_PACKET packets_head;
 
     UINT16 packet_count;
+    UINT16 path_len;
 
-    UINT32 process_id;
-} FORT_PENDING_PROC, *PFORT_PENDING_PROC;
+    UCHAR verdict;
+
+    UINT32 expire_tick;
+    UINT32 process_id; /* last pended process */
+
+    WCHAR path[1];
+} FORT_PENDING_APP, *PFORT_PENDING_APP;
 
 typedef struct fort_pending
 {
@@ -122,17 +105,34 @@ typedef struct fort_pending
     HANDLE injection_transport6_in_id;
     HANDLE injection_transport6_out_id;
 
-    UINT16 proc_count;
+    UINT16 apps_max;
+    UINT16 app_packets_max;
+    UINT16 expire_ticks;
+
+    UINT32 app_count;
+    UINT32 packet_count;
 
-    PFORT_PENDING_PROC proc_free;
-    tommy_arrayof procs;
+    UINT32 tick;
 
-    PFORT_PENDING_PROC procs_head;
+    tommy_hashdyn apps_map; /* by app path */
+    tommy_list expire_wheel[FORT_PENDING_WHEEL_SIZE]; /* by expire tick */
 
     KSPIN_LOCK lock;
 } FORT_PENDING, *PFORT_PENDING;
 
-#define FORT_SHAPER_CLOSED 0x01
+typedef struct fort_proc_queue
+{
+    FORT_PACKET_QUEUE queue;
+
+    struct fort_proc_queue *next_active;
+
+    UINT16 limit_id; /* 1-based index of the app's speed limits pair, 0 - not used */
+
+    UCHAR active : 1;
+} FORT_PROC_QUEUE, *PFORT_PROC_QUEUE;
+
+#define FORT_SHAPER_CLOSED     0x01
+#define FORT_SHAPER_APP_LIMITS 0x02
 
 typedef struct fort_shaper
 {
@@ -152,6 +152,12 @@ typedef struct fort_shaper
     KSPIN_LOCK lock;
 
     PFORT_PACKET_QUEUE queues[FORT_CONF_GROUP_MAX * 2]; /* in/out-bound pairs */
+
+    UINT16 app_limits_n;
+    PFORT_SPEED_LIMIT app_limits; /* in/out-bound pairs */
+
+    PFORT_PROC_QUEUE proc_active;
+    tommy_arrayof proc_queues; /* in/out-bound pairs by process index, created lazily */
 } FORT_SHAPER, *PFORT_SHAPER;
 
 #if defined(__cplusplus)
@@ -181,6 +187,15 @@ FORT_API void fort_pending_clear(PFORT_PENDING pending);
 FORT_API BOOL fort_pending_add_packet(
         PFORT_PENDING pending, PCFORT_CALLOUT_ARG ca, PFORT_CALLOUT_ALE_EXTRA cx);
 
+FORT_API void fort_pending_set_limits(PFORT_PENDING pending, PCFORT_PENDING_LIMITS limits);
+
+FORT_API void fort_pending_decide(
+        PFORT_PENDING pending, PCFORT_PENDING_DECISION_LIST decisions, UINT32 data_len);
+
+FORT_API void fort_pending_expire(PFORT_PENDING pending);
+
+FORT_API UCHAR fort_pending_app_verdict(PFORT_PENDING pending, PCFORT_APP_PATH path);
+
 #ifdef __cplusplus
 } // extern "C"
 #endif
@@ -0,0 +1,267 @@
+/* Fort Firewall Packets Queue */
+
+#include "fortpktq.h"
+
+FORT_API BOOL fort_packet_list_is_empty(PFORT_PACKET_LIST pkt_list)
+{
+    return (pkt_list->packet_head == NULL);
+}
+
+FORT_API void fort_packet_list_add_chain(
+        PFORT_PACKET_LIST pkt_list, PFORT_QUEUE_PACKET pkt_head, PFORT_QUEUE_PACKET pkt_tail)
+{
+    if (pkt_list->packet_tail == NULL) {
+        pkt_list->packet_head = pkt_head;
+    } else {
+        pkt_list->packet_tail->next = pkt_head;
+    }
+
+    pkt_list->packet_tail = pkt_tail;
+}
+
+FORT_API PFORT_QUEUE_PACKET fort_packet_list_get(
+        PFORT_PACKET_LIST pkt_list, PFORT_QUEUE_PACKET pkt)
+{
+    if (pkt_list->packet_head != NULL) {
+        pkt_list->packet_tail->next = pkt;
+        pkt = pkt_list->packet_head;
+
+        pkt_list->packet_head = pkt_list->packet_tail = NULL;
+    }
+
+    return pkt;
+}
+
+static void fort_packet_list_cut_chain(PFORT_PACKET_LIST pkt_list, PFORT_QUEUE_PACKET pkt)
+{
+    pkt_list->packet_head = pkt->next;
+    pkt->next = NULL;
+
+    if (pkt_list->packet_head == NULL) {
+        pkt_list->packet_tail = NULL;
+    }
+}
+
+static void fort_packet_list_cut_packet(
+        PFORT_PACKET_LIST pkt_list, PFORT_QUEUE_PACKET pkt_prev, PFORT_QUEUE_PACKET pkt_next)
+{
+    if (pkt_prev != NULL) {
+        pkt_prev->next = pkt_next;
+    } else {
+        pkt_list->packet_head = pkt_next;
+    }
+
+    if (pkt_next == NULL) {
+        pkt_list->packet_tail = pkt_prev;
+    }
+}
+
+static PFORT_QUEUE_PACKET fort_packet_list_get_flow_packets(PFORT_PACKET_LIST pkt_list,
+        PVOID flow, PFORT_QUEUE_PACKET pkt_chain, PUINT64 data_length)
+{
+    PFORT_QUEUE_PACKET pkt_prev = NULL;
+    PFORT_QUEUE_PACKET pkt = pkt_list->packet_head;
+
+    while (pkt != NULL) {
+        PFORT_QUEUE_PACKET pkt_next = pkt->next;
+
+        if (pkt->flow == flow) {
+            fort_packet_list_cut_packet(pkt_list, pkt_prev, pkt_next);
+
+            *data_length += pkt->data_length;
+
+            pkt->next = pkt_chain;
+            pkt_chain = pkt;
+        } else {
+            pkt_prev = pkt;
+        }
+
+        pkt = pkt_next;
+    }
+
+    return pkt_chain;
+}
+
+FORT_API void fort_packet_queue_init(
+        PFORT_PACKET_QUEUE queue, PCFORT_SPEED_LIMIT limit, const LARGE_INTEGER now)
+{
+    queue->limit = *limit;
+
+    queue->available_bytes = FORT_QUEUE_INITIAL_TOKEN_COUNT;
+    queue->last_tick = now;
+}
+
+FORT_API BOOL fort_packet_queue_is_empty(PFORT_PACKET_QUEUE queue)
+{
+    return fort_packet_list_is_empty(&queue->bandwidth_list)
+            && fort_packet_list_is_empty(&queue->latency_list);
+}
+
+FORT_API BOOL fort_packet_queue_check_plr(PFORT_PACKET_QUEUE queue, PULONG random_seed)
+{
+    const UINT16 plr = queue->limit.plr;
+    if (plr > 0) {
+        const ULONG random = RtlRandomEx(random_seed) % 10000; /* PLR range is 0-10000 */
+        if (random < plr)
+            return FALSE;
+    }
+    return TRUE;
+}
+
+FORT_API BOOL fort_packet_queue_check_buffer(PFORT_PACKET_QUEUE queue, ULONG data_length)
+{
+    const UINT32 buffer_bytes = queue->limit.buffer_bytes;
+
+    return buffer_bytes == 0 || (UINT64) buffer_bytes >= (queue->queued_bytes + data_length);
+}
+
+FORT_API void fort_packet_queue_add_packet(PFORT_PACKET_QUEUE queue, PFORT_QUEUE_PACKET pkt)
+{
+    queue->queued_bytes += pkt->data_length;
+
+    fort_packet_list_add_chain(&queue->bandwidth_list, pkt, pkt);
+}
+
+FORT_API void fort_packet_queue_advance_available(
+        PFORT_PACKET_QUEUE queue, const LARGE_INTEGER now, const LARGE_INTEGER qpcFrequency)
+{
+    const LARGE_INTEGER last_tick = queue->last_tick;
+    queue->last_tick = now;
+
+    const UINT64 bps = queue->limit.bps;
+
+    /* Advance the available bytes */
+    const UINT64 accumulated =
+            (bps * (now.QuadPart - last_tick.QuadPart)) / qpcFrequency.QuadPart;
+
+    queue->available_bytes += accumulated;
+
+    const UINT64 max_available = bps;
+    if (queue->available_bytes > max_available) {
+        queue->available_bytes = max_available;
+    }
+
+    if (fort_packet_list_is_empty(&queue->bandwidth_list)
+            && queue->available_bytes > FORT_QUEUE_INITIAL_TOKEN_COUNT) {
+        queue->available_bytes = FORT_QUEUE_INITIAL_TOKEN_COUNT;
+    }
+
+    /*
+    LOG("Shaper: BAND: queued=%d avail=%d ms=%d\n", (UINT32) queue->queued_bytes,
+            (UINT32) queue->available_bytes,
+            (UINT32) (((now.QuadPart - last_tick.QuadPart) * 1000)
+                    / qpcFrequency.QuadPart));
+    */
+}
+
+FORT_API void fort_packet_queue_process_bandwidth(
+        PFORT_PACKET_QUEUE queue, const LARGE_INTEGER now)
+{
+    /* Move packets to the latency queue as the accumulated available bytes will allow */
+    PFORT_QUEUE_PACKET pkt_chain = queue->bandwidth_list.packet_head;
+    if (pkt_chain == NULL)
+        return;
+
+    PFORT_QUEUE_PACKET pkt_tail = NULL;
+    PFORT_QUEUE_PACKET pkt = pkt_chain;
+    do {
+        const UINT64 pkt_length = pkt->data_length;
+
+        if (queue->available_bytes < pkt_length)
+            break;
+
+        queue->available_bytes -= pkt_length;
+        queue->queued_bytes -= pkt_length;
+
+        pkt->latency_start = now;
+
+        pkt_tail = pkt;
+        pkt = pkt->next;
+    } while (pkt != NULL);
+
+    if (pkt_tail != NULL) {
+        fort_packet_list_cut_chain(&queue->bandwidth_list, pkt_tail);
+
+        fort_packet_list_add_chain(&queue->latency_list, pkt_chain, pkt_tail);
+    }
+}
+
+FORT_API PFORT_QUEUE_PACKET fort_packet_queue_process_latency(
+        PFORT_PACKET_QUEUE queue, const LARGE_INTEGER now, const LARGE_INTEGER qpcFrequency)
+{
+    PFORT_QUEUE_PACKET pkt_chain = queue->latency_list.packet_head;
+    if (pkt_chain == NULL)
+        return NULL;
+
+    const UINT32 latency_ms = queue->limit.latency_ms;
+
+    if (latency_ms == 0) {
+        fort_packet_list_cut_chain(&queue->latency_list, queue->latency_list.packet_tail);
+
+        return pkt_chain;
+    }
+
+    const UINT64 qpcFrequencyHalfMs = qpcFrequency.QuadPart / 2000LL;
+
+    PFORT_QUEUE_PACKET pkt_tail = NULL;
+    PFORT_QUEUE_PACKET pkt = pkt_chain;
+    do {
+        /* Round to the closest ms instead of truncating
+         * by adding 1/2 of a ms to the elapsed ticks */
+        const ULONG elapsed_ms = (ULONG) (((now.QuadPart - pkt->latency_start.QuadPart) * 1000LL
+                                                  + qpcFrequencyHalfMs)
+                / qpcFrequency.QuadPart);
+
+        if (elapsed_ms < latency_ms)
+            break;
+
+        pkt_tail = pkt;
+        pkt = pkt->next;
+    } while (pkt != NULL);
+
+    if (pkt_tail != NULL) {
+        fort_packet_list_cut_chain(&queue->latency_list, pkt_tail);
+
+        return pkt_chain;
+    }
+
+    return NULL;
+}
+
+FORT_API PFORT_QUEUE_PACKET fort_packet_queue_process(
+        PFORT_PACKET_QUEUE queue, const LARGE_INTEGER now, const LARGE_INTEGER qpcFrequency)
+{
+    if (fort_packet_queue_is_empty(queue))
+        return NULL;
+
+    fort_packet_queue_advance_available(queue, now, qpcFrequency);
+    fort_packet_queue_process_bandwidth(queue, now);
+
+    return fort_packet_queue_process_latency(queue, now, qpcFrequency);
+}
+
+FORT_API PFORT_QUEUE_PACKET fort_packet_queue_get_packets(
+        PFORT_PACKET_QUEUE queue, PFORT_QUEUE_PACKET pkt)
+{
+    queue->queued_bytes = 0;
+
+    pkt = fort_packet_list_get(&queue->latency_list, pkt);
+    pkt = fort_packet_list_get(&queue->bandwidth_list, pkt);
+
+    return pkt;
+}
+
+FORT_API PFORT_QUEUE_PACKET fort_packet_queue_get_flow_packets(
+        PFORT_PACKET_QUEUE queue, PVOID flow, PFORT_QUEUE_PACKET pkt)
+{
+    /* Only the bandwidth list's packets are counted in the queued bytes */
+    UINT64 queued_bytes = 0;
+    UINT64 latency_bytes = 0;
+
+    pkt = fort_packet_list_get_flow_packets(&queue->bandwidth_list, flow, pkt, &queued_bytes);
+    pkt = fort_packet_list_get_flow_packets(&queue->latency_list, flow, pkt, &latency_bytes);
+
+    queue->queued_bytes -= queued_bytes;
+
+    return pkt;
+}
@@ -0,0 +1,95 @@
+#ifndef FORTPKTQ_H
+#define FORTPKTQ_H
+
+#include "fortdrv.h"
+
+#include "common/fortconf.h"
+
+#define FORT_QUEUE_INITIAL_TOKEN_COUNT 1500
+
+typedef struct fort_queue_packet
+{
+    struct fort_queue_packet *next;
+
+    PVOID flow; /* to drop on flow deletion */
+
+    LARGE_INTEGER latency_start; /* Time it was placed in the latency queue */
+    UINT32 data_length; /* Size of the packet (in bytes) */
+} FORT_QUEUE_PACKET, *PFORT_QUEUE_PACKET;
+
+typedef struct fort_packet_list
+{
+    PFORT_QUEUE_PACKET packet_head;
+    PFORT_QUEUE_PACKET packet_tail;
+} FORT_PACKET_LIST, *PFORT_PACKET_LIST;
+
+typedef struct fort_packet_queue
+{
+    /* All packets are first buffered into the bandwidth queue and released
+     * at the appropriate rate for the configured bandwidth into the latency queue.
+     * When they are added to the latency queue they are timestamped when they
+     * entered and they are released when the appropriate latency has expired.
+     * Only the bandwidth queue is affected by the queue buffer size.
+     * The latency queue has no limit.
+     */
+    FORT_PACKET_LIST bandwidth_list;
+    FORT_PACKET_LIST latency_list;
+
+    FORT_SPEED_LIMIT limit;
+
+    UINT64 queued_bytes; /* accumulated size of queued packets */
+    UINT64 available_bytes; /* accumulated bytes available for sending */
+    LARGE_INTEGER last_tick; /* last time the queue was checked */
+
+    KSPIN_LOCK lock;
+} FORT_PACKET_QUEUE, *PFORT_PACKET_QUEUE;
+
+/* The queue core has no locking and no knowledge of WFP:
+ * the caller provides the time (in performance counter ticks) and locks the queue. */
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+FORT_API BOOL fort_packet_list_is_empty(PFORT_PACKET_LIST pkt_list);
+
+FORT_API void fort_packet_list_add_chain(
+        PFORT_PACKET_LIST pkt_list, PFORT_QUEUE_PACKET pkt_head, PFORT_QUEUE_PACKET pkt_tail);
+
+FORT_API PFORT_QUEUE_PACKET fort_packet_list_get(
+        PFORT_PACKET_LIST pkt_list, PFORT_QUEUE_PACKET pkt);
+
+FORT_API void fort_packet_queue_init(
+        PFORT_PACKET_QUEUE queue, PCFORT_SPEED_LIMIT limit, const LARGE_INTEGER now);
+
+FORT_API BOOL fort_packet_queue_is_empty(PFORT_PACKET_QUEUE queue);
+
+FORT_API BOOL fort_packet_queue_check_plr(PFORT_PACKET_QUEUE queue, PULONG random_seed);
+
+FORT_API BOOL fort_packet_queue_check_buffer(PFORT_PACKET_QUEUE queue, ULONG data_length);
+
+FORT_API void fort_packet_queue_add_packet(PFORT_PACKET_QUEUE queue, PFORT_QUEUE_PACKET pkt);
+
+FORT_API void fort_packet_queue_advance_available(
+        PFORT_PACKET_QUEUE queue, const LARGE_INTEGER now, const LARGE_INTEGER qpcFrequency);
+
+FORT_API void fort_packet_queue_process_bandwidth(
+        PFORT_PACKET_QUEUE queue, const LARGE_INTEGER now);
+
+FORT_API PFORT_QUEUE_PACKET fort_packet_queue_process_latency(
+        PFORT_PACKET_QUEUE queue, const LARGE_INTEGER now, const LARGE_INTEGER qpcFrequency);
+
+FORT_API PFORT_QUEUE_PACKET fort_packet_queue_process(
+        PFORT_PACKET_QUEUE queue, const LARGE_INTEGER now, const LARGE_INTEGER qpcFrequency);
+
+FORT_API PFORT_QUEUE_PACKET fort_packet_queue_get_packets(
+        PFORT_PACKET_QUEUE queue, PFORT_QUEUE_PACKET pkt);
+
+FORT_API PFORT_QUEUE_PACKET fort_packet_queue_get_flow_packets(
+        PFORT_PACKET_QUEUE queue, PVOID flow, PFORT_QUEUE_PACKET pkt);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // FORTPKTQ_H
@@ -11,36 +11,163 @@
     ((size) < FORT_POOL_SIZE_MIN ? FORT_POOL_SIZE                                                  \
                                  : ((size) < (FORT_POOL_SIZE_MAX / 2) ? 2 * (size) : (size)))
 
-static tommy_node *fort_pool_new(UINT32 pool_size)
+#define FORT_POOL_CHUNK_SHIFT 16 /* pools' data is mapped by 64 KB address chunks */
+
+#define fort_pool_chunk_index(p)    ((UINT_PTR) (p) >> FORT_POOL_CHUNK_SHIFT)
+#define fort_pool_chunk_hash(index) tommy_inthash_u32((UINT32) (index))
+
+static BOOL fort_pool_chunks_new(PFORT_POOL_LIST pool_list, PFORT_POOL pool)
+{
+    const UINT_PTR first_index = fort_pool_chunk_index(pool->data);
+    const UINT_PTR last_index = fort_pool_chunk_index(pool->data + pool->size - 1);
+
+    const UINT32 chunks_n = (UINT32) (last_index - first_index + 1);
+
+    tommy_hashdyn_node *chunks = tommy_malloc(chunks_n * sizeof(tommy_hashdyn_node));
+    if (chunks == NULL)
+        return FALSE;
+
+    for (UINT32 i = 0; i < chunks_n; ++i) {
+        tommy_hashdyn_insert(
+                &pool_list->chunks_map, &chunks[i], pool, fort_pool_chunk_hash(first_index + i));
+    }
+
+    pool->chunks_n = chunks_n;
+    pool->chunks = chunks;
+
+    return TRUE;
+}
+
+static void fort_pool_chunks_del(PFORT_POOL_LIST pool_list, PFORT_POOL pool)
+{
+    for (UINT32 i = 0; i < pool->chunks_n; ++i) {
+        tommy_hashdyn_remove_existing(&pool_list->chunks_map, &pool->chunks[i]);
+    }
+}
+
+static PFORT_POOL fort_pool_new(PFORT_POOL_LIST pool_list, UINT32 pool_size)
 {
     if (pool_size > FORT_POOL_SIZE_MAX)
         return NULL;
 
-    return tommy_malloc(pool_size);
+    PFORT_POOL pool = tommy_malloc(pool_size);
+    if (pool == NULL)
+        return NULL;
+
+    pool->size = pool_size - FORT_POOL_DATA_OFF;
+    pool->used_size = 0;
+
+    if (!fort_pool_chunks_new(pool_list, pool)) {
+        tommy_free(pool);
+        return NULL;
+    }
+
+    ++pool_list->pools_n;
+    pool_list->pools_size += pool->size;
+
+    return pool;
 }
 
-static void fort_pool_del(tommy_node *pool)
+static void fort_pool_del(PFORT_POOL pool)
 {
+    tommy_free(pool->chunks);
     tommy_free(pool);
 }
 
-FORT_API void fort_pool_list_init(PFORT_POOL_LIST pool_list)
+static PFORT_POOL fort_pool_find(PFORT_POOL_LIST pool_list, void *p)
+{
+    const tommy_hash_t chunk_hash = fort_pool_chunk_hash(fort_pool_chunk_index(p));
+
+    tommy_hashdyn_node *node = tommy_hashdyn_bucket(&pool_list->chunks_map, chunk_hash);
+
+    /* The chunk may be shared by adjacent pools */
+    while (node != NULL) {
+        PFORT_POOL pool = node->data;
+
+        if (node->index == chunk_hash && (char *) p >= pool->data
+                && (char *) p < pool->data + pool->size)
+            return pool;
+
+        node = node->next;
+    }
+
+    return NULL;
+}
+
+inline static BOOL fort_pool_is_first(PFORT_POOL_LIST pool_list, PFORT_POOL pool)
+{
+    /* The first pool contains the TLSF control structure */
+    return pool == (PFORT_POOL) tommy_list_tail(&pool_list->pools);
+}
+
+inline static BOOL fort_pool_is_reclaimable(PFORT_POOL_LIST pool_list, UINT32 pool_size)
+{
+    /* Keep the half of the rest pools free to not thrash on bursts */
+    return pool_list->used_size <= (pool_list->pools_size - pool_size) / 2;
+}
+
+static void fort_pool_reclaim(PFORT_POOL_LIST pool_list, PFORT_POOL pool)
+{
+    tlsf_remove_pool(pool_list->tlsf, pool->data);
+
+    tommy_list_remove_existing(&pool_list->pools, (tommy_node *) pool);
+
+    fort_pool_chunks_del(pool_list, pool);
+
+    --pool_list->pools_n;
+    --pool_list->empty_pools_n;
+    pool_list->pools_size -= pool->size;
+
+    fort_pool_del(pool);
+}
+
+static void fort_pool_reclaim_empty(PFORT_POOL_LIST pool_list)
+{
+    if (!fort_pool_is_reclaimable(pool_list, FORT_POOL_SIZE - FORT_POOL_DATA_OFF))
+        return;
+
+    PFORT_POOL pool = (PFORT_POOL) tommy_list_head(&pool_list->pools);
+
+    while (pool != NULL && pool_list->empty_pools_n != 0) {
+        PFORT_POOL next = pool->next;
+
+        if (pool->used_size == 0 && !fort_pool_is_first(pool_list, pool)
+                && fort_pool_is_reclaimable(pool_list, pool->size)) {
+            fort_pool_reclaim(pool_list, pool);
+        }
+
+        pool = next;
+    }
+}
+
+static void fort_pool_list_reset(PFORT_POOL_LIST pool_list)
 {
     tommy_list_init(&pool_list->pools);
+
+    pool_list->pools_n = 0;
+    pool_list->pools_size = 0;
+    pool_list->used_size = 0;
+    pool_list->empty_pools_n = 0;
+}
+
+FORT_API void fort_pool_list_init(PFORT_POOL_LIST pool_list)
+{
+    fort_pool_list_reset(pool_list);
+
+    tommy_hashdyn_init(&pool_list->chunks_map);
 }
 
 FORT_API void fort_pool_init(PFORT_POOL_LIST pool_list, UINT32 size)
 {
     const UINT32 pool_size = fort_pool_size(size);
 
-    tommy_node *pool = fort_pool_new(pool_size);
+    PFORT_POOL pool = fort_pool_new(pool_list, pool_size);
     if (pool == NULL)
         return;
 
-    tommy_list_insert_first(&pool_list->pools, pool);
+    tommy_list_insert_first(&pool_list->pools, (tommy_node *) pool);
 
-    pool_list->tlsf = tlsf_create_with_pool(
-            (char *) pool + FORT_POOL_DATA_OFF, pool_size - FORT_POOL_DATA_OFF);
+    pool_list->tlsf = tlsf_create_with_pool(pool->data, pool->size);
 }
 
 FORT_API void fort_pool_done(PFORT_POOL_LIST pool_list)
@@ -48,38 +175,114 @@ FORT_API void fort_pool_done(PFORT_POOL_LIST pool_list)
     tommy_node *pool = tommy_list_head(&pool_list->pools);
     while (pool != NULL) {
         tommy_node *next = pool->next;
-        fort_pool_del(pool);
+        fort_pool_del((PFORT_POOL) pool);
         pool = next;
     }
+
+    tommy_hashdyn_done(&pool_list->chunks_map);
+
+    fort_pool_list_reset(pool_list);
 }
 
-FORT_API void *fort_pool_malloc(PFORT_POOL_LIST pool_list, UINT32 size)
+static void *fort_pool_malloc_new(PFORT_POOL_LIST pool_list, UINT32 size)
 {
-    tommy_node *pool = tommy_list_tail(&pool_list->pools);
+    const UINT32 pool_size = fort_pool_size(size);
 
+    PFORT_POOL pool = fort_pool_new(pool_list, pool_size);
     if (pool == NULL)
         return NULL;
 
+    tommy_list_insert_head_not_empty(&pool_list->pools, (tommy_node *) pool);
+
+    /* The added pool is empty till its first block is allocated */
+    ++pool_list->empty_pools_n;
+
+    tlsf_add_pool(pool_list->tlsf, pool->data, pool->size);
+
+    return tlsf_malloc(pool_list->tlsf, size);
+}
+
+FORT_API void *fort_pool_malloc(PFORT_POOL_LIST pool_list, UINT32 size)
+{
+    if (tommy_list_empty(&pool_list->pools))
+        return NULL;
+
     void *p = tlsf_malloc(pool_list->tlsf, size);
     if (p == NULL) {
-        const UINT32 pool_size = fort_pool_size(size);
-
-        pool = fort_pool_new(pool_size);
-        if (pool == NULL)
+        p = fort_pool_malloc_new(pool_list, size);
+        if (p == NULL)
             return NULL;
+    }
 
-        tommy_list_insert_head_not_empty(&pool_list->pools, pool);
+    const UINT32 block_size = (UINT32) tlsf_block_size(p);
 
-        tlsf_add_pool(pool_list->tlsf, (char *) pool + FORT_POOL_DATA_OFF,
-                pool_size - FORT_POOL_DATA_OFF);
+    PFORT_POOL pool = fort_pool_find(pool_list, p);
 
-        p = tlsf_malloc(pool_list->tlsf, size);
+    /* The empty pool is used now */
+    if (pool->used_size == 0 && !fort_pool_is_first(pool_list, pool)) {
+        --pool_list->empty_pools_n;
     }
 
+    pool->used_size += block_size;
+
+    pool_list->used_size += block_size;
+
     return p;
 }
 
 FORT_API void fort_pool_free(PFORT_POOL_LIST pool_list, void *p)
 {
+    const UINT32 block_size = (UINT32) tlsf_block_size(p);
+
+    PFORT_POOL pool = fort_pool_find(pool_list, p);
+    pool->used_size -= block_size;
+
+    pool_list->used_size -= block_size;
+
     tlsf_free(pool_list->tlsf, p);
+
+    if (pool->used_size == 0 && !fort_pool_is_first(pool_list, pool)) {
+        ++pool_list->empty_pools_n;
+    }
+
+    /* Return the empty pools back to the system */
+    if (pool_list->empty_pools_n != 0) {
+        fort_pool_reclaim_empty(pool_list);
+    }
+}
+
+static void fort_pool_stat_walker(void *ptr, size_t size, int used, void *user)
+{
+    UNUSED(ptr);
+
+    if (used)
+        return;
+
+    PFORT_POOL_STAT stat = user;
+
+    stat->free_size += (UINT32) size;
+
+    if (stat->free_max_size < size) {
+        stat->free_max_size = (UINT32) size;
+    }
+}
+
+FORT_API void fort_pool_stat(PFORT_POOL_LIST pool_list, PFORT_POOL_STAT stat)
+{
+    RtlZeroMemory(stat, sizeof(FORT_POOL_STAT));
+
+    stat->pools_n = pool_list->pools_n;
+    stat->pools_size = pool_list->pools_size;
+    stat->used_size = pool_list->used_size;
+
+    tommy_node *pool = tommy_list_head(&pool_list->pools);
+    while (pool != NULL) {
+        pool_t tlsf_pool = (pool == tommy_list_tail(&pool_list->pools))
+                ? tlsf_get_pool(pool_list->tlsf)
+                : ((PFORT_POOL) pool)->data;
+
+        tlsf_walk_pool(tlsf_pool, &fort_pool_stat_walker, stat);
+
+        pool = pool->next;
+    }
 }
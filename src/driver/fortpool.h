@@ -3,6 +3,8 @@
 
 #include "fortdrv.h"
 
+#include "common/fortconf.h"
+
 #include "forttds.h"
 #include "forttlsf.h"
 
@@ -14,13 +16,27 @@ typedef struct fort_pool
     struct fort_pool *next;
     struct fort_pool *prev;
 
-    char data[4];
+    UINT32 size; /* data size */
+    UINT32 used_size; /* size of the allocated blocks */
+
+    UINT32 chunks_n;
+    tommy_hashdyn_node *chunks; /* data's address chunks in the pool list's chunks map */
+
+    char data[8];
 } FORT_POOL, *PFORT_POOL;
 
 typedef struct fort_pool_list
 {
     tlsf_t tlsf;
     tommy_list pools;
+
+    tommy_hashdyn chunks_map; /* address chunk -> pool */
+
+    UINT32 pools_n;
+    UINT32 pools_size;
+    UINT32 used_size;
+
+    UINT32 empty_pools_n; /* not reclaimed yet, except the first pool */
 } FORT_POOL_LIST, *PFORT_POOL_LIST;
 
 #if defined(__cplusplus)
@@ -37,6 +53,8 @@ FORT_API void *fort_pool_malloc(PFORT_POOL_LIST pool_list, UINT32 size);
 
 FORT_API void fort_pool_free(PFORT_POOL_LIST pool_list, void *p);
 
+FORT_API void fort_pool_stat(PFORT_POOL_LIST pool_list, PFORT_POOL_STAT stat);
+
 #ifdef __cplusplus
 } // extern "C"
 #endif
@@ -16,11 +16,19 @@
 #define FORT_PSTREE_NAME_LEN_MAX_SIZE (FORT_PSTREE_NAME_LEN_MAX * sizeof(WCHAR))
 #define FORT_PSTREE_NAMES_POOL_SIZE   (4 * 1024)
 
+#define FORT_PSTREE_SERVICE_NAME_MAX_SIZE                                                          \
+    (FORT_SVCHOST_PREFIX_SIZE + FORT_SERVICE_INFO_NAME_MAX_SIZE)
+
 #define FORT_PSNAME_DATA_OFF offsetof(FORT_PSNAME, data)
+#define FORT_PSNAME_ALLOC_SIZE(size)                                                               \
+    (FORT_PSNAME_DATA_OFF + (size) + sizeof(WCHAR)) /* include terminating zero */
 
+/* Interned by content in the names map */
 typedef struct fort_psname
 {
-    UINT16 refcount;
+    tommy_hashdyn_node name_node;
+
+    UINT32 refcount;
     UINT16 size;
     WCHAR data[1];
 } FORT_PSNAME, *PFORT_PSNAME;
@@ -33,6 +41,16 @@ typedef struct fort_psname
 #define FORT_PSNODE_KILL_CHILD        0x0020
 #define FORT_PSNODE_IS_SVCHOST        0x0040
 
+/* Running service by its interned name */
+typedef struct fort_psservice
+{
+    tommy_hashdyn_node service_node;
+
+    PFORT_PSNAME ps_name;
+
+    UINT32 process_id;
+} FORT_PSSERVICE, *PFORT_PSSERVICE;
+
 /* Synchronize with tommy_hashdyn_node! */
 typedef struct fort_psnode
 {
@@ -111,6 +129,9 @@ typedef const FORT_PSTREE_NOTIFY_ARG *PCFORT_PSTREE_NOTIFY_ARG;
 
 #define fort_pstree_proc_hash(process_id) tommy_inthash_u32((UINT32) (process_id))
 
+#define fort_pstree_names_filter_ref(ps_tree, pid_hash)                                            \
+    (&(ps_tree)->names_filter[(pid_hash) & (FORT_PSTREE_NAMES_FILTER_SIZE - 1)])
+
 #define fort_pstree_get_proc(ps_tree, index)                                                       \
     ((PFORT_PSNODE) tommy_arrayof_ref(&(ps_tree)->procs, (index)))
 
@@ -188,26 +209,81 @@ static PFORT_PATH_BUFFER fort_pstree_path_buffer_new(void)
     return pb;
 }
 
-static PFORT_PSNAME fort_pstree_name_new(PFORT_PSTREE ps_tree, UINT16 name_size)
+static PFORT_PSNAME fort_pstree_name_find(
+        PFORT_PSTREE ps_tree, PCFORT_APP_PATH path, tommy_key_t name_hash)
 {
-    PFORT_PSNAME ps_name = fort_pool_malloc(&ps_tree->pool_list,
-            FORT_PSNAME_DATA_OFF + name_size + sizeof(WCHAR)); /* include terminating zero */
-    if (ps_name != NULL) {
-        ps_name->refcount = 1;
-        ps_name->size = name_size;
-        ps_name->data[name_size / sizeof(WCHAR)] = L'\0';
+    tommy_hashdyn_node *node = tommy_hashdyn_bucket(&ps_tree->names_map, name_hash);
+
+    while (node != NULL) {
+        PFORT_PSNAME ps_name = node->data;
+
+        if (node->index == name_hash && ps_name->size == path->len
+                && fort_mem_eql(ps_name->data, path->buffer, path->len))
+            return ps_name;
+
+        node = node->next;
     }
+
+    return NULL;
+}
+
+static PFORT_PSNAME fort_pstree_name_new(
+        PFORT_PSTREE ps_tree, PCFORT_APP_PATH path, tommy_key_t name_hash)
+{
+    const UINT16 name_size = path->len;
+
+    PFORT_PSNAME ps_name = fort_pool_malloc(&ps_tree->pool_list, FORT_PSNAME_ALLOC_SIZE(name_size));
+    if (ps_name == NULL)
+        return NULL;
+
+    ps_name->refcount = 1;
+    ps_name->size = name_size;
+
+    RtlCopyMemory(ps_name->data, path->buffer, name_size);
+    ps_name->data[name_size / sizeof(WCHAR)] = L'\0';
+
+    tommy_hashdyn_insert(&ps_tree->names_map, &ps_name->name_node, ps_name, name_hash);
+
+    ++ps_tree->names_n;
+
     return ps_name;
 }
 
+static void fort_pstree_name_ref(PFORT_PSTREE ps_tree, PFORT_PSNAME ps_name)
+{
+    ++ps_name->refcount;
+
+    ps_tree->names_saved_size += FORT_PSNAME_ALLOC_SIZE(ps_name->size);
+}
+
+static PFORT_PSNAME fort_pstree_name_intern(PFORT_PSTREE ps_tree, PCFORT_APP_PATH path)
+{
+    const tommy_key_t name_hash = (tommy_key_t) tommy_hash_u64(0, path->buffer, path->len);
+
+    PFORT_PSNAME ps_name = fort_pstree_name_find(ps_tree, path, name_hash);
+    if (ps_name != NULL) {
+        fort_pstree_name_ref(ps_tree, ps_name);
+        return ps_name;
+    }
+
+    return fort_pstree_name_new(ps_tree, path, name_hash);
+}
+
 static void fort_pstree_name_del(PFORT_PSTREE ps_tree, PFORT_PSNAME ps_name)
 {
     if (ps_name == NULL)
         return;
 
-    if (--ps_name->refcount == 0) {
-        fort_pool_free(&ps_tree->pool_list, ps_name);
+    if (--ps_name->refcount != 0) {
+        ps_tree->names_saved_size -= FORT_PSNAME_ALLOC_SIZE(ps_name->size);
+        return;
     }
+
+    tommy_hashdyn_remove_existing(&ps_tree->names_map, &ps_name->name_node);
+
+    --ps_tree->names_n;
+
+    fort_pool_free(&ps_tree->pool_list, ps_name);
 }
 
 static BOOL fort_pstree_svchost_path_check(PCUNICODE_STRING path)
@@ -274,35 +350,75 @@ static BOOL fort_pstree_svchost_name_check(
     return TRUE;
 }
 
-static PFORT_PSNAME fort_pstree_create_service_name(
-        PFORT_PSTREE ps_tree, PCUNICODE_STRING serviceName)
+static BOOL fort_pstree_build_service_name(
+        PCUNICODE_STRING serviceName, PWCHAR buffer, PFORT_APP_PATH path)
 {
     const USHORT nameLen = serviceName->Length;
 
-    PFORT_PSNAME ps_name = fort_pstree_name_new(ps_tree, FORT_SVCHOST_PREFIX_SIZE + nameLen);
+    if (FORT_SVCHOST_PREFIX_SIZE + nameLen > FORT_PSTREE_SERVICE_NAME_MAX_SIZE)
+        return FALSE;
 
-    if (ps_name != NULL) {
-        PCHAR data = (PCHAR) &ps_name->data;
-        RtlCopyMemory(data, FORT_SVCHOST_PREFIX, FORT_SVCHOST_PREFIX_SIZE);
+    PCHAR data = (PCHAR) buffer;
+    RtlCopyMemory(data, FORT_SVCHOST_PREFIX, FORT_SVCHOST_PREFIX_SIZE);
 
-        UNICODE_STRING nameString;
-        nameString.Length = nameLen;
-        nameString.MaximumLength = nameLen;
-        nameString.Buffer = (PWSTR) (data + FORT_SVCHOST_PREFIX_SIZE);
+    UNICODE_STRING nameString;
+    nameString.Length = nameLen;
+    nameString.MaximumLength = nameLen;
+    nameString.Buffer = (PWSTR) (data + FORT_SVCHOST_PREFIX_SIZE);
 
-        /* RtlDowncaseUnicodeString() must be called in <DISPATCH level only! */
-        fort_ascii_downcase(&nameString, serviceName);
-    }
+    /* RtlDowncaseUnicodeString() must be called in <DISPATCH level only! */
+    fort_ascii_downcase(&nameString, serviceName);
 
-    return ps_name;
+    path->len = FORT_SVCHOST_PREFIX_SIZE + nameLen;
+    path->buffer = buffer;
+
+    return TRUE;
 }
 
-static void fort_pstree_proc_set_service_name(PFORT_PSNODE proc, PFORT_PSNAME ps_name)
+static PFORT_PSNAME fort_pstree_create_service_name(
+        PFORT_PSTREE ps_tree, PCUNICODE_STRING serviceName)
+{
+    /* Build the name to look it up in the names map */
+    WCHAR buffer[FORT_PSTREE_SERVICE_NAME_MAX_SIZE / sizeof(WCHAR)];
+    FORT_APP_PATH path;
+
+    if (!fort_pstree_build_service_name(serviceName, buffer, &path))
+        return NULL;
+
+    return fort_pstree_name_intern(ps_tree, &path);
+}
+
+static void fort_pstree_proc_name_set(PFORT_PSTREE ps_tree, PFORT_PSNODE proc, PFORT_PSNAME ps_name)
 {
     assert(proc->ps_name == NULL);
 
+    if (ps_name == NULL)
+        return;
+
     proc->ps_name = ps_name;
 
+    InterlockedIncrement(fort_pstree_names_filter_ref(ps_tree, proc->pid_hash));
+}
+
+static void fort_pstree_proc_name_clear(PFORT_PSTREE ps_tree, PFORT_PSNODE proc)
+{
+    PFORT_PSNAME ps_name = proc->ps_name;
+    if (ps_name == NULL)
+        return;
+
+    proc->ps_name = NULL;
+
+    InterlockedDecrement(fort_pstree_names_filter_ref(ps_tree, proc->pid_hash));
+
+    /* Delete from pool */
+    fort_pstree_name_del(ps_tree, ps_name);
+}
+
+static void fort_pstree_proc_set_service_name(
+        PFORT_PSTREE ps_tree, PFORT_PSNODE proc, PFORT_PSNAME ps_name)
+{
+    fort_pstree_proc_name_set(ps_tree, proc, ps_name);
+
     if (ps_name != NULL) {
         /* Service can't inherit parent's name */
         proc->flags |= FORT_PSNODE_NAME_CUSTOM;
@@ -323,7 +439,7 @@ static void fort_pstree_proc_check_svchost(
 
     PFORT_PSNAME ps_name = fort_pstree_create_service_name(ps_tree, &serviceName);
 
-    fort_pstree_proc_set_service_name(proc, ps_name);
+    fort_pstree_proc_set_service_name(ps_tree, proc, ps_name);
 }
 
 static PFORT_PSNODE fort_pstree_proc_new(PFORT_PSTREE ps_tree, tommy_key_t pid_hash)
@@ -352,10 +468,8 @@ static void fort_pstree_proc_del(PFORT_PSTREE ps_tree, PFORT_PSNODE proc)
 {
     --ps_tree->procs_n;
 
-    /* Delete from pool */
-    fort_pstree_name_del(ps_tree, proc->ps_name);
+    fort_pstree_proc_name_clear(ps_tree, proc);
 
-    proc->ps_name = NULL;
     proc->process_id = 0;
 
     /* Delete from procs map */
@@ -392,15 +506,11 @@ static PFORT_PSNODE fort_pstree_find_proc(PFORT_PSTREE ps_tree, DWORD processId)
 inline static void fort_pstree_proc_set_name(
         PFORT_PSTREE ps_tree, PFORT_PSNODE proc, PCFORT_APP_PATH path)
 {
-    const UINT16 path_len = path->len;
-
-    PFORT_PSNAME ps_name = fort_pstree_name_new(ps_tree, path_len);
+    PFORT_PSNAME ps_name = fort_pstree_name_intern(ps_tree, path);
     if (ps_name == NULL)
         return;
 
-    RtlCopyMemory(ps_name->data, path->buffer, path_len);
-
-    proc->ps_name = ps_name;
+    fort_pstree_proc_name_set(ps_tree, proc, ps_name);
 }
 
 inline static void fort_pstree_check_proc_conf(
@@ -450,8 +560,8 @@ inline static BOOL fort_pstree_check_proc_inherited(
     PFORT_PSNAME ps_name = parent->ps_name;
     assert(ps_name != NULL);
 
-    ++ps_name->refcount;
-    proc->ps_name = ps_name;
+    fort_pstree_name_ref(ps_tree, ps_name);
+    fort_pstree_proc_name_set(ps_tree, proc, ps_name);
 
     proc->flags |= inherit_spec_flag | FORT_PSNODE_NAME_INHERITED;
 
@@ -685,6 +795,13 @@ FORT_API void fort_pstree_open(PFORT_PSTREE ps_tree)
 
     tommy_arrayof_init(&ps_tree->procs, sizeof(FORT_PSNODE));
     tommy_hashdyn_init(&ps_tree->procs_map);
+    tommy_hashdyn_init(&ps_tree->names_map);
+    tommy_hashdyn_init(&ps_tree->services_map);
+
+    ps_tree->names_n = 0;
+    ps_tree->names_saved_size = 0;
+
+    RtlZeroMemory((PVOID) ps_tree->names_filter, sizeof(ps_tree->names_filter));
 
     KeInitializeSpinLock(&ps_tree->lock);
 
@@ -702,6 +819,13 @@ FORT_API void fort_pstree_close(PFORT_PSTREE ps_tree)
 
         tommy_arrayof_done(&ps_tree->procs);
         tommy_hashdyn_done(&ps_tree->procs_map);
+        tommy_hashdyn_done(&ps_tree->names_map);
+        tommy_hashdyn_done(&ps_tree->services_map);
+
+        ps_tree->names_n = 0;
+        ps_tree->names_saved_size = 0;
+
+        RtlZeroMemory((PVOID) ps_tree->names_filter, sizeof(ps_tree->names_filter));
     }
     KeReleaseInStackQueuedSpinLock(&lock_queue);
 }
@@ -784,10 +908,10 @@ FORT_API void fort_pstree_enum_processes(PFORT_PSTREE ps_tree)
     fort_mem_free(buffer, FORT_PSTREE_POOL_TAG);
 }
 
-static BOOL fort_pstree_get_proc_name_locked(
-        PFORT_PSTREE ps_tree, DWORD processId, PFORT_APP_PATH path, BOOL *inherited)
+static BOOL fort_pstree_get_proc_name_locked(PFORT_PSTREE ps_tree, DWORD processId,
+        tommy_key_t pid_hash, PFORT_APP_PATH path, BOOL *inherited)
 {
-    PFORT_PSNODE proc = fort_pstree_find_proc(ps_tree, processId);
+    PFORT_PSNODE proc = fort_pstree_find_proc_hash(ps_tree, processId, pid_hash);
     if (proc == NULL)
         return FALSE;
 
@@ -812,20 +936,85 @@ static BOOL fort_pstree_get_proc_name_locked(
 FORT_API BOOL fort_pstree_get_proc_name(
         PFORT_PSTREE ps_tree, DWORD processId, PFORT_APP_PATH path, BOOL *inherited)
 {
+    if (processId == 0)
+        return FALSE;
+
+    const tommy_key_t pid_hash = fort_pstree_proc_hash(processId);
+
+    /* Most processes have no name: don't contend with the process notifications for the lock */
+    if (*fort_pstree_names_filter_ref(ps_tree, pid_hash) == 0)
+        return FALSE;
+
     BOOL res;
 
     KLOCK_QUEUE_HANDLE lock_queue;
     KeAcquireInStackQueuedSpinLock(&ps_tree->lock, &lock_queue);
     {
-        res = fort_pstree_get_proc_name_locked(ps_tree, processId, path, inherited);
+        res = fort_pstree_get_proc_name_locked(ps_tree, processId, pid_hash, path, inherited);
     }
     KeReleaseInStackQueuedSpinLock(&lock_queue);
 
     return res;
 }
 
-inline static void fort_pstree_update_service_proc(
-        PFORT_PSTREE ps_tree, PCUNICODE_STRING serviceName, DWORD processId)
+static PFORT_PSSERVICE fort_pstree_find_service(PFORT_PSTREE ps_tree, PFORT_PSNAME ps_name)
+{
+    tommy_hashdyn_node *node =
+            tommy_hashdyn_bucket(&ps_tree->services_map, ps_name->name_node.index);
+
+    while (node != NULL) {
+        PFORT_PSSERVICE service = node->data;
+
+        /* Names are interned */
+        if (service->ps_name == ps_name)
+            return service;
+
+        node = node->next;
+    }
+
+    return NULL;
+}
+
+static PFORT_PSSERVICE fort_pstree_service_new(PFORT_PSTREE ps_tree, PFORT_PSNAME ps_name)
+{
+    PFORT_PSSERVICE service = fort_pool_malloc(&ps_tree->pool_list, sizeof(FORT_PSSERVICE));
+    if (service == NULL)
+        return NULL;
+
+    fort_pstree_name_ref(ps_tree, ps_name);
+
+    service->ps_name = ps_name;
+    service->process_id = 0;
+
+    tommy_hashdyn_insert(
+            &ps_tree->services_map, &service->service_node, service, ps_name->name_node.index);
+
+    return service;
+}
+
+static void fort_pstree_service_del(PFORT_PSTREE ps_tree, PFORT_PSSERVICE service)
+{
+    tommy_hashdyn_remove_existing(&ps_tree->services_map, &service->service_node);
+
+    fort_pstree_name_del(ps_tree, service->ps_name);
+
+    fort_pool_free(&ps_tree->pool_list, service);
+}
+
+static void fort_pstree_service_proc_detach(PFORT_PSTREE ps_tree, PFORT_PSSERVICE service)
+{
+    /* The previous process doesn't host the service anymore */
+    PFORT_PSNODE proc = fort_pstree_find_proc(ps_tree, service->process_id);
+    if (proc == NULL || proc->ps_name != service->ps_name)
+        return;
+
+    fort_pstree_proc_name_clear(ps_tree, proc);
+
+    proc->flags &= ~FORT_PSNODE_NAME_CUSTOM;
+}
+
+static void fort_pstree_service_proc_attach(
+        PFORT_PSTREE ps_tree, PFORT_PSNAME ps_name, DWORD processId)
 {
     const tommy_key_t pid_hash = fort_pstree_proc_hash(processId);
 
@@ -838,10 +1027,69 @@ inline static void fort_pstree_update_service_proc(
     }
 
     if (proc->ps_name == NULL) {
-        PFORT_PSNAME ps_name = fort_pstree_create_service_name(ps_tree, serviceName);
+        fort_pstree_name_ref(ps_tree, ps_name);
+
+        fort_pstree_proc_set_service_name(ps_tree, proc, ps_name);
+    }
+}
+
+static void fort_pstree_update_service_name(
+        PFORT_PSTREE ps_tree, PFORT_PSNAME ps_name, DWORD processId)
+{
+    PFORT_PSSERVICE service = fort_pstree_find_service(ps_tree, ps_name);
+
+    if (service != NULL) {
+        if (service->process_id != processId) {
+            fort_pstree_service_proc_detach(ps_tree, service);
+
+            if (processId == 0) {
+                /* The service is stopped */
+                fort_pstree_service_del(ps_tree, service);
+                return;
+            }
+        }
+    } else {
+        if (processId == 0)
+            return;
+
+        service = fort_pstree_service_new(ps_tree, ps_name);
+        if (service == NULL)
+            return;
+    }
+
+    service->process_id = processId;
+
+    fort_pstree_service_proc_attach(ps_tree, ps_name, processId);
+}
+
+static void fort_pstree_update_service_proc_locked(
+        PFORT_PSTREE ps_tree, PCFORT_APP_PATH path, DWORD processId)
+{
+    PFORT_PSNAME ps_name = fort_pstree_name_intern(ps_tree, path);
+    if (ps_name == NULL)
+        return;
+
+    fort_pstree_update_service_name(ps_tree, ps_name, processId);
+
+    fort_pstree_name_del(ps_tree, ps_name);
+}
+
+inline static void fort_pstree_update_service_proc(
+        PFORT_PSTREE ps_tree, PCUNICODE_STRING serviceName, DWORD processId)
+{
+    /* Build the name out of the lock */
+    WCHAR buffer[FORT_PSTREE_SERVICE_NAME_MAX_SIZE / sizeof(WCHAR)];
+    FORT_APP_PATH path;
 
-        fort_pstree_proc_set_service_name(proc, ps_name);
+    if (!fort_pstree_build_service_name(serviceName, buffer, &path))
+        return;
+
+    KLOCK_QUEUE_HANDLE lock_queue;
+    KeAcquireInStackQueuedSpinLock(&ps_tree->lock, &lock_queue);
+    {
+        fort_pstree_update_service_proc_locked(ps_tree, &path, processId);
     }
+    KeReleaseInStackQueuedSpinLock(&lock_queue);
 }
 
 static int fort_pstree_update_service(
@@ -865,22 +1113,26 @@ static int fort_pstree_update_service(
 
 FORT_API void fort_pstree_update_services(
         PFORT_PSTREE ps_tree, PCFORT_SERVICE_INFO_LIST services, ULONG data_len)
+{
+    PCHAR data = (PCHAR) services->data;
+    const PCHAR end_data = data + data_len;
+
+    UINT16 n = services->services_n;
+    while (n-- > 0) {
+        const int size = fort_pstree_update_service(ps_tree, (PFORT_SERVICE_INFO) data, end_data);
+        if (size == 0)
+            break;
+
+        data += size;
+    }
+}
+
+FORT_API void fort_pstree_pool_stat(PFORT_PSTREE ps_tree, PFORT_POOL_STAT stat)
 {
     KLOCK_QUEUE_HANDLE lock_queue;
     KeAcquireInStackQueuedSpinLock(&ps_tree->lock, &lock_queue);
     {
-        PCHAR data = (PCHAR) services->data;
-        const PCHAR end_data = data + data_len;
-
-        UINT16 n = services->services_n;
-        while (n-- > 0) {
-            const int size =
-                    fort_pstree_update_service(ps_tree, (PFORT_SERVICE_INFO) data, end_data);
-            if (size == 0)
-                break;
-
-            data += size;
-        }
+        fort_pool_stat(&ps_tree->pool_list, stat);
     }
     KeReleaseInStackQueuedSpinLock(&lock_queue);
 }
@@ -9,6 +9,9 @@
 
 #define FORT_PSTREE_ACTIVE 0x0001
 
+#define FORT_PSTREE_NAMES_FILTER_BITS 10
+#define FORT_PSTREE_NAMES_FILTER_SIZE (1 << FORT_PSTREE_NAMES_FILTER_BITS)
+
 typedef struct fort_pstree
 {
     UCHAR volatile flags;
@@ -21,6 +24,15 @@ typedef struct fort_pstree
     tommy_arrayof procs;
     tommy_hashdyn procs_map;
 
+    tommy_hashdyn names_map; /* interned names */
+    tommy_hashdyn services_map; /* running services by names */
+
+    UINT32 names_n; /* count of live names */
+    UINT32 names_saved_size; /* bytes not allocated due to the names sharing */
+
+    /* Named processes count by pid hash, it's read without the lock */
+    LONG volatile names_filter[FORT_PSTREE_NAMES_FILTER_SIZE];
+
     KSPIN_LOCK lock;
 } FORT_PSTREE, *PFORT_PSTREE;
 
@@ -40,6 +52,8 @@ FORT_API BOOL fort_pstree_get_proc_name(
 FORT_API void fort_pstree_update_services(
         PFORT_PSTREE ps_tree, PCFORT_SERVICE_INFO_LIST services, ULONG data_len);
 
+FORT_API void fort_pstree_pool_stat(PFORT_PSTREE ps_tree, PFORT_POOL_STAT stat);
+
 #ifdef __cplusplus
 } // extern "C"
 #endif
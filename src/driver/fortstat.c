@@ -9,6 +9,7 @@
 
 #define fort_stat_proc_hash(process_id) tommy_inthash_u32((UINT32) (process_id))
 #define fort_flow_hash(flow_id)         tommy_inthash_u32((UINT32) (flow_id))
+#define fort_stat_quota_hash(key)       tommy_inthash_u32((UINT32) (key))
 
 static void fort_stat_proc_active_add(PFORT_STAT stat, PFORT_STAT_PROC proc)
 {
@@ -61,8 +62,7 @@ static PFORT_STAT_PROC fort_stat_proc_add(PFORT_STAT stat, UINT32 process_id)
         if (size + 1 >= FORT_PROC_COUNT_MAX)
             return NULL;
 
-        /* TODO: tommy_arrayof_grow(): check calloc()'s result for NULL */
-        if (tommy_arrayof_grow(&stat->procs, size + 1), 0)
+        if (!fort_tommy_arrayof_grow(&stat->procs, size + 1))
             return NULL;
 
         proc = tommy_arrayof_ref(&stat->procs, size);
@@ -270,8 +270,7 @@ static PFORT_FLOW fort_flow_new(PFORT_STAT stat, UINT64 flow_id, const tommy_key
     } else {
         const tommy_size_t size = tommy_arrayof_size(&stat->flows);
 
-        /* TODO: tommy_arrayof_grow(): check calloc()'s result for NULL */
-        if (tommy_arrayof_grow(&stat->flows, size + 1), 0)
+        if (!fort_tommy_arrayof_grow(&stat->flows, size + 1))
             return NULL;
 
         flow = tommy_arrayof_ref(&stat->flows, size);
@@ -284,6 +283,209 @@ static PFORT_FLOW fort_flow_new(PFORT_STAT stat, UINT64 flow_id, const tommy_key
     return flow;
 }
 
+static PFORT_STAT_QUOTA fort_stat_quota_ref(PFORT_STAT stat, UINT16 quota_id)
+{
+    if (quota_id == 0 || quota_id > stat->quotas_n)
+        return NULL;
+
+    return &stat->quotas[quota_id - 1];
+}
+
+inline static BOOL fort_stat_quota_exceeded_check(PCFORT_TRAF_QUOTA quota)
+{
+    return (quota->day_bytes != 0 && quota->day_used >= quota->day_bytes)
+            || (quota->month_bytes != 0 && quota->month_used >= quota->month_bytes);
+}
+
+static PFORT_STAT_QUOTA fort_stat_quotas_exceeded(PFORT_STAT stat, const UINT16 *quota_ids)
+{
+    for (int i = 0; i < FORT_FLOW_QUOTA_COUNT; ++i) {
+        PFORT_STAT_QUOTA quota = fort_stat_quota_ref(stat, quota_ids[i]);
+
+        if (quota != NULL && quota->exceeded)
+            return quota;
+    }
+
+    return NULL;
+}
+
+static PFORT_STAT_QUOTA fort_stat_quota_get(
+        tommy_hashdyn *quotas_map, UINT32 key, tommy_key_t key_hash)
+{
+    PFORT_STAT_QUOTA quota = (PFORT_STAT_QUOTA) tommy_hashdyn_bucket(quotas_map, key_hash);
+
+    while (quota != NULL) {
+        if (quota->quota.key == key)
+            return quota;
+
+        quota = quota->next;
+    }
+
+    return NULL;
+}
+
+static PFORT_STAT_QUOTA fort_stat_quotas_new(
+        PCFORT_CONF conf, UINT16 quotas_n, tommy_hashdyn *quotas_map)
+{
+    tommy_hashdyn_init(quotas_map);
+
+    if (quotas_n == 0)
+        return NULL;
+
+    PFORT_STAT_QUOTA quotas =
+            fort_mem_alloc(quotas_n * sizeof(FORT_STAT_QUOTA), FORT_STAT_POOL_TAG);
+    if (quotas == NULL)
+        return NULL;
+
+    PCFORT_TRAF_QUOTA conf_quotas = fort_conf_quotas_ref(conf);
+
+    for (UINT16 i = 0; i < quotas_n; ++i) {
+        PFORT_STAT_QUOTA quota = &quotas[i];
+
+        quota->quota = conf_quotas[i];
+        quota->exceeded = FALSE;
+
+        const tommy_key_t key_hash = fort_stat_quota_hash(quota->quota.key);
+
+        tommy_hashdyn_insert(quotas_map, (tommy_hashdyn_node *) quota, NULL, key_hash);
+    }
+
+    return quotas;
+}
+
+static void fort_stat_quotas_merge(PFORT_STAT stat, PFORT_STAT_QUOTA quotas, UINT16 quotas_n)
+{
+    for (UINT16 i = 0; i < quotas_n; ++i) {
+        PFORT_TRAF_QUOTA quota = &quotas[i].quota;
+
+        /* Keep the bytes counted by the driver, unless the seeded ones are bigger */
+        PCFORT_STAT_QUOTA old_quota =
+                fort_stat_quota_get(&stat->quotas_map, quota->key, quotas[i].key_hash);
+
+        if (old_quota != NULL) {
+            if (quota->day_used < old_quota->quota.day_used) {
+                quota->day_used = old_quota->quota.day_used;
+            }
+            if (quota->month_used < old_quota->quota.month_used) {
+                quota->month_used = old_quota->quota.month_used;
+            }
+        }
+
+        quotas[i].exceeded = fort_stat_quota_exceeded_check(quota);
+    }
+}
+
+typedef struct fort_flow_quotas_remap_arg
+{
+    PFORT_STAT stat;
+    PFORT_STAT_QUOTA quotas;
+    tommy_hashdyn *quotas_map;
+} FORT_FLOW_QUOTAS_REMAP_ARG, *PFORT_FLOW_QUOTAS_REMAP_ARG;
+
+static void fort_flow_quotas_remap(PVOID remap_arg, PVOID flow_node)
+{
+    PFORT_FLOW_QUOTAS_REMAP_ARG ra = remap_arg;
+    PFORT_FLOW flow = flow_node;
+
+    for (int i = 0; i < FORT_FLOW_QUOTA_COUNT; ++i) {
+        PCFORT_STAT_QUOTA old_quota = fort_stat_quota_ref(ra->stat, flow->quota_ids[i]);
+        if (old_quota == NULL)
+            continue;
+
+        PCFORT_STAT_QUOTA quota =
+                fort_stat_quota_get(ra->quotas_map, old_quota->quota.key, old_quota->key_hash);
+
+        flow->quota_ids[i] = (quota != NULL) ? (UINT16) (quota - ra->quotas) + 1 : 0;
+    }
+}
+
+static PFORT_SPEED_LIMIT fort_stat_app_limits_new(PCFORT_CONF conf)
+{
+    const UINT16 app_limits_n = conf->app_limits_n;
+    if (app_limits_n == 0)
+        return NULL;
+
+    const ULONG size = FORT_CONF_APP_LIMITS_SIZE(app_limits_n);
+
+    PFORT_SPEED_LIMIT app_limits = fort_mem_alloc(size, FORT_STAT_POOL_TAG);
+    if (app_limits == NULL)
+        return NULL;
+
+    RtlCopyMemory(app_limits, fort_conf_app_limits_ref(conf), size);
+
+    return app_limits;
+}
+
+inline static void fort_stat_app_limits_free(PFORT_SPEED_LIMIT app_limits)
+{
+    if (app_limits != NULL) {
+        fort_mem_free(app_limits, FORT_STAT_POOL_TAG);
+    }
+}
+
+static UINT16 fort_stat_app_limit_find(
+        PCFORT_SPEED_LIMIT app_limits, UINT16 app_limits_n, PCFORT_SPEED_LIMIT limits)
+{
+    const SIZE_T size = 2 * sizeof(FORT_SPEED_LIMIT);
+
+    for (UINT16 i = 0; i < app_limits_n; ++i) {
+        if (RtlEqualMemory(&app_limits[i * 2], limits, size))
+            return i + 1;
+    }
+
+    return 0;
+}
+
+typedef struct fort_flow_limits_remap_arg
+{
+    UINT16 old_limits_n;
+    const UINT16 *limits_map; /* old limit id -> new limit id */
+} FORT_FLOW_LIMITS_REMAP_ARG, *PFORT_FLOW_LIMITS_REMAP_ARG;
+
+static void fort_flow_limits_remap(PVOID remap_arg, PVOID flow_node)
+{
+    PFORT_FLOW_LIMITS_REMAP_ARG ra = remap_arg;
+    PFORT_FLOW flow = flow_node;
+
+    const UINT16 limit_id = flow->limit_id;
+    if (limit_id == 0)
+        return;
+
+    flow->limit_id = (ra->limits_map != NULL && limit_id <= ra->old_limits_n)
+            ? ra->limits_map[limit_id - 1]
+            : 0;
+}
+
+static void fort_stat_app_limits_remap(
+        PFORT_STAT stat, PCFORT_SPEED_LIMIT app_limits, UINT16 app_limits_n)
+{
+    const UINT16 old_limits_n = stat->app_limits_n;
+    if (old_limits_n == 0)
+        return;
+
+    /* Map the old limit ids to the new ones by the limits' values */
+    UINT16 *limits_map = fort_mem_alloc(old_limits_n * sizeof(UINT16), FORT_STAT_POOL_TAG);
+
+    if (limits_map != NULL) {
+        for (UINT16 i = 0; i < old_limits_n; ++i) {
+            limits_map[i] =
+                    fort_stat_app_limit_find(app_limits, app_limits_n, &stat->app_limits[i * 2]);
+        }
+    }
+
+    /* The flows are not limited by the app anymore, when the map can't be allocated */
+    FORT_FLOW_LIMITS_REMAP_ARG ra = {
+        .old_limits_n = old_limits_n,
+        .limits_map = limits_map,
+    };
+
+    tommy_hashdyn_foreach_node_arg(&stat->flows_map, &fort_flow_limits_remap, &ra);
+
+    if (limits_map != NULL) {
+        fort_mem_free(limits_map, FORT_STAT_POOL_TAG);
+    }
+}
+
 inline static UCHAR fort_stat_group_speed_limit(PFORT_CONF_GROUP conf_group, UCHAR group_index)
 {
     if (((conf_group->group_bits & conf_group->limit_bits) & (1 << group_index)) == 0)
@@ -310,8 +512,18 @@ inline static NTSTATUS fort_flow_add_new(PFORT_STAT stat, PFORT_FLOW *flow, UINT
     return status;
 }
 
+inline static UCHAR fort_flow_speed_limit(PFORT_STAT stat, UCHAR group_index, UCHAR limit_io_bits)
+{
+    /* The app's own speed limits override the group's ones */
+    if (limit_io_bits != 0)
+        return FORT_FLOW_SPEED_LIMIT_PROC | limit_io_bits;
+
+    return fort_stat_group_speed_limit(&stat->conf_group, group_index);
+}
+
 static NTSTATUS fort_flow_add(PFORT_STAT stat, UINT64 flow_id, PCFORT_CONF_META_CONN conn,
-        UINT16 proc_index, UCHAR group_index)
+        UINT16 proc_index, UCHAR group_index, UINT16 limit_id, UCHAR limit_io_bits,
+        const UINT16 *quota_ids)
 {
     const tommy_key_t flow_hash = fort_flow_hash(flow_id);
     PFORT_FLOW flow = fort_flow_get(stat, flow_id, flow_hash);
@@ -325,12 +537,15 @@ static NTSTATUS fort_flow_add(PFORT_STAT stat, UINT64 flow_id, PCFORT_CONF_META_
         fort_stat_proc_inc(stat, proc_index);
     }
 
-    const UCHAR speed_limit = fort_stat_group_speed_limit(&stat->conf_group, group_index);
+    const UCHAR speed_limit = fort_flow_speed_limit(stat, group_index, limit_io_bits);
 
     flow->opt.flags = speed_limit | (conn->ip_proto == IPPROTO_TCP ? FORT_FLOW_TCP : 0)
             | (conn->isIPv6 ? FORT_FLOW_IP6 : 0) | (conn->inbound ? FORT_FLOW_INBOUND : 0);
     flow->opt.group_index = group_index;
     flow->opt.proc_index = proc_index;
+    flow->limit_id = (limit_io_bits != 0) ? limit_id : 0;
+    flow->quota_ids[0] = quota_ids[0];
+    flow->quota_ids[1] = quota_ids[1];
 
     return STATUS_SUCCESS;
 }
@@ -343,6 +558,8 @@ FORT_API void fort_stat_open(PFORT_STAT stat)
     tommy_arrayof_init(&stat->flows, sizeof(FORT_FLOW));
     tommy_hashdyn_init(&stat->flows_map);
 
+    tommy_hashdyn_init(&stat->quotas_map);
+
     KeInitializeSpinLock(&stat->lock);
 }
 
@@ -390,6 +607,18 @@ FORT_API void fort_stat_close(PFORT_STAT stat)
     tommy_arrayof_done(&stat->flows);
     tommy_hashdyn_done(&stat->flows_map);
 
+    tommy_hashdyn_done(&stat->quotas_map);
+
+    if (stat->quotas != NULL) {
+        fort_mem_free(stat->quotas, FORT_STAT_POOL_TAG);
+        stat->quotas = NULL;
+    }
+    stat->quotas_n = 0;
+
+    fort_stat_app_limits_free(stat->app_limits);
+    stat->app_limits = NULL;
+    stat->app_limits_n = 0;
+
     KeReleaseInStackQueuedSpinLock(&lock_queue);
 }
 
@@ -414,12 +643,74 @@ FORT_API void fort_stat_log_update(PFORT_STAT stat, BOOL log_stat)
 
 FORT_API void fort_stat_conf_update(PFORT_STAT stat, PCFORT_CONF_IO conf_io)
 {
+    PCFORT_CONF conf = &conf_io->conf;
+
+    tommy_hashdyn quotas_map;
+    PFORT_STAT_QUOTA quotas = fort_stat_quotas_new(conf, conf->quotas_n, &quotas_map);
+    const UINT16 quotas_n = (quotas != NULL) ? conf->quotas_n : 0;
+
+    PFORT_SPEED_LIMIT app_limits = fort_stat_app_limits_new(conf);
+    const UINT16 app_limits_n = (app_limits != NULL) ? conf->app_limits_n : 0;
+
     KLOCK_QUEUE_HANDLE lock_queue;
     KeAcquireInStackQueuedSpinLock(&stat->lock, &lock_queue);
     {
         stat->conf_group = conf_io->conf_group;
+
+        fort_stat_quotas_merge(stat, quotas, quotas_n);
+
+        /* The quota ids of existing flows point to the old quotas */
+        if (stat->quotas_n != 0) {
+            FORT_FLOW_QUOTAS_REMAP_ARG ra = {
+                .stat = stat,
+                .quotas = quotas,
+                .quotas_map = &quotas_map,
+            };
+
+            tommy_hashdyn_foreach_node_arg(&stat->flows_map, &fort_flow_quotas_remap, &ra);
+        }
+
+        /* The limit ids of existing flows point to the old app limits */
+        fort_stat_app_limits_remap(stat, app_limits, app_limits_n);
+
+        if (stat->quota_month_start != conf->quota_month_start) {
+            stat->quota_month_start = conf->quota_month_start;
+            stat->quota_month_id = 0; /* the seeded bytes are of the new window */
+        }
+
+        /* Swap the quotas */
+        {
+            PFORT_STAT_QUOTA old_quotas = stat->quotas;
+            const tommy_hashdyn old_quotas_map = stat->quotas_map;
+
+            stat->quotas_n = quotas_n;
+            stat->quotas = quotas;
+            stat->quotas_map = quotas_map;
+
+            quotas = old_quotas;
+            quotas_map = old_quotas_map;
+        }
+
+        /* Swap the app limits */
+        {
+            PFORT_SPEED_LIMIT old_app_limits = stat->app_limits;
+
+            stat->app_limits_n = app_limits_n;
+            stat->app_limits = app_limits;
+
+            app_limits = old_app_limits;
+        }
     }
     KeReleaseInStackQueuedSpinLock(&lock_queue);
+
+    /* Free the old quotas */
+    tommy_hashdyn_done(&quotas_map);
+
+    if (quotas != NULL) {
+        fort_mem_free(quotas, FORT_STAT_POOL_TAG);
+    }
+
+    fort_stat_app_limits_free(app_limits);
 }
 
 FORT_API void fort_stat_conf_flags_update(PFORT_STAT stat, const FORT_CONF_FLAGS conf_flags)
@@ -454,21 +745,50 @@ static NTSTATUS fort_flow_associate_proc(
     return STATUS_SUCCESS;
 }
 
+static NTSTATUS fort_flow_associate_quota(
+        PFORT_STAT stat, const UINT16 *quota_ids, UCHAR *group_index, UCHAR *limit_io_bits)
+{
+    PCFORT_STAT_QUOTA quota = fort_stat_quotas_exceeded(stat, quota_ids);
+    if (quota == NULL)
+        return STATUS_SUCCESS;
+
+    const UCHAR throttle_group = quota->quota.throttle_group;
+
+    if (throttle_group == 0 || throttle_group > FORT_CONF_GROUP_MAX)
+        return FORT_STATUS_FLOW_QUOTA;
+
+    /* Throttle the flow by the group's speed limits */
+    *group_index = throttle_group - 1;
+    *limit_io_bits = 0;
+
+    return STATUS_SUCCESS;
+}
+
 FORT_API NTSTATUS fort_flow_associate(PFORT_STAT stat, UINT64 flow_id, PCFORT_CONF_META_CONN conn,
-        UCHAR group_index, BOOL *log_stat)
+        UCHAR group_index, UINT16 limit_id, UCHAR limit_io_bits, UINT16 quota_id, BOOL *log_stat)
 {
     NTSTATUS status;
 
     KLOCK_QUEUE_HANDLE lock_queue;
     KeAcquireInStackQueuedSpinLock(&stat->lock, &lock_queue);
 
+    const UINT16 quota_ids[FORT_FLOW_QUOTA_COUNT] = {
+        quota_id,
+        stat->conf_group.quota_ids[group_index],
+    };
+
+    status = fort_flow_associate_quota(stat, quota_ids, &group_index, &limit_io_bits);
+
     BOOL is_new_proc = FALSE;
     PFORT_STAT_PROC proc = NULL;
-    status = fort_flow_associate_proc(stat, conn->process_id, &is_new_proc, &proc);
+    if (NT_SUCCESS(status)) {
+        status = fort_flow_associate_proc(stat, conn->process_id, &is_new_proc, &proc);
+    }
 
     /* Add flow */
     if (NT_SUCCESS(status)) {
-        status = fort_flow_add(stat, flow_id, conn, proc->proc_index, group_index);
+        status = fort_flow_add(stat, flow_id, conn, proc->proc_index, group_index, limit_id,
+                limit_io_bits, quota_ids);
 
         if (NT_SUCCESS(status)) {
             *log_stat = proc->log_stat;
@@ -510,19 +830,49 @@ FORT_API void fort_flow_delete(PFORT_STAT stat, UINT64 flowContext)
     KeReleaseInStackQueuedSpinLock(&lock_queue);
 }
 
-FORT_API void fort_flow_classify(PFORT_STAT stat, UINT64 flowContext, UINT32 data_len, BOOL inbound)
+static BOOL fort_flow_quotas_blocked(PFORT_STAT stat, PFORT_FLOW flow, UINT32 data_len)
+{
+    PFORT_STAT_QUOTA quotas[FORT_FLOW_QUOTA_COUNT];
+
+    for (int i = 0; i < FORT_FLOW_QUOTA_COUNT; ++i) {
+        PFORT_STAT_QUOTA quota = fort_stat_quota_ref(stat, flow->quota_ids[i]);
+
+        /* Throttled flows are limited by the group's speed limits on association */
+        if (quota != NULL && quota->exceeded && quota->quota.throttle_group == 0)
+            return TRUE;
+
+        quotas[i] = quota;
+    }
+
+    for (int i = 0; i < FORT_FLOW_QUOTA_COUNT; ++i) {
+        PFORT_STAT_QUOTA quota = quotas[i];
+        if (quota == NULL)
+            continue;
+
+        quota->quota.day_used += data_len;
+        quota->quota.month_used += data_len;
+
+        quota->exceeded = fort_stat_quota_exceeded_check(&quota->quota);
+    }
+
+    return FALSE;
+}
+
+FORT_API BOOL fort_flow_classify(PFORT_STAT stat, UINT64 flowContext, UINT32 data_len, BOOL inbound)
 {
     if (data_len == 0)
-        return;
+        return FALSE;
 
     PFORT_FLOW flow = (PFORT_FLOW) flowContext;
 
     KLOCK_QUEUE_HANDLE lock_queue;
     KeAcquireInStackQueuedSpinLock(&stat->lock, &lock_queue);
 
+    const BOOL blocked = fort_flow_quotas_blocked(stat, flow, data_len);
+
     PFORT_STAT_PROC proc = tommy_arrayof_ref(&stat->procs, flow->opt.proc_index);
 
-    if (proc->log_stat) {
+    if (proc->log_stat && !blocked) {
         UINT32 *proc_bytes = inbound ? &proc->traf.in_bytes : &proc->traf.out_bytes;
 
         /* Add traffic to process's bytes */
@@ -532,6 +882,65 @@ FORT_API void fort_flow_classify(PFORT_STAT stat, UINT64 flowContext, UINT32 dat
     }
 
     KeReleaseInStackQueuedSpinLock(&lock_queue);
+
+    return blocked;
+}
+
+FORT_API void fort_stat_quota_window_update(PFORT_STAT stat, UINT32 day_id, UINT32 month_id)
+{
+    const BOOL day_changed = (stat->quota_day_id != day_id);
+    const BOOL month_changed = (stat->quota_month_id != month_id);
+
+    if (!day_changed && !month_changed)
+        return;
+
+    /* The seeded bytes are of the current window */
+    const BOOL day_reset = (day_changed && stat->quota_day_id != 0);
+    const BOOL month_reset = (month_changed && stat->quota_month_id != 0);
+
+    stat->quota_day_id = day_id;
+    stat->quota_month_id = month_id;
+
+    for (UINT16 i = 0; i < stat->quotas_n; ++i) {
+        PFORT_STAT_QUOTA quota = &stat->quotas[i];
+
+        if (day_reset) {
+            quota->quota.day_used = 0;
+        }
+        if (month_reset) {
+            quota->quota.month_used = 0;
+        }
+
+        quota->exceeded = fort_stat_quota_exceeded_check(&quota->quota);
+    }
+}
+
+FORT_API void fort_stat_quota_time_update(PFORT_STAT stat, LARGE_INTEGER system_time)
+{
+    if (stat->quotas_n == 0)
+        return;
+
+    LARGE_INTEGER local_time;
+    ExSystemTimeToLocalTime(&system_time, &local_time);
+
+    TIME_FIELDS tf = { 0 };
+    RtlTimeToTimeFields(&local_time, &tf);
+
+    UINT32 year = tf.Year;
+    UINT32 month = tf.Month;
+
+    /* The monthly window starts at the configured day of month */
+    if (tf.Day < stat->quota_month_start) {
+        if (--month == 0) {
+            month = 12;
+            --year;
+        }
+    }
+
+    const UINT32 day_id = (UINT32) tf.Year * 10000 + tf.Month * 100 + tf.Day;
+    const UINT32 month_id = year * 100 + month;
+
+    fort_stat_quota_window_update(stat, day_id, month_id);
 }
 
 FORT_API void fort_stat_dpc_begin(PFORT_STAT stat, PKLOCK_QUEUE_HANDLE lock_queue)
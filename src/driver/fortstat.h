@@ -7,6 +7,7 @@
 #include "forttds.h"
 
 #define FORT_STATUS_FLOW_BLOCK STATUS_NOT_SAME_DEVICE
+#define FORT_STATUS_FLOW_QUOTA STATUS_QUOTA_EXCEEDED
 
 /* Synchronize with tommy_hashdyn_node! */
 typedef struct fort_stat_proc
@@ -86,8 +87,31 @@ typedef struct fort_flow
 #else
     UINT64 flow_id;
 #endif
+
+    UINT16 limit_id; /* app's speed limits for FORT_FLOW_SPEED_LIMIT_PROC */
+
+    UINT16 quota_ids[2]; /* app's and group's traffic quotas */
 } FORT_FLOW, *PFORT_FLOW;
 
+#define FORT_FLOW_QUOTA_COUNT 2
+
+/* Synchronize with tommy_hashdyn_node! */
+typedef struct fort_stat_quota
+{
+    struct fort_stat_quota *next;
+    struct fort_stat_quota *prev;
+
+    void *data; /* tommy_hashdyn_node::data */
+
+    tommy_key_t key_hash; /* tommy_hashdyn_node::index */
+
+    UCHAR exceeded : 1;
+
+    FORT_TRAF_QUOTA quota;
+} FORT_STAT_QUOTA, *PFORT_STAT_QUOTA;
+
+typedef const FORT_STAT_QUOTA *PCFORT_STAT_QUOTA;
+
 #define FORT_STAT_LOG                 0x01
 #define FORT_STAT_SYSTEM_TIME_CHANGED 0x02
 #define FORT_STAT_CLOSED              0x10 /* used on driver unloading */
@@ -143,6 +167,18 @@ typedef struct fort_stat
 
     FORT_CONF_GROUP conf_group;
 
+    UINT16 quotas_n;
+    UCHAR quota_month_start;
+
+    UINT32 quota_day_id; /* local date of the daily quotas' window, 0 - not set yet */
+    UINT32 quota_month_id; /* local month of the monthly quotas' window, 0 - not set yet */
+
+    PFORT_STAT_QUOTA quotas;
+    tommy_hashdyn quotas_map; /* quota key -> quota */
+
+    UINT16 app_limits_n;
+    PFORT_SPEED_LIMIT app_limits; /* to remap the flows' limit ids on conf update */
+
     LARGE_INTEGER system_time;
 
     KSPIN_LOCK lock;
@@ -173,13 +209,17 @@ FORT_API void fort_stat_conf_update(PFORT_STAT stat, PCFORT_CONF_IO conf_io);
 FORT_API void fort_stat_conf_flags_update(PFORT_STAT stat, const FORT_CONF_FLAGS conf_flags);
 
 FORT_API NTSTATUS fort_flow_associate(PFORT_STAT stat, UINT64 flow_id, PCFORT_CONF_META_CONN conn,
-        UCHAR group_index, BOOL *log_stat);
+        UCHAR group_index, UINT16 limit_id, UCHAR limit_io_bits, UINT16 quota_id, BOOL *log_stat);
 
 FORT_API void fort_flow_delete(PFORT_STAT stat, UINT64 flowContext);
 
-FORT_API void fort_flow_classify(
+FORT_API BOOL fort_flow_classify(
         PFORT_STAT stat, UINT64 flowContext, UINT32 data_len, BOOL inbound);
 
+FORT_API void fort_stat_quota_window_update(PFORT_STAT stat, UINT32 day_id, UINT32 month_id);
+
+FORT_API void fort_stat_quota_time_update(PFORT_STAT stat, LARGE_INTEGER system_time);
+
 FORT_API void fort_stat_dpc_begin(PFORT_STAT stat, PKLOCK_QUEUE_HANDLE lock_queue);
 
 FORT_API void fort_stat_dpc_end(PKLOCK_QUEUE_HANDLE lock_queue);
@@ -35,6 +35,30 @@ FORT_API PVOID fort_tommy_realloc(PVOID p, SIZE_T new_size)
     return NULL;
 }
 
+/* tommy_arrayof_grow() with checking of the segments' allocation */
+FORT_API BOOL fort_tommy_arrayof_grow(tommy_arrayof *array, tommy_size_t count)
+{
+    if (array->count >= count)
+        return TRUE;
+
+    while (count > array->bucket_max) {
+        unsigned char *segment = fort_tommy_calloc(array->bucket_max, array->element_size);
+        if (segment == NULL)
+            return FALSE; /* the allocated segments are kept */
+
+        /* Store it adjusting the offset */
+        array->bucket[array->bucket_bit] =
+                segment - (tommy_ptrdiff_t) array->bucket_max * array->element_size;
+
+        ++array->bucket_bit;
+        array->bucket_max = (tommy_size_t) 1 << array->bucket_bit;
+    }
+
+    array->count = count;
+
+    return TRUE;
+}
+
 #include "../3rdparty/tommyds/tommyarrayof.c"
 #include "../3rdparty/tommyds/tommyhash.c"
 #include "../3rdparty/tommyds/tommyhashdyn.c"
@@ -25,4 +25,14 @@ FORT_API PVOID fort_tommy_realloc(PVOID p, SIZE_T new_size);
 #include "../3rdparty/tommyds/tommyhash.h"
 #include "../3rdparty/tommyds/tommyhashdyn.h"
 
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+FORT_API BOOL fort_tommy_arrayof_grow(tommy_arrayof *array, tommy_size_t count);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
 #endif // FORTTDS_H
@@ -6,8 +6,18 @@
 
 #include <assert.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <wchar.h>
 
 #include "../fortcb.h"
+#include "../fortcnf.h"
+#include "../fortdev.h"
+#include "../fortpkt.h"
+#include "../fortpktq.h"
+#include "../fortpool.h"
+#include "../fortps.h"
+#include "../fortstat.h"
 #include "../fortutl.h"
 #include "../proxycb/fortpcb_drv.h"
 #include "../proxycb/fortpcb_src.h"
@@ -96,6 +106,1428 @@ static void test_utl_bits(void)
     assert(v == 0x33333333);
 }
 
+/* Shaper simulator: drives the packet queue core in virtual time */
+
+#define TEST_SHAPER_QPC_FREQUENCY 10000000LL /* 100ns ticks */
+#define TEST_SHAPER_TICK_MS       2 /* timeout of the shaper's thread */
+#define TEST_SHAPER_DURATION_MS   4000
+#define TEST_SHAPER_LATENCY_MAX   4096 /* size of the latency histogram in ms */
+#define TEST_SHAPER_GROUP_COUNT   4
+
+#define TEST_SHAPER_MS_TO_TICKS(ms) ((ms) * (TEST_SHAPER_QPC_FREQUENCY / 1000))
+
+typedef struct test_shaper_packet
+{
+    FORT_QUEUE_PACKET qpkt; /* must be first! */
+
+    LONGLONG arrival_tick;
+} TEST_SHAPER_PACKET, *PTEST_SHAPER_PACKET;
+
+typedef struct test_shaper_group
+{
+    const char *name;
+
+    FORT_SPEED_LIMIT limit;
+
+    UINT32 arrival_bps; /* rate of synthetic arrivals */
+    UINT32 packet_size;
+
+    LONGLONG next_arrival_tick;
+
+    FORT_PACKET_QUEUE queue;
+
+    UINT64 arrived_bytes;
+    UINT64 sent_bytes;
+    UINT32 arrived_count;
+    UINT32 sent_count;
+    UINT32 dropped_count;
+
+    UINT32 latency_hist[TEST_SHAPER_LATENCY_MAX];
+} TEST_SHAPER_GROUP, *PTEST_SHAPER_GROUP;
+
+static LONGLONG test_shaper_next_arrival(PTEST_SHAPER_GROUP group, PULONG seed)
+{
+    const LONGLONG interval =
+            (LONGLONG) group->packet_size * TEST_SHAPER_QPC_FREQUENCY / group->arrival_bps;
+
+    /* Poisson-like jitter: 50%..150% of the mean interval */
+    const LONGLONG jitter = (LONGLONG) (RtlRandomEx(seed) % 1001) * interval / 1000;
+
+    return group->next_arrival_tick + interval / 2 + jitter;
+}
+
+static void test_shaper_arrive(PTEST_SHAPER_GROUP group, LONGLONG now, PULONG seed)
+{
+    PFORT_PACKET_QUEUE queue = &group->queue;
+
+    ++group->arrived_count;
+    group->arrived_bytes += group->packet_size;
+
+    if (!fort_packet_queue_check_plr(queue, seed)
+            || !fort_packet_queue_check_buffer(queue, group->packet_size)) {
+        ++group->dropped_count;
+        return;
+    }
+
+    PTEST_SHAPER_PACKET pkt = calloc(1, sizeof(TEST_SHAPER_PACKET));
+    assert(pkt != NULL);
+
+    pkt->qpkt.flow = group;
+    pkt->qpkt.data_length = group->packet_size;
+    pkt->arrival_tick = now;
+
+    fort_packet_queue_add_packet(queue, &pkt->qpkt);
+
+    const UINT32 buffer_bytes = queue->limit.buffer_bytes;
+    assert(buffer_bytes == 0 || queue->queued_bytes <= buffer_bytes);
+}
+
+static BOOL test_shaper_process(PTEST_SHAPER_GROUP group, LONGLONG now)
+{
+    PFORT_PACKET_QUEUE queue = &group->queue;
+
+    const LARGE_INTEGER tick = { .QuadPart = now };
+    const LARGE_INTEGER qpcFrequency = { .QuadPart = TEST_SHAPER_QPC_FREQUENCY };
+
+    PFORT_QUEUE_PACKET qpkt = fort_packet_queue_process(queue, tick, qpcFrequency);
+
+    while (qpkt != NULL) {
+        PTEST_SHAPER_PACKET pkt = (PTEST_SHAPER_PACKET) qpkt;
+        qpkt = qpkt->next;
+
+        const LONGLONG latency_ms =
+                (now - pkt->arrival_tick) * 1000 / TEST_SHAPER_QPC_FREQUENCY;
+
+        ++group->latency_hist[latency_ms < TEST_SHAPER_LATENCY_MAX ? latency_ms
+                                                                   : TEST_SHAPER_LATENCY_MAX - 1];
+
+        ++group->sent_count;
+        group->sent_bytes += pkt->qpkt.data_length;
+
+        free(pkt);
+    }
+
+    return !fort_packet_queue_is_empty(queue);
+}
+
+static UINT32 test_shaper_latency_percentile(PTEST_SHAPER_GROUP group, UINT32 percent)
+{
+    const UINT32 rank = (group->sent_count * percent + 99) / 100;
+    UINT32 count = 0;
+
+    for (UINT32 i = 0; i < TEST_SHAPER_LATENCY_MAX; ++i) {
+        count += group->latency_hist[i];
+        if (count >= rank && count != 0)
+            return i;
+    }
+
+    return TEST_SHAPER_LATENCY_MAX;
+}
+
+static void test_shaper_run(PTEST_SHAPER_GROUP groups, int groups_count, ULONG seed)
+{
+    const LONGLONG end_tick = TEST_SHAPER_MS_TO_TICKS(TEST_SHAPER_DURATION_MS);
+    const LONGLONG tick_interval = TEST_SHAPER_MS_TO_TICKS(TEST_SHAPER_TICK_MS);
+
+    const LARGE_INTEGER start = { .QuadPart = 0 };
+
+    for (int i = 0; i < groups_count; ++i) {
+        PTEST_SHAPER_GROUP group = &groups[i];
+
+        fort_packet_queue_init(&group->queue, &group->limit, start);
+
+        group->next_arrival_tick = test_shaper_next_arrival(group, &seed);
+    }
+
+    /* The shaper's thread sleeps until a packet arrives or the timeout expires while active */
+    LONGLONG next_tick = -1;
+
+    for (;;) {
+        LONGLONG now = next_tick;
+        PTEST_SHAPER_GROUP arrival_group = NULL;
+
+        for (int i = 0; i < groups_count; ++i) {
+            PTEST_SHAPER_GROUP group = &groups[i];
+
+            if (now < 0 || group->next_arrival_tick < now) {
+                now = group->next_arrival_tick;
+                arrival_group = group;
+            }
+        }
+
+        if (now >= end_tick)
+            break;
+
+        if (arrival_group != NULL) {
+            test_shaper_arrive(arrival_group, now, &seed);
+
+            arrival_group->next_arrival_tick = test_shaper_next_arrival(arrival_group, &seed);
+        }
+
+        BOOL is_active = FALSE;
+        for (int i = 0; i < groups_count; ++i) {
+            is_active |= test_shaper_process(&groups[i], now);
+        }
+
+        next_tick = is_active ? now + tick_interval : -1;
+    }
+
+    /* Drop the rest */
+    for (int i = 0; i < groups_count; ++i) {
+        PFORT_QUEUE_PACKET qpkt = fort_packet_queue_get_packets(&groups[i].queue, NULL);
+
+        while (qpkt != NULL) {
+            PFORT_QUEUE_PACKET qpkt_next = qpkt->next;
+            free(qpkt);
+            qpkt = qpkt_next;
+        }
+    }
+}
+
+static void test_shaper_report(PTEST_SHAPER_GROUP group)
+{
+    const UINT32 rate = (UINT32) (group->sent_bytes * 1000 / TEST_SHAPER_DURATION_MS);
+    const UINT32 drop_rate = group->dropped_count * 10000 / group->arrived_count;
+
+    printf("test_shaper_sim: %s: rate=%u/%u bps drops=%u/%u (%u.%02u%%) latency: p0=%u p50=%u "
+           "p99=%u p100=%u ms\n",
+            group->name, rate, (UINT32) group->limit.bps, group->dropped_count,
+            group->arrived_count, drop_rate / 100, drop_rate % 100,
+            test_shaper_latency_percentile(group, 0), test_shaper_latency_percentile(group, 50),
+            test_shaper_latency_percentile(group, 99), test_shaper_latency_percentile(group, 100));
+}
+
+static void test_shaper_sim(void)
+{
+    static TEST_SHAPER_GROUP groups[TEST_SHAPER_GROUP_COUNT] = {
+        {
+                .name = "bandwidth",
+                .limit = { .bps = 64 * 1024 },
+                .arrival_bps = 128 * 1024,
+                .packet_size = 1024,
+        },
+        {
+                .name = "latency",
+                .limit = { .latency_ms = 50, .bps = 1024 * 1024 },
+                .arrival_bps = 256 * 1024,
+                .packet_size = 512,
+        },
+        {
+                .name = "plr",
+                .limit = { .plr = 1000, .bps = 1024 * 1024 },
+                .arrival_bps = 256 * 1024,
+                .packet_size = 512,
+        },
+        {
+                .name = "buffer",
+                .limit = { .buffer_bytes = 15000, .bps = 32 * 1024 },
+                .arrival_bps = 128 * 1024,
+                .packet_size = 1500,
+        },
+    };
+
+    test_shaper_run(groups, TEST_SHAPER_GROUP_COUNT, /*seed=*/33);
+
+    for (int i = 0; i < TEST_SHAPER_GROUP_COUNT; ++i) {
+        test_shaper_report(&groups[i]);
+    }
+
+    fflush(stdout);
+
+    /* Achieved rate is within 5% of the limit */
+    PTEST_SHAPER_GROUP bandwidth = &groups[0];
+    const UINT64 bandwidth_rate = bandwidth->sent_bytes * 1000 / TEST_SHAPER_DURATION_MS;
+    assert(bandwidth_rate * 100 >= bandwidth->limit.bps * 95);
+    assert(bandwidth_rate * 100 <= bandwidth->limit.bps * 105);
+    assert(bandwidth->dropped_count == 0);
+
+    /* Latency is delayed by the configured value within the thread's timeout */
+    PTEST_SHAPER_GROUP latency = &groups[1];
+    assert(test_shaper_latency_percentile(latency, 0) >= latency->limit.latency_ms - 1);
+    assert(test_shaper_latency_percentile(latency, 100)
+            <= latency->limit.latency_ms + TEST_SHAPER_TICK_MS);
+    assert(latency->dropped_count == 0);
+
+    /* Drop rate is close to the PLR */
+    PTEST_SHAPER_GROUP plr = &groups[2];
+    const UINT32 plr_rate = plr->dropped_count * 10000 / plr->arrived_count;
+    const UINT32 plr_limit = plr->limit.plr;
+    assert(plr_rate + 200 >= plr_limit && plr_rate <= plr_limit + 200);
+    assert(test_shaper_latency_percentile(plr, 100) <= TEST_SHAPER_TICK_MS);
+
+    /* Overflow of the buffer is dropped, the rest is shaped */
+    PTEST_SHAPER_GROUP buffer = &groups[3];
+    const UINT64 buffer_rate = buffer->sent_bytes * 1000 / TEST_SHAPER_DURATION_MS;
+    assert(buffer_rate * 100 >= buffer->limit.bps * 95);
+    assert(buffer_rate * 100 <= buffer->limit.bps * 105);
+    assert(buffer->dropped_count * 100 >= buffer->arrived_count * 60);
+}
+
+/* Exe apps lookup: index vs hash map */
+
+#define TEST_CONF_EXE_PATH_MAX      64
+#define TEST_CONF_EXE_LOOKUPS_COUNT 1000000
+
+#define TEST_CONF_EXE_RULE_ID(i) ((UINT16) ((i) & 0x1FFF)) /* 13 bits */
+
+static UINT16 test_conf_exe_path(PWCHAR path, UINT32 i)
+{
+    const int len = swprintf(path, TEST_CONF_EXE_PATH_MAX,
+            L"\\device\\harddiskvolume1\\programs\\app%u\\app.exe", i);
+
+    return (UINT16) (len * sizeof(WCHAR));
+}
+
+static PFORT_CONF_REF test_conf_exe_ref_new(UINT32 apps_count)
+{
+    const ULONG data_len =
+            apps_count * FORT_CONF_APP_ENTRY_SIZE(TEST_CONF_EXE_PATH_MAX * sizeof(WCHAR));
+    const ULONG conf_len = FORT_CONF_DATA_OFF + data_len;
+
+    PFORT_CONF conf = calloc(1, conf_len);
+    assert(conf != NULL);
+
+    conf->exe_apps_n = apps_count;
+
+    char *app_entries = conf->data;
+
+    for (UINT32 i = 0; i < apps_count; ++i) {
+        PFORT_APP_ENTRY entry = (PFORT_APP_ENTRY) app_entries;
+
+        entry->app_data.found = 1;
+        entry->app_data.rule_id = TEST_CONF_EXE_RULE_ID(i);
+        entry->path_len = test_conf_exe_path(entry->path, i);
+
+        app_entries += FORT_CONF_APP_ENTRY_SIZE(entry->path_len);
+    }
+
+    PFORT_CONF_REF conf_ref = fort_conf_ref_new(conf, conf_len);
+    assert(conf_ref != NULL);
+
+    free(conf);
+
+    return conf_ref;
+}
+
+static double test_conf_exe_lookups(PFORT_CONF_REF conf_ref, UINT32 apps_count, UINT32 *found)
+{
+    WCHAR buffer[TEST_CONF_EXE_PATH_MAX];
+    FORT_APP_PATH path = { .buffer = buffer };
+
+    ULONG seed = 33;
+    *found = 0;
+
+    const clock_t start = clock();
+
+    for (int i = 0; i < TEST_CONF_EXE_LOOKUPS_COUNT; ++i) {
+        /* Every 4th lookup misses */
+        const UINT32 app_index = RtlRandomEx(&seed) % (apps_count + apps_count / 3);
+
+        path.len = test_conf_exe_path(buffer, app_index);
+
+        const FORT_APP_DATA app_data = fort_conf_exe_find(&conf_ref->conf, conf_ref, &path);
+
+        if (app_data.found) {
+            assert(app_data.rule_id == TEST_CONF_EXE_RULE_ID(app_index));
+            ++*found;
+        }
+    }
+
+    const double secs = (double) (clock() - start) / CLOCKS_PER_SEC;
+
+    return TEST_CONF_EXE_LOOKUPS_COUNT / (secs > 0 ? secs : 1e-9);
+}
+
+static void test_conf_exe_overlay(PFORT_CONF_REF conf_ref, UINT32 apps_count)
+{
+    WCHAR buffer[TEST_CONF_EXE_PATH_MAX];
+    FORT_APP_PATH path = { .buffer = buffer };
+
+    /* Delete an indexed app */
+    path.len = test_conf_exe_path(buffer, 1);
+
+    {
+        PFORT_APP_ENTRY del_entry =
+                calloc(1, FORT_CONF_APP_ENTRY_SIZE(TEST_CONF_EXE_PATH_MAX * sizeof(WCHAR)));
+        assert(del_entry != NULL);
+
+        del_entry->path_len = test_conf_exe_path(del_entry->path, 1);
+
+        fort_conf_ref_exe_del_entry(conf_ref, del_entry);
+
+        free(del_entry);
+    }
+
+    assert(!fort_conf_exe_find(&conf_ref->conf, conf_ref, &path).found);
+
+    /* Add a new app into the overlay */
+    path.len = test_conf_exe_path(buffer, apps_count);
+
+    {
+        const FORT_APP_ENTRY app_entry = {
+            .app_data = { .found = 1, .is_new = 1, .rule_id = 7 },
+        };
+
+        const NTSTATUS status = fort_conf_ref_exe_add_path(conf_ref, &app_entry, &path);
+        assert(status == STATUS_SUCCESS);
+    }
+
+    assert(conf_ref->exe_overlay_n == 1);
+    assert(fort_conf_exe_find(&conf_ref->conf, conf_ref, &path).rule_id == 7);
+
+    /* Indexed apps are still found */
+    path.len = test_conf_exe_path(buffer, 2);
+    assert(fort_conf_exe_find(&conf_ref->conf, conf_ref, &path).rule_id == 2);
+}
+
+static void test_conf_exe_bench(UINT32 apps_count)
+{
+    PFORT_CONF_REF conf_ref = test_conf_exe_ref_new(apps_count);
+
+    assert(conf_ref->exe_index.tags != NULL);
+    assert(conf_ref->conf.exe_apps_n == apps_count);
+
+    UINT32 index_found;
+    const double index_rate = test_conf_exe_lookups(conf_ref, apps_count, &index_found);
+
+    /* Lookup in the exe map without the index */
+    const FORT_CONF_EXE_INDEX exe_index = conf_ref->exe_index;
+    RtlZeroMemory(&conf_ref->exe_index, sizeof(FORT_CONF_EXE_INDEX));
+
+    UINT32 map_found;
+    const double map_rate = test_conf_exe_lookups(conf_ref, apps_count, &map_found);
+
+    conf_ref->exe_index = exe_index;
+
+    assert(index_found == map_found);
+
+    printf("test_conf_exe_bench: apps=%u found=%u lookups/s: index=%.0f map=%.0f\n",
+            apps_count, index_found, index_rate, map_rate);
+
+    fflush(stdout);
+
+    test_conf_exe_overlay(conf_ref, apps_count);
+
+    /* The conf_ref is freed by the device's conf only */
+}
+
+/* Device conf: readers take the conf_ref while it's republished */
+
+#define TEST_CONF_EPOCH_READERS_COUNT 4
+#define TEST_CONF_EPOCH_UPDATES_COUNT 2000
+#define TEST_CONF_EPOCH_APPS_COUNT    8
+
+typedef struct test_conf_epoch
+{
+    FORT_DEVICE_CONF device_conf;
+
+    LONG volatile stop;
+    LONG volatile takes_count;
+} TEST_CONF_EPOCH, *PTEST_CONF_EPOCH;
+
+static DWORD WINAPI test_conf_epoch_reader(LPVOID param)
+{
+    PTEST_CONF_EPOCH tc = param;
+
+    while (!tc->stop) {
+        PFORT_CONF_REF conf_ref = fort_conf_ref_take(&tc->device_conf);
+
+        /* The conf is always published */
+        assert(conf_ref != NULL);
+        assert(conf_ref->conf.exe_apps_n == TEST_CONF_EPOCH_APPS_COUNT);
+
+        fort_conf_ref_put(&tc->device_conf, conf_ref);
+
+        InterlockedIncrement(&tc->takes_count);
+    }
+
+    return 0;
+}
+
+static void test_conf_epoch_stress(void)
+{
+    static TEST_CONF_EPOCH tc;
+
+    assert(fort_device_conf_open(&tc.device_conf) == STATUS_SUCCESS);
+
+    fort_conf_ref_set(&tc.device_conf, test_conf_exe_ref_new(TEST_CONF_EPOCH_APPS_COUNT));
+
+    HANDLE threads[TEST_CONF_EPOCH_READERS_COUNT];
+
+    for (int i = 0; i < TEST_CONF_EPOCH_READERS_COUNT; ++i) {
+        threads[i] = CreateThread(NULL, 0, &test_conf_epoch_reader, &tc, 0, NULL);
+        assert(threads[i] != NULL);
+    }
+
+    for (int i = 0; i < TEST_CONF_EPOCH_UPDATES_COUNT; ++i) {
+        fort_conf_ref_set(&tc.device_conf, test_conf_exe_ref_new(TEST_CONF_EPOCH_APPS_COUNT));
+    }
+
+    InterlockedExchange(&tc.stop, 1);
+
+    WaitForMultipleObjects(TEST_CONF_EPOCH_READERS_COUNT, threads, TRUE, INFINITE);
+
+    for (int i = 0; i < TEST_CONF_EPOCH_READERS_COUNT; ++i) {
+        CloseHandle(threads[i]);
+    }
+
+    printf("test_conf_epoch_stress: updates=%d takes=%d\n", TEST_CONF_EPOCH_UPDATES_COUNT,
+            (int) tc.takes_count);
+
+    fort_conf_ref_set(&tc.device_conf, NULL);
+
+    fort_device_conf_close(&tc.device_conf);
+}
+
+/* Device: app updates queue the reauth only when they change the conf */
+
+#define TEST_DEVICE_APPS_COUNT 4
+
+static ULONG test_device_apps_entry(char *data, UINT32 i, UINT16 rule_id)
+{
+    PFORT_APP_ENTRY app_entry = (PFORT_APP_ENTRY) data;
+
+    RtlZeroMemory(app_entry, FORT_CONF_APP_ENTRY_PATH_OFF);
+
+    app_entry->app_data.found = 1;
+    app_entry->app_data.rule_id = rule_id;
+    app_entry->path_len = test_conf_exe_path(app_entry->path, i);
+
+    return FORT_CONF_APP_ENTRY_SIZE(app_entry->path_len);
+}
+
+static int test_device_apps_reauths(const char *data, ULONG len, BOOL is_adding, NTSTATUS status)
+{
+    PFORT_WORKER worker = &fort_device()->worker;
+
+    /* The work item is not run in the test: re-arm the queueing */
+    worker->id_bits = 0;
+
+    const SHORT queue_size = worker->queue_size;
+
+    assert(fort_device_apps_conf(data, len, is_adding) == status);
+
+    return worker->queue_size - queue_size;
+}
+
+static void test_device_apps_reauth(void)
+{
+    static FORT_DEVICE device;
+    static char data[TEST_DEVICE_APPS_COUNT * 2
+            * FORT_CONF_APP_ENTRY_SIZE(TEST_CONF_EXE_PATH_MAX * sizeof(WCHAR))];
+
+    fort_device_set(&device);
+
+    assert(fort_device_conf_open(&device.conf) == STATUS_SUCCESS);
+
+    fort_conf_ref_set(&device.conf, test_conf_exe_ref_new(TEST_DEVICE_APPS_COUNT));
+
+    ULONG len;
+
+    /* The same app data */
+    len = test_device_apps_entry(data, 1, TEST_CONF_EXE_RULE_ID(1));
+    assert(test_device_apps_reauths(data, len, /*is_adding=*/TRUE, STATUS_SUCCESS) == 0);
+
+    /* The batch of the same apps' data */
+    len = 0;
+    for (UINT32 i = 0; i < TEST_DEVICE_APPS_COUNT; ++i) {
+        len += test_device_apps_entry(data + len, i, TEST_CONF_EXE_RULE_ID(i));
+    }
+    assert(test_device_apps_reauths(data, len, /*is_adding=*/TRUE, STATUS_SUCCESS) == 0);
+
+    /* Deleting a missing app */
+    len = test_device_apps_entry(data, TEST_DEVICE_APPS_COUNT, 0);
+    assert(test_device_apps_reauths(data, len, /*is_adding=*/FALSE, STATUS_SUCCESS) == 0);
+
+    /* The batch with a truncated entry changes nothing */
+    len = test_device_apps_entry(data, 1, /*rule_id=*/77);
+    len += test_device_apps_entry(data + len, 2, /*rule_id=*/77);
+    assert(test_device_apps_reauths(data, len - 1, /*is_adding=*/TRUE, STATUS_UNSUCCESSFUL)
+            == 0);
+
+    /* The changed apps' data: one reauth for the batch */
+    assert(test_device_apps_reauths(data, len, /*is_adding=*/TRUE, STATUS_SUCCESS) == 1);
+
+    /* Deleting an existing app */
+    len = test_device_apps_entry(data, 3, 0);
+    assert(test_device_apps_reauths(data, len, /*is_adding=*/FALSE, STATUS_SUCCESS) == 1);
+
+    printf("test_device_apps_reauth: reauths=%d\n", (int) device.worker.queue_size);
+
+    fort_conf_ref_set(&device.conf, NULL);
+
+    fort_device_conf_close(&device.conf);
+
+    fort_device_set(NULL);
+}
+
+/* Process tree: names lookup under the process notifications */
+
+#define TEST_PSTREE_EVENTS_COUNT      100000
+#define TEST_PSTREE_LOOKUPS_PER_EVENT 10
+#define TEST_PSTREE_PROCS_COUNT       256 /* processes with service names */
+#define TEST_PSTREE_PIDS_RANGE        (TEST_PSTREE_PROCS_COUNT * 16)
+
+#define TEST_PSTREE_PID(i) ((DWORD) (((i) + 2) * 4)) /* skip System (sub)processes */
+
+static UINT16 test_pstree_service_name(PWCHAR name, UINT32 name_id)
+{
+    /* Lower case: the driver downcases service names */
+    const int len = swprintf(name, FORT_SERVICE_INFO_NAME_MAX, L"testsvc%u", name_id);
+
+    return (UINT16) (len * sizeof(WCHAR));
+}
+
+#define TEST_PSTREE_SERVICES_MAX 16 /* per message */
+
+typedef struct test_pstree_services
+{
+    ULONG data_len;
+
+    union {
+        FORT_SERVICE_INFO_LIST list;
+        char data[FORT_SERVICE_INFO_LIST_DATA_OFF
+                + TEST_PSTREE_SERVICES_MAX * FORT_SERVICE_INFO_MAX_SIZE];
+    };
+} TEST_PSTREE_SERVICES, *PTEST_PSTREE_SERVICES;
+
+static void test_pstree_services_add(
+        PTEST_PSTREE_SERVICES services, DWORD processId, UINT32 name_id)
+{
+    assert(services->list.services_n < TEST_PSTREE_SERVICES_MAX);
+
+    PFORT_SERVICE_INFO service =
+            (PFORT_SERVICE_INFO) ((PCHAR) services->list.data + services->data_len);
+
+    service->process_id = processId;
+    service->name_len = test_pstree_service_name(service->name, name_id);
+
+    services->data_len += FORT_SERVICE_INFO_NAME_OFF + FORT_CONF_STR_DATA_SIZE(service->name_len);
+
+    ++services->list.services_n;
+}
+
+static void test_pstree_services_update(PFORT_PSTREE ps_tree, PTEST_PSTREE_SERVICES services)
+{
+    fort_pstree_update_services(ps_tree, &services->list, services->data_len);
+
+    services->list.services_n = 0;
+    services->data_len = 0;
+}
+
+static void test_pstree_service_update(PFORT_PSTREE ps_tree, DWORD processId, UINT32 name_id)
+{
+    TEST_PSTREE_SERVICES services = { 0 };
+
+    test_pstree_services_add(&services, processId, name_id);
+    test_pstree_services_update(ps_tree, &services);
+}
+
+static void test_pstree_proc_exited(DWORD processId)
+{
+    um_ps_notify_process((HANDLE) (ptrdiff_t) processId, /*createInfo=*/NULL);
+}
+
+static BOOL test_pstree_lookup(PFORT_PSTREE ps_tree, DWORD processId, UINT32 name_id, BOOL alive)
+{
+    FORT_APP_PATH path;
+    BOOL inherited = FALSE;
+
+    const BOOL res = fort_pstree_get_proc_name(ps_tree, processId, &path, &inherited);
+    assert(res == alive);
+
+    if (res) {
+        WCHAR name[FORT_SERVICE_INFO_NAME_MAX];
+        const UINT16 name_len = test_pstree_service_name(name, name_id);
+
+        /* The service name is prefixed */
+        assert(!inherited);
+        assert(path.len > name_len);
+        assert(memcmp((PCHAR) path.buffer + path.len - name_len, name, name_len) == 0);
+    }
+
+    /* Lookup passed without the lock? */
+    const tommy_key_t pid_hash = tommy_inthash_u32(processId);
+
+    return ps_tree->names_filter[pid_hash & (FORT_PSTREE_NAMES_FILTER_SIZE - 1)] == 0;
+}
+
+static PFORT_PSTREE test_pstree_open(void)
+{
+    PFORT_DEVICE device = calloc(1, sizeof(FORT_DEVICE));
+    assert(device != NULL);
+
+    fort_device_set(device);
+
+    PFORT_PSTREE ps_tree = &device->ps_tree;
+
+    fort_pstree_open(ps_tree);
+
+    return ps_tree;
+}
+
+static void test_pstree_close(PFORT_PSTREE ps_tree)
+{
+    fort_pstree_close(ps_tree);
+
+    PFORT_DEVICE device = fort_device();
+
+    fort_device_set(NULL);
+
+    free(device);
+}
+
+static void test_pstree_names(void)
+{
+    PFORT_PSTREE ps_tree = test_pstree_open();
+
+    BOOL alive[TEST_PSTREE_PROCS_COUNT] = { 0 };
+    UINT32 lookups_n = 0;
+    UINT32 unlocked_n = 0;
+
+    ULONG seed = 33;
+
+    const clock_t start = clock();
+
+    /* Interleave the create/exit events with the lookups */
+    for (int i = 0; i < TEST_PSTREE_EVENTS_COUNT; ++i) {
+        const UINT32 proc_index = RtlRandomEx(&seed) % TEST_PSTREE_PROCS_COUNT;
+        const DWORD processId = TEST_PSTREE_PID(proc_index);
+
+        if (alive[proc_index]) {
+            test_pstree_proc_exited(processId);
+        } else {
+            test_pstree_service_update(ps_tree, processId, /*name_id=*/processId);
+        }
+
+        alive[proc_index] = !alive[proc_index];
+
+        for (int j = 0; j < TEST_PSTREE_LOOKUPS_PER_EVENT; ++j) {
+            const UINT32 pid_index = RtlRandomEx(&seed) % TEST_PSTREE_PIDS_RANGE;
+            const DWORD pid = TEST_PSTREE_PID(pid_index);
+            const BOOL is_alive = (pid_index < TEST_PSTREE_PROCS_COUNT && alive[pid_index]);
+
+            if (test_pstree_lookup(ps_tree, pid, /*name_id=*/pid, is_alive)) {
+                ++unlocked_n;
+            }
+            ++lookups_n;
+        }
+    }
+
+    const double secs = (double) (clock() - start) / CLOCKS_PER_SEC;
+
+    printf("test_pstree_names: events=%d lookups=%u unlocked=%u (%u%%) ops/s=%.0f\n",
+            TEST_PSTREE_EVENTS_COUNT, lookups_n, unlocked_n, unlocked_n * 100 / lookups_n,
+            (TEST_PSTREE_EVENTS_COUNT + lookups_n) / (secs > 0 ? secs : 1e-9));
+
+    fflush(stdout);
+
+    /* Exit all processes: the names filter must be empty */
+    for (int i = 0; i < TEST_PSTREE_PROCS_COUNT; ++i) {
+        if (alive[i]) {
+            test_pstree_proc_exited(TEST_PSTREE_PID(i));
+        }
+    }
+
+    for (int i = 0; i < FORT_PSTREE_NAMES_FILTER_SIZE; ++i) {
+        assert(ps_tree->names_filter[i] == 0);
+    }
+
+    assert(ps_tree->procs_n == 0);
+
+    /* Stop all services */
+    for (int i = 0; i < TEST_PSTREE_PROCS_COUNT; ++i) {
+        const DWORD processId = TEST_PSTREE_PID(i);
+
+        test_pstree_service_update(ps_tree, /*processId=*/0, /*name_id=*/processId);
+    }
+
+    assert(ps_tree->names_n == 0);
+
+    test_pstree_close(ps_tree);
+}
+
+#define TEST_PSTREE_INTERN_RESTARTS_COUNT 1000
+#define TEST_PSTREE_INTERN_NAMES_COUNT    10
+
+static void test_pstree_names_intern(void)
+{
+    PFORT_PSTREE ps_tree = test_pstree_open();
+
+    PVOID name_buffer = NULL;
+
+    /* Services are restarted many times with new processes */
+    for (int i = 0; i < TEST_PSTREE_INTERN_RESTARTS_COUNT; ++i) {
+        const UINT32 name_id = i % TEST_PSTREE_INTERN_NAMES_COUNT;
+        const DWORD processId = TEST_PSTREE_PID(i);
+
+        test_pstree_service_update(ps_tree, processId, name_id);
+
+        if (name_id == 1) {
+            FORT_APP_PATH path;
+            BOOL inherited;
+
+            assert(fort_pstree_get_proc_name(ps_tree, processId, &path, &inherited));
+
+            /* The interned name is reused */
+            assert(name_buffer == NULL || name_buffer == path.buffer);
+            name_buffer = path.buffer;
+        }
+    }
+
+    printf("test_pstree_names_intern: procs=%u names=%u saved=%u bytes\n", ps_tree->procs_n,
+            ps_tree->names_n, ps_tree->names_saved_size);
+
+    fflush(stdout);
+
+    assert(ps_tree->procs_n == TEST_PSTREE_INTERN_RESTARTS_COUNT);
+    assert(ps_tree->names_n == TEST_PSTREE_INTERN_NAMES_COUNT);
+    assert(ps_tree->names_saved_size != 0);
+
+    for (int i = 0; i < TEST_PSTREE_INTERN_RESTARTS_COUNT; ++i) {
+        test_pstree_proc_exited(TEST_PSTREE_PID(i));
+    }
+
+    for (int i = 0; i < TEST_PSTREE_INTERN_NAMES_COUNT; ++i) {
+        test_pstree_service_update(ps_tree, /*processId=*/0, /*name_id=*/i);
+    }
+
+    assert(ps_tree->names_n == 0);
+    assert(ps_tree->names_saved_size == 0);
+
+    test_pstree_close(ps_tree);
+}
+
+#define TEST_PSTREE_CHURN_SERVICES_COUNT 500
+#define TEST_PSTREE_CHURN_ROUNDS_COUNT   1000
+#define TEST_PSTREE_CHURN_CHANGES_COUNT  8 /* per message */
+
+static void test_pstree_services_churn(void)
+{
+    PFORT_PSTREE ps_tree = test_pstree_open();
+
+    TEST_PSTREE_SERVICES services = { 0 };
+
+    DWORD pids[TEST_PSTREE_CHURN_SERVICES_COUNT];
+    DWORD next_pid = TEST_PSTREE_PID(1000);
+
+    /* Full list of the running services */
+    for (int i = 0; i < TEST_PSTREE_CHURN_SERVICES_COUNT; ++i) {
+        pids[i] = next_pid;
+        next_pid += 4;
+
+        test_pstree_services_add(&services, pids[i], /*name_id=*/i);
+
+        if (services.list.services_n == TEST_PSTREE_SERVICES_MAX) {
+            test_pstree_services_update(ps_tree, &services);
+        }
+    }
+    test_pstree_services_update(ps_tree, &services);
+
+    assert(ps_tree->names_n == TEST_PSTREE_CHURN_SERVICES_COUNT);
+
+    ULONG seed = 33;
+
+    const clock_t start = clock();
+
+    /* Added, removed and pid-changed services */
+    for (int i = 0; i < TEST_PSTREE_CHURN_ROUNDS_COUNT; ++i) {
+        DWORD old_pids[TEST_PSTREE_CHURN_CHANGES_COUNT];
+
+        for (int j = 0; j < TEST_PSTREE_CHURN_CHANGES_COUNT; ++j) {
+            const UINT32 name_id = RtlRandomEx(&seed) % TEST_PSTREE_CHURN_SERVICES_COUNT;
+            const DWORD old_pid = pids[name_id];
+
+            if (old_pid != 0 && (RtlRandomEx(&seed) & 1) != 0) {
+                /* Stopped */
+                test_pstree_proc_exited(old_pid);
+                pids[name_id] = 0;
+            } else {
+                /* Started or restarted, the old process may be still alive */
+                pids[name_id] = next_pid;
+                next_pid += 4;
+            }
+
+            old_pids[j] = old_pid;
+
+            test_pstree_services_add(&services, pids[name_id], name_id);
+        }
+
+        test_pstree_services_update(ps_tree, &services);
+
+        /* The previous processes don't have the service names */
+        for (int j = 0; j < TEST_PSTREE_CHURN_CHANGES_COUNT; ++j) {
+            const DWORD old_pid = old_pids[j];
+
+            if (old_pid != 0) {
+                test_pstree_lookup(ps_tree, old_pid, /*name_id=*/0, /*alive=*/FALSE);
+            }
+        }
+    }
+
+    const double secs = (double) (clock() - start) / CLOCKS_PER_SEC;
+
+    printf("test_pstree_services_churn: services=%d messages=%d changes=%d msg/s=%.0f\n",
+            TEST_PSTREE_CHURN_SERVICES_COUNT, TEST_PSTREE_CHURN_ROUNDS_COUNT,
+            TEST_PSTREE_CHURN_ROUNDS_COUNT * TEST_PSTREE_CHURN_CHANGES_COUNT,
+            TEST_PSTREE_CHURN_ROUNDS_COUNT / (secs > 0 ? secs : 1e-9));
+
+    fflush(stdout);
+
+    /* The running services resolve to their names */
+    UINT32 running_n = 0;
+
+    for (int i = 0; i < TEST_PSTREE_CHURN_SERVICES_COUNT; ++i) {
+        if (pids[i] != 0) {
+            test_pstree_lookup(ps_tree, pids[i], /*name_id=*/i, /*alive=*/TRUE);
+            ++running_n;
+        }
+    }
+
+    assert(ps_tree->names_n == running_n);
+
+    /* Stop all services */
+    for (int i = 0; i < TEST_PSTREE_CHURN_SERVICES_COUNT; ++i) {
+        if (pids[i] == 0)
+            continue;
+
+        test_pstree_services_add(&services, /*processId=*/0, /*name_id=*/i);
+
+        if (services.list.services_n == TEST_PSTREE_SERVICES_MAX) {
+            test_pstree_services_update(ps_tree, &services);
+        }
+    }
+    test_pstree_services_update(ps_tree, &services);
+
+    assert(ps_tree->names_n == 0);
+
+    test_pstree_close(ps_tree);
+}
+
+/* Pool allocator: mixed sizes and bursts */
+
+#define TEST_POOL_LIVE_COUNT  10000
+#define TEST_POOL_OPS_COUNT   1000000
+#define TEST_POOL_BURST_COUNT 100000
+#define TEST_POOL_SIZE_MIN    16
+#define TEST_POOL_SIZE_MAX    512
+
+static UINT32 test_pool_size(PULONG seed)
+{
+    return TEST_POOL_SIZE_MIN + RtlRandomEx(seed) % (TEST_POOL_SIZE_MAX - TEST_POOL_SIZE_MIN);
+}
+
+static void test_pool_report(PFORT_POOL_LIST pool_list, const char *title)
+{
+    FORT_POOL_STAT stat;
+    fort_pool_stat(pool_list, &stat);
+
+    const UINT32 frag_percent = (stat.free_size == 0)
+            ? 0
+            : 100 - (UINT32) ((UINT64) stat.free_max_size * 100 / stat.free_size);
+
+    printf("test_pool_bench: %s: pools=%u size=%u used=%u free=%u fragmentation=%u%%\n", title,
+            stat.pools_n, stat.pools_size, stat.used_size, stat.free_size, frag_percent);
+
+    fflush(stdout);
+}
+
+static void test_pool_bench(void)
+{
+    FORT_POOL_LIST pool_list;
+    fort_pool_list_init(&pool_list);
+    fort_pool_init(&pool_list, 0);
+
+    PVOID *blocks = calloc(TEST_POOL_BURST_COUNT, sizeof(PVOID));
+    assert(blocks != NULL);
+
+    ULONG seed = 33;
+
+    /* Random frees and allocations of the live blocks */
+    for (int i = 0; i < TEST_POOL_LIVE_COUNT; ++i) {
+        blocks[i] = fort_pool_malloc(&pool_list, test_pool_size(&seed));
+        assert(blocks[i] != NULL);
+    }
+
+    const clock_t start = clock();
+
+    for (int i = 0; i < TEST_POOL_OPS_COUNT; ++i) {
+        const UINT32 index = RtlRandomEx(&seed) % TEST_POOL_LIVE_COUNT;
+
+        fort_pool_free(&pool_list, blocks[index]);
+
+        blocks[index] = fort_pool_malloc(&pool_list, test_pool_size(&seed));
+        assert(blocks[index] != NULL);
+    }
+
+    const double secs = (double) (clock() - start) / CLOCKS_PER_SEC;
+
+    printf("test_pool_bench: live=%d free+malloc/s=%.0f\n", TEST_POOL_LIVE_COUNT,
+            TEST_POOL_OPS_COUNT / (secs > 0 ? secs : 1e-9));
+
+    test_pool_report(&pool_list, "mixed");
+
+    /* Burst */
+    for (int i = TEST_POOL_LIVE_COUNT; i < TEST_POOL_BURST_COUNT; ++i) {
+        blocks[i] = fort_pool_malloc(&pool_list, test_pool_size(&seed));
+        assert(blocks[i] != NULL);
+    }
+
+    test_pool_report(&pool_list, "burst");
+
+    for (int i = 0; i < TEST_POOL_BURST_COUNT; ++i) {
+        fort_pool_free(&pool_list, blocks[i]);
+    }
+
+    test_pool_report(&pool_list, "freed");
+
+    /* Empty pools are returned back */
+    assert(pool_list.pools_n == 1);
+    assert(pool_list.used_size == 0);
+
+    free(blocks);
+
+    fort_pool_done(&pool_list);
+}
+
+/* Pool allocator: the added pools are reclaimed, when emptied */
+
+#define TEST_POOL_RECLAIM_BLOCK_SIZE 64
+#define TEST_POOL_RECLAIM_BIG_SIZE   (128 * 1024)
+#define TEST_POOL_RECLAIM_MAX_COUNT  4096
+#define TEST_POOL_RECLAIM_ADD_COUNT  100
+
+static void test_pool_reclaim(void)
+{
+    FORT_POOL_LIST pool_list;
+    fort_pool_list_init(&pool_list);
+    fort_pool_init(&pool_list, 0);
+
+    assert(pool_list.pools_n == 1);
+
+    /* The big block takes an added pool */
+    {
+        PVOID big_block = fort_pool_malloc(&pool_list, TEST_POOL_RECLAIM_BIG_SIZE);
+        assert(big_block != NULL);
+
+        assert(pool_list.pools_n == 2);
+        assert(pool_list.empty_pools_n == 0);
+
+        fort_pool_free(&pool_list, big_block);
+
+        assert(pool_list.pools_n == 1);
+        assert(pool_list.empty_pools_n == 0);
+    }
+
+    PVOID *blocks = calloc(TEST_POOL_RECLAIM_MAX_COUNT, sizeof(PVOID));
+    assert(blocks != NULL);
+
+    /* Small blocks overflow the first pool */
+    int count = 0;
+
+    while (pool_list.pools_n == 1) {
+        assert(count < TEST_POOL_RECLAIM_MAX_COUNT);
+
+        blocks[count] = fort_pool_malloc(&pool_list, TEST_POOL_RECLAIM_BLOCK_SIZE);
+        assert(blocks[count++] != NULL);
+    }
+
+    const int first_count = count - 1; /* the last block is in the added pool */
+
+    for (int i = 0; i < TEST_POOL_RECLAIM_ADD_COUNT; ++i) {
+        blocks[count] = fort_pool_malloc(&pool_list, TEST_POOL_RECLAIM_BLOCK_SIZE);
+        assert(blocks[count++] != NULL);
+    }
+
+    assert(pool_list.pools_n == 2);
+    assert(pool_list.empty_pools_n == 0);
+
+    /* The emptied pool is kept, while the first pool is full */
+    for (int i = first_count; i < count; ++i) {
+        fort_pool_free(&pool_list, blocks[i]);
+    }
+
+    assert(pool_list.pools_n == 2);
+    assert(pool_list.empty_pools_n == 1);
+
+    /* The emptied pool is reclaimed, when the first pool is freed enough */
+    for (int i = 0; i < first_count; ++i) {
+        fort_pool_free(&pool_list, blocks[i]);
+    }
+
+    assert(pool_list.pools_n == 1);
+    assert(pool_list.empty_pools_n == 0);
+    assert(pool_list.used_size == 0);
+
+    free(blocks);
+
+    fort_pool_done(&pool_list);
+}
+
+/* Pending apps: many apps, batched decisions, verdicts and expiry */
+
+#define TEST_PENDING_APP_COUNT    3000
+#define TEST_PENDING_APP_PACKETS  2
+#define TEST_PENDING_PATH_MAX     64
+#define TEST_PENDING_EXPIRE_SECS  5
+
+typedef struct test_pending_conn
+{
+    FWPS_INCOMING_VALUE0 values[FWPS_FIELD_ALE_AUTH_RECV_ACCEPT_V4_MAX];
+    FWPS_INCOMING_VALUES0 fixed_values;
+    FWPS_INCOMING_METADATA_VALUES0 meta_values;
+
+    FORT_CALLOUT_ARG ca;
+    FORT_CALLOUT_ALE_EXTRA cx;
+
+    WCHAR path[TEST_PENDING_PATH_MAX];
+} TEST_PENDING_CONN, *PTEST_PENDING_CONN;
+
+static UINT16 test_pending_app_path(PWCHAR path, UINT32 app_id)
+{
+    const int len = swprintf(
+            path, TEST_PENDING_PATH_MAX, L"\\device\\harddiskvolume1\\app%u.exe", app_id);
+
+    return (UINT16) (len * sizeof(WCHAR));
+}
+
+static void test_pending_conn_init(PTEST_PENDING_CONN tc)
+{
+    RtlZeroMemory(tc, sizeof(TEST_PENDING_CONN));
+
+    tc->fixed_values.layerId = FWPS_LAYER_ALE_AUTH_RECV_ACCEPT_V4;
+    tc->fixed_values.valueCount = FWPS_FIELD_ALE_AUTH_RECV_ACCEPT_V4_MAX;
+    tc->fixed_values.incomingValue = tc->values;
+
+    tc->ca.inFixedValues = &tc->fixed_values;
+    tc->ca.inMetaValues = &tc->meta_values;
+    tc->ca.inbound = TRUE;
+}
+
+static BOOL test_pending_add(
+        PFORT_PENDING pending, PTEST_PENDING_CONN tc, UINT32 app_id, UINT32 process_id)
+{
+    PFORT_CONF_META_CONN conn = &tc->cx.conn;
+
+    conn->process_id = process_id;
+    conn->real_path.len = test_pending_app_path(tc->path, app_id);
+    conn->real_path.buffer = tc->path;
+
+    return fort_pending_add_packet(pending, &tc->ca, &tc->cx);
+}
+
+static UCHAR test_pending_verdict(PFORT_PENDING pending, UINT32 app_id)
+{
+    WCHAR path_buf[TEST_PENDING_PATH_MAX];
+
+    const FORT_APP_PATH path = {
+        .len = test_pending_app_path(path_buf, app_id),
+        .buffer = path_buf,
+    };
+
+    return fort_pending_app_verdict(pending, &path);
+}
+
+static PFORT_PENDING_DECISION_LIST test_pending_decisions_new(
+        UINT32 app_id_from, UINT32 app_id_to, UINT32 *data_len)
+{
+    const UINT32 decisions_n = app_id_to - app_id_from;
+
+    PFORT_PENDING_DECISION_LIST decisions = calloc(1,
+            FORT_PENDING_DECISION_LIST_DATA_OFF + decisions_n * FORT_PENDING_DECISION_MAX_SIZE);
+    assert(decisions != NULL);
+
+    decisions->decisions_n = (UINT16) decisions_n;
+
+    char *data = (char *) &decisions->data;
+    UINT32 len = 0;
+
+    for (UINT32 app_id = app_id_from; app_id < app_id_to; ++app_id) {
+        PFORT_PENDING_DECISION decision = (PFORT_PENDING_DECISION) (data + len);
+
+        decision->allow = (app_id & 1);
+        decision->path_len = test_pending_app_path(decision->path, app_id);
+
+        len += FORT_PENDING_DECISION_PATH_OFF + FORT_CONF_STR_DATA_SIZE(decision->path_len);
+    }
+
+    *data_len = len;
+
+    return decisions;
+}
+
+static void test_pending_apps(void)
+{
+    PFORT_DEVICE device = calloc(1, sizeof(FORT_DEVICE));
+    assert(device != NULL);
+
+    fort_device_set(device);
+
+    PFORT_PENDING pending = &device->pending;
+
+    fort_pending_open(pending);
+
+    const FORT_PENDING_LIMITS limits = { .expire_secs = TEST_PENDING_EXPIRE_SECS };
+    fort_pending_set_limits(pending, &limits);
+
+    TEST_PENDING_CONN tc;
+    test_pending_conn_init(&tc);
+
+    /* Pend the connections of more apps, than the old fixed limit was */
+    const clock_t start = clock();
+
+    for (UINT32 i = 0; i < TEST_PENDING_APP_PACKETS; ++i) {
+        for (UINT32 app_id = 0; app_id < TEST_PENDING_APP_COUNT; ++app_id) {
+            const BOOL res = test_pending_add(pending, &tc, app_id, /*process_id=*/100 + i);
+            assert(res);
+        }
+    }
+
+    const double secs = (double) (clock() - start) / CLOCKS_PER_SEC;
+
+    printf("test_pending_apps: apps=%u packets=%u add/s=%.0f\n", pending->app_count,
+            pending->packet_count,
+            TEST_PENDING_APP_COUNT * TEST_PENDING_APP_PACKETS / (secs > 0 ? secs : 1e-9));
+
+    fflush(stdout);
+
+    /* Connections of one app are aggregated */
+    assert(pending->app_count == TEST_PENDING_APP_COUNT);
+    assert(pending->packet_count == TEST_PENDING_APP_COUNT * TEST_PENDING_APP_PACKETS);
+
+    /* Per-app limit */
+    for (UINT32 i = TEST_PENDING_APP_PACKETS; i < FORT_PENDING_APP_PACKET_COUNT_MAX; ++i) {
+        assert(test_pending_add(pending, &tc, /*app_id=*/0, /*process_id=*/200));
+    }
+    assert(!test_pending_add(pending, &tc, /*app_id=*/0, /*process_id=*/200));
+
+    /* Answer the first half of apps at once */
+    UINT32 data_len;
+    PFORT_PENDING_DECISION_LIST decisions =
+            test_pending_decisions_new(0, TEST_PENDING_APP_COUNT / 2, &data_len);
+
+    fort_pending_decide(pending, decisions, data_len);
+
+    free(decisions);
+
+    /* The decided apps keep their verdicts for the re-authorized connections */
+    assert(pending->app_count == TEST_PENDING_APP_COUNT);
+    assert(pending->packet_count == TEST_PENDING_APP_COUNT / 2 * TEST_PENDING_APP_PACKETS);
+
+    assert(test_pending_verdict(pending, /*app_id=*/1) == FORT_PENDING_VERDICT_ALLOW);
+    assert(test_pending_verdict(pending, /*app_id=*/2) == FORT_PENDING_VERDICT_DENY);
+    assert(test_pending_verdict(pending, TEST_PENDING_APP_COUNT / 2)
+            == FORT_PENDING_VERDICT_NONE);
+    assert(test_pending_verdict(pending, TEST_PENDING_APP_COUNT)
+            == FORT_PENDING_VERDICT_UNKNOWN);
+
+    /* Decided app is pended again */
+    assert(test_pending_add(pending, &tc, /*app_id=*/0, /*process_id=*/300));
+    assert(test_pending_verdict(pending, /*app_id=*/0) == FORT_PENDING_VERDICT_NONE);
+
+    /* Expire the unanswered apps and the verdicts */
+    const UINT32 expire_ticks = TEST_PENDING_EXPIRE_SECS * 1000 / FORT_PENDING_TICK_MS;
+
+    for (UINT32 i = 0; i < expire_ticks; ++i) {
+        fort_pending_expire(pending);
+    }
+
+    assert(pending->app_count == TEST_PENDING_APP_COUNT / 2 + 1);
+    assert(pending->packet_count == 0);
+
+    /* The unanswered apps aren't allowed on re-authorization */
+    assert(test_pending_verdict(pending, /*app_id=*/0) == FORT_PENDING_VERDICT_EXPIRED);
+    assert(test_pending_verdict(pending, /*app_id=*/1) == FORT_PENDING_VERDICT_UNKNOWN);
+    assert(test_pending_verdict(pending, TEST_PENDING_APP_COUNT / 2 + 1)
+            == FORT_PENDING_VERDICT_EXPIRED);
+
+    /* The late answer is kept */
+    decisions = test_pending_decisions_new(
+            TEST_PENDING_APP_COUNT / 2 + 1, TEST_PENDING_APP_COUNT / 2 + 2, &data_len);
+
+    fort_pending_decide(pending, decisions, data_len);
+
+    free(decisions);
+
+    assert(test_pending_verdict(pending, TEST_PENDING_APP_COUNT / 2 + 1)
+            == FORT_PENDING_VERDICT_ALLOW);
+
+    for (UINT32 i = 0; i < expire_ticks; ++i) {
+        fort_pending_expire(pending);
+    }
+
+    assert(pending->app_count == 0);
+    assert(pending->packet_count == 0);
+
+    fort_pending_close(pending);
+
+    fort_device_set(NULL);
+
+    free(device);
+}
+
+#define TEST_STAT_QUOTA_APP_KEY   1
+#define TEST_STAT_QUOTA_GROUP_KEY 0x80000001
+
+static PFORT_CONF_IO test_stat_quotas_conf_new(void)
+{
+    const UINT32 size = FORT_CONF_IO_CONF_OFF + FORT_CONF_DATA_OFF + FORT_CONF_QUOTAS_SIZE(2);
+
+    PFORT_CONF_IO conf_io = calloc(1, size);
+    assert(conf_io != NULL);
+
+    PFORT_CONF conf = &conf_io->conf;
+    conf->quotas_n = 2;
+    conf->quota_month_start = 1;
+
+    PFORT_TRAF_QUOTA quotas = (PFORT_TRAF_QUOTA) conf->data;
+
+    /* The app's daily quota blocks */
+    quotas[0].key = TEST_STAT_QUOTA_APP_KEY;
+    quotas[0].day_bytes = 1000;
+
+    /* The group's monthly quota throttles into the 2nd group */
+    quotas[1].key = TEST_STAT_QUOTA_GROUP_KEY;
+    quotas[1].month_bytes = 5000;
+    quotas[1].throttle_group = 2;
+
+    conf_io->conf_group.quota_ids[0] = 2;
+
+    return conf_io;
+}
+
+static void test_stat_quotas_conf_update(PFORT_STAT stat)
+{
+    PFORT_CONF_IO conf_io = test_stat_quotas_conf_new();
+
+    fort_stat_conf_update(stat, conf_io);
+
+    free(conf_io);
+}
+
+static NTSTATUS test_stat_quotas_associate(PFORT_STAT stat, UINT64 flow_id, UINT16 quota_id)
+{
+    const FORT_CONF_META_CONN conn = { .process_id = 100 };
+    BOOL log_stat = FALSE;
+
+    return fort_flow_associate(stat, flow_id, &conn, /*group_index=*/0, /*limit_id=*/0,
+            /*limit_io_bits=*/0, quota_id, &log_stat);
+}
+
+static void test_stat_quotas(void)
+{
+    static FORT_STAT stat;
+
+    fort_stat_open(&stat);
+    fort_stat_log_update(&stat, TRUE);
+
+    test_stat_quotas_conf_update(&stat);
+
+    fort_stat_quota_window_update(&stat, /*day_id=*/20240131, /*month_id=*/202401);
+
+    /* The app's flow */
+    assert(test_stat_quotas_associate(&stat, /*flow_id=*/1, /*quota_id=*/1) == STATUS_SUCCESS);
+
+    const UINT64 app_flow = (UINT64) tommy_arrayof_ref(&stat.flows, 0);
+
+    assert(!fort_flow_classify(&stat, app_flow, 600, /*inbound=*/TRUE));
+    assert(!fort_flow_classify(&stat, app_flow, 600, /*inbound=*/FALSE));
+
+    /* The daily quota is exceeded: block the packets and new flows */
+    assert(fort_flow_classify(&stat, app_flow, 100, /*inbound=*/TRUE));
+    assert(test_stat_quotas_associate(&stat, /*flow_id=*/2, /*quota_id=*/1)
+            == FORT_STATUS_FLOW_QUOTA);
+
+    /* The used bytes are kept on conf updates */
+    test_stat_quotas_conf_update(&stat);
+
+    assert(fort_flow_classify(&stat, app_flow, 100, /*inbound=*/TRUE));
+
+    /* The next day */
+    fort_stat_quota_window_update(&stat, /*day_id=*/20240201, /*month_id=*/202401);
+
+    assert(!fort_flow_classify(&stat, app_flow, 100, /*inbound=*/TRUE));
+
+    /* The group's monthly quota is exceeded: throttle new flows */
+    assert(test_stat_quotas_associate(&stat, /*flow_id=*/3, /*quota_id=*/0) == STATUS_SUCCESS);
+
+    const UINT64 group_flow = (UINT64) tommy_arrayof_ref(&stat.flows, 1);
+
+    assert(!fort_flow_classify(&stat, group_flow, 4000, /*inbound=*/TRUE));
+    assert(!fort_flow_classify(&stat, group_flow, 100, /*inbound=*/TRUE));
+
+    assert(test_stat_quotas_associate(&stat, /*flow_id=*/3, /*quota_id=*/0) == STATUS_SUCCESS);
+    assert(((PFORT_FLOW) group_flow)->opt.group_index == 1);
+
+    printf("test_stat_quotas: app day_used=%llu group month_used=%llu\n",
+            (unsigned long long) stat.quotas[0].quota.day_used,
+            (unsigned long long) stat.quotas[1].quota.month_used);
+
+    /* The next month */
+    fort_stat_quota_window_update(&stat, /*day_id=*/20240301, /*month_id=*/202402);
+
+    assert(test_stat_quotas_associate(&stat, /*flow_id=*/3, /*quota_id=*/0) == STATUS_SUCCESS);
+    assert(((PFORT_FLOW) group_flow)->opt.group_index == 0);
+
+    fort_flow_delete(&stat, app_flow);
+    fort_flow_delete(&stat, group_flow);
+
+    fort_stat_close(&stat);
+}
+
+static void test_stat_limits_conf_update(PFORT_STAT stat, UINT32 bps_first, UINT32 bps_second)
+{
+    const UINT32 size =
+            FORT_CONF_IO_CONF_OFF + FORT_CONF_DATA_OFF + FORT_CONF_APP_LIMITS_SIZE(2);
+
+    PFORT_CONF_IO conf_io = calloc(1, size);
+    assert(conf_io != NULL);
+
+    PFORT_CONF conf = &conf_io->conf;
+    conf->app_limits_n = 2;
+
+    PFORT_SPEED_LIMIT limits = (PFORT_SPEED_LIMIT) conf->data;
+
+    limits[0].bps = limits[1].bps = bps_first;
+    limits[2].bps = limits[3].bps = bps_second;
+
+    fort_stat_conf_update(stat, conf_io);
+
+    free(conf_io);
+}
+
+static void test_stat_limits(void)
+{
+    static FORT_STAT stat;
+
+    fort_stat_open(&stat);
+    fort_stat_log_update(&stat, TRUE);
+
+    test_stat_limits_conf_update(&stat, /*bps_first=*/1000, /*bps_second=*/2000);
+
+    const FORT_CONF_META_CONN conn = { .process_id = 100 };
+    BOOL log_stat = FALSE;
+
+    assert(fort_flow_associate(&stat, /*flow_id=*/1, &conn, /*group_index=*/0, /*limit_id=*/2,
+                   /*limit_io_bits=*/3, /*quota_id=*/0, &log_stat)
+            == STATUS_SUCCESS);
+
+    PFORT_FLOW flow = tommy_arrayof_ref(&stat.flows, 0);
+    assert(flow->limit_id == 2);
+
+    /* The flow's limits are moved to another index */
+    test_stat_limits_conf_update(&stat, /*bps_first=*/2000, /*bps_second=*/3000);
+    assert(flow->limit_id == 1);
+
+    /* The flow's limits are removed */
+    test_stat_limits_conf_update(&stat, /*bps_first=*/4000, /*bps_second=*/3000);
+    assert(flow->limit_id == 0);
+
+    fort_flow_delete(&stat, (UINT64) flow);
+
+    fort_stat_close(&stat);
+}
+
 int main(int argc, char *argv[])
 {
     (void) argc;
@@ -105,6 +1537,19 @@ int main(int argc, char *argv[])
     test_major();
     test_utl_ascii();
     test_utl_bits();
+    test_shaper_sim();
+    test_conf_exe_bench(10000);
+    test_conf_exe_bench(100000);
+    test_conf_epoch_stress();
+    test_device_apps_reauth();
+    test_pool_bench();
+    test_pool_reclaim();
+    test_pstree_names();
+    test_pstree_names_intern();
+    test_pstree_services_churn();
+    test_pending_apps();
+    test_stat_quotas();
+    test_stat_limits();
 
     return 0;
 }
@@ -7,19 +7,26 @@ NTSTATUS IoQueryFullDriverPath(PDRIVER_OBJECT driverObject, PUNICODE_STRING full
     return STATUS_SUCCESS;
 }
 
+static PCREATE_PROCESS_NOTIFY_ROUTINE_EX g_processNotifyRoutine = NULL;
+
 NTSTATUS PsSetCreateProcessNotifyRoutineEx(
         PCREATE_PROCESS_NOTIFY_ROUTINE_EX notifyRoutine, BOOLEAN remove)
 {
-    UNUSED(notifyRoutine);
-    UNUSED(remove);
+    g_processNotifyRoutine = remove ? NULL : notifyRoutine;
     return STATUS_SUCCESS;
 }
 
+void um_ps_notify_process(HANDLE processId, PPS_CREATE_NOTIFY_INFO createInfo)
+{
+    if (g_processNotifyRoutine != NULL) {
+        g_processNotifyRoutine(NULL, processId, createInfo);
+    }
+}
+
 NTSTATUS KeExpandKernelStackAndCallout(PEXPAND_STACK_CALLOUT callout, PVOID parameter, SIZE_T size)
 {
-    UNUSED(callout);
-    UNUSED(parameter);
     UNUSED(size);
+    callout(parameter);
     return STATUS_SUCCESS;
 }
 
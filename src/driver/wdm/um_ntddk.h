@@ -39,6 +39,9 @@ FORT_API NTSTATUS IoQueryFullDriverPath(PDRIVER_OBJECT driverObject, PUNICODE_ST
 FORT_API NTSTATUS PsSetCreateProcessNotifyRoutineEx(
         PCREATE_PROCESS_NOTIFY_ROUTINE_EX notifyRoutine, BOOLEAN remove);
 
+/* Call the registered process notify routine (for tests) */
+FORT_API void um_ps_notify_process(HANDLE processId, PPS_CREATE_NOTIFY_INFO createInfo);
+
 typedef void(NTAPI EXPAND_STACK_CALLOUT)(PVOID parameter);
 typedef EXPAND_STACK_CALLOUT *PEXPAND_STACK_CALLOUT;
 
@@ -43,6 +43,8 @@ void KeUnstackDetachProcess(PRKAPC_STATE apcState)
 
 ULONG RtlRandomEx(PULONG seed)
 {
-    UNUSED(seed);
-    return 0;
+    /* Park-Miller "minimal standard" generator, the seed must not be 0 */
+    const ULONG value = (ULONG) (((ULONGLONG) (*seed % 0x7FFFFFFF) * 16807) % 0x7FFFFFFF);
+    *seed = (value != 0) ? value : 1;
+    return *seed;
 }
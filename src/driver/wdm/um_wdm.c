@@ -261,6 +261,92 @@ void ExReleaseRundownProtection(PEX_RUNDOWN_REF runRef)
     UNUSED(runRef);
 }
 
+#define UM_RUNDOWN_ACTIVE    1 /* the rundown is in progress */
+#define UM_RUNDOWN_COUNT_INC 2
+
+static BOOLEAN um_rundown_acquire(PEX_RUNDOWN_REF runRef)
+{
+    for (;;) {
+        const ULONG_PTR count = runRef->Count;
+        if ((count & UM_RUNDOWN_ACTIVE) != 0)
+            return FALSE;
+
+        if (InterlockedCompareExchangePointer(
+                    &runRef->Ptr, (PVOID) (count + UM_RUNDOWN_COUNT_INC), (PVOID) count)
+                == (PVOID) count)
+            return TRUE;
+    }
+}
+
+static void um_rundown_release(PEX_RUNDOWN_REF runRef)
+{
+    for (;;) {
+        const ULONG_PTR count = runRef->Count;
+
+        if (InterlockedCompareExchangePointer(
+                    &runRef->Ptr, (PVOID) (count - UM_RUNDOWN_COUNT_INC), (PVOID) count)
+                == (PVOID) count)
+            return;
+    }
+}
+
+static void um_rundown_wait(PEX_RUNDOWN_REF runRef)
+{
+    for (;;) {
+        const ULONG_PTR count = runRef->Count;
+
+        if (InterlockedCompareExchangePointer(
+                    &runRef->Ptr, (PVOID) (count | UM_RUNDOWN_ACTIVE), (PVOID) count)
+                == (PVOID) count)
+            break;
+    }
+
+    /* Wait for the owners to leave */
+    while (runRef->Count != UM_RUNDOWN_ACTIVE) {
+        SwitchToThread();
+    }
+}
+
+static void um_rundown_reinit(PEX_RUNDOWN_REF runRef)
+{
+    InterlockedExchangePointer(&runRef->Ptr, NULL);
+}
+
+PEX_RUNDOWN_REF_CACHE_AWARE ExAllocateCacheAwareRundownProtection(DWORD poolType, ULONG tag)
+{
+    PEX_RUNDOWN_REF runRef = ExAllocatePoolWithTag(poolType, sizeof(EX_RUNDOWN_REF), tag);
+    if (runRef != NULL) {
+        runRef->Count = 0;
+    }
+
+    return (PEX_RUNDOWN_REF_CACHE_AWARE) runRef;
+}
+
+void ExFreeCacheAwareRundownProtection(PEX_RUNDOWN_REF_CACHE_AWARE runRefCacheAware)
+{
+    ExFreePoolWithTag(runRefCacheAware, 0);
+}
+
+BOOLEAN ExAcquireRundownProtectionCacheAware(PEX_RUNDOWN_REF_CACHE_AWARE runRefCacheAware)
+{
+    return um_rundown_acquire((PEX_RUNDOWN_REF) runRefCacheAware);
+}
+
+void ExReleaseRundownProtectionCacheAware(PEX_RUNDOWN_REF_CACHE_AWARE runRefCacheAware)
+{
+    um_rundown_release((PEX_RUNDOWN_REF) runRefCacheAware);
+}
+
+void ExWaitForRundownProtectionReleaseCacheAware(PEX_RUNDOWN_REF_CACHE_AWARE runRefCacheAware)
+{
+    um_rundown_wait((PEX_RUNDOWN_REF) runRefCacheAware);
+}
+
+void ExReInitializeRundownProtectionCacheAware(PEX_RUNDOWN_REF_CACHE_AWARE runRefCacheAware)
+{
+    um_rundown_reinit((PEX_RUNDOWN_REF) runRefCacheAware);
+}
+
 void KeInitializeEvent(PRKEVENT event, EVENT_TYPE type, BOOLEAN state)
 {
     UNUSED(event);
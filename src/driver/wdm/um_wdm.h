@@ -227,6 +227,8 @@ typedef struct _EX_RUNDOWN_REF
     };
 } EX_RUNDOWN_REF, *PEX_RUNDOWN_REF;
 
+typedef struct _EX_RUNDOWN_REF_CACHE_AWARE *PEX_RUNDOWN_REF_CACHE_AWARE;
+
 typedef LONG KEVENT, *PKEVENT, *PRKEVENT;
 
 typedef enum _EVENT_TYPE {
@@ -386,6 +388,17 @@ FORT_API void ExInitializeRundownProtection(PEX_RUNDOWN_REF runRef);
 FORT_API BOOLEAN ExAcquireRundownProtection(PEX_RUNDOWN_REF runRef);
 FORT_API void ExReleaseRundownProtection(PEX_RUNDOWN_REF runRef);
 
+FORT_API PEX_RUNDOWN_REF_CACHE_AWARE ExAllocateCacheAwareRundownProtection(
+        DWORD poolType, ULONG tag);
+FORT_API void ExFreeCacheAwareRundownProtection(PEX_RUNDOWN_REF_CACHE_AWARE runRefCacheAware);
+FORT_API BOOLEAN ExAcquireRundownProtectionCacheAware(
+        PEX_RUNDOWN_REF_CACHE_AWARE runRefCacheAware);
+FORT_API void ExReleaseRundownProtectionCacheAware(PEX_RUNDOWN_REF_CACHE_AWARE runRefCacheAware);
+FORT_API void ExWaitForRundownProtectionReleaseCacheAware(
+        PEX_RUNDOWN_REF_CACHE_AWARE runRefCacheAware);
+FORT_API void ExReInitializeRundownProtectionCacheAware(
+        PEX_RUNDOWN_REF_CACHE_AWARE runRefCacheAware);
+
 FORT_API void KeInitializeEvent(PRKEVENT event, EVENT_TYPE type, BOOLEAN state);
 FORT_API void KeClearEvent(PRKEVENT event);
 FORT_API LONG KeSetEvent(PRKEVENT event, KPRIORITY increment, BOOLEAN wait);
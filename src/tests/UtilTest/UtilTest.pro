@@ -1,14 +1,19 @@
 include(../Common/Common.pri)
 
 HEADERS += \
+    tst_appinfomanager.h \
     tst_bitutil.h \
     tst_confutil.h \
+    tst_controlcodec.h \
     tst_dateutil.h \
     tst_fileutil.h \
+    tst_hostinfocache.h \
     tst_ioccontainer.h \
     tst_netutil.h \
+    tst_rpceventbus.h \
     tst_ruletextparser.h \
-    tst_stringutil.h
+    tst_stringutil.h \
+    tst_workermanager.h
 
 SOURCES += \
     tst_main.cpp
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <QDebug>
+#include <QImage>
+#include <QRandomGenerator>
+
+#include <googletest.h>
+
+#include <sqlite/dbquery.h>
+#include <sqlite/sqlitedb.h>
+
+#include <appinfo/appinfomanager.h>
+
+class AppInfoManagerTest : public Test
+{
+    // Test interface
+protected:
+    void SetUp();
+    void TearDown();
+};
+
+void AppInfoManagerTest::SetUp()
+{
+    Q_INIT_RESOURCE(appinfo_migrations);
+}
+
+void AppInfoManagerTest::TearDown() { }
+
+TEST_F(AppInfoManagerTest, lruPurgeSkewedTrace)
+{
+    constexpr int maxAppsCount = 100;
+    constexpr int hotAppsCount = 20;
+    constexpr int accessCount = 20000;
+    constexpr int purgeInterval = 100;
+
+    AppInfoManager manager(":memory:");
+    manager.setUp();
+    manager.setMaxAppsCount(maxAppsCount);
+
+    QImage icon(16, 16, QImage::Format_ARGB32);
+    icon.fill(Qt::red);
+
+    const auto hotAppPath = [](int i) { return QString("C:\\Hot\\app%1.exe").arg(i); };
+
+    // Skewed trace: 90% of accesses to few hot apps, the rest to one-off apps
+    QRandomGenerator rand(0xA110);
+
+    int onceAppsCount = 0;
+
+    for (int i = 0; i < accessCount; ++i) {
+        const bool isHot = (rand.bounded(10) != 0);
+        const QString appPath = isHot ? hotAppPath(rand.bounded(hotAppsCount))
+                                      : QString("C:\\Once\\app%1.exe").arg(i);
+
+        if (!isHot) {
+            ++onceAppsCount;
+        }
+
+        AppInfo appInfo;
+        if (!manager.loadInfoFromDb(appPath, appInfo)) {
+            appInfo.fileDescription = appPath;
+            appInfo.fileModTime = QDateTime::fromSecsSinceEpoch(1700000000);
+
+            ASSERT_TRUE(manager.saveToDb(appPath, appInfo, icon));
+        }
+
+        if (i % purgeInterval == 0) {
+            manager.purgeApps();
+        }
+    }
+
+    manager.purgeApps();
+
+    const quint64 hitCount = manager.hitCount();
+    const quint64 missCount = manager.missCount();
+
+    qDebug() << "App info cache:" << hitCount << "hits," << missCount << "misses;"
+             << "hit rate:" << (hitCount * 100 / (hitCount + missCount)) << "%";
+
+    ASSERT_EQ(hitCount + missCount, quint64(accessCount));
+
+    // Hot apps are extracted only once and never evicted
+    ASSERT_EQ(missCount, quint64(onceAppsCount + hotAppsCount));
+
+    for (int i = 0; i < hotAppsCount; ++i) {
+        AppInfo appInfo;
+        ASSERT_TRUE(manager.loadInfoFromDb(hotAppPath(i), appInfo));
+    }
+
+    SqliteDb *sqliteDb = manager.sqliteDb();
+
+    const int appCount = DbQuery(sqliteDb).sql("SELECT count(*) FROM app;").execute().toInt();
+    ASSERT_EQ(appCount, maxAppsCount);
+
+    // The shared icon is stored once and referenced by every app
+    const int iconCount = DbQuery(sqliteDb).sql("SELECT count(*) FROM icon;").execute().toInt();
+    ASSERT_EQ(iconCount, 1);
+
+    const int iconRefCount =
+            DbQuery(sqliteDb).sql("SELECT ref_count FROM icon;").execute().toInt();
+    ASSERT_EQ(iconRefCount, appCount);
+}
@@ -1,21 +1,28 @@
 #pragma once
 
+#include <QElapsedTimer>
 #include <QSignalSpy>
+#include <QTemporaryDir>
 
 #include <googletest.h>
 
+#include <sqlite/sqlitedb.h>
+
 #include <conf/addressgroup.h>
+#include <conf/app.h>
 #include <conf/appgroup.h>
 #include <conf/confrulemanager.h>
 #include <conf/firewallconf.h>
 #include <conf/rule.h>
 #include <driver/drivercommon.h>
+#include <driver/driversnapshot.h>
 #include <log/logentryconn.h>
 #include <manager/envmanager.h>
 #include <util/conf/confappswalker.h>
 #include <util/conf/confbuffer.h>
 #include <util/conf/confruleswalker.h>
 #include <util/fileutil.h>
+#include <util/net/iprange.h>
 #include <util/net/netformatutil.h>
 #include <util/net/netutil.h>
 #include <util/stringutil.h>
@@ -121,6 +128,622 @@ TEST_F(ConfUtilTest, confWriteRead)
     ASSERT_EQ(int(firefoxData.flags.group_index), 1);
 }
 
+namespace {
+
+bool ipRangeContains(const IpRange &range, const ip_addr_t &ip, bool isIPv6)
+{
+    if (!isIPv6) {
+        if (range.ip4Array().contains(ip.v4))
+            return true;
+
+        for (int i = 0, n = range.pair4Size(); i < n; ++i) {
+            const Ip4Pair pair = range.pair4At(i);
+            if (ip.v4 >= pair.from && ip.v4 <= pair.to)
+                return true;
+        }
+        return false;
+    }
+
+    const auto ip6Cmp = [](const ip6_addr_t &l, const ip6_addr_t &r) {
+        return std::memcmp(l.data, r.data, sizeof(ip6_addr_t));
+    };
+
+    for (int i = 0, n = range.ip6Size(); i < n; ++i) {
+        if (ip6Cmp(ip.v6, range.ip6At(i)) == 0)
+            return true;
+    }
+
+    for (int i = 0, n = range.pair6Size(); i < n; ++i) {
+        const Ip6Pair pair = range.pair6At(i);
+        if (ip6Cmp(ip.v6, pair.from) >= 0 && ip6Cmp(ip.v6, pair.to) <= 0)
+            return true;
+    }
+    return false;
+}
+
+}
+
+TEST_F(ConfUtilTest, addressGroupCompiled)
+{
+    const QString includeText = "10.0.0.0/8\n"
+                                "192.168.0.0/16\n"
+                                "1.2.3.4\n"
+                                "172.16.0.0-172.16.0.255\n"
+                                "fe80::/10\n"
+                                "2001:db8::/32\n"
+                                "2001:db8::1\n";
+    const QString excludeText = "10.1.0.0/16\n"
+                                "10.2.3.4\n"
+                                "192.168.1.1-192.168.1.10\n"
+                                "172.16.0.0/24\n"
+                                "fe80::1\n"
+                                "fe80::10-fe80::20\n"
+                                "2001:db8::/48\n";
+
+    IpRange includeRange;
+    IpRange excludeRange;
+    ASSERT_TRUE(includeRange.fromText(includeText));
+    ASSERT_TRUE(excludeRange.fromText(excludeText));
+
+    EnvManager envManager;
+    FirewallConf conf;
+
+    AddressGroup *inetGroup = conf.inetAddressGroup();
+
+    inetGroup->setIncludeAll(false);
+    inetGroup->setExcludeAll(false);
+
+    inetGroup->setIncludeText(includeText);
+    inetGroup->setExcludeText(excludeText);
+
+    conf.addAppGroup(new AppGroup());
+
+    conf.resetEdited(FirewallConf::AllEdited);
+    conf.prepareToSave();
+
+    ConfBuffer confBuf;
+
+    if (!confBuf.writeConf(conf, nullptr, envManager)) {
+        qCritical() << "Error:" << confBuf.errorMessage();
+        Q_UNREACHABLE();
+    }
+
+    const char *data = confBuf.data() + DriverCommon::confIoConfOff();
+
+    // IPv4: check the edges of all ranges
+    QVector<ip4_t> ip4List;
+    for (const IpRange *range : { &includeRange, &excludeRange }) {
+        ip4_arr_t edges = range->ip4Array();
+        edges << range->pair4FromArray() << range->pair4ToArray();
+
+        for (const ip4_t ip : std::as_const(edges)) {
+            ip4List << (ip - 1) << ip << (ip + 1);
+        }
+    }
+
+    for (const ip4_t ip4 : std::as_const(ip4List)) {
+        const ip_addr_t ip = { .v4 = ip4 };
+
+        const bool included = ipRangeContains(includeRange, ip, /*isIPv6=*/false)
+                && !ipRangeContains(excludeRange, ip, /*isIPv6=*/false);
+
+        ASSERT_EQ(DriverCommon::confIpIncluded(data, ip), included)
+                << NetFormatUtil::ip4ToText(ip4).toStdString();
+
+        // The exclude list is folded into the include list
+        ASSERT_FALSE(DriverCommon::confIp4InRange(data, ip4));
+    }
+
+    // IPv6
+    const QStringList ip6List = { "fe7f:ffff:ffff:ffff:ffff:ffff:ffff:ffff", "fe80::", "fe80::1",
+        "fe80::2", "fe80::f", "fe80::10", "fe80::20", "fe80::21", "febf::1", "fec0::",
+        "2001:db7:ffff:ffff:ffff:ffff:ffff:ffff", "2001:db8::", "2001:db8::1",
+        "2001:db8:0:ffff:ffff:ffff:ffff:ffff", "2001:db8:1::", "2001:db8:ffff::1", "2001:db9::" };
+
+    for (const QString &ip6Text : ip6List) {
+        const ip_addr_t ip = { .v6 = NetFormatUtil::textToIp6(ip6Text) };
+
+        const bool included = ipRangeContains(includeRange, ip, /*isIPv6=*/true)
+                && !ipRangeContains(excludeRange, ip, /*isIPv6=*/true);
+
+        ASSERT_EQ(DriverCommon::confIpIncluded(data, ip, /*isIPv6=*/true), included)
+                << ip6Text.toStdString();
+    }
+}
+
+class TestConfAppsWalker : public ConfAppsWalker
+{
+public:
+    explicit TestConfAppsWalker(const QList<App> &apps) : m_apps(apps) { }
+
+    bool walkApps(const std::function<walkAppsCallback> &func) const override
+    {
+        for (App app : m_apps) {
+            if (!func(app))
+                return false;
+        }
+        return true;
+    }
+
+private:
+    QList<App> m_apps;
+};
+
+TEST_F(ConfUtilTest, confAppSpeedLimits)
+{
+    EnvManager envManager;
+    FirewallConf conf;
+
+    conf.addAppGroup(new AppGroup());
+
+    App app1;
+    app1.appPath = "C:\\Utils\\Updater.exe";
+    app1.speedLimitIn = 100;
+
+    App app2;
+    app2.appPath = "C:\\Utils\\Sync.exe";
+    app2.speedLimitIn = 100;
+
+    App app3;
+    app3.appPath = "C:\\Utils\\Backup.exe";
+    app3.speedLimitOut = 200;
+
+    App app4;
+    app4.appPath = "C:\\Utils\\Browser.exe";
+
+    const TestConfAppsWalker confAppsWalker({ app1, app2, app3, app4 });
+
+    conf.resetEdited(FirewallConf::AllEdited);
+    conf.prepareToSave();
+
+    ConfBuffer confBuf;
+
+    if (!confBuf.writeConf(conf, &confAppsWalker, envManager)) {
+        qCritical() << "Error:" << confBuf.errorMessage();
+        Q_UNREACHABLE();
+    }
+
+    const char *data = confBuf.data() + DriverCommon::confIoConfOff();
+
+    const auto appData1 =
+            DriverCommon::confAppFind(data, FileUtil::pathToKernelPath(app1.appPath));
+    const auto appData2 =
+            DriverCommon::confAppFind(data, FileUtil::pathToKernelPath(app2.appPath));
+    const auto appData3 =
+            DriverCommon::confAppFind(data, FileUtil::pathToKernelPath(app3.appPath));
+    const auto appData4 =
+            DriverCommon::confAppFind(data, FileUtil::pathToKernelPath(app4.appPath));
+
+    // Equal speed limits are shared
+    ASSERT_NE(appData1.limit_id, 0);
+    ASSERT_EQ(appData1.limit_id, appData2.limit_id);
+    ASSERT_NE(appData1.limit_id, appData3.limit_id);
+    ASSERT_EQ(appData4.limit_id, 0);
+
+    ASSERT_EQ(DriverCommon::confAppLimitIoBits(data, appData1.limit_id), 0x01); // in
+    ASSERT_EQ(DriverCommon::confAppLimitIoBits(data, appData3.limit_id), 0x02); // out
+    ASSERT_EQ(DriverCommon::confAppLimitIoBits(data, appData4.limit_id), 0);
+}
+
+static QList<App> generateBigApps(int appsCount)
+{
+    QList<App> apps;
+    apps.reserve(appsCount);
+
+    for (int i = 0; i < appsCount; ++i) {
+        App app;
+        app.blocked = (i % 2) != 0;
+
+        if (i % 100 == 0) {
+            app.isWildcard = true;
+            app.appOriginPath = QString("C:\\Wild\\%1\\**\nC:\\Wild\\%1\\*.exe").arg(i);
+        } else {
+            app.appPath = QString("C:\\Programs\\App%1\\app.exe").arg(i);
+        }
+
+        apps.append(app);
+    }
+
+    return apps;
+}
+
+TEST_F(ConfUtilTest, confWriteBigApps)
+{
+    constexpr int appsCount = 100000;
+
+    EnvManager envManager;
+    FirewallConf conf;
+
+    conf.addAppGroup(new AppGroup());
+
+    QList<App> apps = generateBigApps(appsCount);
+
+    // Duplicate path: the first app wins
+    App dupApp = apps.at(1);
+    dupApp.blocked = !dupApp.blocked;
+    apps.append(dupApp);
+
+    const TestConfAppsWalker confAppsWalker(apps);
+
+    conf.resetEdited(FirewallConf::AllEdited);
+    conf.prepareToSave();
+
+    ConfBuffer confBuf;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    if (!confBuf.writeConf(conf, &confAppsWalker, envManager)) {
+        qCritical() << "Error:" << confBuf.errorMessage();
+        Q_UNREACHABLE();
+    }
+
+    qDebug() << "Write conf:" << appsCount << "apps;" << timer.elapsed() << "msec;"
+             << confBuf.buffer().size() << "bytes";
+
+    const char *data = confBuf.data() + DriverCommon::confIoConfOff();
+
+    for (int i : { 1, 2, appsCount / 2 + 1, appsCount - 1 }) {
+        const App &app = apps.at(i);
+        const auto appData =
+                DriverCommon::confAppFind(data, FileUtil::pathToKernelPath(app.appPath));
+
+        ASSERT_TRUE(appData.found);
+        ASSERT_EQ(appData.flags.blocked, app.blocked);
+    }
+
+    // Wildcard prefix
+    const auto wildAppData = DriverCommon::confAppFind(
+            data, FileUtil::pathToKernelPath("C:\\Wild\\100\\Sub\\app.exe"));
+
+    ASSERT_TRUE(wildAppData.found);
+}
+
+TEST_F(ConfUtilTest, driverSnapshot)
+{
+    constexpr int appsCount = 100000;
+
+    QTemporaryDir tempDir;
+    ASSERT_TRUE(tempDir.isValid());
+
+    const QString snapshotPath = tempDir.filePath("driver.snapshot");
+    const QString statePath = tempDir.filePath("state.ini");
+
+    ASSERT_TRUE(FileUtil::writeFile(statePath, "state=1"));
+
+    SqliteDb sqliteDb(":memory:");
+    ASSERT_TRUE(sqliteDb.open());
+
+    EnvManager envManager;
+    FirewallConf conf;
+
+    conf.addAppGroup(new AppGroup());
+
+    const TestConfAppsWalker confAppsWalker(generateBigApps(appsCount));
+
+    conf.resetEdited(FirewallConf::AllEdited);
+    conf.prepareToSave();
+
+    // Cold start: build the conf
+    QElapsedTimer timer;
+    timer.start();
+
+    ConfBuffer confBuf;
+    ASSERT_TRUE(confBuf.writeConf(conf, &confAppsWalker, envManager));
+
+    const qint64 coldMsec = timer.restart();
+
+    DriverSnapshot snapshot;
+    snapshot.conf = confBuf.buffer();
+
+    const QByteArray stateKey = DriverSnapshot::stateKey(&sqliteDb, { statePath });
+
+    ASSERT_TRUE(snapshot.save(snapshotPath, stateKey));
+
+    // Warm start: load the snapshot
+    timer.restart();
+
+    DriverSnapshot loadedSnapshot;
+    ASSERT_TRUE(loadedSnapshot.load(snapshotPath, stateKey));
+
+    const qint64 warmMsec = timer.elapsed();
+
+    ASSERT_EQ(loadedSnapshot.conf, snapshot.conf);
+    ASSERT_TRUE(loadedSnapshot.rules.isEmpty());
+
+    qDebug() << "Driver conf:" << appsCount << "apps;"
+             << "cold:" << coldMsec << "msec;"
+             << "warm:" << warmMsec << "msec";
+
+    // Changed state invalidates the snapshot
+    ASSERT_TRUE(FileUtil::writeFile(statePath, "state=2"));
+
+    DriverSnapshot staleSnapshot;
+    ASSERT_FALSE(staleSnapshot.load(
+            snapshotPath, DriverSnapshot::stateKey(&sqliteDb, { statePath })));
+    ASSERT_TRUE(staleSnapshot.isEmpty());
+}
+
+TEST_F(ConfUtilTest, driverSnapshotWalDb)
+{
+    QTemporaryDir tempDir;
+    ASSERT_TRUE(tempDir.isValid());
+
+    const QString dbPath = tempDir.filePath("test.db");
+    const QString statePath = tempDir.filePath("state.ini");
+
+    ASSERT_TRUE(FileUtil::writeFile(statePath, "state=1"));
+
+    QByteArray startupKey;
+    {
+        SqliteDb sqliteDb(dbPath);
+        ASSERT_TRUE(sqliteDb.open());
+        ASSERT_TRUE(sqliteDb.execute("PRAGMA journal_mode = WAL;"));
+        ASSERT_TRUE(sqliteDb.execute("CREATE TABLE app(app_id INTEGER PRIMARY KEY, path TEXT,"
+                                     " blocked BOOLEAN, group_id INTEGER);"));
+        ASSERT_TRUE(sqliteDb.execute("INSERT INTO app(path, blocked, group_id)"
+                                     " VALUES('C:\\app1.exe', 1, 0), ('C:\\app2.exe', 0, NULL);"));
+
+        // The changes are in the WAL file yet
+        ASSERT_TRUE(FileUtil::fileExists(dbPath + "-wal"));
+
+        startupKey = DriverSnapshot::stateKey(&sqliteDb, { statePath });
+    }
+
+    // The WAL file is checkpointed and removed on close
+    ASSERT_FALSE(FileUtil::fileExists(dbPath + "-wal"));
+
+    SqliteDb sqliteDb(dbPath);
+    ASSERT_TRUE(sqliteDb.open());
+
+    ASSERT_EQ(DriverSnapshot::stateKey(&sqliteDb, { statePath }), startupKey);
+
+    // Changed conf invalidates the key
+    ASSERT_TRUE(sqliteDb.execute("UPDATE app SET blocked = 0 WHERE app_id = 1;"));
+
+    const QByteArray changedKey = DriverSnapshot::stateKey(&sqliteDb, { statePath });
+    ASSERT_NE(changedKey, startupKey);
+
+    // NULL differs from the empty value
+    ASSERT_TRUE(sqliteDb.execute("UPDATE app SET group_id = '' WHERE app_id = 2;"));
+    ASSERT_NE(DriverSnapshot::stateKey(&sqliteDb, { statePath }), changedKey);
+
+    ASSERT_TRUE(sqliteDb.execute("UPDATE app SET group_id = NULL WHERE app_id = 2;"));
+    ASSERT_EQ(DriverSnapshot::stateKey(&sqliteDb, { statePath }), changedKey);
+
+    // Changed ini invalidates the key
+    ASSERT_TRUE(FileUtil::writeFile(statePath, "state=2"));
+    ASSERT_NE(DriverSnapshot::stateKey(&sqliteDb, { statePath }), changedKey);
+}
+
+TEST_F(ConfUtilTest, driverSnapshotFlags)
+{
+    DriverSnapshot snapshot;
+
+    // Conf flags
+    {
+        FirewallConf conf;
+        conf.setFilterEnabled(true);
+
+        ConfBuffer confBuf;
+        confBuf.writeFlags(conf);
+
+        snapshot.conf = QByteArray(DriverCommon::confIoConfOff() + sizeof(FORT_CONF), '\0');
+        snapshot.setConfFlags(confBuf.buffer());
+
+        PCFORT_CONF_IO confIo = PCFORT_CONF_IO(snapshot.conf.constData());
+        ASSERT_TRUE(confIo->conf.flags.filter_enabled);
+    }
+
+    // Zone flags
+    {
+        snapshot.zones = QByteArray(sizeof(FORT_CONF_ZONES), '\0');
+
+        const FORT_CONF_ZONE_FLAG zoneFlag = { .zone_id = 3, .enabled = true };
+        snapshot.setZoneFlag(QByteArray((const char *) &zoneFlag, sizeof(zoneFlag)));
+
+        PCFORT_CONF_ZONES zones = PCFORT_CONF_ZONES(snapshot.zones.constData());
+        ASSERT_EQ(zones->enabled_mask, 1u << 2);
+
+        // Invalid zone drops the blob
+        const FORT_CONF_ZONE_FLAG badZoneFlag = { .zone_id = 0, .enabled = true };
+        snapshot.setZoneFlag(QByteArray((const char *) &badZoneFlag, sizeof(badZoneFlag)));
+
+        ASSERT_TRUE(snapshot.zones.isEmpty());
+    }
+
+    // Rule flags
+    {
+        const Rule rule = { .ruleId = 1, .ruleText = "1.1.1.1" };
+
+        class TestRules : public ConfRulesWalker
+        {
+        public:
+            explicit TestRules(const Rule &rule) : m_rule(rule) { }
+
+            bool walkRules(
+                    WalkRulesArgs &wra, const std::function<walkRulesCallback> &func) const override
+            {
+                wra.maxRuleId = 2;
+
+                return func(m_rule);
+            }
+
+        private:
+            const Rule &m_rule;
+        };
+
+        ConfBuffer confBuf;
+        ASSERT_TRUE(confBuf.writeRules(TestRules(rule)));
+
+        snapshot.rules = confBuf.buffer();
+
+        const FORT_CONF_RULE_FLAG ruleFlag = { .rule_id = 1, .enabled = false };
+        snapshot.setRuleFlag(QByteArray((const char *) &ruleFlag, sizeof(ruleFlag)));
+
+        ASSERT_FALSE(snapshot.rules.isEmpty());
+
+        PCFORT_CONF_RULES rules = PCFORT_CONF_RULES(snapshot.rules.constData());
+        const FORT_CONF_RULES_RT rulesRt = fort_conf_rules_rt_make(rules, /*zones=*/nullptr);
+        ASSERT_FALSE(fort_conf_rules_rt_rule(&rulesRt, 1)->enabled);
+
+        // Not written rule drops the blob
+        const FORT_CONF_RULE_FLAG missingRuleFlag = { .rule_id = 2, .enabled = true };
+        snapshot.setRuleFlag(QByteArray((const char *) &missingRuleFlag, sizeof(missingRuleFlag)));
+
+        ASSERT_TRUE(snapshot.rules.isEmpty());
+    }
+}
+
+TEST_F(ConfUtilTest, serviceChanges)
+{
+    QVector<ServiceInfo> services(2);
+
+    services[0].isRunning = true;
+    services[0].processId = 1234;
+    services[0].serviceName = "Dnscache";
+
+    services[1].processId = 4321; // stopped
+    services[1].serviceName = "Dhcp";
+
+    ConfBuffer confBuf;
+    confBuf.writeServiceChanges(services);
+
+    const char *data = confBuf.data();
+
+    const auto infoList = PCFORT_SERVICE_INFO_LIST(data);
+    ASSERT_EQ(infoList->services_n, 2);
+
+    const auto info1 = PCFORT_SERVICE_INFO(data + FORT_SERVICE_INFO_LIST_DATA_OFF);
+    ASSERT_EQ(info1->process_id, 1234);
+    ASSERT_EQ(QString::fromUtf16(
+                      (const char16_t *) info1->name, info1->name_len / sizeof(char16_t)),
+            "Dnscache");
+
+    const auto info2 = PCFORT_SERVICE_INFO((const char *) info1 + FORT_SERVICE_INFO_NAME_OFF
+            + FORT_CONF_STR_DATA_SIZE(info1->name_len));
+    ASSERT_EQ(info2->process_id, 0);
+    ASSERT_EQ(QString::fromUtf16(
+                      (const char16_t *) info2->name, info2->name_len / sizeof(char16_t)),
+            "Dhcp");
+
+    ASSERT_EQ(confBuf.buffer().size(),
+            (const char *) info2 + FORT_SERVICE_INFO_NAME_OFF
+                    + FORT_CONF_STR_DATA_SIZE(info2->name_len) - data);
+}
+
+TEST_F(ConfUtilTest, pendingDecisions)
+{
+    const QHash<QString, bool> decisions = {
+        { R"(\device\harddiskvolume1\app.exe)", true },
+    };
+
+    const PendingLimits limits = { .expireSecs = 30 };
+
+    ConfBuffer confBuf;
+    confBuf.writePendingDecisions(decisions, limits);
+
+    const char *data = confBuf.data();
+
+    const auto decisionList = PCFORT_PENDING_DECISION_LIST(data);
+    ASSERT_EQ(decisionList->limits.apps_max, 0);
+    ASSERT_EQ(decisionList->limits.expire_secs, 30);
+    ASSERT_EQ(decisionList->decisions_n, 1);
+
+    const auto decision = PCFORT_PENDING_DECISION(data + FORT_PENDING_DECISION_LIST_DATA_OFF);
+    ASSERT_TRUE(decision->allow);
+    ASSERT_EQ(QString::fromUtf16(
+                      (const char16_t *) decision->path, decision->path_len / sizeof(char16_t)),
+            R"(\device\harddiskvolume1\app.exe)");
+
+    ASSERT_EQ(confBuf.buffer().size(),
+            FORT_PENDING_DECISION_LIST_DATA_OFF + FORT_PENDING_DECISION_PATH_OFF
+                    + FORT_CONF_STR_DATA_SIZE(decision->path_len));
+}
+
+class TestQuotaConfAppsWalker : public TestConfAppsWalker
+{
+public:
+    using TestConfAppsWalker::TestConfAppsWalker;
+
+    void appQuotaTraffic(const App &app, quint64 &dayBytes, quint64 &monthBytes) const override
+    {
+        dayBytes = (app.quotaDayMb != 0) ? 1000 : 0;
+        monthBytes = (app.quotaMonthMb != 0) ? 2000 : 0;
+    }
+};
+
+TEST_F(ConfUtilTest, confAppQuotas)
+{
+    EnvManager envManager;
+    FirewallConf conf;
+
+    auto appGroup1 = new AppGroup();
+    appGroup1->setId(1);
+    appGroup1->setQuotaMonthMb(10);
+
+    auto appGroup2 = new AppGroup();
+    appGroup2->setId(2);
+
+    conf.addAppGroup(appGroup1);
+    conf.addAppGroup(appGroup2);
+
+    App app1;
+    app1.appId = 11;
+    app1.appPath = "C:\\Utils\\Updater.exe";
+    app1.quotaDayMb = 1;
+    app1.quotaThrottleGroup = 2;
+
+    App app2;
+    app2.appId = 12;
+    app2.appPath = "C:\\Utils\\Browser.exe";
+
+    const TestQuotaConfAppsWalker confAppsWalker({ app1, app2 });
+
+    conf.resetEdited(FirewallConf::AllEdited);
+    conf.prepareToSave();
+
+    ConfBuffer confBuf;
+
+    if (!confBuf.writeConf(conf, &confAppsWalker, envManager)) {
+        qCritical() << "Error:" << confBuf.errorMessage();
+        Q_UNREACHABLE();
+    }
+
+    const auto confIo = PCFORT_CONF_IO(confBuf.data());
+    const char *data = confBuf.data() + DriverCommon::confIoConfOff();
+
+    ASSERT_EQ(confIo->conf.quotas_n, 2);
+
+    const auto appData1 =
+            DriverCommon::confAppFind(data, FileUtil::pathToKernelPath(app1.appPath));
+    const auto appData2 =
+            DriverCommon::confAppFind(data, FileUtil::pathToKernelPath(app2.appPath));
+
+    ASSERT_NE(appData1.quota_id, 0);
+    ASSERT_EQ(appData2.quota_id, 0);
+
+    // The app's quota is seeded with the logged traffic
+    const auto quota1 = DriverCommon::confQuota(data, appData1.quota_id);
+    ASSERT_EQ(quota1.key, 11);
+    ASSERT_EQ(quota1.throttle_group, 2);
+    ASSERT_EQ(quota1.day_bytes, 1024 * 1024);
+    ASSERT_EQ(quota1.month_bytes, 0);
+    ASSERT_EQ(quota1.day_used, 1000);
+    ASSERT_EQ(quota1.month_used, 0);
+
+    // Only the first group has a quota
+    const quint16 groupQuotaId = confIo->conf_group.quota_ids[0];
+    ASSERT_NE(groupQuotaId, 0);
+    ASSERT_NE(groupQuotaId, appData1.quota_id);
+    ASSERT_EQ(confIo->conf_group.quota_ids[1], 0);
+
+    const auto groupQuota = DriverCommon::confQuota(data, groupQuotaId);
+    ASSERT_NE(groupQuota.key, 1);
+    ASSERT_EQ(groupQuota.throttle_group, 0);
+    ASSERT_EQ(groupQuota.month_bytes, 10 * 1024 * 1024);
+}
+
 TEST_F(ConfUtilTest, checkEnvManager)
 {
     EnvManager envManager;
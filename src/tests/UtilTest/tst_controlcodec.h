@@ -0,0 +1,331 @@
+#pragma once
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <QSize>
+
+#include <googletest.h>
+
+#include <conf/app.h>
+#include <conf/rule.h>
+#include <control/controlcodec.h>
+#include <rpc/confappmanagerrpc.h>
+#include <rpc/confrulemanagerrpc.h>
+
+class ControlCodecTest : public Test
+{
+    // Test interface
+protected:
+    void SetUp();
+    void TearDown();
+};
+
+void ControlCodecTest::SetUp() { }
+
+void ControlCodecTest::TearDown() { }
+
+namespace {
+
+QVariant randomArg(QRandomGenerator &rand, int depth = 0)
+{
+    switch (rand.bounded(depth < 2 ? 11 : 8)) {
+    case 0:
+        return QVariant();
+    case 1:
+        return bool(rand.bounded(2));
+    case 2:
+        return qint64(rand.generate64());
+    case 3:
+        return quint64(rand.bounded(1000));
+    case 4:
+        return rand.generateDouble();
+    case 5: {
+        QString s(rand.bounded(64), Qt::Uninitialized);
+        for (QChar &c : s) {
+            c = QChar(char16_t(rand.bounded(0x20, 0x500)));
+        }
+        return s;
+    }
+    case 6: {
+        QByteArray bytes(rand.bounded(64), '\0');
+        for (char &c : bytes) {
+            c = char(rand.generate());
+        }
+        return bytes;
+    }
+    case 7:
+        return QStringList { "a", QString::number(rand.generate()), "" };
+    case 8: {
+        QVariantList list;
+        for (int n = rand.bounded(4); n > 0; --n) {
+            list.append(randomArg(rand, depth + 1));
+        }
+        return list;
+    }
+    case 9: {
+        QVariantMap map;
+        for (int n = rand.bounded(4); n > 0; --n) {
+            map.insert(QString::number(n), randomArg(rand, depth + 1));
+        }
+        return map;
+    }
+    default:
+        return QDateTime::fromMSecsSinceEpoch(qint64(rand.bounded(1 << 30)) * 1000);
+    }
+}
+
+QVariantList randomArgs(QRandomGenerator &rand)
+{
+    QVariantList args;
+    for (int n = rand.bounded(8); n > 0; --n) {
+        args.append(randomArg(rand));
+    }
+    return args;
+}
+
+QByteArray streamArgs(const QVariantList &args)
+{
+    QByteArray data;
+    QDataStream stream(&data, QDataStream::WriteOnly);
+
+    stream << qint8(args.size());
+
+    for (const auto &arg : args) {
+        stream << arg;
+    }
+
+    return data;
+}
+
+}
+
+TEST_F(ControlCodecTest, argsRoundTrip)
+{
+    const QDateTime dateTime = QDateTime::fromMSecsSinceEpoch(1700000000123);
+
+    const QVariantList args = {
+        QVariant(),
+        true,
+        false,
+        int(-1),
+        qint64(Q_INT64_C(-9000000000)),
+        quint32(0xFFFFFFFF),
+        quint64(Q_UINT64_C(0xFFFFFFFFFFFFFFFF)),
+        -2.5,
+        QString(),
+        QString("C:\\Program Files\\Путь\\app.exe"),
+        QByteArray("\x00\x01\xFF", 3),
+        dateTime,
+        QVariantList { 1, QString("x"), QVariantList { false } },
+        QStringList { "a", "", "b" },
+        QVariantMap { { "k1", 7u }, { "k2", QString("v") } },
+        QVariant::fromValue(QSize(3, 4)),
+    };
+
+    const QByteArray data = ControlCodec::encodeArgs(args);
+
+    QVariantList decoded;
+    ASSERT_TRUE(ControlCodec::decodeArgs(data, decoded));
+    ASSERT_EQ(decoded.size(), args.size());
+
+    ASSERT_TRUE(decoded[0].isNull());
+    ASSERT_TRUE(decoded[1].toBool());
+    ASSERT_FALSE(decoded[2].toBool());
+    ASSERT_EQ(decoded[3].toInt(), -1);
+    ASSERT_EQ(decoded[4].toLongLong(), Q_INT64_C(-9000000000));
+    ASSERT_EQ(decoded[5].toUInt(), 0xFFFFFFFF);
+    ASSERT_EQ(decoded[6].toULongLong(), Q_UINT64_C(0xFFFFFFFFFFFFFFFF));
+    ASSERT_EQ(decoded[7].toDouble(), -2.5);
+    ASSERT_TRUE(decoded[8].toString().isEmpty());
+    ASSERT_EQ(decoded[9].toString(), args[9].toString());
+    ASSERT_EQ(decoded[10].toByteArray(), args[10].toByteArray());
+    ASSERT_EQ(decoded[11].toDateTime(), dateTime);
+    ASSERT_EQ(decoded[12].toList().size(), 3);
+    ASSERT_EQ(decoded[12].toList()[2].toList()[0].toBool(), false);
+    ASSERT_EQ(decoded[13].toStringList(), args[13].toStringList());
+    ASSERT_EQ(decoded[14].toMap().value("k1").toUInt(), 7);
+    ASSERT_EQ(decoded[14].toMap().value("k2").toString(), "v");
+    ASSERT_EQ(decoded[15].toSize(), QSize(3, 4));
+
+    // Trailing data must be rejected
+    QVariantList trailing;
+    ASSERT_FALSE(ControlCodec::decodeArgs(data + '\0', trailing));
+}
+
+TEST_F(ControlCodecTest, fuzzDecode)
+{
+    constexpr int iterCount = 5000;
+
+    QRandomGenerator rand(0xF0F7);
+
+    for (int i = 0; i < iterCount; ++i) {
+        const QVariantList args = randomArgs(rand);
+        const QByteArray data = ControlCodec::encodeArgs(args);
+
+        QVariantList decoded;
+        ASSERT_TRUE(ControlCodec::decodeArgs(data, decoded));
+        ASSERT_EQ(decoded, args);
+
+        // Truncated data must be rejected
+        if (data.size() > 1) {
+            QVariantList truncated;
+            ASSERT_FALSE(ControlCodec::decodeArgs(
+                    data.left(rand.bounded(1, int(data.size()))), truncated));
+        }
+
+        // Corrupted data must be decoded safely or rejected
+        QByteArray corrupted = data;
+        for (int n = rand.bounded(1, 4); n > 0; --n) {
+            corrupted[rand.bounded(int(corrupted.size()))] = char(rand.generate());
+        }
+
+        QVariantList garbage;
+        ControlCodec::decodeArgs(corrupted, garbage);
+    }
+
+    // Nesting must be limited
+    QByteArray nested;
+    for (int i = 0; i < 100; ++i) {
+        nested.append(char(1));
+        nested.append(char(ControlCodec::ArgList));
+    }
+    nested.append(char(0));
+
+    QVariantList deep;
+    ASSERT_FALSE(ControlCodec::decodeArgs(nested, deep));
+}
+
+TEST_F(ControlCodecTest, codecThroughput)
+{
+    constexpr int iterCount = 20000;
+
+    // Typical service events and commands
+    const QVariantList args = {
+        qint64(1700000000),
+        quint32(123456),
+        quint32(7890),
+        QString("C:\\Program Files\\Fort Firewall\\FortFirewall.exe"),
+        true,
+        QStringList { "1.1.1.1", "8.8.8.8" },
+    };
+
+    qint64 streamBytes = 0;
+    qint64 codecBytes = 0;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    for (int i = 0; i < iterCount; ++i) {
+        const QByteArray data = streamArgs(args);
+        streamBytes += data.size();
+
+        QDataStream stream(data);
+
+        qint8 argsCount;
+        stream >> argsCount;
+
+        QVariantList decoded;
+        while (--argsCount >= 0) {
+            QVariant arg;
+            stream >> arg;
+            decoded.append(arg);
+        }
+    }
+
+    const qint64 streamNs = timer.nsecsElapsed();
+
+    timer.restart();
+
+    for (int i = 0; i < iterCount; ++i) {
+        const QByteArray data = ControlCodec::encodeArgs(args);
+        codecBytes += data.size();
+
+        QVariantList decoded;
+        ControlCodec::decodeArgs(data, decoded);
+    }
+
+    const qint64 codecNs = timer.nsecsElapsed();
+
+    qDebug() << "QDataStream:" << (streamNs / iterCount) << "ns/msg,"
+             << (streamBytes / iterCount) << "bytes/msg;"
+             << "codec:" << (codecNs / iterCount) << "ns/msg," << (codecBytes / iterCount)
+             << "bytes/msg";
+
+    ASSERT_LT(codecBytes, streamBytes);
+}
+
+TEST_F(ControlCodecTest, typedLayouts)
+{
+    App app;
+    app.applyChild = true;
+    app.logAllowedConn = false;
+    app.killProcess = true;
+    app.groupIndex = 3;
+    app.acceptZones = 0x80000001;
+    app.ruleId = 1024;
+    app.appId = 123456789;
+    app.appOriginPath = "C:\\Program Files\\Путь\\app.exe";
+    app.appPath = "c:\\program files\\путь\\app.exe";
+    app.appName = "App";
+    app.scheduleAction = App::ScheduleRemove;
+    app.scheduleTime = QDateTime::fromMSecsSinceEpoch(1700000000123);
+    app.speedLimitOut = 0xFFFFFFFF;
+    app.quotaMonthMb = 500;
+    app.quotaThrottleGroup = 2;
+
+    const QByteArray appData = ConfAppManagerRpc::appToBytes(app);
+
+    App decodedApp;
+    ASSERT_TRUE(ConfAppManagerRpc::bytesToApp(appData, decodedApp));
+    ASSERT_TRUE(decodedApp.isFlagsEqual(app));
+    ASSERT_TRUE(decodedApp.isOptionsEqual(app));
+    ASSERT_TRUE(decodedApp.isNameEqual(app));
+    ASSERT_EQ(decodedApp.appId, app.appId);
+    ASSERT_EQ(decodedApp.appOriginPath, app.appOriginPath);
+    ASSERT_EQ(decodedApp.scheduleTime, app.scheduleTime);
+
+    // The null schedule time stays null
+    App defaultApp;
+    ASSERT_TRUE(ConfAppManagerRpc::bytesToApp(
+            ConfAppManagerRpc::appToBytes(App()), defaultApp));
+    ASSERT_TRUE(defaultApp.scheduleTime.isNull());
+    ASSERT_TRUE(defaultApp.logBlockedConn);
+
+    // Truncated and extended data must be rejected
+    ASSERT_FALSE(ConfAppManagerRpc::bytesToApp(appData.left(appData.size() - 1), decodedApp));
+    ASSERT_FALSE(ConfAppManagerRpc::bytesToApp(appData + '\0', decodedApp));
+
+    Rule rule;
+    rule.blocked = true;
+    rule.terminate = true;
+    rule.ruleType = Rule::PresetRule;
+    rule.ruleId = 300;
+    rule.rejectZones = 5;
+    rule.ruleName = "Rule";
+    rule.ruleText = "1.1.1.1:53\n{ tcp }";
+    rule.ruleSet = { 1, 255, 1024 };
+
+    const QByteArray ruleData = ConfRuleManagerRpc::ruleToBytes(rule);
+
+    Rule decodedRule;
+    ASSERT_TRUE(ConfRuleManagerRpc::bytesToRule(ruleData, decodedRule));
+    ASSERT_TRUE(decodedRule.isFlagsEqual(rule));
+    ASSERT_TRUE(decodedRule.isOptionsEqual(rule));
+    ASSERT_TRUE(decodedRule.isNameEqual(rule));
+    ASSERT_EQ(decodedRule.ruleId, rule.ruleId);
+    ASSERT_EQ(decodedRule.ruleSet, rule.ruleSet);
+
+    ASSERT_FALSE(
+            ConfRuleManagerRpc::bytesToRule(ruleData.left(ruleData.size() - 1), decodedRule));
+
+    // The typed layout is smaller than the generic args
+    const QVariantList ruleArgs = { rule.enabled, rule.blocked, rule.exclusive, rule.terminate,
+        rule.terminateBlocked, rule.ruleSetEdited, rule.ruleType, rule.ruleId, rule.acceptZones,
+        rule.rejectZones, rule.ruleName, rule.notes, rule.ruleText,
+        QVariantList { 1, 255, 1024 } };
+
+    ASSERT_LT(ruleData.size(), ControlCodec::encodeArgs(ruleArgs).size());
+}
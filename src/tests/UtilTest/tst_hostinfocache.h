@@ -0,0 +1,135 @@
+#pragma once
+
+#include <QThread>
+
+#include <googletest.h>
+
+#include <hostinfo/hostinfo.h>
+#include <hostinfo/hostinfocache.h>
+#include <hostinfo/hostinfomanager.h>
+
+namespace HostInfoTest {
+
+class TestHostInfoManager : public HostInfoManager
+{
+public:
+    int lookupCount(const QByteArray &ipKey) const { return m_lookupKeys.count(ipKey); }
+
+    void lookupHost(const QByteArray &ipKey) override { m_lookupKeys.append(ipKey); }
+
+    void finishLookup(const ip_addr_t &ip, const QString &hostName)
+    {
+        emit lookupFinished(HostInfo::ipToKey(ip), hostName);
+    }
+
+private:
+    QList<QByteArray> m_lookupKeys;
+};
+
+ip_addr_t testIp(quint32 v4)
+{
+    ip_addr_t ip;
+    memset(&ip, 0, sizeof(ip_addr_t));
+    ip.v4 = v4;
+    return ip;
+}
+
+}
+
+class HostInfoCacheTest : public Test
+{
+    // Test interface
+protected:
+    void SetUp();
+    void TearDown();
+};
+
+void HostInfoCacheTest::SetUp() { }
+
+void HostInfoCacheTest::TearDown() { }
+
+TEST_F(HostInfoCacheTest, lookupCoalescing)
+{
+    using namespace HostInfoTest;
+
+    auto manager = new TestHostInfoManager();
+    HostInfoCache cache(manager);
+
+    const ip_addr_t ip = testIp(0x01020304);
+    const QByteArray ipKey = HostInfo::ipToKey(ip);
+
+    // Pending lookups are shared
+    ASSERT_TRUE(cache.hostName(ip).isEmpty());
+    ASSERT_TRUE(cache.hostName(ip).isEmpty());
+    ASSERT_TRUE(cache.hostName(ip).isEmpty());
+
+    ASSERT_EQ(manager->lookupCount(ipKey), 1);
+
+    manager->finishLookup(ip, "host.example");
+
+    ASSERT_EQ(cache.hostName(ip), "host.example");
+    ASSERT_EQ(manager->lookupCount(ipKey), 1);
+
+    // The IPv4 and IPv6 keys differ
+    ASSERT_TRUE(cache.hostName(ip, /*isIPv6=*/true).isEmpty());
+    ASSERT_EQ(manager->lookupCount(HostInfo::ipToKey(ip, /*isIPv6=*/true)), 1);
+}
+
+TEST_F(HostInfoCacheTest, nameTtlExpiry)
+{
+    using namespace HostInfoTest;
+
+    auto manager = new TestHostInfoManager();
+    HostInfoCache cache(manager);
+    cache.setNameTtl(50);
+
+    const ip_addr_t ip = testIp(0x05060708);
+    const QByteArray ipKey = HostInfo::ipToKey(ip);
+
+    cache.hostName(ip);
+    manager->finishLookup(ip, "host.example");
+
+    // Not expired yet
+    ASSERT_EQ(cache.hostName(ip), "host.example");
+    ASSERT_EQ(manager->lookupCount(ipKey), 1);
+
+    QThread::msleep(100);
+
+    // The expired name is kept until it's refreshed once
+    ASSERT_EQ(cache.hostName(ip), "host.example");
+    ASSERT_EQ(cache.hostName(ip), "host.example");
+    ASSERT_EQ(manager->lookupCount(ipKey), 2);
+
+    manager->finishLookup(ip, "new.example");
+
+    ASSERT_EQ(cache.hostName(ip), "new.example");
+    ASSERT_EQ(manager->lookupCount(ipKey), 2);
+}
+
+TEST_F(HostInfoCacheTest, noNameTtlExpiry)
+{
+    using namespace HostInfoTest;
+
+    auto manager = new TestHostInfoManager();
+    HostInfoCache cache(manager);
+    cache.setNameTtl(60 * 60 * 1000);
+    cache.setNoNameTtl(50);
+
+    const ip_addr_t namedIp = testIp(0x0A000001);
+    const ip_addr_t unnamedIp = testIp(0x0A000002);
+
+    cache.hostName(namedIp);
+    cache.hostName(unnamedIp);
+
+    manager->finishLookup(namedIp, "named.example");
+    manager->finishLookup(unnamedIp, QString());
+
+    QThread::msleep(100);
+
+    // Only the negative result is expired
+    ASSERT_EQ(cache.hostName(namedIp), "named.example");
+    ASSERT_TRUE(cache.hostName(unnamedIp).isEmpty());
+
+    ASSERT_EQ(manager->lookupCount(HostInfo::ipToKey(namedIp)), 1);
+    ASSERT_EQ(manager->lookupCount(HostInfo::ipToKey(unnamedIp)), 2);
+}
@@ -1,7 +1,15 @@
 #pragma once
 
+#include <QCryptographicHash>
+#include <QElapsedTimer>
 #include <QFileInfo>
 #include <QSignalSpy>
+#include <QTemporaryDir>
+
+#define WIN32_LEAN_AND_MEAN
+#include <qt_windows.h>
+
+#include <psapi.h>
 
 #include <googletest.h>
 
@@ -112,6 +120,21 @@ TEST_F(NetUtilTest, ip4Ranges)
         ASSERT_EQ(ipRange.ip4At(0), NetFormatUtil::textToIp4("127.0.0.1"));
     }
 
+    // Merge adjacent ranges and fold the contained addresses
+    {
+        ASSERT_TRUE(ipRange.fromText("10.0.0.0/8\n"
+                                     "10.0.0.0\n"
+                                     "10.1.2.3\n"
+                                     "11.0.0.0/8\n"
+                                     "12.0.0.1\n"
+                                     "12.0.0.2\n"));
+        ASSERT_EQ(ipRange.ip4Size(), 0);
+        ASSERT_EQ(ipRange.pair4Size(), 2);
+        ASSERT_EQ(ipRange.toText(),
+                QString("10.0.0.0-11.255.255.255\n"
+                        "12.0.0.1-12.0.0.2\n"));
+    }
+
     // Merge ranges
     {
         ASSERT_TRUE(ipRange.fromText("10.0.0.0 - 10.0.0.255\n"
@@ -140,11 +163,27 @@ TEST_F(NetUtilTest, ip6Ranges)
     ASSERT_TRUE(ipRange.fromText("2002::/16"));
     ASSERT_EQ(ipRange.toText(), QString("2002::-2002:ffff:ffff:ffff:ffff:ffff:ffff:ffff\n"));
 
+    ASSERT_FALSE(ipRange.fromText("::3 - ::1"));
+
+    // Merge overlapping ranges
     ASSERT_TRUE(ipRange.fromText("[::2]/126\n"
                                  "[::1]/126\n"));
-    ASSERT_EQ(ipRange.toText(),
-            QString("::1-::3\n"
-                    "::2-::3\n"));
+    ASSERT_EQ(ipRange.toText(), QString("::1-::3\n"));
+
+    // Merge adjacent ranges and fold the contained addresses
+    {
+        ASSERT_TRUE(ipRange.fromText("2001:db8::/33\n"
+                                     "2001:db8:8000::/33\n"
+                                     "2001:db8::1\n"
+                                     "2001:db9::\n"
+                                     "fe80::1\n"
+                                     "fe80::1\n"));
+        ASSERT_EQ(ipRange.ip6Size(), 1);
+        ASSERT_EQ(ipRange.pair6Size(), 1);
+        ASSERT_EQ(ipRange.toText(),
+                QString("fe80::1\n"
+                        "2001:db8::-2001:db9::\n"));
+    }
 }
 
 TEST_F(NetUtilTest, portRanges)
@@ -243,7 +282,252 @@ TEST_F(NetUtilTest, taskTasix)
     tasix.setCachePath(cachePath);
     ASSERT_TRUE(tasix.storeAddresses(list));
 
+    // Compression of the normalized ranges
+    {
+        IpRange ipRange;
+        ipRange.setEmptyNetMask(24);
+        ASSERT_TRUE(ipRange.fromList(list));
+
+        const int rangeCount =
+                ipRange.ip4Size() + ipRange.pair4Size() + ipRange.ip6Size() + ipRange.pair6Size();
+        ASSERT_GT(rangeCount, 0);
+        ASSERT_LE(rangeCount, list.size());
+
+        qDebug() << "Zone ranges:" << list.size() << "->" << rangeCount << "ratio:"
+                 << (double(list.size()) / rangeCount);
+    }
+
     const QFileInfo out(cachePath + "tasix-mrlg.txt");
     ASSERT_TRUE(tasix.saveAddressesAsText(out.filePath()));
     ASSERT_GT(out.size(), 0);
 }
+
+TEST_F(NetUtilTest, taskBigList)
+{
+    constexpr int lineCount = 2000000;
+
+    // Generate the "a.b.c.d" and "a.b.c.0/24" lines
+    QByteArray buf;
+    buf.reserve(lineCount * 20);
+
+    quint32 seed = 1;
+    for (int i = 0; i < lineCount; ++i) {
+        seed = seed * 1103515245 + 12345;
+
+        const quint32 ip = seed;
+        const bool isNet = (i % 4 == 0);
+
+        buf += QByteArray::number(ip >> 24) + '.' + QByteArray::number((ip >> 16) & 0xFF) + '.'
+                + QByteArray::number((ip >> 8) & 0xFF) + '.'
+                + (isNet ? QByteArray("0/24") : QByteArray::number(ip & 0xFF)) + "\r\n";
+    }
+
+    TaskZoneDownloader zone;
+    zone.setSort(true);
+    zone.setIp4FastPath(true);
+    zone.setPattern("^\\s*(\\[?[A-Fa-f\\d:.]+\\]?\\s*[\\/-]?\\s*\\S*)");
+
+    QElapsedTimer timer;
+    timer.start();
+
+    QString textChecksum;
+    const auto text = QString::fromLatin1(buf);
+    const auto list = zone.parseAddresses(text, textChecksum);
+    ASSERT_EQ(list.size(), lineCount);
+
+    const qint64 parseMs = timer.restart();
+
+    IpRange ipRange;
+    ASSERT_TRUE(ipRange.fromList(list));
+    ASSERT_GT(ipRange.ip4Size() + ipRange.pair4Size(), 0);
+
+    const qint64 rangeMs = timer.elapsed();
+
+    PROCESS_MEMORY_COUNTERS pmc;
+    GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc));
+
+    qDebug() << "Zone list:" << lineCount << "lines;"
+             << "parse:" << parseMs << "ms;"
+             << "ranges:" << rangeMs << "ms;"
+             << "peak RSS:" << (pmc.PeakWorkingSetSize / (1024 * 1024)) << "MiB";
+}
+
+namespace {
+
+void setupZoneCache(TaskZoneDownloader &zone, const QString &cachePath)
+{
+    zone.setZoneId(1);
+    zone.setIp4FastPath(true);
+    zone.setCachePath(cachePath);
+}
+
+QByteArray storeZoneCache(TaskZoneDownloader &zone)
+{
+    const QString text("1.1.1.1\n"
+                       "2.2.2.0/24\n"
+                       "10.0.0.1\n");
+
+    QString textChecksum;
+    const auto list = zone.parseAddresses(text, textChecksum);
+
+    if (!zone.storeAddresses(list))
+        return {};
+
+    return QByteArray(zone.zoneData().constData(), zone.zoneData().size()); // deep copy
+}
+
+bool loadZoneCache(const QString &cachePath, const QString &binChecksum, QByteArray &zoneData)
+{
+    TaskZoneDownloader zone;
+    setupZoneCache(zone, cachePath);
+    zone.setBinChecksum(binChecksum);
+
+    if (!zone.loadAddresses())
+        return false;
+
+    zoneData = QByteArray(zone.zoneData().constData(), zone.zoneData().size());
+    return true;
+}
+
+QByteArray zoneCacheFile(const TaskZoneDownloader::CacheHeader &header, const QByteArray &zoneData)
+{
+    QByteArray data(TaskZoneDownloader::CacheDataOffset, '\0');
+    memcpy(data.data(), &header, sizeof(header));
+
+    return data + zoneData;
+}
+
+}
+
+TEST_F(NetUtilTest, zoneCacheRoundTrip)
+{
+    QTemporaryDir tempDir;
+    ASSERT_TRUE(tempDir.isValid());
+
+    const QString cachePath = tempDir.path() + '/';
+
+    TaskZoneDownloader zone;
+    setupZoneCache(zone, cachePath);
+
+    const QByteArray zoneData = storeZoneCache(zone);
+    ASSERT_FALSE(zoneData.isEmpty());
+
+    // The header is followed by the zone data at the page aligned offset
+    const QByteArray fileData = FileUtil::readFileData(zone.cacheFileBinPath());
+    ASSERT_EQ(fileData.size(), TaskZoneDownloader::CacheDataOffset + zoneData.size());
+
+    const auto header = reinterpret_cast<const TaskZoneDownloader::CacheHeader *>(fileData.data());
+    ASSERT_EQ(header->magic, TaskZoneDownloader::CacheMagic);
+    ASSERT_EQ(header->version, TaskZoneDownloader::CacheVersion);
+    ASSERT_EQ(header->dataOffset, TaskZoneDownloader::CacheDataOffset);
+    ASSERT_EQ(header->dataSize, quint32(zoneData.size()));
+    ASSERT_EQ(fileData.mid(header->dataOffset), zoneData);
+
+    // The mapped zone data
+    QByteArray loadedData;
+    ASSERT_TRUE(loadZoneCache(cachePath, zone.binChecksum(), loadedData));
+    ASSERT_EQ(loadedData, zoneData);
+
+    // The checksum mismatch
+    ASSERT_FALSE(loadZoneCache(cachePath, "bad", loadedData));
+    ASSERT_FALSE(FileUtil::fileExists(zone.cacheFileBinPath()));
+}
+
+TEST_F(NetUtilTest, zoneCacheCompressedFallback)
+{
+    QTemporaryDir tempDir;
+    ASSERT_TRUE(tempDir.isValid());
+
+    const QString cachePath = tempDir.path() + '/';
+
+    TaskZoneDownloader zone;
+    setupZoneCache(zone, cachePath);
+
+    const QByteArray zoneData = storeZoneCache(zone);
+    ASSERT_FALSE(zoneData.isEmpty());
+
+    // The compressed cache file of the previous versions
+    const QByteArray binData = qCompress(zoneData);
+    ASSERT_TRUE(FileUtil::writeFileData(zone.cacheFileBinPath(), binData));
+
+    const QString binChecksum = QString::fromLatin1(
+            QCryptographicHash::hash(binData, QCryptographicHash::Sha256).toHex());
+
+    QByteArray loadedData;
+    ASSERT_TRUE(loadZoneCache(cachePath, binChecksum, loadedData));
+    ASSERT_EQ(loadedData, zoneData);
+}
+
+TEST_F(NetUtilTest, zoneCacheBadFiles)
+{
+    QTemporaryDir tempDir;
+    ASSERT_TRUE(tempDir.isValid());
+
+    const QString cachePath = tempDir.path() + '/';
+
+    TaskZoneDownloader zone;
+    setupZoneCache(zone, cachePath);
+
+    const QByteArray zoneData = storeZoneCache(zone);
+    ASSERT_FALSE(zoneData.isEmpty());
+
+    const QString filePath = zone.cacheFileBinPath();
+    const QString binChecksum = zone.binChecksum();
+
+    const TaskZoneDownloader::CacheHeader validHeader = {
+        .magic = TaskZoneDownloader::CacheMagic,
+        .version = TaskZoneDownloader::CacheVersion,
+        .dataOffset = TaskZoneDownloader::CacheDataOffset,
+        .dataSize = quint32(zoneData.size()),
+    };
+
+    const auto checkRejected = [&](const QByteArray &fileData) {
+        QByteArray loadedData;
+        return FileUtil::writeFileData(filePath, fileData)
+                && !loadZoneCache(cachePath, binChecksum, loadedData)
+                && !FileUtil::fileExists(filePath);
+    };
+
+    // The valid file
+    {
+        QByteArray loadedData;
+        ASSERT_TRUE(FileUtil::writeFileData(filePath, zoneCacheFile(validHeader, zoneData)));
+        ASSERT_TRUE(loadZoneCache(cachePath, binChecksum, loadedData));
+        ASSERT_EQ(loadedData, zoneData);
+    }
+
+    // Bad magic: not a compressed file of the previous versions too
+    {
+        auto header = validHeader;
+        header.magic = 0x12345678;
+
+        ASSERT_TRUE(checkRejected(zoneCacheFile(header, zoneData)));
+    }
+
+    // Unknown version
+    {
+        auto header = validHeader;
+        header.version = TaskZoneDownloader::CacheVersion + 1;
+
+        ASSERT_TRUE(checkRejected(zoneCacheFile(header, zoneData)));
+    }
+
+    // Truncated file
+    {
+        const QByteArray fileData = zoneCacheFile(validHeader, zoneData);
+
+        ASSERT_TRUE(checkRejected(fileData.left(fileData.size() - 1)));
+        ASSERT_TRUE(checkRejected(fileData.left(TaskZoneDownloader::CacheDataOffset / 2)));
+    }
+
+    // Wrong data offset
+    {
+        auto header = validHeader;
+
+        header.dataOffset = sizeof(TaskZoneDownloader::CacheHeader) - 1;
+        ASSERT_TRUE(checkRejected(zoneCacheFile(header, zoneData)));
+
+        header.dataOffset = TaskZoneDownloader::CacheDataOffset + 1;
+        ASSERT_TRUE(checkRejected(zoneCacheFile(header, zoneData)));
+    }
+}
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <QDebug>
+
+#include <googletest.h>
+
+#include <control/controlworker.h>
+#include <rpc/rpceventbus.h>
+
+class RpcEventBusTest : public Test
+{
+    // Test interface
+protected:
+    void SetUp();
+    void TearDown();
+};
+
+void RpcEventBusTest::SetUp() { }
+
+void RpcEventBusTest::TearDown() { }
+
+TEST_F(RpcEventBusTest, batchRoundTrip)
+{
+    const RpcEvents events = {
+        { .command = Control::Rpc_StatManager_trafficAdded,
+                .args = { qint64(1700000000), quint32(0xFFFFFFFF), quint32(0) } },
+        { .command = Control::Rpc_StatManager_appCreated,
+                .args = { qint64(-5), QString("C:\\Program Files\\Путь\\app.exe") } },
+        { .command = Control::Rpc_StatConnManager_connChanged },
+        { .command = Control::Rpc_StatManager_appStatRemoved,
+                .args = { true, QVariant(), QByteArray("\x00\x01", 2), 1.5 } },
+    };
+
+    const QByteArray data = RpcEventBus::encodeEvents(events);
+
+    RpcEvents decoded;
+    ASSERT_TRUE(RpcEventBus::decodeEvents(data, decoded));
+    ASSERT_EQ(decoded.size(), events.size());
+
+    for (int i = 0; i < events.size(); ++i) {
+        const RpcEvent &e = events[i];
+        const RpcEvent &d = decoded[i];
+
+        ASSERT_EQ(d.command, e.command);
+        ASSERT_EQ(d.args.size(), e.args.size());
+    }
+
+    ASSERT_EQ(decoded[0].args[0].toLongLong(), 1700000000);
+    ASSERT_EQ(decoded[0].args[1].toUInt(), 0xFFFFFFFF);
+    ASSERT_EQ(decoded[1].args[0].toLongLong(), -5);
+    ASSERT_EQ(decoded[1].args[1].toString(), events[1].args[1].toString());
+    ASSERT_TRUE(decoded[3].args[0].toBool());
+    ASSERT_TRUE(decoded[3].args[1].isNull());
+    ASSERT_EQ(decoded[3].args[2].toByteArray(), QByteArray("\x00\x01", 2));
+    ASSERT_EQ(decoded[3].args[3].toDouble(), 1.5);
+
+    // Truncated data must be rejected
+    RpcEvents truncated;
+    ASSERT_FALSE(RpcEventBus::decodeEvents(data.left(data.size() - 1), truncated));
+
+    // Unknown commands must be rejected
+    for (const quint8 command :
+            { quint8(Control::CommandNone), quint8(Control::CommandCount), quint8(0xFF) }) {
+        QByteArray bad;
+        bad.append(char(1)); // events count
+        bad.append(char(command));
+        bad.append(char(0)); // args count
+
+        RpcEvents rejected;
+        ASSERT_FALSE(RpcEventBus::decodeEvents(bad, rejected));
+    }
+}
+
+TEST_F(RpcEventBusTest, coalesceEvents)
+{
+    RpcEventBus bus;
+
+    bus.postEvent(Control::Rpc_StatManager_trafficAdded, { qint64(10), 100u, 10u },
+            RpcEventBus::CoalesceTraffic);
+    bus.postEvent(Control::Rpc_StatManager_trafficAdded, { qint64(10), 200u, 20u },
+            RpcEventBus::CoalesceTraffic);
+    bus.postEvent(Control::Rpc_StatConnManager_connChanged, {}, RpcEventBus::CoalesceUnique);
+    bus.postEvent(Control::Rpc_StatManager_appCreated, { qint64(1), QString("a.exe") });
+    bus.postEvent(Control::Rpc_StatConnManager_connChanged, {}, RpcEventBus::CoalesceUnique);
+    bus.postEvent(Control::Rpc_StatManager_trafficAdded, { qint64(10), 1u, 1u },
+            RpcEventBus::CoalesceTraffic);
+    bus.postEvent(Control::Rpc_StatManager_trafficAdded, { qint64(11), 5u, 5u },
+            RpcEventBus::CoalesceTraffic);
+
+    const RpcEvents &events = bus.events();
+    ASSERT_EQ(events.size(), 5);
+
+    // Only the adjacent traffic of the same second is summed
+    ASSERT_EQ(events[0].command, Control::Rpc_StatManager_trafficAdded);
+    ASSERT_EQ(events[0].args[1].toUInt(), 300);
+    ASSERT_EQ(events[0].args[2].toUInt(), 30);
+    ASSERT_EQ(events[1].command, Control::Rpc_StatConnManager_connChanged);
+    ASSERT_EQ(events[2].command, Control::Rpc_StatManager_appCreated);
+    ASSERT_EQ(events[3].args[1].toUInt(), 1);
+    ASSERT_EQ(events[4].args[0].toLongLong(), 11);
+
+    const QByteArray data = bus.takeBatch();
+    ASSERT_FALSE(data.isEmpty());
+    ASSERT_TRUE(bus.events().isEmpty());
+
+    ASSERT_EQ(bus.postedCount(), 7);
+    ASSERT_EQ(bus.sentCount(), 5);
+    ASSERT_EQ(bus.batchesCount(), 1);
+    ASSERT_EQ(bus.batchesBytes(), quint64(data.size()));
+}
+
+TEST_F(RpcEventBusTest, batchVsPerEventSize)
+{
+    // Flush windows of heavy traffic: log stats, new apps and connections
+    constexpr int windowsCount = 10;
+    constexpr int eventsPerWindow = 100;
+
+    RpcEventBus bus;
+
+    int perEventMessages = 0;
+    qint64 perEventBytes = 0;
+    qint64 batchedBytes = 0;
+
+    const auto postEvent = [&](Control::Command command, const QVariantList &args,
+                                   RpcEventBus::CoalesceType coalesceType) {
+        bus.postEvent(command, args, coalesceType);
+
+        perEventBytes += ControlWorker::buildCommandData(command, args).size();
+        ++perEventMessages;
+    };
+
+    for (int w = 0; w < windowsCount; ++w) {
+        for (int i = 0; i < eventsPerWindow; ++i) {
+            const qint64 unixTime = 1700000000 + (w * eventsPerWindow + i) / 500;
+            const QVariantList trafArgs = { unixTime, quint32(1500 + i), quint32(40 + i) };
+
+            postEvent(Control::Rpc_StatManager_trafficAdded, trafArgs,
+                    RpcEventBus::CoalesceTraffic);
+
+            if (i % 10 == 0) {
+                const QVariantList appArgs = { qint64(w * 10 + i),
+                    QString("C:\\Program Files\\App%1\\app.exe").arg(i) };
+
+                postEvent(Control::Rpc_StatManager_appCreated, appArgs, RpcEventBus::CoalesceNone);
+            }
+
+            if (i % 5 == 0) {
+                postEvent(
+                        Control::Rpc_StatConnManager_connChanged, {}, RpcEventBus::CoalesceUnique);
+            }
+        }
+
+        // The batch is sent as one command
+        const QByteArray data = bus.takeBatch();
+
+        batchedBytes +=
+                ControlWorker::buildCommandData(Control::Rpc_RpcManager_eventBatch, { data })
+                        .size();
+    }
+
+    qDebug() << "Per-event:" << perEventMessages << "messages," << perEventBytes << "bytes;"
+             << "batched:" << bus.batchesCount() << "messages," << batchedBytes << "bytes;"
+             << "events posted:" << bus.postedCount() << "sent:" << bus.sentCount();
+
+    ASSERT_EQ(bus.batchesCount(), windowsCount);
+    ASSERT_LT(batchedBytes, perEventBytes);
+}
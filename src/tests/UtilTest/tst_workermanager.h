@@ -0,0 +1,153 @@
+#pragma once
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QSemaphore>
+#include <QStringList>
+
+#include <googletest.h>
+
+#include <util/worker/workerjob.h>
+#include <util/worker/workermanager.h>
+
+namespace WorkerTest {
+
+struct JobLog
+{
+    void append(const QString &text)
+    {
+        QMutexLocker locker(&mutex);
+        texts.append(text);
+    }
+
+    QStringList list() const
+    {
+        QMutexLocker locker(&mutex);
+        return texts;
+    }
+
+    mutable QMutex mutex;
+    QStringList texts;
+
+    QSemaphore started;
+    QSemaphore gate;
+    QSemaphore done;
+};
+
+class TestJob : public WorkerJob
+{
+public:
+    explicit TestJob(JobLog &log, const QString &text, JobPriority priority = PriorityNormal,
+            bool blocking = false) :
+        WorkerJob(text), m_blocking(blocking), m_priority(priority), m_log(log)
+    {
+    }
+
+    JobPriority priority() const override { return m_priority; }
+
+    void doJob(WorkerObject & /*worker*/) override
+    {
+        if (m_blocking) {
+            m_log.started.release();
+            m_log.gate.acquire();
+        }
+    }
+
+    void reportResult(WorkerObject & /*worker*/) override
+    {
+        m_log.append(text());
+        m_log.done.release();
+    }
+
+private:
+    const bool m_blocking = false;
+    const JobPriority m_priority = PriorityNormal;
+
+    JobLog &m_log;
+};
+
+}
+
+class WorkerManagerTest : public Test
+{
+    // Test interface
+protected:
+    void SetUp();
+    void TearDown();
+};
+
+void WorkerManagerTest::SetUp() { }
+
+void WorkerManagerTest::TearDown() { }
+
+using namespace WorkerTest;
+
+TEST_F(WorkerManagerTest, priorityLanes)
+{
+    JobLog log;
+
+    WorkerManager manager;
+    manager.setMaxWorkersCount(1);
+
+    manager.enqueueJob(WorkerJobPtr(new TestJob(log, "block", WorkerJob::PriorityNormal, true)));
+    ASSERT_TRUE(log.started.tryAcquire(1, 5000));
+
+    manager.enqueueJob(WorkerJobPtr(new TestJob(log, "low", WorkerJob::PriorityLow)));
+    manager.enqueueJob(WorkerJobPtr(new TestJob(log, "normal", WorkerJob::PriorityNormal)));
+    manager.enqueueJob(WorkerJobPtr(new TestJob(log, "high", WorkerJob::PriorityHigh)));
+
+    log.gate.release();
+    ASSERT_TRUE(log.done.tryAcquire(4, 5000));
+
+    ASSERT_EQ(log.list(), QStringList({ "block", "high", "normal", "low" }));
+}
+
+TEST_F(WorkerManagerTest, clearDropsRunningResult)
+{
+    JobLog log;
+
+    WorkerManager manager;
+    manager.setMaxWorkersCount(1);
+
+    manager.enqueueJob(WorkerJobPtr(new TestJob(log, "stale", WorkerJob::PriorityNormal, true)));
+    ASSERT_TRUE(log.started.tryAcquire(1, 5000));
+
+    manager.clear();
+
+    manager.enqueueJob(WorkerJobPtr(new TestJob(log, "fresh")));
+
+    log.gate.release();
+    ASSERT_TRUE(log.done.tryAcquire(1, 5000));
+
+    ASSERT_EQ(log.list(), QStringList({ "fresh" }));
+}
+
+TEST_F(WorkerManagerTest, dispatchThroughput)
+{
+    constexpr int jobCount = 100000;
+
+    JobLog log;
+
+    WorkerManager manager;
+    manager.setMaxWorkersCount(2);
+
+    QElapsedTimer timer;
+    timer.start();
+
+    for (int i = 0; i < jobCount; ++i) {
+        const auto priority = WorkerJob::JobPriority(i % WorkerJob::PriorityCount);
+
+        manager.enqueueJob(WorkerJobPtr(new TestJob(log, {}, priority)));
+    }
+
+    const qint64 enqueueNs = timer.nsecsElapsed();
+
+    ASSERT_TRUE(log.done.tryAcquire(jobCount, 30000));
+
+    const qint64 totalNs = timer.nsecsElapsed();
+
+    qDebug() << "Worker dispatch:" << jobCount << "jobs;"
+             << "enqueue:" << (enqueueNs / jobCount) << "ns/job;"
+             << "total:" << (totalNs / jobCount) << "ns/job";
+}
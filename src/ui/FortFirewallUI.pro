@@ -10,6 +10,7 @@ TEMPLATE = lib
 
 SOURCES += \
     appinfo/appbasejob.cpp \
+    appinfo/appcheckjob.cpp \
     appinfo/appiconjob.cpp \
     appinfo/appinfo.cpp \
     appinfo/appinfocache.cpp \
@@ -29,10 +30,12 @@ SOURCES += \
     conf/rule.cpp \
     conf/zone.cpp \
     control/control.cpp \
+    control/controlcodec.cpp \
     control/controlmanager.cpp \
     control/controlworker.cpp \
     driver/drivercommon.cpp \
     driver/drivermanager.cpp \
+    driver/driversnapshot.cpp \
     driver/driverworker.cpp \
     form/basecontroller.cpp \
     form/controls/appinforow.cpp \
@@ -70,6 +73,7 @@ SOURCES += \
     form/dialog/splashscreen.cpp \
     form/graph/axistickerspeed.cpp \
     form/graph/graphplot.cpp \
+    form/graph/graphvaluemax.cpp \
     form/graph/graphwindow.cpp \
     form/home/homecontroller.cpp \
     form/home/homewindow.cpp \
@@ -157,6 +161,7 @@ SOURCES += \
     rpc/drivermanagerrpc.cpp \
     rpc/logmanagerrpc.cpp \
     rpc/quotamanagerrpc.cpp \
+    rpc/rpceventbus.cpp \
     rpc/rpcmanager.cpp \
     rpc/serviceinfomanagerrpc.cpp \
     rpc/statconnmanagerrpc.cpp \
@@ -249,6 +254,7 @@ SOURCES += \
 
 HEADERS += \
     appinfo/appbasejob.h \
+    appinfo/appcheckjob.h \
     appinfo/appiconjob.h \
     appinfo/appinfo.h \
     appinfo/appinfocache.h \
@@ -269,10 +275,12 @@ HEADERS += \
     conf/zone.h \
     control/control.h \
     control/control_types.h \
+    control/controlcodec.h \
     control/controlmanager.h \
     control/controlworker.h \
     driver/drivercommon.h \
     driver/drivermanager.h \
+    driver/driversnapshot.h \
     driver/driverworker.h \
     form/basecontroller.h \
     form/controls/appinforow.h \
@@ -311,6 +319,7 @@ HEADERS += \
     form/form_types.h \
     form/graph/axistickerspeed.h \
     form/graph/graphplot.h \
+    form/graph/graphvaluemax.h \
     form/graph/graphwindow.h \
     form/home/homecontroller.h \
     form/home/homewindow.h \
@@ -399,6 +408,7 @@ HEADERS += \
     rpc/drivermanagerrpc.h \
     rpc/logmanagerrpc.h \
     rpc/quotamanagerrpc.h \
+    rpc/rpceventbus.h \
     rpc/rpcmanager.h \
     rpc/serviceinfomanagerrpc.h \
     rpc/statconnmanagerrpc.h \
@@ -507,7 +517,6 @@ RESOURCES += \
 OTHER_FILES += \
     appinfo/migrations/*.sql \
     conf/migrations/*.sql \
-    stat/migrations/block/*.sql \
     stat/migrations/conn/*.sql \
     stat/migrations/traf/*.sql
 
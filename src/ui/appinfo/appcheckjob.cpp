@@ -0,0 +1,40 @@
+#include "appcheckjob.h"
+
+#include <util/worker/workermanager.h>
+#include <util/worker/workerobject.h>
+
+#include "appinfomanager.h"
+
+AppCheckJob::AppCheckJob(const QHash<QString, AppInfo> &appInfos) : m_appInfos(appInfos) { }
+
+void AppCheckJob::doJob(WorkerObject &worker)
+{
+    checkAppInfos(worker.manager());
+}
+
+void AppCheckJob::reportResult(WorkerObject &worker)
+{
+    emitFinished(static_cast<AppInfoManager *>(worker.manager()));
+}
+
+void AppCheckJob::checkAppInfos(WorkerManager *manager)
+{
+    for (auto it = m_appInfos.constBegin(); it != m_appInfos.constEnd(); ++it) {
+        if (manager->isJobStale(*this))
+            break;
+
+        const QString &appPath = it.key();
+
+        if (it.value().isFileModified(appPath)) {
+            m_modifiedPaths.append(appPath);
+        }
+    }
+}
+
+void AppCheckJob::emitFinished(AppInfoManager *manager)
+{
+    if (m_modifiedPaths.isEmpty())
+        return;
+
+    emit manager->checkModifiedFinished(m_modifiedPaths);
+}
@@ -0,0 +1,36 @@
+#ifndef APPCHECKJOB_H
+#define APPCHECKJOB_H
+
+#include <QHash>
+#include <QStringList>
+
+#include <util/worker/workerjob.h>
+
+#include "appinfo.h"
+
+class AppInfoManager;
+class WorkerManager;
+
+class AppCheckJob : public WorkerJob
+{
+public:
+    explicit AppCheckJob(const QHash<QString, AppInfo> &appInfos);
+
+    const QHash<QString, AppInfo> &appInfos() const { return m_appInfos; }
+
+    JobPriority priority() const override { return PriorityLow; }
+
+    void doJob(WorkerObject &worker) override;
+    void reportResult(WorkerObject &worker) override;
+
+private:
+    void checkAppInfos(WorkerManager *manager);
+    void emitFinished(AppInfoManager *manager);
+
+private:
+    const QHash<QString, AppInfo> m_appInfos;
+
+    QStringList m_modifiedPaths;
+};
+
+#endif // APPCHECKJOB_H
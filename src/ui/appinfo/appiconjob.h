@@ -14,6 +14,8 @@ public:
 
     qint64 iconId() const { return m_iconId; }
 
+    JobPriority priority() const override { return PriorityHigh; }
+
     void doJob(WorkerObject &worker) override;
     void reportResult(WorkerObject &worker) override;
 
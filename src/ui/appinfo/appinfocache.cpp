@@ -3,6 +3,7 @@
 #include <QIcon>
 #include <QImage>
 
+#include <util/fileutil.h>
 #include <util/iconcache.h>
 #include <util/ioc/ioccontainer.h>
 
@@ -11,6 +12,9 @@
 AppInfoCache::AppInfoCache(QObject *parent) : QObject(parent), m_cache(1000)
 {
     connect(&m_triggerTimer, &QTimer::timeout, this, &AppInfoCache::cacheChanged);
+    connect(&m_checkTimer, &QTimer::timeout, this, &AppInfoCache::checkFilesModified);
+
+    m_checkClock.start();
 }
 
 void AppInfoCache::setUp()
@@ -21,6 +25,8 @@ void AppInfoCache::setUp()
             &AppInfoCache::handleFinishedInfoLookup);
     connect(appInfoManager, &AppInfoManager::lookupIconFinished, this,
             &AppInfoCache::handleFinishedIconLookup);
+    connect(appInfoManager, &AppInfoManager::checkModifiedFinished, this,
+            &AppInfoCache::handleFinishedModifiedCheck);
 }
 
 void AppInfoCache::tearDown()
@@ -28,10 +34,16 @@ void AppInfoCache::tearDown()
     disconnect(IoC<AppInfoManager>());
 }
 
-QString AppInfoCache::appName(const QString &appPath)
+QString AppInfoCache::appName(const QString &appPath, bool loadFromFs)
 {
     AppInfo appInfo = this->appInfo(appPath);
     if (!appInfo.isValid()) {
+        if (!loadFromFs) {
+            // Don't wait for the lookup
+            return FileUtil::isSystemApp(appPath) ? FileUtil::systemAppDescription()
+                                                  : FileUtil::fileName(appPath);
+        }
+
         IoC<AppInfoManager>()->loadInfoFromFs(appPath, appInfo);
     }
     return appInfo.fileDescription;
@@ -66,10 +78,6 @@ AppInfo AppInfoCache::appInfo(const QString &appPath)
 
     appInfoCached(appPath, appInfo, lookupRequired);
 
-    if (!lookupRequired) {
-        lookupRequired = appInfo.isValid() && appInfo.isFileModified(appPath);
-    }
-
     if (lookupRequired) {
         IoC<AppInfoManager>()->lookupAppInfo(appPath);
     }
@@ -79,11 +87,12 @@ AppInfo AppInfoCache::appInfo(const QString &appPath)
 
 void AppInfoCache::handleFinishedInfoLookup(const QString &appPath, const AppInfo &info)
 {
-    AppInfo *appInfo = m_cache.object(appPath);
-    if (!appInfo)
+    CachedAppInfo *cachedInfo = m_cache.object(appPath);
+    if (!cachedInfo)
         return;
 
-    *appInfo = info;
+    cachedInfo->info = info;
+    cachedInfo->checkedTime = m_checkClock.elapsed();
 
     IconCache::remove(appPath); // invalidate cached icon
 
@@ -102,21 +111,55 @@ void AppInfoCache::handleFinishedIconLookup(const QString &appPath, const QImage
     emitCacheChanged();
 }
 
+void AppInfoCache::handleFinishedModifiedCheck(const QStringList &appPaths)
+{
+    auto appInfoManager = IoC<AppInfoManager>();
+
+    for (const QString &appPath : appPaths) {
+        appInfoManager->lookupAppInfo(appPath);
+    }
+}
+
+void AppInfoCache::checkFilesModified()
+{
+    QHash<QString, AppInfo> appInfos;
+
+    for (const QString &appPath : std::as_const(m_checkPaths)) {
+        const CachedAppInfo *cachedInfo = m_cache.object(appPath);
+
+        if (cachedInfo && cachedInfo->info.isValid()) {
+            appInfos.insert(appPath, cachedInfo->info);
+        }
+    }
+
+    m_checkPaths.clear();
+
+    if (!appInfos.isEmpty()) {
+        IoC<AppInfoManager>()->checkAppInfos(appInfos);
+    }
+}
+
 void AppInfoCache::appInfoCached(const QString &appPath, AppInfo &info, bool &lookupRequired)
 {
-    AppInfo *cachedInfo = m_cache.object(appPath);
+    CachedAppInfo *cachedInfo = m_cache.object(appPath);
 
     if (cachedInfo) {
         lookupRequired = false;
 
-        info = *cachedInfo;
+        info = cachedInfo->info;
+
+        if (info.isValid()) {
+            scheduleFileCheck(appPath, *cachedInfo);
+        }
     } else {
         lookupRequired = !IoC<AppInfoManager>()->loadInfoFromDb(appPath, info);
 
-        cachedInfo = new AppInfo();
+        cachedInfo = new CachedAppInfo();
 
         if (!lookupRequired) {
-            *cachedInfo = info;
+            cachedInfo->info = info;
+
+            scheduleFileCheck(appPath, *cachedInfo);
         }
 
         m_cache.insert(appPath, cachedInfo, /*cost=*/1);
@@ -124,6 +167,21 @@ void AppInfoCache::appInfoCached(const QString &appPath, AppInfo &info, bool &lo
     }
 }
 
+void AppInfoCache::scheduleFileCheck(const QString &appPath, CachedAppInfo &cachedInfo)
+{
+    // Check the file modification at most once per TTL on the worker thread
+    const qint64 now = m_checkClock.elapsed();
+
+    if (cachedInfo.checkedTime >= 0 && now - cachedInfo.checkedTime < FileCheckTtl)
+        return;
+
+    cachedInfo.checkedTime = now;
+
+    m_checkPaths.append(appPath);
+
+    m_checkTimer.startTrigger();
+}
+
 void AppInfoCache::emitCacheChanged()
 {
     m_triggerTimer.startTrigger();
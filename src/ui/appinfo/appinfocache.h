@@ -2,6 +2,7 @@
 #define APPINFOCACHE_H
 
 #include <QCache>
+#include <QElapsedTimer>
 #include <QObject>
 
 #include <util/ioc/iocservice.h>
@@ -14,12 +15,14 @@ class AppInfoCache : public QObject, public IocService
     Q_OBJECT
 
 public:
+    constexpr static int FileCheckTtl = 30000; // milliseconds
+
     explicit AppInfoCache(QObject *parent = nullptr);
 
     void setUp() override;
     void tearDown() override;
 
-    QString appName(const QString &appPath);
+    QString appName(const QString &appPath, bool loadFromFs = true);
 
     QIcon appIcon(const QString &appPath, const QString &nullIconPath = QString());
 
@@ -31,16 +34,32 @@ signals:
 private slots:
     void handleFinishedInfoLookup(const QString &appPath, const AppInfo &info);
     void handleFinishedIconLookup(const QString &appPath, const QImage &image);
+    void handleFinishedModifiedCheck(const QStringList &appPaths);
+
+    void checkFilesModified();
 
 private:
+    struct CachedAppInfo
+    {
+        AppInfo info;
+        qint64 checkedTime = -1; // never checked
+    };
+
     void appInfoCached(const QString &appPath, AppInfo &info, bool &lookupRequired);
 
+    void scheduleFileCheck(const QString &appPath, CachedAppInfo &cachedInfo);
+
     void emitCacheChanged();
 
 private:
-    QCache<QString, AppInfo> m_cache;
+    QCache<QString, CachedAppInfo> m_cache;
+
+    QStringList m_checkPaths;
+
+    QElapsedTimer m_checkClock;
 
     TriggerTimer m_triggerTimer;
+    TriggerTimer m_checkTimer;
 };
 
 #endif // APPINFOCACHE_H
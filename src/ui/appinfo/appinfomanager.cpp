@@ -1,5 +1,6 @@
 #include "appinfomanager.h"
 
+#include <QElapsedTimer>
 #include <QImage>
 #include <QLoggingCategory>
 
@@ -7,6 +8,7 @@
 #include <sqlite/sqlitedb.h>
 #include <sqlite/sqlitestmt.h>
 
+#include "appcheckjob.h"
 #include "appiconjob.h"
 #include "appinfojob.h"
 #include "appinfoutil.h"
@@ -16,7 +18,7 @@ namespace {
 
 const QLoggingCategory LC("appInfo");
 
-constexpr int DATABASE_USER_VERSION = 7;
+constexpr int DATABASE_USER_VERSION = 8;
 
 constexpr int APP_CACHE_MAX_COUNT = 3000;
 constexpr int APP_PURGE_INTERVAL = 3000; // 3 seconds
@@ -36,15 +38,20 @@ const char *const sqlUpdateIconRefCount = "UPDATE icon"
                                           "  SET ref_count = ref_count + ?2"
                                           "  WHERE icon_id = ?1;";
 
-const char *const sqlInsertAppInfo = "INSERT INTO app(path, alt_path, file_descr, company_name,"
-                                     "    product_name, product_ver, file_mod_time, icon_id)"
-                                     "  VALUES(?1, ?2, ?3, ?4, ?5, ?6, ?7, ?8);";
+const char *const sqlInsertAppInfo =
+        "INSERT INTO app(path, alt_path, file_descr, company_name,"
+        "    product_name, product_ver, file_mod_time, icon_id, access_seq)"
+        "  VALUES(?1, ?2, ?3, ?4, ?5, ?6, ?7, ?8, ?9);";
+
+const char *const sqlUpdateAppAccessSeq = "UPDATE app SET access_seq = ?2 WHERE path = ?1;";
+
+const char *const sqlSelectMaxAccessSeq = "SELECT max(access_seq) FROM app;";
 
 const char *const sqlSelectAppCount = "SELECT count(*) FROM app;";
 
 const char *const sqlSelectOldApps = "SELECT path, icon_id"
                                      "  FROM app"
-                                     "  ORDER BY app_id"
+                                     "  ORDER BY access_seq"
                                      "  LIMIT ?1;";
 
 const char *const sqlDeleteIconIfNotUsed = "DELETE FROM icon"
@@ -56,17 +63,21 @@ const char *const sqlDeleteApp = "DELETE FROM app WHERE path = ?1;";
 
 AppInfoManager::AppInfoManager(const QString &filePath, QObject *parent, quint32 openFlags) :
     WorkerManager(parent),
+    m_maxAppsCount(APP_CACHE_MAX_COUNT),
     m_appsPurgeTimer(APP_PURGE_INTERVAL),
     m_sqliteDb(new SqliteDb(filePath, openFlags))
 {
     setMaxWorkersCount(1);
+    setPoolPriority(1); // interactive lookups
 
     connect(&m_appsPurgeTimer, &QTimer::timeout, this, &AppInfoManager::purgeApps);
 }
 
 void AppInfoManager::setUp()
 {
-    setupDb();
+    if (setupDb()) {
+        setupAccessSeq();
+    }
 }
 
 WorkerObject *AppInfoManager::createWorker()
@@ -84,6 +95,20 @@ void AppInfoManager::lookupAppIcon(const QString &appPath, qint64 iconId)
     enqueueJob(WorkerJobPtr(new AppIconJob(appPath, iconId)));
 }
 
+void AppInfoManager::checkAppInfos(const QHash<QString, AppInfo> &appInfos)
+{
+    // The checked apps are in use
+    {
+        QMutexLocker locker(&m_mutex);
+
+        for (auto it = appInfos.constBegin(); it != appInfos.constEnd(); ++it) {
+            touchApp(it.key());
+        }
+    }
+
+    enqueueJob(WorkerJobPtr(new AppCheckJob(appInfos)));
+}
+
 void AppInfoManager::checkLookupInfoFinished(const QString &appPath)
 {
     AppInfo appInfo;
@@ -94,12 +119,27 @@ void AppInfoManager::checkLookupInfoFinished(const QString &appPath)
 
 bool AppInfoManager::loadInfoFromFs(const QString &appPath, AppInfo &appInfo)
 {
-    return AppInfoUtil::getInfo(appPath, appInfo);
+    QElapsedTimer timer;
+    timer.start();
+
+    const bool ok = AppInfoUtil::getInfo(appPath, appInfo);
+
+    m_extractCount.fetchAndAddRelaxed(1);
+    m_extractTimeMsecs.fetchAndAddRelaxed(quint64(timer.elapsed()));
+
+    return ok;
 }
 
 QImage AppInfoManager::loadIconFromFs(const QString &appPath, const AppInfo &appInfo)
 {
-    return AppInfoUtil::getIcon(appInfo.filePath(appPath));
+    QElapsedTimer timer;
+    timer.start();
+
+    const QImage image = AppInfoUtil::getIcon(appInfo.filePath(appPath));
+
+    m_extractTimeMsecs.fetchAndAddRelaxed(quint64(timer.elapsed()));
+
+    return image;
 }
 
 bool AppInfoManager::loadInfoFromDb(const QString &appPath, AppInfo &appInfo)
@@ -116,8 +156,10 @@ bool AppInfoManager::loadInfoFromDb(const QString &appPath, AppInfo &appInfo)
 
     stmt.bindText(1, appPath);
 
-    if (stmt.step() != SqliteStmt::StepRow)
+    if (stmt.step() != SqliteStmt::StepRow) {
+        m_missCount.fetchAndAddRelaxed(1);
         return false;
+    }
 
     appInfo.altPath = stmt.columnText(0);
     appInfo.fileDescription = stmt.columnText(1);
@@ -127,6 +169,10 @@ bool AppInfoManager::loadInfoFromDb(const QString &appPath, AppInfo &appInfo)
     appInfo.fileModTime = stmt.columnDateTime(5);
     appInfo.iconId = stmt.columnInt64(6);
 
+    m_hitCount.fetchAndAddRelaxed(1);
+
+    touchApp(appPath);
+
     return true;
 }
 
@@ -153,6 +199,13 @@ bool AppInfoManager::setupDb()
     return true;
 }
 
+void AppInfoManager::setupAccessSeq()
+{
+    QMutexLocker locker(&m_mutex);
+
+    m_accessSeq = DbQuery(sqliteDb()).sql(sqlSelectMaxAccessSeq).execute().toLongLong();
+}
+
 void AppInfoManager::saveAppIcon(const QImage &appIcon, QVariant &iconId, bool &ok)
 {
     const uint iconHash = uint(qHashBits(appIcon.constBits(), size_t(appIcon.sizeInBytes())));
@@ -183,11 +236,36 @@ void AppInfoManager::saveAppInfo(
         appInfo.productVersion,
         appInfo.fileModTime,
         iconId,
+        ++m_accessSeq,
     };
 
     DbQuery(sqliteDb(), &ok).sql(sqlInsertAppInfo).vars(vars).executeOk();
 }
 
+void AppInfoManager::touchApp(const QString &appPath)
+{
+    if ((sqliteDb()->openFlags() & SqliteDb::OpenReadOnly) != 0)
+        return;
+
+    const bool isFirstAccess = m_accessSeqs.isEmpty();
+
+    // Save the access order later in one transaction
+    m_accessSeqs.insert(appPath, ++m_accessSeq);
+
+    if (isFirstAccess) {
+        emitAppsPurge();
+    }
+}
+
+void AppInfoManager::saveAccessSeqs()
+{
+    for (auto it = m_accessSeqs.constBegin(); it != m_accessSeqs.constEnd(); ++it) {
+        DbQuery(sqliteDb()).sql(sqlUpdateAppAccessSeq).vars({ it.key(), it.value() }).executeOk();
+    }
+
+    m_accessSeqs.clear();
+}
+
 void AppInfoManager::emitAppsPurge()
 {
     QMetaObject::invokeMethod(&m_appsPurgeTimer, &TriggerTimer::startTrigger, Qt::QueuedConnection);
@@ -199,11 +277,17 @@ void AppInfoManager::purgeApps()
 
     sqliteDb()->beginWriteTransaction();
 
+    saveAccessSeqs();
+
     const int appCount = DbQuery(sqliteDb()).sql(sqlSelectAppCount).execute().toInt();
-    const int excessCount = appCount - APP_CACHE_MAX_COUNT;
+    const int excessCount = appCount - maxAppsCount();
 
     if (excessCount > 0) {
         deleteOldApps(excessCount);
+
+        qCDebug(LC) << "Purged:" << excessCount << "hits:" << hitCount()
+                    << "misses:" << missCount() << "extracts:" << extractCount()
+                    << "extract msecs:" << extractTimeMsecs();
     }
 
     sqliteDb()->commitTransaction();
@@ -1,6 +1,8 @@
 #ifndef APPINFOMANAGER_H
 #define APPINFOMANAGER_H
 
+#include <QAtomicInteger>
+#include <QHash>
 #include <QMutex>
 #include <QVector>
 
@@ -24,6 +26,15 @@ public:
 
     SqliteDb *sqliteDb() const { return m_sqliteDb.data(); }
 
+    int maxAppsCount() const { return m_maxAppsCount; }
+    void setMaxAppsCount(int v) { m_maxAppsCount = v; }
+
+    // Statistics of the cache usage
+    quint64 hitCount() const { return m_hitCount.loadRelaxed(); }
+    quint64 missCount() const { return m_missCount.loadRelaxed(); }
+    quint64 extractCount() const { return m_extractCount.loadRelaxed(); }
+    quint64 extractTimeMsecs() const { return m_extractTimeMsecs.loadRelaxed(); }
+
     void setUp() override;
 
     bool loadInfoFromFs(const QString &appPath, AppInfo &appInfo);
@@ -40,25 +51,32 @@ public:
 signals:
     void lookupInfoFinished(const QString &appPath, const AppInfo &appInfo);
     void lookupIconFinished(const QString &appPath, const QImage &image);
+    void checkModifiedFinished(const QStringList &appPaths);
 
 public slots:
     virtual void lookupAppInfo(const QString &appPath);
     void lookupAppIcon(const QString &appPath, qint64 iconId);
+    void checkAppInfos(const QHash<QString, AppInfo> &appInfos);
 
     void checkLookupInfoFinished(const QString &appPath);
 
+    void purgeApps();
+
 protected:
     WorkerObject *createWorker() override;
 
 private:
     bool setupDb();
+    void setupAccessSeq();
 
     void saveAppIcon(const QImage &appIcon, QVariant &iconId, bool &ok);
     void saveAppInfo(
             const QString &appPath, const AppInfo &appInfo, const QVariant &iconId, bool &ok);
 
+    void touchApp(const QString &appPath);
+    void saveAccessSeqs();
+
     void emitAppsPurge();
-    void purgeApps();
 
     void getOldAppsAndIcons(
             QStringList &appPaths, QHash<qint64, int> &iconIds, int limitCount) const;
@@ -71,6 +89,16 @@ private:
     void deleteApp(const QString &appPath, bool &ok);
 
 private:
+    int m_maxAppsCount = 0;
+
+    qint64 m_accessSeq = 0;
+    QHash<QString, qint64> m_accessSeqs; // pending LRU updates
+
+    QAtomicInteger<quint64> m_hitCount = 0;
+    QAtomicInteger<quint64> m_missCount = 0;
+    QAtomicInteger<quint64> m_extractCount = 0;
+    QAtomicInteger<quint64> m_extractTimeMsecs = 0;
+
     TriggerTimer m_appsPurgeTimer;
 
     SqliteDbPtr m_sqliteDb;
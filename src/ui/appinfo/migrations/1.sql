@@ -7,10 +7,12 @@ CREATE TABLE app(
   product_name TEXT,
   product_ver TEXT,
   file_mod_time INTEGER,
-  icon_id INTEGER
+  icon_id INTEGER,
+  access_seq INTEGER NOT NULL DEFAULT 0
 );
 
 CREATE UNIQUE INDEX app_path_uk ON app(path);
+CREATE INDEX app_access_seq_idx ON app(access_seq);
 
 CREATE TABLE icon(
   icon_id INTEGER PRIMARY KEY,
@@ -24,6 +24,17 @@ bool App::isZonesEqual(const App &o) const
     return acceptZones == o.acceptZones && rejectZones == o.rejectZones;
 }
 
+bool App::isSpeedLimitsEqual(const App &o) const
+{
+    return speedLimitIn == o.speedLimitIn && speedLimitOut == o.speedLimitOut;
+}
+
+bool App::isQuotasEqual(const App &o) const
+{
+    return quotaDayMb == o.quotaDayMb && quotaMonthMb == o.quotaMonthMb
+            && quotaThrottleGroup == o.quotaThrottleGroup;
+}
+
 bool App::isPathsEqual(const App &o) const
 {
     return appOriginPath == o.appOriginPath && appPath == o.appPath;
@@ -31,8 +42,9 @@ bool App::isPathsEqual(const App &o) const
 
 bool App::isOptionsEqual(const App &o) const
 {
-    return isFlagsEqual(o) && isZonesEqual(o) && groupIndex == o.groupIndex && ruleId == o.ruleId
-            && isPathsEqual(o) && notes == o.notes && scheduleAction == o.scheduleAction
+    return isFlagsEqual(o) && isZonesEqual(o) && isSpeedLimitsEqual(o) && isQuotasEqual(o)
+            && groupIndex == o.groupIndex && ruleId == o.ruleId && isPathsEqual(o)
+            && notes == o.notes && scheduleAction == o.scheduleAction
             && scheduleTime == o.scheduleTime;
 }
 
@@ -50,3 +62,13 @@ bool App::hasZone() const
 {
     return acceptZones != 0 || rejectZones != 0;
 }
+
+bool App::hasSpeedLimit() const
+{
+    return speedLimitIn != 0 || speedLimitOut != 0;
+}
+
+bool App::hasQuota() const
+{
+    return quotaDayMb != 0 || quotaMonthMb != 0;
+}
@@ -18,12 +18,16 @@ public:
     bool isBaseFlagsEqual(const App &o) const;
     bool isExtraFlagsEqual(const App &o) const;
     bool isZonesEqual(const App &o) const;
+    bool isSpeedLimitsEqual(const App &o) const;
+    bool isQuotasEqual(const App &o) const;
     bool isPathsEqual(const App &o) const;
     bool isOptionsEqual(const App &o) const;
     bool isNameEqual(const App &o) const;
 
     bool isProcWild() const;
     bool hasZone() const;
+    bool hasSpeedLimit() const;
+    bool hasQuota() const;
 
 public:
     bool isWildcard : 1 = false;
@@ -44,6 +48,16 @@ public:
     qint8 groupIndex = 0; // "Main" app. group
 
     quint16 ruleId = 0;
+    quint16 speedLimitId = 0; // transient
+    quint16 quotaId = 0; // transient
+
+    quint8 quotaThrottleGroup = 0; // 1-based app. group to throttle into, 0 - block
+
+    quint32 speedLimitIn = 0; // Kbit/s
+    quint32 speedLimitOut = 0; // Kbit/s
+
+    quint32 quotaDayMb = 0;
+    quint32 quotaMonthMb = 0;
 
     quint32 acceptZones = 0;
     quint32 rejectZones = 0;
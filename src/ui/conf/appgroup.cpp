@@ -101,6 +101,22 @@ void AppGroup::setLimitLatency(quint32 v)
     }
 }
 
+void AppGroup::setQuotaDayMb(quint32 v)
+{
+    if (m_quotaDayMb != v) {
+        m_quotaDayMb = v;
+        setEdited(true);
+    }
+}
+
+void AppGroup::setQuotaMonthMb(quint32 v)
+{
+    if (m_quotaMonthMb != v) {
+        m_quotaMonthMb = v;
+        setEdited(true);
+    }
+}
+
 void AppGroup::setLimitBufferSizeIn(quint32 v)
 {
     if (m_limitBufferSizeIn != v) {
@@ -220,6 +236,9 @@ void AppGroup::copy(const AppGroup &o)
     m_limitBufferSizeIn = o.limitBufferSizeIn();
     m_limitBufferSizeOut = o.limitBufferSizeOut();
 
+    m_quotaDayMb = o.quotaDayMb();
+    m_quotaMonthMb = o.quotaMonthMb();
+
     m_id = o.id();
     m_name = o.name();
 
@@ -254,6 +273,9 @@ QVariant AppGroup::toVariant() const
     map["limitBufferSizeIn"] = limitBufferSizeIn();
     map["limitBufferSizeOut"] = limitBufferSizeOut();
 
+    map["quotaDayMb"] = quotaDayMb();
+    map["quotaMonthMb"] = quotaMonthMb();
+
     map["id"] = id();
     map["name"] = name();
 
@@ -290,6 +312,9 @@ void AppGroup::fromVariant(const QVariant &v)
     m_limitBufferSizeIn = map["limitBufferSizeIn"].toUInt();
     m_limitBufferSizeOut = map["limitBufferSizeOut"].toUInt();
 
+    m_quotaDayMb = map["quotaDayMb"].toUInt();
+    m_quotaMonthMb = map["quotaMonthMb"].toUInt();
+
     m_id = map["id"].toLongLong();
     m_name = map["name"].toString();
 
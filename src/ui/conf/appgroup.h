@@ -60,6 +60,14 @@ public:
     quint32 limitBufferSizeOut() const { return m_limitBufferSizeOut; }
     void setLimitBufferSizeOut(quint32 v);
 
+    quint32 quotaDayMb() const { return m_quotaDayMb; }
+    void setQuotaDayMb(quint32 v);
+
+    quint32 quotaMonthMb() const { return m_quotaMonthMb; }
+    void setQuotaMonthMb(quint32 v);
+
+    bool hasQuota() const { return m_quotaDayMb != 0 || m_quotaMonthMb != 0; }
+
     quint32 enabledSpeedLimitIn() const { return limitInEnabled() ? speedLimitIn() : 0; }
     quint32 enabledSpeedLimitOut() const { return limitOutEnabled() ? speedLimitOut() : 0; }
 
@@ -124,6 +132,10 @@ private:
     quint32 m_limitBufferSizeIn = DEFAULT_LIMIT_BUFFER_SIZE;
     quint32 m_limitBufferSizeOut = DEFAULT_LIMIT_BUFFER_SIZE;
 
+    // Traffic quotas in MiB, 0 - unlimited
+    quint32 m_quotaDayMb = 0;
+    quint32 m_quotaMonthMb = 0;
+
     qint64 m_id = 0;
 
     QString m_name;
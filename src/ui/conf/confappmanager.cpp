@@ -15,6 +15,8 @@
 #include <log/logmanager.h>
 #include <manager/drivelistmanager.h>
 #include <manager/envmanager.h>
+#include <stat/askpendingmanager.h>
+#include <stat/statmanager.h>
 #include <util/conf/confbuffer.h>
 #include <util/dateutil.h>
 #include <util/fileutil.h>
@@ -54,7 +56,12 @@ constexpr int APP_END_TIMER_INTERVAL_MAX = 24 * 60 * 60 * 1000; // 1 day
     "    t.end_action,"                                                                            \
     "    t.end_time,"                                                                              \
     "    g.order_index as group_index,"                                                            \
-    "    (alert.app_id IS NOT NULL) as alerted"
+    "    (alert.app_id IS NOT NULL) as alerted,"                                                   \
+    "    t.speed_limit_in,"                                                                        \
+    "    t.speed_limit_out,"                                                                       \
+    "    t.quota_day_mb,"                                                                          \
+    "    t.quota_month_mb,"                                                                        \
+    "    t.quota_throttle_group"
 
 const char *const sqlSelectAppById = "SELECT" SELECT_APP_FIELDS "  FROM app t"
                                      "    JOIN app_group g ON g.app_group_id = t.app_group_id"
@@ -86,9 +93,12 @@ const char *const sqlUpsertApp = "INSERT INTO app(app_group_id, origin_path, pat
                                  "    apply_parent, apply_child, apply_spec_child, kill_child,"
                                  "    lan_only, parked, log_allowed_conn, log_blocked_conn,"
                                  "    blocked, kill_process, accept_zones, reject_zones,"
-                                 "    rule_id, end_action, end_time, creat_time)"
+                                 "    rule_id, end_action, end_time, creat_time,"
+                                 "    speed_limit_in, speed_limit_out,"
+                                 "    quota_day_mb, quota_month_mb, quota_throttle_group)"
                                  "  VALUES(?2, ?3, ?4, ?5, ?6, ?7, ?8, ?9, ?10, ?11, ?12, ?13, ?14,"
-                                 "    ?15, ?16, ?17, ?18, ?19, ?20, ?21, ?22, ?23)"
+                                 "    ?15, ?16, ?17, ?18, ?19, ?20, ?21, ?22, ?23, ?24, ?25,"
+                                 "    ?26, ?27, ?28)"
                                  "  ON CONFLICT(path) DO UPDATE"
                                  "  SET app_group_id = ?2, origin_path = ?3,"
                                  "    name = ?5, notes = ?6, is_wildcard = ?7,"
@@ -97,7 +107,10 @@ const char *const sqlUpsertApp = "INSERT INTO app(app_group_id, origin_path, pat
                                  "    log_allowed_conn = ?14, log_blocked_conn = ?15,"
                                  "    blocked = ?16, kill_process = ?17,"
                                  "    accept_zones = ?18, reject_zones = ?19, rule_id = ?20,"
-                                 "    end_action = ?21, end_time = ?22"
+                                 "    end_action = ?21, end_time = ?22,"
+                                 "    speed_limit_in = ?24, speed_limit_out = ?25,"
+                                 "    quota_day_mb = ?26, quota_month_mb = ?27,"
+                                 "    quota_throttle_group = ?28"
                                  "  RETURNING app_id;";
 
 const char *const sqlUpdateApp = "UPDATE app"
@@ -108,7 +121,10 @@ const char *const sqlUpdateApp = "UPDATE app"
                                  "    log_allowed_conn = ?14, log_blocked_conn = ?15,"
                                  "    blocked = ?16, kill_process = ?17,"
                                  "    accept_zones = ?18, reject_zones = ?19, rule_id = ?20,"
-                                 "    end_action = ?21, end_time = ?22"
+                                 "    end_action = ?21, end_time = ?22,"
+                                 "    speed_limit_in = ?24, speed_limit_out = ?25,"
+                                 "    quota_day_mb = ?26, quota_month_mb = ?27,"
+                                 "    quota_throttle_group = ?28"
                                  "  WHERE app_id = ?1"
                                  "  RETURNING app_id;";
 
@@ -244,6 +260,11 @@ void ConfAppManager::beginAddOrUpdateApp(
         app.scheduleAction,
         DbVar::nullable(app.scheduleTime),
         DbVar::nullable(DateUtil::now(), onlyUpdate),
+        app.speedLimitIn,
+        app.speedLimitOut,
+        app.quotaDayMb,
+        app.quotaMonthMb,
+        app.quotaThrottleGroup,
     };
 
     const char *sql = onlyUpdate ? sqlUpdateApp : sqlUpsertApp;
@@ -267,6 +288,17 @@ void ConfAppManager::endAddOrUpdateApp(const App &app, bool onlyUpdate)
     }
 
     updateDriverUpdateAppConf(app);
+
+    decidePendingApp(app);
+}
+
+void ConfAppManager::decidePendingApp(const App &app)
+{
+    if (app.alerted)
+        return;
+
+    // The decisions are flushed after the driver's conf is updated
+    IoC<AskPendingManager>()->decideAppPath(app.appPath, /*allow=*/!app.blocked);
 }
 
 void ConfAppManager::emitAppAlerted()
@@ -385,9 +417,10 @@ bool ConfAppManager::deleteApps(const QVector<qint64> &appIdList)
 {
     bool ok = true;
     bool isWildcard = false;
+    QVector<App> driverApps;
 
     for (const qint64 appId : appIdList) {
-        if (!deleteApp(appId, isWildcard)) {
+        if (!deleteApp(appId, isWildcard, driverApps)) {
             ok = false;
             break;
         }
@@ -395,6 +428,8 @@ bool ConfAppManager::deleteApps(const QVector<qint64> &appIdList)
 
     if (isWildcard) {
         updateDriverConf();
+    } else if (!driverApps.isEmpty()) {
+        updateDriverUpdateApps(driverApps, /*remove=*/true);
     }
 
     return ok;
@@ -411,7 +446,7 @@ bool ConfAppManager::clearAlerts()
     return ok;
 }
 
-bool ConfAppManager::deleteApp(qint64 appId, bool &isWildcard)
+bool ConfAppManager::deleteApp(qint64 appId, bool &isWildcard, QVector<App> &driverApps)
 {
     bool ok = false;
 
@@ -431,9 +466,10 @@ bool ConfAppManager::deleteApp(qint64 appId, bool &isWildcard)
         if (resList.at(0).toBool()) {
             isWildcard = true;
         } else {
-            const QString appPath = resList.at(1).toString();
+            App app;
+            app.appPath = resList.at(1).toString();
 
-            updateDriverDeleteApp(appPath);
+            driverApps.append(app);
         }
 
         emitAppsChanged();
@@ -461,10 +497,11 @@ bool ConfAppManager::updateAppsBlocked(
         const QVector<qint64> &appIdList, bool blocked, bool killProcess)
 {
     bool ok = true;
-    bool isWildcard = (appIdList.size() > 7);
+    bool isWildcard = false;
+    QVector<App> driverApps;
 
     for (const qint64 appId : appIdList) {
-        if (!updateAppBlocked(appId, blocked, killProcess, isWildcard)) {
+        if (!updateAppBlocked(appId, blocked, killProcess, isWildcard, driverApps)) {
             ok = false;
             break;
         }
@@ -472,13 +509,15 @@ bool ConfAppManager::updateAppsBlocked(
 
     if (isWildcard) {
         updateDriverConf();
+    } else if (!driverApps.isEmpty()) {
+        updateDriverUpdateApps(driverApps);
     }
 
     return ok;
 }
 
-bool ConfAppManager::updateAppBlocked(
-        qint64 appId, bool blocked, bool killProcess, bool &isWildcard)
+bool ConfAppManager::updateAppBlocked(qint64 appId, bool blocked, bool killProcess,
+        bool &isWildcard, QVector<App> &driverApps)
 {
     App app;
     app.appId = appId;
@@ -491,10 +530,12 @@ bool ConfAppManager::updateAppBlocked(
     if (!saveAppBlocked(app))
         return false;
 
-    if (app.isWildcard) {
+    decidePendingApp(app);
+
+    if (app.isWildcard || app.hasSpeedLimit() || app.hasQuota()) {
         isWildcard = true;
     } else {
-        updateDriverUpdateApp(app);
+        driverApps.append(app);
     }
 
     return true;
@@ -559,6 +600,21 @@ bool ConfAppManager::walkApps(const std::function<walkAppsCallback> &func) const
     return true;
 }
 
+void ConfAppManager::appQuotaTraffic(const App &app, quint64 &dayBytes, quint64 &monthBytes) const
+{
+    dayBytes = monthBytes = 0;
+
+    auto statManager = IoC<StatManager>();
+    if (!statManager || app.isWildcard)
+        return;
+
+    qint64 statDayBytes, statMonthBytes;
+    statManager->getAppQuotaTraffic(app.appPath, statDayBytes, statMonthBytes);
+
+    dayBytes = quint64(statDayBytes);
+    monthBytes = quint64(statMonthBytes);
+}
+
 bool ConfAppManager::saveAppBlocked(const App &app)
 {
     bool ok = true;
@@ -696,6 +752,20 @@ bool ConfAppManager::updateDriverConf(bool onlyFlags)
     return true;
 }
 
+bool ConfAppManager::buildDriverConf(QByteArray &buf)
+{
+    ConfBuffer confBuf;
+
+    if (!confBuf.writeConf(*conf(), this, *IoC<EnvManager>())) {
+        qCWarning(LC) << "Driver config error:" << confBuf.errorMessage();
+        return false;
+    }
+
+    buf = confBuf.buffer();
+
+    return true;
+}
+
 bool ConfAppManager::loadAppById(App &app)
 {
     SqliteStmt stmt;
@@ -736,21 +806,23 @@ void ConfAppManager::fillApp(App &app, const SqliteStmt &stmt)
     app.scheduleTime = stmt.columnDateTime(20);
     app.groupIndex = stmt.columnInt(21);
     app.alerted = stmt.columnBool(22);
+    app.speedLimitIn = stmt.columnUInt(23);
+    app.speedLimitOut = stmt.columnUInt(24);
+    app.quotaDayMb = stmt.columnUInt(25);
+    app.quotaMonthMb = stmt.columnUInt(26);
+    app.quotaThrottleGroup = quint8(stmt.columnInt(27));
 }
 
-bool ConfAppManager::updateDriverDeleteApp(const QString &appPath)
+bool ConfAppManager::updateDriverUpdateApp(const App &app, bool remove)
 {
-    App app;
-    app.appPath = appPath;
-
-    return updateDriverUpdateApp(app, /*remove=*/true);
+    return updateDriverUpdateApps({ app }, remove);
 }
 
-bool ConfAppManager::updateDriverUpdateApp(const App &app, bool remove)
+bool ConfAppManager::updateDriverUpdateApps(const QVector<App> &apps, bool remove)
 {
     ConfBuffer confBuf;
 
-    if (!confBuf.writeAppEntry(app)) {
+    if (!confBuf.writeAppEntries(apps)) {
         qCWarning(LC) << "Driver config error:" << confBuf.errorMessage();
         return false;
     }
@@ -758,7 +830,9 @@ bool ConfAppManager::updateDriverUpdateApp(const App &app, bool remove)
     auto driverManager = IoC<DriverManager>();
     if (!driverManager->writeApp(confBuf.buffer(), remove)) {
         qCWarning(LC) << "Update driver error:" << driverManager->errorMessage();
-        return false;
+
+        // The batch may be applied partially: re-send the full config
+        return updateDriverConf();
     }
 
     m_driveMask |= remove ? 0 : confBuf.driveMask();
@@ -768,7 +842,10 @@ bool ConfAppManager::updateDriverUpdateApp(const App &app, bool remove)
 
 bool ConfAppManager::updateDriverUpdateAppConf(const App &app)
 {
-    return app.isWildcard ? updateDriverConf() : updateDriverUpdateApp(app);
+    // The app's speed limits and quotas are referenced by index from the full config
+    return (app.isWildcard || app.hasSpeedLimit() || app.hasQuota())
+            ? updateDriverConf()
+            : updateDriverUpdateApp(app);
 }
 
 bool ConfAppManager::beginTransaction()
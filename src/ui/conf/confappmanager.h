@@ -48,6 +48,7 @@ public:
             const QVector<qint64> &appIdList, bool blocked, bool killProcess);
 
     bool walkApps(const std::function<walkAppsCallback> &func) const override;
+    void appQuotaTraffic(const App &app, quint64 &dayBytes, quint64 &monthBytes) const override;
 
     bool saveAppBlocked(const App &app);
     void updateAppEndTimes();
@@ -58,6 +59,8 @@ public:
 
     virtual bool updateDriverConf(bool onlyFlags = false);
 
+    bool buildDriverConf(QByteArray &buf);
+
 signals:
     void appAlerted();
     void appsChanged();
@@ -75,9 +78,12 @@ private:
     void beginAddOrUpdateApp(App &app, const AppGroup &appGroup, bool onlyUpdate, bool &ok);
     void endAddOrUpdateApp(const App &app, bool onlyUpdate);
 
-    bool deleteApp(qint64 appId, bool &isWildcard);
+    void decidePendingApp(const App &app);
+
+    bool deleteApp(qint64 appId, bool &isWildcard, QVector<App> &driverApps);
 
-    bool updateAppBlocked(qint64 appId, bool blocked, bool killProcess, bool &isWildcard);
+    bool updateAppBlocked(qint64 appId, bool blocked, bool killProcess, bool &isWildcard,
+            QVector<App> &driverApps);
     bool checkAppBlockedChanged(App &app, bool blocked, bool killProcess);
 
     QVector<qint64> collectObsoleteApps(quint32 driveMask);
@@ -90,8 +96,8 @@ private:
     bool loadAppById(App &app);
     static void fillApp(App &app, const SqliteStmt &stmt);
 
-    bool updateDriverDeleteApp(const QString &appPath);
     bool updateDriverUpdateApp(const App &app, bool remove = false);
+    bool updateDriverUpdateApps(const QVector<App> &apps, bool remove = false);
     bool updateDriverUpdateAppConf(const App &app);
 
     bool beginTransaction();
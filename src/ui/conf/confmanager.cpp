@@ -30,7 +30,7 @@ namespace {
 
 const QLoggingCategory LC("conf");
 
-constexpr int DATABASE_USER_VERSION = 48;
+constexpr int DATABASE_USER_VERSION = 50;
 
 constexpr int CONF_PERIODS_UPDATE_INTERVAL = 60 * 1000; // 1 minute
 
@@ -47,7 +47,8 @@ const char *const sqlSelectAppGroups = "SELECT app_group_id, enabled, apply_chil
                                        "    limit_packet_loss, limit_latency,"
                                        "    limit_bufsize_in, limit_bufsize_out,"
                                        "    name, kill_text, block_text, allow_text,"
-                                       "    period_from, period_to"
+                                       "    period_from, period_to,"
+                                       "    quota_day_mb, quota_month_mb"
                                        "  FROM app_group"
                                        "  ORDER BY order_index;";
 
@@ -71,9 +72,11 @@ const char *const sqlInsertAppGroup = "INSERT INTO app_group(app_group_id, order
                                       "    limit_packet_loss, limit_latency,"
                                       "    limit_bufsize_in, limit_bufsize_out,"
                                       "    name, kill_text, block_text, allow_text,"
-                                      "    period_from, period_to)"
+                                      "    period_from, period_to,"
+                                      "    quota_day_mb, quota_month_mb)"
                                       "  VALUES(?1, ?2, ?3, ?4, ?5, ?6, ?7, ?8, ?9, ?10, ?11, ?12,"
-                                      "    ?13, ?14, ?15, ?16, ?17, ?18, ?19, ?20, ?21, ?22);";
+                                      "    ?13, ?14, ?15, ?16, ?17, ?18, ?19, ?20, ?21, ?22,"
+                                      "    ?23, ?24);";
 
 const char *const sqlUpdateAppGroup = "UPDATE app_group"
                                       "  SET order_index = ?2, enabled = ?3,"
@@ -84,7 +87,8 @@ const char *const sqlUpdateAppGroup = "UPDATE app_group"
                                       "    limit_packet_loss = ?13, limit_latency = ?14,"
                                       "    limit_bufsize_in = ?15, limit_bufsize_out = ?16,"
                                       "    name = ?17, kill_text = ?18, block_text = ?19,"
-                                      "    allow_text = ?20, period_from = ?21, period_to = ?22"
+                                      "    allow_text = ?20, period_from = ?21, period_to = ?22,"
+                                      "    quota_day_mb = ?23, quota_month_mb = ?24"
                                       "  WHERE app_group_id = ?1;";
 
 const char *const sqlDeleteAppGroup = "DELETE FROM app_group"
@@ -346,6 +350,8 @@ bool loadAppGroups(SqliteDb *db, FirewallConf &conf)
         appGroup->setAllowText(stmt.columnText(18));
         appGroup->setPeriodFrom(stmt.columnText(19));
         appGroup->setPeriodTo(stmt.columnText(20));
+        appGroup->setQuotaDayMb(quint32(stmt.columnInt(21)));
+        appGroup->setQuotaMonthMb(quint32(stmt.columnInt(22)));
         appGroup->setEdited(false);
 
         conf.addAppGroup(appGroup);
@@ -383,6 +389,8 @@ bool saveAppGroup(SqliteDb *db, AppGroup *appGroup, int orderIndex)
         appGroup->allowText(),
         appGroup->periodFrom(),
         appGroup->periodTo(),
+        appGroup->quotaDayMb(),
+        appGroup->quotaMonthMb(),
     };
 
     const char *sql = rowExists ? sqlUpdateAppGroup : sqlInsertAppGroup;
@@ -937,6 +945,15 @@ void ConfManager::updateDriverServices(
     IoC<DriverManager>()->writeServices(confBuf.buffer());
 }
 
+void ConfManager::updateDriverServiceChanges(const QVector<ServiceInfo> &services)
+{
+    ConfBuffer confBuf;
+
+    confBuf.writeServiceChanges(services);
+
+    IoC<DriverManager>()->writeServices(confBuf.buffer());
+}
+
 void ConfManager::updateOwnProcessServices(ServiceInfoManager *serviceInfoManager)
 {
     int runningServicesCount = 0;
@@ -72,6 +72,7 @@ public:
     bool validateDriver();
 
     void updateDriverServices(const QVector<ServiceInfo> &services, int runningServicesCount);
+    void updateDriverServiceChanges(const QVector<ServiceInfo> &services);
 
     void updateServices();
 
@@ -87,6 +87,16 @@ public:
     }
     void setConnKeepCount(int v) { setValue("stat/connKeepCount", v); }
 
+    // Limits of the driver's pending connections, 0 - the driver's default
+    int askPendingAppsMax() const { return valueInt("ask/pendingAppsMax"); }
+    void setAskPendingAppsMax(int v) { setValue("ask/pendingAppsMax", v); }
+
+    int askPendingAppPacketsMax() const { return valueInt("ask/pendingAppPacketsMax"); }
+    void setAskPendingAppPacketsMax(int v) { setValue("ask/pendingAppPacketsMax", v); }
+
+    int askPendingExpireSecs() const { return valueInt("ask/pendingExpireSecs"); }
+    void setAskPendingExpireSecs(int v) { setValue("ask/pendingExpireSecs", v); }
+
     bool updateKeepCurrentVersion() const { return valueBool("autoUpdate/keepCurrentVersion"); }
     void setUpdateKeepCurrentVersion(bool v) { setValue("autoUpdate/keepCurrentVersion", v); }
 
@@ -43,6 +43,8 @@ CREATE TABLE app_group(
   limit_latency INTEGER NOT NULL DEFAULT 0,
   limit_bufsize_in INTEGER NOT NULL DEFAULT 150000,
   limit_bufsize_out INTEGER NOT NULL DEFAULT 150000,
+  quota_day_mb INTEGER NOT NULL DEFAULT 0,
+  quota_month_mb INTEGER NOT NULL DEFAULT 0,
   name TEXT NOT NULL,
   kill_text TEXT,
   block_text TEXT NOT NULL,
@@ -72,6 +74,11 @@ CREATE TABLE app(
   accept_zones INTEGER NOT NULL DEFAULT 0,  -- zone ids bit mask
   reject_zones INTEGER NOT NULL DEFAULT 0,  -- zone ids bit mask
   rule_id INTEGER,
+  speed_limit_in INTEGER NOT NULL DEFAULT 0,  -- Kbit/s
+  speed_limit_out INTEGER NOT NULL DEFAULT 0,  -- Kbit/s
+  quota_day_mb INTEGER NOT NULL DEFAULT 0,
+  quota_month_mb INTEGER NOT NULL DEFAULT 0,
+  quota_throttle_group INTEGER NOT NULL DEFAULT 0,  -- 1-based app group index, 0 - block
   creat_time INTEGER NOT NULL,
   end_action INTEGER NOT NULL DEFAULT 0,
   end_time INTEGER
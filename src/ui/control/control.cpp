@@ -21,6 +21,7 @@ static const QHash<Command, const char *> g_commandNames = {
     CASE_STRING(Rpc_Result_Error),
 
     CASE_STRING(Rpc_RpcManager_initClient),
+    CASE_STRING(Rpc_RpcManager_eventBatch),
 
     CASE_STRING(Rpc_AppInfoManager_lookupAppInfo),
     CASE_STRING(Rpc_AppInfoManager_checkLookupInfoFinished),
@@ -136,6 +137,7 @@ static const RpcManager g_commandManagers[] = {
     Rpc_NoneManager, // Rpc_Result_Error,
 
     Rpc_NoneManager, // Rpc_RpcManager_initClient,
+    Rpc_NoneManager, // Rpc_RpcManager_eventBatch,
 
     Rpc_AppInfoManager, // Rpc_AppInfoManager_lookupAppInfo,
     Rpc_AppInfoManager, // Rpc_AppInfoManager_checkLookupFinished,
@@ -211,6 +213,8 @@ static const RpcManager g_commandManagers[] = {
     Rpc_TaskManager, // Rpc_TaskManager_zonesDownloaded,
 };
 
+static_assert(std::size(g_commandManagers) == CommandCount, "Command managers size mismatch");
+
 RpcManager managerByCommand(Command cmd)
 {
     return g_commandManagers[cmd];
@@ -231,6 +235,7 @@ static const qint8 g_commandValidations[] = {
     0, // Rpc_Result_Error,
 
     0, // Rpc_RpcManager_initClient,
+    0, // Rpc_RpcManager_eventBatch,
 
     true, // Rpc_AppInfoManager_lookupAppInfo,
     0, // Rpc_AppInfoManager_checkLookupFinished,
@@ -294,6 +299,9 @@ static const qint8 g_commandValidations[] = {
     true, // Rpc_StatConnManager_deleteConn,
     0, // Rpc_StatConnManager_connChanged,
 
+    true, // Rpc_ServiceInfoManager_trackService,
+    true, // Rpc_ServiceInfoManager_revertService,
+
     true, // Rpc_TaskManager_runTask,
     true, // Rpc_TaskManager_abortTask,
     0, // Rpc_TaskManager_taskStarted,
@@ -303,6 +311,9 @@ static const qint8 g_commandValidations[] = {
     0, // Rpc_TaskManager_zonesDownloaded,
 };
 
+static_assert(std::size(g_commandValidations) == CommandCount,
+        "Command validations size mismatch");
+
 bool commandRequiresValidation(Command cmd)
 {
     return g_commandValidations[cmd];
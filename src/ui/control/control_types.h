@@ -23,6 +23,7 @@ enum Command : qint8 {
     Rpc_Result_Error,
 
     Rpc_RpcManager_initClient,
+    Rpc_RpcManager_eventBatch,
 
     Rpc_AppInfoManager_lookupAppInfo,
     Rpc_AppInfoManager_checkLookupInfoFinished,
@@ -96,6 +97,8 @@ enum Command : qint8 {
     Rpc_TaskManager_appVersionUpdated,
     Rpc_TaskManager_appVersionDownloaded,
     Rpc_TaskManager_zonesDownloaded,
+
+    CommandCount // must be last one!
 };
 
 enum RpcManager : qint8 {
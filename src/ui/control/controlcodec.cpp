@@ -0,0 +1,397 @@
+#include "controlcodec.h"
+
+#include <QDataStream>
+#include <QDateTime>
+
+namespace {
+
+constexpr int argMaxDepth = 8;
+
+void writeSized(QByteArray &data, const char *bytes, qsizetype size)
+{
+    ControlCodec::writeVarUInt(data, quint64(size));
+    data.append(bytes, size);
+}
+
+void writeDouble(QByteArray &data, double v)
+{
+    char bytes[sizeof(double)];
+    memcpy(bytes, &v, sizeof(double));
+
+    data.append(bytes, sizeof(double));
+}
+
+void writeVariant(QByteArray &data, const QVariant &arg)
+{
+    QByteArray bytes;
+    {
+        QDataStream stream(&bytes, QDataStream::WriteOnly);
+        stream << arg;
+    }
+
+    data.append(char(ControlCodec::ArgVariant));
+    writeSized(data, bytes.constData(), bytes.size());
+}
+
+}
+
+QByteArray ControlCodec::encodeArgs(const QVariantList &args)
+{
+    QByteArray data;
+    writeArgs(data, args);
+    return data;
+}
+
+bool ControlCodec::decodeArgs(const QByteArray &data, QVariantList &args)
+{
+    ControlCodecReader reader(data);
+
+    return reader.readArgs(args) && reader.atEnd();
+}
+
+void ControlCodec::writeVarUInt(QByteArray &data, quint64 v)
+{
+    while (v >= 0x80) {
+        data.append(char(quint8(v) | 0x80));
+        v >>= 7;
+    }
+    data.append(char(v));
+}
+
+void ControlCodec::writeVarInt(QByteArray &data, qint64 v)
+{
+    writeVarUInt(data, (quint64(v) << 1) ^ quint64(v >> 63));
+}
+
+void ControlCodec::writeString(QByteArray &data, const QString &s)
+{
+    // UTF-16 to be decoded without conversion
+    writeVarUInt(data, quint64(s.size()));
+    data.append((const char *) s.utf16(), s.size() * sizeof(char16_t));
+}
+
+void ControlCodec::writeArg(QByteArray &data, const QVariant &arg)
+{
+    switch (arg.userType()) {
+    case QMetaType::UnknownType: {
+        data.append(char(ArgNull));
+    } break;
+    case QMetaType::Bool: {
+        data.append(char(arg.toBool() ? ArgTrue : ArgFalse));
+    } break;
+    case QMetaType::SChar:
+    case QMetaType::Short:
+    case QMetaType::Int:
+    case QMetaType::Long:
+    case QMetaType::LongLong: {
+        data.append(char(ArgInt));
+        writeVarInt(data, arg.toLongLong());
+    } break;
+    case QMetaType::UChar:
+    case QMetaType::UShort:
+    case QMetaType::UInt:
+    case QMetaType::ULong:
+    case QMetaType::ULongLong: {
+        data.append(char(ArgUInt));
+        writeVarUInt(data, arg.toULongLong());
+    } break;
+    case QMetaType::Double: {
+        data.append(char(ArgDouble));
+        writeDouble(data, arg.toDouble());
+    } break;
+    case QMetaType::QString: {
+        data.append(char(ArgString));
+        writeString(data, arg.toString());
+    } break;
+    case QMetaType::QByteArray: {
+        const QByteArray bytes = arg.toByteArray();
+
+        data.append(char(ArgBytes));
+        writeSized(data, bytes.constData(), bytes.size());
+    } break;
+    case QMetaType::QDateTime: {
+        const QDateTime dateTime = arg.toDateTime();
+        if (!dateTime.isValid()) {
+            writeVariant(data, arg);
+            break;
+        }
+
+        data.append(char(ArgDateTime));
+        writeVarInt(data, dateTime.toMSecsSinceEpoch());
+    } break;
+    case QMetaType::QVariantList: {
+        data.append(char(ArgList));
+        writeArgs(data, arg.toList());
+    } break;
+    case QMetaType::QStringList: {
+        const QStringList list = arg.toStringList();
+
+        data.append(char(ArgStringList));
+        writeVarUInt(data, quint64(list.size()));
+
+        for (const QString &s : list) {
+            writeString(data, s);
+        }
+    } break;
+    case QMetaType::QVariantMap: {
+        const QVariantMap map = arg.toMap();
+
+        data.append(char(ArgMap));
+        writeVarUInt(data, quint64(map.size()));
+
+        for (auto it = map.constBegin(); it != map.constEnd(); ++it) {
+            writeString(data, it.key());
+            writeArg(data, it.value());
+        }
+    } break;
+    default: {
+        writeVariant(data, arg);
+    }
+    }
+}
+
+void ControlCodec::writeArgs(QByteArray &data, const QVariantList &args)
+{
+    writeVarUInt(data, quint64(args.size()));
+
+    for (const QVariant &arg : args) {
+        writeArg(data, arg);
+    }
+}
+
+ControlCodecReader::ControlCodecReader(const QByteArray &data) :
+    m_p(data.constData()), m_end(data.constData() + data.size())
+{
+}
+
+bool ControlCodecReader::readByte(quint8 &v)
+{
+    if (m_p >= m_end)
+        return false;
+
+    v = quint8(*m_p++);
+    return true;
+}
+
+bool ControlCodecReader::readVarUInt(quint64 &v)
+{
+    v = 0;
+
+    for (int shift = 0; shift < 64; shift += 7) {
+        quint8 b;
+        if (!readByte(b))
+            return false;
+
+        v |= quint64(b & 0x7F) << shift;
+
+        if ((b & 0x80) == 0)
+            return true;
+    }
+
+    return false;
+}
+
+bool ControlCodecReader::readVarInt(qint64 &v)
+{
+    quint64 u;
+    if (!readVarUInt(u))
+        return false;
+
+    v = qint64(u >> 1) ^ -qint64(u & 1);
+    return true;
+}
+
+bool ControlCodecReader::readCount(quint64 &count)
+{
+    // Each item takes at least one byte
+    return readVarUInt(count) && count <= quint64(m_end - m_p);
+}
+
+bool ControlCodecReader::readBytes(QByteArray &bytes)
+{
+    quint64 size;
+    if (!readCount(size))
+        return false;
+
+    bytes = QByteArray(m_p, qsizetype(size));
+    m_p += size;
+    return true;
+}
+
+bool ControlCodecReader::readString(QString &s)
+{
+    quint64 len;
+    if (!readVarUInt(len) || len > quint64(m_end - m_p) / sizeof(char16_t))
+        return false;
+
+    s = QString(qsizetype(len), Qt::Uninitialized);
+    memcpy(s.data(), m_p, len * sizeof(char16_t));
+
+    m_p += len * sizeof(char16_t);
+    return true;
+}
+
+bool ControlCodecReader::readArg(QVariant &arg)
+{
+    quint8 type;
+    if (!readByte(type))
+        return false;
+
+    switch (type) {
+    case ControlCodec::ArgNull: {
+        arg = QVariant();
+    } break;
+    case ControlCodec::ArgFalse:
+    case ControlCodec::ArgTrue: {
+        arg = (type == ControlCodec::ArgTrue);
+    } break;
+    case ControlCodec::ArgInt: {
+        qint64 v;
+        if (!readVarInt(v))
+            return false;
+        arg = v;
+    } break;
+    case ControlCodec::ArgUInt: {
+        quint64 v;
+        if (!readVarUInt(v))
+            return false;
+        arg = v;
+    } break;
+    case ControlCodec::ArgDouble: {
+        if (m_end - m_p < qsizetype(sizeof(double)))
+            return false;
+
+        double v;
+        memcpy(&v, m_p, sizeof(double));
+        m_p += sizeof(double);
+        arg = v;
+    } break;
+    case ControlCodec::ArgString: {
+        QString s;
+        if (!readString(s))
+            return false;
+        arg = s;
+    } break;
+    case ControlCodec::ArgBytes: {
+        QByteArray bytes;
+        if (!readBytes(bytes))
+            return false;
+        arg = bytes;
+    } break;
+    case ControlCodec::ArgDateTime: {
+        qint64 msecs;
+        if (!readVarInt(msecs))
+            return false;
+        arg = QDateTime::fromMSecsSinceEpoch(msecs);
+    } break;
+    case ControlCodec::ArgList: {
+        return readList(arg);
+    }
+    case ControlCodec::ArgStringList: {
+        return readStringList(arg);
+    }
+    case ControlCodec::ArgMap: {
+        return readMap(arg);
+    }
+    case ControlCodec::ArgVariant: {
+        QByteArray bytes;
+        if (!readBytes(bytes))
+            return false;
+
+        QDataStream stream(bytes);
+        stream >> arg;
+
+        return stream.status() == QDataStream::Ok;
+    }
+    default:
+        return false;
+    }
+
+    return true;
+}
+
+bool ControlCodecReader::readArgs(QVariantList &args)
+{
+    quint64 count;
+    if (!readCount(count))
+        return false;
+
+    args.reserve(args.size() + qsizetype(count));
+
+    while (count-- > 0) {
+        QVariant arg;
+        if (!readArg(arg))
+            return false;
+
+        args.append(arg);
+    }
+
+    return true;
+}
+
+bool ControlCodecReader::readList(QVariant &arg)
+{
+    if (m_depth >= argMaxDepth)
+        return false;
+
+    ++m_depth;
+
+    QVariantList list;
+    const bool ok = readArgs(list);
+
+    --m_depth;
+
+    arg = list;
+    return ok;
+}
+
+bool ControlCodecReader::readStringList(QVariant &arg)
+{
+    quint64 count;
+    if (!readCount(count))
+        return false;
+
+    QStringList list;
+    list.reserve(qsizetype(count));
+
+    while (count-- > 0) {
+        QString s;
+        if (!readString(s))
+            return false;
+
+        list.append(s);
+    }
+
+    arg = list;
+    return true;
+}
+
+bool ControlCodecReader::readMap(QVariant &arg)
+{
+    if (m_depth >= argMaxDepth)
+        return false;
+
+    quint64 count;
+    if (!readCount(count))
+        return false;
+
+    ++m_depth;
+
+    QVariantMap map;
+    bool ok = true;
+
+    while (ok && count-- > 0) {
+        QString key;
+        QVariant value;
+
+        ok = readString(key) && readArg(value);
+        if (ok) {
+            map.insert(key, value);
+        }
+    }
+
+    --m_depth;
+
+    arg = map;
+    return ok;
+}
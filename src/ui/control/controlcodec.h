@@ -0,0 +1,68 @@
+#ifndef CONTROLCODEC_H
+#define CONTROLCODEC_H
+
+#include <QByteArray>
+#include <QVariant>
+
+// Compact typed encoding of the control commands' arguments
+class ControlCodec
+{
+public:
+    enum ArgType : quint8 {
+        ArgNull = 0,
+        ArgFalse,
+        ArgTrue,
+        ArgInt, // zigzag varint
+        ArgUInt, // varint
+        ArgDouble, // 8 bytes
+        ArgString, // varint length + UTF-16
+        ArgBytes, // varint size + bytes
+        ArgDateTime, // zigzag varint of msecs since epoch
+        ArgList, // varint count + args
+        ArgStringList, // varint count + strings
+        ArgMap, // varint count + (string key, arg) pairs
+        ArgVariant, // varint size + QDataStream of QVariant
+    };
+
+    static QByteArray encodeArgs(const QVariantList &args);
+    static bool decodeArgs(const QByteArray &data, QVariantList &args);
+
+    static void writeVarUInt(QByteArray &data, quint64 v);
+    static void writeVarInt(QByteArray &data, qint64 v);
+    static void writeString(QByteArray &data, const QString &s);
+    static void writeArg(QByteArray &data, const QVariant &arg);
+    static void writeArgs(QByteArray &data, const QVariantList &args);
+};
+
+class ControlCodecReader
+{
+public:
+    explicit ControlCodecReader(const QByteArray &data);
+
+    bool atEnd() const { return m_p >= m_end; }
+
+    bool readByte(quint8 &v);
+    bool readVarUInt(quint64 &v);
+    bool readVarInt(qint64 &v);
+    bool readString(QString &s);
+    bool readArg(QVariant &arg);
+    bool readArgs(QVariantList &args);
+
+    // Count of the next items, each takes at least one byte
+    bool readCount(quint64 &count);
+
+private:
+    bool readBytes(QByteArray &bytes);
+
+    bool readList(QVariant &arg);
+    bool readStringList(QVariant &arg);
+    bool readMap(QVariant &arg);
+
+private:
+    int m_depth = 0;
+
+    const char *m_p = nullptr;
+    const char *m_end = nullptr;
+};
+
+#endif // CONTROLCODEC_H
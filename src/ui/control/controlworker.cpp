@@ -1,16 +1,18 @@
 #include "controlworker.h"
 
-#include <QDataStream>
 #include <QLocalSocket>
 #include <QLoggingCategory>
 #include <QTimer>
 
+#include "controlcodec.h"
+
 namespace {
 
 const QLoggingCategory LC("controlWorker");
 
 constexpr int commandMaxArgs = 32;
 constexpr int commandArgMaxSize = 4 * 1024;
+constexpr int argsCompressMinSize = 1024;
 constexpr quint32 dataMaxSize = 1 * 1024 * 1024;
 
 quint32 nextWorkerId()
@@ -30,19 +32,20 @@ bool buildArgsData(QByteArray &buffer, const QVariantList &args, bool &compresse
         return false;
     }
 
-    QByteArray data;
-    {
-        QDataStream stream(&data, QDataStream::WriteOnly);
+    QByteArray data = ControlCodec::encodeArgs(args);
 
-        stream << qint8(argsCount);
+    // Compress with the fastest level only when it pays off
+    compressed = false;
+    if (data.size() > argsCompressMinSize) {
+        QByteArray packed = qCompress(data, /*compressionLevel=*/1);
 
-        for (const auto &arg : args) {
-            stream << arg;
+        compressed = (packed.size() < data.size());
+        if (compressed) {
+            data = std::move(packed);
         }
     }
 
-    compressed = (data.size() > 128);
-    buffer = compressed ? qCompress(data) : std::move(data);
+    buffer = std::move(data);
 
     return true;
 }
@@ -54,21 +57,14 @@ bool parseArgsData(const QByteArray &buffer, QVariantList &args, bool compressed
 
     const QByteArray data = compressed ? qUncompress(buffer) : buffer;
 
-    QDataStream stream(data);
-
-    qint8 argsCount;
-    stream >> argsCount;
-
-    if (argsCount > commandMaxArgs) {
-        qCWarning(LC) << "Bad parse args count:" << argsCount;
+    if (!ControlCodec::decodeArgs(data, args)) {
+        qCWarning(LC) << "Bad parse args data:" << data.size();
         return false;
     }
 
-    while (--argsCount >= 0) {
-        QVariant arg;
-        stream >> arg;
-
-        args.append(arg);
+    if (args.size() > commandMaxArgs) {
+        qCWarning(LC) << "Bad parse args count:" << args.size();
+        return false;
     }
 
     return true;
@@ -67,6 +67,16 @@ quint32 ioctlSetRuleFlag()
     return FORT_IOCTL_SETRULEFLAG;
 }
 
+quint32 ioctlSetPending()
+{
+    return FORT_IOCTL_SETPENDING;
+}
+
+quint32 ioctlGetPoolStat()
+{
+    return FORT_IOCTL_GETPOOLSTAT;
+}
+
 quint32 userErrorCode()
 {
     return FORT_ERROR_USER_ERROR;
@@ -218,6 +228,14 @@ bool confIp6InRange(const void *drvConf, const ip6_addr_t ip, bool included, int
     return confIpInRange(drvConf, ip_addr, /*isIPv6=*/true, included, addrGroupIndex);
 }
 
+bool confIpIncluded(const void *drvConf, const ip_addr_t ip, bool isIPv6, int addrGroupIndex)
+{
+    PCFORT_CONF conf = (PCFORT_CONF) drvConf;
+
+    return fort_conf_ip_included(conf, /*zone_func=*/nullptr, /*ctx=*/nullptr, ip, isIPv6,
+            addrGroupIndex);
+}
+
 FORT_APP_DATA confAppFind(const void *drvConf, const QString &kernelPath)
 {
     PCFORT_CONF conf = PCFORT_CONF(drvConf);
@@ -234,6 +252,77 @@ FORT_APP_DATA confAppFind(const void *drvConf, const QString &kernelPath)
     return app_data;
 }
 
+quint8 confAppLimitIoBits(const void *drvConf, quint16 limitId)
+{
+    PCFORT_CONF conf = PCFORT_CONF(drvConf);
+
+    return fort_conf_app_limit_io_bits(conf, limitId);
+}
+
+FORT_TRAF_QUOTA confQuota(const void *drvConf, quint16 quotaId)
+{
+    PCFORT_CONF conf = PCFORT_CONF(drvConf);
+
+    if (quotaId == 0 || quotaId > conf->quotas_n)
+        return {};
+
+    return fort_conf_quotas_ref(conf)[quotaId - 1];
+}
+
+void confIoFlagsSet(void *drvConfIo, const void *drvFlags)
+{
+    PFORT_CONF_IO conf_io = PFORT_CONF_IO(drvConfIo);
+
+    conf_io->conf.flags = *PCFORT_CONF_FLAGS(drvFlags);
+}
+
+bool confZoneFlagSet(void *drvZones, const void *drvZoneFlag)
+{
+    PFORT_CONF_ZONES zones = PFORT_CONF_ZONES(drvZones);
+    PCFORT_CONF_ZONE_FLAG zone_flag = PCFORT_CONF_ZONE_FLAG(drvZoneFlag);
+
+    if (zone_flag->zone_id == 0 || zone_flag->zone_id > FORT_CONF_ZONE_MAX)
+        return false;
+
+    const quint32 zone_mask = (1u << (zone_flag->zone_id - 1));
+
+    if (zone_flag->enabled) {
+        zones->enabled_mask |= zone_mask;
+    } else {
+        zones->enabled_mask &= ~zone_mask;
+    }
+
+    return true;
+}
+
+bool confRuleFlagSet(void *drvRules, const void *drvRuleFlag, quint32 rulesSize)
+{
+    PFORT_CONF_RULES rules = PFORT_CONF_RULES(drvRules);
+    PCFORT_CONF_RULE_FLAG rule_flag = PCFORT_CONF_RULE_FLAG(drvRuleFlag);
+
+    const quint16 rule_id = rule_flag->rule_id;
+    if (rule_id == 0 || rule_id > rules->max_rule_id)
+        return false;
+
+    const quint32 offsets_size = FORT_CONF_RULES_OFFSETS_SIZE(rules->max_rule_id);
+    if (FORT_CONF_RULES_DATA_OFF + offsets_size > rulesSize)
+        return false;
+
+    const FORT_CONF_RULES_RT rules_rt = fort_conf_rules_rt_make(rules, /*zones=*/nullptr);
+
+    // The rule must be placed after the offsets
+    const quint32 rule_off = rules_rt.rule_offsets[rule_id];
+    if (rule_off < offsets_size
+            || FORT_CONF_RULES_DATA_OFF + rule_off + sizeof(FORT_CONF_RULE) > rulesSize)
+        return false;
+
+    PFORT_CONF_RULE rule = fort_conf_rules_rt_rule(&rules_rt, rule_id);
+
+    rule->enabled = (rule_flag->enabled != 0);
+
+    return true;
+}
+
 bool confRulesConnFiltered(const void *drvRules, PFORT_CONF_META_CONN conn, quint16 ruleId)
 {
     PCFORT_CONF_RULES rules = PCFORT_CONF_RULES(drvRules);
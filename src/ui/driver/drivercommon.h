@@ -20,6 +20,8 @@ quint32 ioctlSetZones();
 quint32 ioctlSetZoneFlag();
 quint32 ioctlSetRules();
 quint32 ioctlSetRuleFlag();
+quint32 ioctlSetPending();
+quint32 ioctlGetPoolStat();
 
 quint32 userErrorCode();
 
@@ -66,7 +68,16 @@ bool confIp4InRange(const void *drvConf, quint32 ip, bool included = false, int
 bool confIp6InRange(
         const void *drvConf, const ip6_addr_t ip, bool included = false, int addrGroupIndex = 0);
 
+bool confIpIncluded(
+        const void *drvConf, const ip_addr_t ip, bool isIPv6 = false, int addrGroupIndex = 0);
+
 FORT_APP_DATA confAppFind(const void *drvConf, const QString &kernelPath);
+quint8 confAppLimitIoBits(const void *drvConf, quint16 limitId);
+FORT_TRAF_QUOTA confQuota(const void *drvConf, quint16 quotaId);
+
+void confIoFlagsSet(void *drvConfIo, const void *drvFlags);
+bool confZoneFlagSet(void *drvZones, const void *drvZoneFlag);
+bool confRuleFlagSet(void *drvRules, const void *drvRuleFlag, quint32 rulesSize);
 
 bool confRulesConnFiltered(const void *drvRules, PFORT_CONF_META_CONN conn, quint16 ruleId);
 bool confRulesConnBlocked(const void *drvRules, PFORT_CONF_META_CONN conn, quint16 ruleId);
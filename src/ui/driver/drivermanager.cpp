@@ -78,6 +78,9 @@ void DriverManager::closeWorker()
 
 bool DriverManager::openDevice()
 {
+    m_snapshot.clear();
+    m_pendingSnapshot.clear();
+
     const bool res = device()->open(DriverCommon::deviceName());
 
     updateErrorCode(res);
@@ -89,6 +92,8 @@ bool DriverManager::openDevice()
 
 bool DriverManager::closeDevice()
 {
+    m_pendingSnapshot.clear();
+
     const bool res = device()->close();
 
     updateErrorCode(true);
@@ -110,26 +115,119 @@ bool DriverManager::writeServices(QByteArray &buf)
 
 bool DriverManager::writeConf(QByteArray &buf, bool onlyFlags)
 {
-    return writeData(onlyFlags ? DriverCommon::ioctlSetFlags() : DriverCommon::ioctlSetConf(), buf);
+    if (onlyFlags) {
+        m_pendingSnapshot.conf.clear();
+
+        if (!writeData(DriverCommon::ioctlSetFlags(), buf))
+            return false;
+
+        m_snapshot.setConfFlags(buf);
+
+        return true;
+    }
+
+    if (!writeBlob(DriverCommon::ioctlSetConf(), buf, m_snapshot.conf, m_pendingSnapshot.conf))
+        return false;
+
+    m_snapshot.confOutdated = false;
+
+    logPoolStat();
+
+    return true;
 }
 
 bool DriverManager::writeApp(QByteArray &buf, bool remove)
 {
+    m_pendingSnapshot.conf.clear();
+
+    // The applied conf doesn't contain the app changes, so rebuild it on save
+    m_snapshot.confOutdated = !m_snapshot.conf.isEmpty();
+
     return writeData(remove ? DriverCommon::ioctlDelApp() : DriverCommon::ioctlAddApp(), buf);
 }
 
 bool DriverManager::writeZones(QByteArray &buf, bool onlyFlags)
 {
-    const auto code = onlyFlags ? DriverCommon::ioctlSetZoneFlag() : DriverCommon::ioctlSetZones();
+    if (onlyFlags) {
+        m_pendingSnapshot.zones.clear();
+
+        if (!writeData(DriverCommon::ioctlSetZoneFlag(), buf))
+            return false;
 
-    return writeData(code, buf);
+        m_snapshot.setZoneFlag(buf);
+
+        return true;
+    }
+
+    return writeBlob(
+            DriverCommon::ioctlSetZones(), buf, m_snapshot.zones, m_pendingSnapshot.zones);
 }
 
 bool DriverManager::writeRules(QByteArray &buf, bool onlyFlags)
 {
-    const auto code = onlyFlags ? DriverCommon::ioctlSetRuleFlag() : DriverCommon::ioctlSetRules();
+    if (onlyFlags) {
+        m_pendingSnapshot.rules.clear();
+
+        if (!writeData(DriverCommon::ioctlSetRuleFlag(), buf))
+            return false;
+
+        m_snapshot.setRuleFlag(buf);
 
-    return writeData(code, buf);
+        return true;
+    }
+
+    return writeBlob(
+            DriverCommon::ioctlSetRules(), buf, m_snapshot.rules, m_pendingSnapshot.rules);
+}
+
+bool DriverManager::writePending(QByteArray &buf)
+{
+    return writeData(DriverCommon::ioctlSetPending(), buf);
+}
+
+bool DriverManager::readPoolStat(FORT_DEVICE_POOL_STAT &poolStat)
+{
+    if (!isDeviceOpened())
+        return false;
+
+    const bool wasCancelled = driverWorker()->cancelAsyncIo();
+
+    qsizetype retSize = 0;
+    const bool res = device()->ioctl(DriverCommon::ioctlGetPoolStat(), nullptr, 0,
+            reinterpret_cast<char *>(&poolStat), sizeof(FORT_DEVICE_POOL_STAT), &retSize);
+
+    if (wasCancelled) {
+        driverWorker()->continueAsyncIo();
+    }
+
+    return res && retSize == sizeof(FORT_DEVICE_POOL_STAT);
+}
+
+bool DriverManager::applySnapshot(const DriverSnapshot &snapshot)
+{
+    if (!isDeviceOpened())
+        return false;
+
+    // The rules & zones are referenced by the conf, so set them first
+    if (!snapshot.zones.isEmpty()) {
+        QByteArray buf = snapshot.zones;
+        if (!writeZones(buf))
+            return false;
+    }
+
+    if (!snapshot.rules.isEmpty()) {
+        QByteArray buf = snapshot.rules;
+        if (!writeRules(buf))
+            return false;
+    }
+
+    QByteArray buf = snapshot.conf;
+    if (!writeConf(buf))
+        return false;
+
+    m_pendingSnapshot = snapshot;
+
+    return true;
 }
 
 bool DriverManager::writeData(quint32 code, QByteArray &buf)
@@ -150,6 +248,47 @@ bool DriverManager::writeData(quint32 code, QByteArray &buf)
     return res;
 }
 
+void DriverManager::logPoolStat()
+{
+    FORT_DEVICE_POOL_STAT poolStat;
+    if (!readPoolStat(poolStat))
+        return;
+
+    const auto poolText = [](const FORT_POOL_STAT &stat) {
+        // Fragmentation is the free space, which isn't in the largest free block
+        const quint32 fragPercent = (stat.free_size == 0)
+                ? 0
+                : 100 - quint32(quint64(stat.free_max_size) * 100 / stat.free_size);
+
+        return QString("pools=%1 size=%2 used=%3 free=%4 fragmentation=%5%")
+                .arg(QString::number(stat.pools_n), QString::number(stat.pools_size),
+                        QString::number(stat.used_size), QString::number(stat.free_size),
+                        QString::number(fragPercent));
+    };
+
+    qCDebug(LC) << "Pool of conf:" << poolText(poolStat.conf)
+                << "; of processes:" << poolText(poolStat.ps_tree);
+}
+
+bool DriverManager::writeBlob(
+        quint32 code, QByteArray &buf, QByteArray &applied, QByteArray &pending)
+{
+    // Skip the rebuilt blob, which is equal to the applied from snapshot one
+    const bool isPending = !pending.isEmpty() && pending == buf;
+
+    pending.clear();
+
+    if (isPending)
+        return true;
+
+    if (!writeData(code, buf))
+        return false;
+
+    applied = buf;
+
+    return true;
+}
+
 bool DriverManager::checkReinstallDriver()
 {
     return executeCommand("check-reinstall.bat");
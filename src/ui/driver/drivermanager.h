@@ -3,9 +3,13 @@
 
 #include <QObject>
 
+#include <common/fortconf.h>
+
 #include <util/classhelpers.h>
 #include <util/ioc/iocservice.h>
 
+#include "driversnapshot.h"
+
 class Device;
 class DriverWorker;
 
@@ -21,6 +25,8 @@ public:
     Device *device() const { return m_device; }
     DriverWorker *driverWorker() const { return m_driverWorker; }
 
+    const DriverSnapshot &snapshot() const { return m_snapshot; }
+
     quint32 errorCode() const { return m_errorCode; }
     QString errorMessage() const;
     bool isDeviceError() const;
@@ -48,6 +54,11 @@ public slots:
     bool writeApp(QByteArray &buf, bool remove = false);
     bool writeZones(QByteArray &buf, bool onlyFlags = false);
     bool writeRules(QByteArray &buf, bool onlyFlags = false);
+    bool writePending(QByteArray &buf);
+
+    bool readPoolStat(FORT_DEVICE_POOL_STAT &poolStat);
+
+    bool applySnapshot(const DriverSnapshot &snapshot);
 
 protected:
     void setErrorCode(quint32 v);
@@ -60,11 +71,17 @@ private:
 
     bool writeData(quint32 code, QByteArray &buf);
 
+    void logPoolStat();
+    bool writeBlob(quint32 code, QByteArray &buf, QByteArray &applied, QByteArray &pending);
+
     static bool executeCommand(const QString &fileName);
 
 private:
     quint32 m_errorCode = 0;
 
+    DriverSnapshot m_snapshot; // last applied blobs
+    DriverSnapshot m_pendingSnapshot; // applied on startup blobs to be validated by rebuilt ones
+
     Device *m_device = nullptr;
     DriverWorker *m_driverWorker = nullptr;
 };
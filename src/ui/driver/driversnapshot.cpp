@@ -0,0 +1,185 @@
+#include "driversnapshot.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QFile>
+#include <QLoggingCategory>
+
+#include <fort_version.h>
+
+#include <sqlite/sqlitedb.h>
+#include <sqlite/sqlitestmt.h>
+
+#include <util/fileutil.h>
+
+#include "drivercommon.h"
+
+namespace {
+
+const QLoggingCategory LC("driver.snapshot");
+
+constexpr quint32 snapshotMagic = 0x53445446; // "FTDS"
+constexpr quint16 snapshotVersion = 1;
+
+void addDbTableData(QCryptographicHash &hash, SqliteDb *sqliteDb, const QString &tableName)
+{
+    const auto sql = QString("SELECT * FROM %1 ORDER BY rowid;").arg(tableName);
+
+    SqliteStmt stmt;
+    if (!stmt.prepare(sqliteDb->db(), sql.toLatin1())) {
+        hash.addData(QByteArrayLiteral("-")); // broken table
+        return;
+    }
+
+    hash.addData(tableName.toLatin1());
+
+    const int columnCount = stmt.columnCount();
+
+    while (stmt.step() == SqliteStmt::StepRow) {
+        for (int i = 0; i < columnCount; ++i) {
+            if (stmt.columnIsNull(i)) {
+                hash.addData(QByteArrayLiteral("-"));
+                continue;
+            }
+
+            const QByteArray data = stmt.columnBlob(i, /*isView=*/true);
+
+            hash.addData(QByteArray::number(data.size()));
+            hash.addData(data);
+        }
+    }
+}
+
+void addDbData(QCryptographicHash &hash, SqliteDb *sqliteDb)
+{
+    // Not the DB files: their WAL is checkpointed on close
+    QStringList tableNames = sqliteDb->tableNames();
+    tableNames.sort();
+
+    for (const QString &tableName : std::as_const(tableNames)) {
+        addDbTableData(hash, sqliteDb, tableName);
+    }
+}
+
+void addFilesData(QCryptographicHash &hash, const QStringList &filePaths)
+{
+    for (const QString &filePath : filePaths) {
+        QFile file(filePath);
+        if (!file.open(QFile::ReadOnly)) {
+            hash.addData(QByteArrayLiteral("-")); // missing file
+            continue;
+        }
+
+        hash.addData(QByteArray::number(file.size()));
+        hash.addData(&file);
+    }
+}
+
+}
+
+void DriverSnapshot::clear()
+{
+    confOutdated = false;
+
+    conf.clear();
+    rules.clear();
+    zones.clear();
+}
+
+void DriverSnapshot::setConfFlags(const QByteArray &buf)
+{
+    if (conf.isEmpty())
+        return;
+
+    if (buf.size() != qsizetype(sizeof(FORT_CONF_FLAGS))
+            || conf.size() < qsizetype(DriverCommon::confIoConfOff() + sizeof(FORT_CONF_FLAGS))) {
+        conf.clear();
+        return;
+    }
+
+    DriverCommon::confIoFlagsSet(conf.data(), buf.constData());
+}
+
+void DriverSnapshot::setZoneFlag(const QByteArray &buf)
+{
+    if (zones.isEmpty())
+        return;
+
+    if (buf.size() != qsizetype(sizeof(FORT_CONF_ZONE_FLAG))
+            || zones.size() < qsizetype(FORT_CONF_ZONES_DATA_OFF)
+            || !DriverCommon::confZoneFlagSet(zones.data(), buf.constData())) {
+        zones.clear();
+    }
+}
+
+void DriverSnapshot::setRuleFlag(const QByteArray &buf)
+{
+    if (rules.isEmpty())
+        return;
+
+    if (buf.size() != qsizetype(sizeof(FORT_CONF_RULE_FLAG))
+            || rules.size() < qsizetype(FORT_CONF_RULES_DATA_OFF)
+            || !DriverCommon::confRuleFlagSet(rules.data(), buf.constData(), rules.size())) {
+        rules.clear();
+    }
+}
+
+bool DriverSnapshot::load(const QString &filePath, const QByteArray &stateKey)
+{
+    const QByteArray data = FileUtil::readFileData(filePath);
+    if (data.isEmpty())
+        return false;
+
+    QDataStream stream(data);
+
+    quint32 magic = 0;
+    quint16 version = 0;
+    quint32 driverVersion = 0;
+    QByteArray key;
+
+    stream >> magic >> version >> driverVersion >> key;
+
+    if (magic != snapshotMagic || version != snapshotVersion
+            || driverVersion != DRIVER_VERSION) {
+        qCDebug(LC) << "Incompatible:" << filePath;
+        return false;
+    }
+
+    if (key != stateKey) {
+        qCDebug(LC) << "State changed:" << filePath;
+        return false;
+    }
+
+    stream >> conf >> rules >> zones;
+
+    if (stream.status() != QDataStream::Ok) {
+        qCWarning(LC) << "Corrupted:" << filePath;
+        clear();
+        return false;
+    }
+
+    return !isEmpty();
+}
+
+bool DriverSnapshot::save(const QString &filePath, const QByteArray &stateKey) const
+{
+    QByteArray data;
+    QDataStream stream(&data, QDataStream::WriteOnly);
+
+    stream << snapshotMagic << snapshotVersion << quint32(DRIVER_VERSION) << stateKey << conf
+           << rules << zones;
+
+    return FileUtil::writeFileData(filePath, data);
+}
+
+QByteArray DriverSnapshot::stateKey(SqliteDb *sqliteDb, const QStringList &filePaths)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+
+    hash.addData(QByteArrayLiteral(APP_VERSION_STR));
+
+    addDbData(hash, sqliteDb);
+    addFilesData(hash, filePaths);
+
+    return hash.result();
+}
@@ -0,0 +1,36 @@
+#ifndef DRIVERSNAPSHOT_H
+#define DRIVERSNAPSHOT_H
+
+#include <QByteArray>
+#include <QStringList>
+
+class SqliteDb;
+
+// Last successfully applied driver blobs to push them on startup before the rebuild
+class DriverSnapshot
+{
+public:
+    bool isEmpty() const { return conf.isEmpty(); }
+
+    void clear();
+
+    // Keep the applied blobs in sync with the incremental flag writes
+    void setConfFlags(const QByteArray &buf);
+    void setZoneFlag(const QByteArray &buf);
+    void setRuleFlag(const QByteArray &buf);
+
+    bool load(const QString &filePath, const QByteArray &stateKey);
+    bool save(const QString &filePath, const QByteArray &stateKey) const;
+
+    // Hash of the DB tables and files contents, which the blobs were built from
+    static QByteArray stateKey(SqliteDb *sqliteDb, const QStringList &filePaths);
+
+public:
+    bool confOutdated = false; // the app entries were written after the conf
+
+    QByteArray conf;
+    QByteArray rules;
+    QByteArray zones;
+};
+
+#endif // DRIVERSNAPSHOT_H
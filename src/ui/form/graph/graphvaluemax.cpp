@@ -0,0 +1,46 @@
+#include "graphvaluemax.h"
+
+void GraphValueMax::clear()
+{
+    m_lowerKey = 0;
+    m_points.clear();
+}
+
+void GraphValueMax::add(double key, double value)
+{
+    // Time went backwards
+    if (!m_points.isEmpty() && key < m_points.constLast().key) {
+        m_points.clear();
+    }
+
+    while (!m_points.isEmpty() && m_points.constLast().value <= value) {
+        m_points.removeLast();
+    }
+
+    m_points.append({ .key = key, .value = value });
+}
+
+bool GraphValueMax::removeBefore(double key)
+{
+    if (key < m_lowerKey)
+        return false;
+
+    m_lowerKey = key;
+
+    while (!m_points.isEmpty() && m_points.constFirst().key < key) {
+        m_points.removeFirst();
+    }
+
+    return true;
+}
+
+void GraphValueMax::rebuild(const QCPBarsDataContainer &data, double lowerKey)
+{
+    m_points.clear();
+    m_lowerKey = lowerKey;
+
+    auto it = data.findBegin(lowerKey, /*expandedRange=*/false);
+    for (; it != data.constEnd(); ++it) {
+        add(it->mainKey(), it->mainValue());
+    }
+}
@@ -0,0 +1,37 @@
+#ifndef GRAPHVALUEMAX_H
+#define GRAPHVALUEMAX_H
+
+#include <QList>
+
+#include <qcustomplot.h>
+
+// Tracks the maximum value of the graph's data in a sliding key range.
+// Keeps only the points which may become the maximum (a decreasing sequence),
+// so adding and trimming are amortized O(1) instead of rescanning the range.
+class GraphValueMax
+{
+public:
+    double maxValue() const { return m_points.isEmpty() ? 0 : m_points.constFirst().value; }
+
+    void clear();
+
+    void add(double key, double value);
+
+    // Returns false, if the range was extended to the left and needs a rebuild
+    bool removeBefore(double key);
+
+    void rebuild(const QCPBarsDataContainer &data, double lowerKey);
+
+private:
+    struct Point
+    {
+        double key = 0;
+        double value = 0;
+    };
+
+    double m_lowerKey = 0;
+
+    QList<Point> m_points;
+};
+
+#endif // GRAPHVALUEMAX_H
@@ -15,6 +15,7 @@
 
 #include "axistickerspeed.h"
 #include "graphplot.h"
+#include "graphvaluemax.h"
 
 namespace {
 
@@ -393,31 +394,49 @@ void GraphWindow::addTraffic(qint64 unixTime, quint32 inBytes, quint32 outBytes)
     const double rangeLowerKey = double(rangeLower);
     const double unixTimeKey = double(unixTime);
 
-    addData(m_graphIn, rangeLowerKey, unixTimeKey, inBytes);
-    addData(m_graphOut, rangeLowerKey, unixTimeKey, outBytes);
+    addData(m_graphIn, m_inValueMax, rangeLowerKey, unixTimeKey, inBytes);
+    addData(m_graphOut, m_outValueMax, rangeLowerKey, unixTimeKey, outBytes);
 
     m_plot->xAxis->setRange(unixTimeKey, qFloor(m_plot->axisRect()->width() / 4), Qt::AlignRight);
 
-    m_graphIn->rescaleValueAxis(false, true);
-    m_graphOut->rescaleValueAxis(true, true);
+    updateValueAxis();
+
+    m_plot->replot();
+}
+
+void GraphWindow::updateValueAxis()
+{
+    const double visibleLowerKey = m_plot->xAxis->range().lower;
+
+    updateValueMax(m_graphIn, m_inValueMax, visibleLowerKey);
+    updateValueMax(m_graphOut, m_outValueMax, visibleLowerKey);
+
+    const double maxValue = qMax(m_inValueMax.maxValue(), m_outValueMax.maxValue());
 
-    // Avoid negative Y range
     QCPRange yRange = m_plot->yAxis->range();
-    if (yRange.lower < 0) {
+    if (maxValue > 0) {
+        yRange.lower = 0;
+        yRange.upper = maxValue;
+    } else if (yRange.lower < 0) {
+        // Avoid negative Y range
         yRange.upper -= yRange.lower;
         yRange.lower = 0;
-
-        m_plot->yAxis->setRange(yRange);
     }
 
     const qint64 yRangeMax = iniUser()->graphWindowFixedSpeed() * 1024LL;
     if (yRangeMax > 0) {
         yRange.upper = yRangeMax;
-
-        m_plot->yAxis->setRange(yRange);
     }
 
-    m_plot->replot();
+    m_plot->yAxis->setRange(yRange);
+}
+
+void GraphWindow::updateValueMax(QCPBars *graph, GraphValueMax &valueMax, double visibleLowerKey)
+{
+    // The visible range was extended to the left, e.g. on resize
+    if (!valueMax.removeBefore(visibleLowerKey)) {
+        valueMax.rebuild(*graph->data(), visibleLowerKey);
+    }
 }
 
 void GraphWindow::addEmptyTraffic()
@@ -425,7 +444,8 @@ void GraphWindow::addEmptyTraffic()
     addTraffic(DateUtil::getUnixTime(), 0, 0);
 }
 
-void GraphWindow::addData(QCPBars *graph, double rangeLowerKey, double unixTimeKey, quint32 bytes)
+void GraphWindow::addData(QCPBars *graph, GraphValueMax &valueMax, double rangeLowerKey,
+        double unixTimeKey, quint32 bytes)
 {
     auto data = graph->data();
     quint32 bits = bytes * 8;
@@ -436,6 +456,8 @@ void GraphWindow::addData(QCPBars *graph, double rangeLowerKey, double unixTimeK
 
     // Add data
     data->add(QCPBarsData(unixTimeKey, bits));
+
+    valueMax.add(unixTimeKey, bits);
 }
 
 void GraphWindow::updateWindowTitleSpeed()
@@ -6,6 +6,8 @@
 #include <form/controls/formwindow.h>
 #include <util/formatutil.h>
 
+#include "graphvaluemax.h"
+
 class AxisTickerSpeed;
 
 class ConfManager;
@@ -61,7 +63,11 @@ private:
 
     void setupTimer();
 
-    void addData(QCPBars *graph, double rangeLowerKey, double unixTimeKey, quint32 bytes);
+    void addData(QCPBars *graph, GraphValueMax &valueMax, double rangeLowerKey,
+            double unixTimeKey, quint32 bytes);
+
+    void updateValueAxis();
+    void updateValueMax(QCPBars *graph, GraphValueMax &valueMax, double visibleLowerKey);
 
     void updateWindowTitleSpeed();
     void setWindowOpacityPercent(int percent);
@@ -99,6 +105,9 @@ private:
     QCPBars *m_graphIn = nullptr;
     QCPBars *m_graphOut = nullptr;
 
+    GraphValueMax m_inValueMax;
+    GraphValueMax m_outValueMax;
+
     QPoint m_mousePressPoint;
     QPoint m_posOnMousePress;
     QSize m_sizeOnMousePress;
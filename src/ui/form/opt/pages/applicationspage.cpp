@@ -167,6 +167,9 @@ void ApplicationsPage::onRetranslateUi()
     m_limitBufferSizeIn->label()->setText(tr("Download Buffer Size:"));
     m_limitBufferSizeOut->label()->setText(tr("Upload Buffer Size:"));
 
+    m_quotaDay->label()->setText(tr("Day quota:"));
+    m_quotaMonth->label()->setText(tr("Month quota:"));
+
     m_cbGroupEnabled->setText(tr("Enabled"));
     m_ctpGroupPeriod->checkBox()->setText(tr("time period:"));
 
@@ -413,12 +416,14 @@ void ApplicationsPage::setupGroupOptions()
     setupGroupLimitLatency();
     setupGroupLimitPacketLoss();
     setupGroupLimitBufferSize();
+    setupGroupQuotas();
 
     // Menu
     auto layout = ControlUtil::createVLayoutByWidgets(
             { m_cbApplyChild, ControlUtil::createSeparator(), m_cbLogBlocked, m_cbLogConn,
                     ControlUtil::createSeparator(), m_cscLimitIn, m_cscLimitOut, m_limitLatency,
-                    m_limitPacketLoss, m_limitBufferSizeIn, m_limitBufferSizeOut });
+                    m_limitPacketLoss, m_limitBufferSizeIn, m_limitBufferSizeOut,
+                    ControlUtil::createSeparator(), m_quotaDay, m_quotaMonth });
 
     auto menu = ControlUtil::createMenuByLayout(layout, this);
 
@@ -508,6 +513,20 @@ void ApplicationsPage::setupGroupLimitBufferSize()
     });
 }
 
+void ApplicationsPage::setupGroupQuotas()
+{
+    constexpr int maxQuotaMb = 9999999;
+    const QLatin1String suffix(" MiB");
+
+    m_quotaDay = ControlUtil::createSpin(0, 0, maxQuotaMb, suffix, [&](int value) {
+        pageAppGroupSetUInt32(this, &AppGroup::setQuotaDayMb, quint32(value));
+    });
+
+    m_quotaMonth = ControlUtil::createSpin(0, 0, maxQuotaMb, suffix, [&](int value) {
+        pageAppGroupSetUInt32(this, &AppGroup::setQuotaMonthMb, quint32(value));
+    });
+}
+
 void ApplicationsPage::setupKillApps()
 {
     m_killApps = new AppsColumn(":/icons/scull.png");
@@ -596,6 +615,9 @@ void ApplicationsPage::updateGroup()
     m_limitBufferSizeIn->spinBox()->setValue(int(appGroup->limitBufferSizeIn()));
     m_limitBufferSizeOut->spinBox()->setValue(int(appGroup->limitBufferSizeOut()));
 
+    m_quotaDay->spinBox()->setValue(int(appGroup->quotaDayMb()));
+    m_quotaMonth->spinBox()->setValue(int(appGroup->quotaMonthMb()));
+
     m_cbGroupEnabled->setChecked(appGroup->enabled());
 
     m_ctpGroupPeriod->checkBox()->setChecked(appGroup->periodEnabled());
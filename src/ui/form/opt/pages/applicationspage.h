@@ -55,6 +55,7 @@ private:
     void setupGroupLimitLatency();
     void setupGroupLimitPacketLoss();
     void setupGroupLimitBufferSize();
+    void setupGroupQuotas();
     void setupKillApps();
     void setupBlockApps();
     void setupAllowApps();
@@ -86,6 +87,8 @@ private:
     LabelDoubleSpin *m_limitPacketLoss = nullptr;
     LabelSpin *m_limitBufferSizeIn = nullptr;
     LabelSpin *m_limitBufferSizeOut = nullptr;
+    LabelSpin *m_quotaDay = nullptr;
+    LabelSpin *m_quotaMonth = nullptr;
     QCheckBox *m_cbLogBlocked = nullptr;
     QCheckBox *m_cbLogConn = nullptr;
     AppsColumn *m_killApps = nullptr;
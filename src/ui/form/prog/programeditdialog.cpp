@@ -16,7 +16,9 @@
 #include <conf/confmanager.h>
 #include <conf/confrulemanager.h>
 #include <conf/firewallconf.h>
+#include <form/controls/checkspincombo.h>
 #include <form/controls/controlutil.h>
+#include <form/controls/labelspin.h>
 #include <form/controls/lineedit.h>
 #include <form/controls/plaintextedit.h>
 #include <form/controls/spincombo.h>
@@ -28,6 +30,7 @@
 #include <model/rulelistmodel.h>
 #include <util/dateutil.h>
 #include <util/fileutil.h>
+#include <util/formatutil.h>
 #include <util/guiutil.h>
 #include <util/iconcache.h>
 #include <util/ioc/ioccontainer.h>
@@ -45,6 +48,35 @@ const QSize appIconSize(32, 32);
 const std::array appBlockInMinuteValues = { 15, 0, 1, 5, 10, 30, 60 * 1, 60 * 6, 60 * 12, 60 * 24,
     60 * 24 * 7, 60 * 24 * 30 };
 
+constexpr int speedLimitDisabledIndex = 1;
+const std::array speedLimitValues = { 1024, 0, 50, 100, 200, 300, 500, 900, 1024, 2 * 1024,
+    5 * 1024, 10 * 1024, 20 * 1024, 50 * 1024 };
+
+CheckSpinCombo *createSpeedLimitCombo()
+{
+    auto c = new CheckSpinCombo();
+    c->setValues(speedLimitValues);
+    c->setDisabledIndex(speedLimitDisabledIndex);
+
+    auto spinBox = c->spinBox();
+    spinBox->setRange(0, 9999999);
+    spinBox->setSuffix(" Kb/s");
+
+    return c;
+}
+
+LabelSpin *createQuotaSpin()
+{
+    auto c = new LabelSpin();
+
+    auto spinBox = c->spinBox();
+    spinBox->setRange(0, 9999999);
+    spinBox->setSuffix(" MiB");
+    spinBox->setSpecialValueText(" ");
+
+    return c;
+}
+
 }
 
 enum ScheduleTimeType : qint8 {
@@ -130,6 +162,15 @@ void ProgramEditDialog::initialize(const AppRow &appRow, const QVector<qint64> &
     m_btZones->setUncheckedZones(appRow.rejectZones);
     updateZonesRulesLayout();
 
+    m_cscLimitIn->checkBox()->setChecked(appRow.speedLimitIn != 0);
+    m_cscLimitIn->spinBox()->setValue(int(appRow.speedLimitIn));
+    m_cscLimitOut->checkBox()->setChecked(appRow.speedLimitOut != 0);
+    m_cscLimitOut->spinBox()->setValue(int(appRow.speedLimitOut));
+
+    m_quotaDay->spinBox()->setValue(int(appRow.quotaDayMb));
+    m_quotaMonth->spinBox()->setValue(int(appRow.quotaMonthMb));
+    m_comboQuotaThrottle->setCurrentIndex(appRow.quotaThrottleGroup);
+
     m_cbSchedule->setChecked(!appRow.scheduleTime.isNull());
     m_comboScheduleAction->setCurrentIndex(appRow.scheduleAction);
     m_comboScheduleType->setCurrentIndex(
@@ -288,6 +329,15 @@ void ProgramEditDialog::retranslateUi()
     m_editRuleName->setPlaceholderText(tr("Rule"));
     m_btSelectRule->setToolTip(tr("Select Rule"));
 
+    m_cscLimitIn->checkBox()->setText(tr("Download speed limit:"));
+    m_cscLimitOut->checkBox()->setText(tr("Upload speed limit:"));
+    retranslateSpeedLimits();
+
+    m_quotaDay->label()->setText(tr("Day quota:"));
+    m_quotaMonth->label()->setText(tr("Month quota:"));
+    m_labelQuotaThrottle->setText(tr("When exceeded:"));
+    retranslateQuotaThrottle();
+
     m_cbSchedule->setText(tr("Schedule"));
     retranslateScheduleAction();
     retranslateScheduleType();
@@ -334,6 +384,36 @@ void ProgramEditDialog::retranslateComboApplyChild()
     updateApplyChild();
 }
 
+void ProgramEditDialog::retranslateSpeedLimits()
+{
+    QStringList list;
+
+    list.append(tr("Custom"));
+    list.append(tr("Disabled"));
+
+    int index = 0;
+    for (const int v : speedLimitValues) {
+        if (++index > 2) {
+            list.append(FormatUtil::formatSpeed(v * 1024LL));
+        }
+    }
+
+    m_cscLimitIn->setNames(list);
+    m_cscLimitOut->setNames(list);
+}
+
+void ProgramEditDialog::retranslateQuotaThrottle()
+{
+    // Index 0 blocks the app, else it's the 1-based app group index to throttle into
+    QStringList list = { tr("Block") };
+
+    for (const QString &name : conf()->appGroupNames()) {
+        list.append(tr("Throttle: %1").arg(name));
+    }
+
+    ControlUtil::setComboBoxTexts(m_comboQuotaThrottle, list);
+}
+
 void ProgramEditDialog::retranslateScheduleAction()
 {
     const QStringList list = { tr("Block"), tr("Allow"), tr("Remove"), tr("Kill Process") };
@@ -402,6 +482,12 @@ QLayout *ProgramEditDialog::setupMainLayout()
     // Zones/Rules
     auto zonesRulesLayout = setupZonesRuleLayout();
 
+    // Speed Limits
+    auto speedLimitsLayout = setupSpeedLimitsLayout();
+
+    // Traffic Quotas
+    auto quotasLayout = setupQuotasLayout();
+
     // Schedule
     auto scheduleLayout = setupScheduleLayout();
 
@@ -416,6 +502,8 @@ QLayout *ProgramEditDialog::setupMainLayout()
     layout->addLayout(actionsLayout);
     layout->addWidget(ControlUtil::createHSeparator());
     layout->addLayout(zonesRulesLayout);
+    layout->addLayout(speedLimitsLayout);
+    layout->addLayout(quotasLayout);
     layout->addWidget(ControlUtil::createSeparator());
     layout->addLayout(scheduleLayout);
     layout->addStretch();
@@ -591,6 +679,44 @@ QLayout *ProgramEditDialog::setupZonesRuleLayout()
     return layout;
 }
 
+QLayout *ProgramEditDialog::setupSpeedLimitsLayout()
+{
+    m_cscLimitIn = createSpeedLimitCombo();
+    m_cscLimitOut = createSpeedLimitCombo();
+
+    auto layout = new QHBoxLayout();
+    layout->addWidget(m_cscLimitIn);
+    layout->addWidget(ControlUtil::createVSeparator());
+    layout->addWidget(m_cscLimitOut);
+
+    return layout;
+}
+
+QLayout *ProgramEditDialog::setupQuotasLayout()
+{
+    m_quotaDay = createQuotaSpin();
+    m_quotaMonth = createQuotaSpin();
+
+    m_labelQuotaThrottle = ControlUtil::createLabel();
+    m_comboQuotaThrottle = ControlUtil::createComboBox();
+
+    connect(confManager(), &ConfManager::confChanged, this, [&](bool onlyFlags) {
+        if (!onlyFlags) {
+            retranslateQuotaThrottle();
+        }
+    });
+
+    auto layout = new QHBoxLayout();
+    layout->addWidget(m_quotaDay);
+    layout->addWidget(ControlUtil::createVSeparator());
+    layout->addWidget(m_quotaMonth);
+    layout->addWidget(ControlUtil::createVSeparator());
+    layout->addWidget(m_labelQuotaThrottle);
+    layout->addWidget(m_comboQuotaThrottle, 1);
+
+    return layout;
+}
+
 QLayout *ProgramEditDialog::setupRuleLayout()
 {
     m_editRuleName = new LineEdit();
@@ -946,6 +1072,17 @@ void ProgramEditDialog::fillApp(App &app) const
     app.acceptZones = m_btZones->zones();
     app.rejectZones = m_btZones->uncheckedZones();
 
+    app.speedLimitIn = m_cscLimitIn->checkBox()->isChecked()
+            ? quint32(m_cscLimitIn->spinBox()->value())
+            : 0;
+    app.speedLimitOut = m_cscLimitOut->checkBox()->isChecked()
+            ? quint32(m_cscLimitOut->spinBox()->value())
+            : 0;
+
+    app.quotaDayMb = quint32(m_quotaDay->spinBox()->value());
+    app.quotaMonthMb = quint32(m_quotaMonth->spinBox()->value());
+    app.quotaThrottleGroup = quint8(qMax(m_comboQuotaThrottle->currentIndex(), 0));
+
     fillAppPath(app);
     fillAppApplyChild(app);
     fillAppEndTime(app);
@@ -4,12 +4,14 @@
 #include <form/controls/formwindow.h>
 #include <model/applistmodel.h>
 
+class CheckSpinCombo;
 class ConfAppManager;
 class ConfRuleManager;
 class ConfManager;
 class FirewallConf;
 class FortManager;
 class IniUser;
+class LabelSpin;
 class LineEdit;
 class PlainTextEdit;
 class ProgramsController;
@@ -70,6 +72,8 @@ private:
     void retranslateUi();
     void retranslatePathPlaceholderText();
     void retranslateComboApplyChild();
+    void retranslateSpeedLimits();
+    void retranslateQuotaThrottle();
     void retranslateScheduleAction();
     void retranslateScheduleType();
     void retranslateScheduleIn();
@@ -85,6 +89,8 @@ private:
     void setupActionsGroup();
     QLayout *setupZonesRuleLayout();
     QLayout *setupRuleLayout();
+    QLayout *setupSpeedLimitsLayout();
+    QLayout *setupQuotasLayout();
     QLayout *setupScheduleLayout();
     void setupCbSchedule();
     void setupComboScheduleType();
@@ -153,6 +159,12 @@ private:
     ZonesSelector *m_btZones = nullptr;
     LineEdit *m_editRuleName = nullptr;
     QToolButton *m_btSelectRule = nullptr;
+    CheckSpinCombo *m_cscLimitIn = nullptr;
+    CheckSpinCombo *m_cscLimitOut = nullptr;
+    LabelSpin *m_quotaDay = nullptr;
+    LabelSpin *m_quotaMonth = nullptr;
+    QLabel *m_labelQuotaThrottle = nullptr;
+    QComboBox *m_comboQuotaThrottle = nullptr;
     QCheckBox *m_cbSchedule = nullptr;
     QComboBox *m_comboScheduleAction = nullptr;
     QComboBox *m_comboScheduleType = nullptr;
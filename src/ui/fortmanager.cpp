@@ -11,6 +11,7 @@
 #include <conf/firewallconf.h>
 #include <control/controlmanager.h>
 #include <driver/drivercommon.h>
+#include <driver/drivermanager.h>
 #include <form/dialog/passworddialog.h>
 #include <fortsettings.h>
 #include <hostinfo/hostinfocache.h>
@@ -140,6 +141,8 @@ FortManager::FortManager(QObject *parent) : QObject(parent) { }
 FortManager::~FortManager()
 {
     if (m_initialized) {
+        saveDriverSnapshot();
+
         closeDriver();
 
         emit aboutToDestroy();
@@ -173,6 +176,7 @@ bool FortManager::checkRunningInstance(bool isService, bool isLaunch)
 void FortManager::initialize()
 {
     m_initialized = true;
+    m_startupTimer.start();
 
     OsUtil::setCurrentThreadName("Main");
 
@@ -191,6 +195,8 @@ void FortManager::initialize()
     checkReinstallDriver();
     checkStartService();
 
+    setupDriverSnapshot();
+
     if (!setupDriver()) {
         checkDriverAccess();
     }
@@ -497,8 +503,8 @@ void FortManager::setupServiceInfoManager()
 {
     auto serviceInfoManager = IoC<ServiceInfoManager>();
 
-    connect(serviceInfoManager, &ServiceInfoManager::servicesStarted, IoC<ConfManager>(),
-            &ConfManager::updateDriverServices);
+    connect(serviceInfoManager, &ServiceInfoManager::servicesChanged, IoC<ConfManager>(),
+            &ConfManager::updateDriverServiceChanges);
 }
 
 void FortManager::processRestartRequired(const QString &info)
@@ -528,6 +534,8 @@ void FortManager::loadConf()
                                                             : "Program");
 
     confManager->load();
+
+    qCDebug(LC) << "Conf loaded in" << m_startupTimer.elapsed() << "msec";
 }
 
 bool FortManager::setupDriverConf()
@@ -537,6 +545,8 @@ bool FortManager::setupDriverConf()
     if (!confManager->validateDriver())
         return false;
 
+    applyDriverSnapshot();
+
     // Services
     confManager->updateServices();
 
@@ -570,6 +580,59 @@ bool FortManager::updateDriverConf(bool onlyFlags)
     return res;
 }
 
+void FortManager::setupDriverSnapshot()
+{
+    const auto settings = IoC<FortSettings>();
+
+    // Only the driver's owner process uses the snapshot
+    if (settings->noCache() || (settings->hasService() && !settings->isService()))
+        return;
+
+    m_driverSnapshotPath = settings->cachePath() + "driver.snapshot";
+    m_driverStatePaths = { settings->filePath() };
+}
+
+void FortManager::applyDriverSnapshot()
+{
+    if (m_driverSnapshotPath.isEmpty())
+        return;
+
+    DriverSnapshot snapshot;
+    if (!snapshot.load(m_driverSnapshotPath, driverStateKey()))
+        return;
+
+    if (!IoC<DriverManager>()->applySnapshot(snapshot))
+        return;
+
+    qCDebug(LC) << "Driver snapshot applied in" << m_startupTimer.elapsed() << "msec";
+}
+
+void FortManager::saveDriverSnapshot()
+{
+    if (m_driverSnapshotPath.isEmpty())
+        return;
+
+    DriverSnapshot snapshot = IoC<DriverManager>()->snapshot();
+
+    // Rebuild the conf once with all the app changes, written after it
+    if (snapshot.confOutdated && !IoC<ConfAppManager>()->buildDriverConf(snapshot.conf)) {
+        snapshot.conf.clear();
+    }
+
+    if (snapshot.isEmpty()) {
+        FileUtil::removeFile(m_driverSnapshotPath);
+        return;
+    }
+
+    snapshot.save(m_driverSnapshotPath, driverStateKey());
+}
+
+QByteArray FortManager::driverStateKey() const
+{
+    // The conf DB is open both on startup and on exit
+    return DriverSnapshot::stateKey(IoC<ConfManager>()->sqliteDb(), m_driverStatePaths);
+}
+
 void FortManager::updateLogManager(bool active)
 {
     IoC<LogManager>()->setActive(active);
@@ -1,6 +1,7 @@
 #ifndef FORTMANAGER_H
 #define FORTMANAGER_H
 
+#include <QElapsedTimer>
 #include <QObject>
 
 #include <util/classhelpers.h>
@@ -65,6 +66,12 @@ private:
     bool setupDriverConf();
     bool updateDriverConf(bool onlyFlags = false);
 
+    void setupDriverSnapshot();
+    void applyDriverSnapshot();
+    void saveDriverSnapshot();
+
+    QByteArray driverStateKey() const;
+
     void updateLogManager(bool active);
     void updateStatManager(FirewallConf *conf);
 
@@ -72,6 +79,11 @@ private:
     bool m_initialized : 1 = false;
 
     void *m_instanceMutex = nullptr;
+
+    QElapsedTimer m_startupTimer;
+
+    QString m_driverSnapshotPath; // empty, when the snapshot is not used
+    QStringList m_driverStatePaths; // besides the conf DB
 };
 
 #endif // FORTMANAGER_H
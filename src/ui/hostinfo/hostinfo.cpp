@@ -1 +1,19 @@
 #include "hostinfo.h"
+
+QByteArray HostInfo::ipToKey(const ip_addr_t &ip, bool isIPv6)
+{
+    return QByteArray(ip.data, isIPv6 ? sizeof(ip6_addr_t) : sizeof(quint32));
+}
+
+ip_addr_t HostInfo::keyToIp(const QByteArray &key, bool &isIPv6)
+{
+    ip_addr_t ip;
+    memset(&ip, 0, sizeof(ip_addr_t));
+
+    const int size = qMin(key.size(), int(sizeof(ip_addr_t)));
+    memcpy(ip.data, key.constData(), size);
+
+    isIPv6 = (size == sizeof(ip6_addr_t));
+
+    return ip;
+}
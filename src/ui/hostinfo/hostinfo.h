@@ -1,12 +1,25 @@
 #ifndef HOSTINFO_H
 #define HOSTINFO_H
 
+#include <QDeadlineTimer>
 #include <QObject>
 
+#include <common/common_types.h>
+
 class HostInfo
 {
 public:
-    QString hostName;
+    bool isExpired() const { return expireTimer.hasExpired(); }
+
+    static QByteArray ipToKey(const ip_addr_t &ip, bool isIPv6 = false);
+    static ip_addr_t keyToIp(const QByteArray &key, bool &isIPv6);
+
+public:
+    bool lookupPending = true;
+
+    QString hostName; // empty, if the address has no name
+
+    QDeadlineTimer expireTimer;
 };
 
 #endif // HOSTINFO_H
@@ -2,9 +2,19 @@
 
 #include "hostinfomanager.h"
 
-HostInfoCache::HostInfoCache(QObject *parent) :
-    QObject(parent), m_manager(new HostInfoManager(this)), m_cache(1000)
+namespace {
+
+constexpr int HOST_CACHE_MAX_COUNT = 1000;
+
+}
+
+HostInfoCache::HostInfoCache(HostInfoManager *manager, QObject *parent) :
+    QObject(parent),
+    m_manager(manager ? manager : new HostInfoManager()),
+    m_cache(HOST_CACHE_MAX_COUNT)
 {
+    m_manager->setParent(this);
+
     connect(m_manager, &HostInfoManager::lookupFinished, this,
             &HostInfoCache::handleFinishedLookup);
 
@@ -17,20 +27,29 @@ HostInfoCache::~HostInfoCache()
     close();
 }
 
-QString HostInfoCache::hostName(const QString &address)
+QString HostInfoCache::hostName(const ip_addr_t &ip, bool isIPv6)
 {
-    HostInfo *hostInfo = m_cache.object(address);
+    const QByteArray ipKey = HostInfo::ipToKey(ip, isIPv6);
+
+    HostInfo *hostInfo = m_cache.object(ipKey);
 
     if (hostInfo) {
+        // Refresh the expired name, pending lookups are shared
+        if (!hostInfo->lookupPending && hostInfo->isExpired()) {
+            hostInfo->lookupPending = true;
+
+            m_manager->lookupHost(ipKey);
+        }
+
         return hostInfo->hostName;
     }
 
     hostInfo = new HostInfo();
 
-    m_cache.insert(address, hostInfo, 1);
+    m_cache.insert(ipKey, hostInfo, 1);
     /* hostInfo may be deleted */
 
-    m_manager->lookupHost(address);
+    m_manager->lookupHost(ipKey);
 
     return {};
 }
@@ -48,13 +67,15 @@ void HostInfoCache::close()
     m_manager->abortWorkers();
 }
 
-void HostInfoCache::handleFinishedLookup(const QString &address, const QString &hostName)
+void HostInfoCache::handleFinishedLookup(const QByteArray &ipKey, const QString &hostName)
 {
-    HostInfo *hostInfo = m_cache.object(address);
+    HostInfo *hostInfo = m_cache.object(ipKey);
     if (!hostInfo)
         return;
 
+    hostInfo->lookupPending = false;
     hostInfo->hostName = hostName;
+    hostInfo->expireTimer.setRemainingTime(hostName.isEmpty() ? m_noNameTtl : m_nameTtl);
 
     emitCacheChanged();
 }
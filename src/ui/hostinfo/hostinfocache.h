@@ -16,29 +16,41 @@ class HostInfoCache : public QObject, public IocService
     Q_OBJECT
 
 public:
-    explicit HostInfoCache(QObject *parent = nullptr);
+    constexpr static qint64 NameTtl = 60 * 60 * 1000; // 1 hour
+    constexpr static qint64 NoNameTtl = 5 * 60 * 1000; // 5 minutes
+
+    explicit HostInfoCache(HostInfoManager *manager = nullptr, QObject *parent = nullptr);
     ~HostInfoCache() override;
 
+    qint64 nameTtl() const { return m_nameTtl; }
+    void setNameTtl(qint64 v) { m_nameTtl = v; }
+
+    qint64 noNameTtl() const { return m_noNameTtl; }
+    void setNoNameTtl(qint64 v) { m_noNameTtl = v; }
+
 signals:
     void cacheChanged();
 
 public slots:
-    QString hostName(const QString &address);
+    QString hostName(const ip_addr_t &ip, bool isIPv6 = false);
 
     void clear();
 
 private slots:
     void close();
 
-    void handleFinishedLookup(const QString &address, const QString &hostName);
+    void handleFinishedLookup(const QByteArray &ipKey, const QString &hostName);
 
 private:
     void emitCacheChanged();
 
 private:
+    qint64 m_nameTtl = NameTtl;
+    qint64 m_noNameTtl = NoNameTtl;
+
     HostInfoManager *m_manager = nullptr;
 
-    QCache<QString, HostInfo> m_cache;
+    QCache<QByteArray, HostInfo> m_cache;
 
     TriggerTimer m_triggerTimer;
 };
@@ -3,13 +3,17 @@
 #include <util/net/netutil.h>
 #include <util/worker/workerobject.h>
 
+#include "hostinfo.h"
 #include "hostinfomanager.h"
 
-HostInfoJob::HostInfoJob(const QString &address) : WorkerJob(address) { }
+HostInfoJob::HostInfoJob(const QByteArray &ipKey) : m_ipKey(ipKey) { }
 
 void HostInfoJob::doJob(WorkerObject & /*worker*/)
 {
-    m_hostName = NetUtil::getHostName(address());
+    bool isIPv6;
+    const ip_addr_t ip = HostInfo::keyToIp(ipKey(), isIPv6);
+
+    m_hostName = NetUtil::getHostName(ip, isIPv6);
 }
 
 void HostInfoJob::reportResult(WorkerObject &worker)
@@ -19,5 +23,5 @@ void HostInfoJob::reportResult(WorkerObject &worker)
 
 void HostInfoJob::emitFinished(HostInfoManager *manager)
 {
-    emit manager->lookupFinished(address(), m_hostName);
+    emit manager->lookupFinished(ipKey(), m_hostName);
 }
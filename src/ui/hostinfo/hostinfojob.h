@@ -8,9 +8,9 @@ class HostInfoManager;
 class HostInfoJob : public WorkerJob
 {
 public:
-    explicit HostInfoJob(const QString &address);
+    explicit HostInfoJob(const QByteArray &ipKey);
 
-    QString address() const { return text(); }
+    const QByteArray &ipKey() const { return m_ipKey; }
 
     void doJob(WorkerObject &worker) override;
     void reportResult(WorkerObject &worker) override;
@@ -19,6 +19,8 @@ private:
     void emitFinished(HostInfoManager *manager);
 
 private:
+    const QByteArray m_ipKey;
+
     QString m_hostName;
 };
 
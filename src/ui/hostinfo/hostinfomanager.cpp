@@ -9,7 +9,7 @@ HostInfoManager::HostInfoManager(QObject *parent) : WorkerManager(parent)
     QSysInfo::machineHostName(); // Initialize ws2_32.dll
 }
 
-void HostInfoManager::lookupHost(const QString &address)
+void HostInfoManager::lookupHost(const QByteArray &ipKey)
 {
-    enqueueJob(WorkerJobPtr(new HostInfoJob(address)));
+    enqueueJob(WorkerJobPtr(new HostInfoJob(ipKey)));
 }
@@ -13,10 +13,10 @@ public:
     QString workerName() const override { return "HostInfoWorker"; }
 
 signals:
-    void lookupFinished(const QString &address, const QString &hostName);
+    void lookupFinished(const QByteArray &ipKey, const QString &hostName);
 
 public slots:
-    void lookupHost(const QString &address);
+    virtual void lookupHost(const QByteArray &ipKey);
 };
 
 #endif // HOSTINFOMANAGER_H
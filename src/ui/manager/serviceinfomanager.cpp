@@ -296,7 +296,11 @@ void ServiceInfoManager::onServiceStateChanged(ServiceMonitor *serviceMonitor)
     case ServiceMonitor::ServiceRunning: {
         onServiceStarted(serviceMonitor);
     } break;
+    case ServiceMonitor::ServiceStopped: {
+        onServiceStopped(serviceMonitor);
+    } break;
     case ServiceMonitor::ServiceDeleting: {
+        onServiceStopped(serviceMonitor);
         stopServiceMonitor(serviceMonitor);
     } break;
     }
@@ -304,14 +308,22 @@ void ServiceInfoManager::onServiceStateChanged(ServiceMonitor *serviceMonitor)
 
 void ServiceInfoManager::onServiceStarted(ServiceMonitor *serviceMonitor)
 {
-    constexpr int servicesCount = 1;
-
-    QVector<ServiceInfo> services(servicesCount);
+    QVector<ServiceInfo> services(1);
 
     ServiceInfo &info = services[0];
     info.isRunning = true;
     info.processId = serviceMonitor->processId();
     info.serviceName = serviceMonitor->serviceName();
 
-    emit servicesStarted(services, servicesCount);
+    emit servicesChanged(services);
+}
+
+void ServiceInfoManager::onServiceStopped(ServiceMonitor *serviceMonitor)
+{
+    QVector<ServiceInfo> services(1);
+
+    ServiceInfo &info = services[0];
+    info.serviceName = serviceMonitor->serviceName();
+
+    emit servicesChanged(services);
 }
@@ -26,7 +26,8 @@ public:
     static QString getSvcHostServiceDll(const QString &serviceName);
 
 signals:
-    void servicesStarted(const QVector<ServiceInfo> &services, int runningServicesCount);
+    // Added, removed or pid-changed services
+    void servicesChanged(const QVector<ServiceInfo> &services);
 
 public slots:
     virtual void trackService(const QString &serviceName);
@@ -46,6 +47,7 @@ private:
     void onServicesCreated(const QStringList &serviceNames);
     void onServiceStateChanged(ServiceMonitor *serviceMonitor);
     void onServiceStarted(ServiceMonitor *serviceMonitor);
+    void onServiceStopped(ServiceMonitor *serviceMonitor);
 
 private:
     ServiceListMonitor *m_serviceListMonitor = nullptr;
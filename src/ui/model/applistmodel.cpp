@@ -212,6 +212,11 @@ bool AppListModel::updateAppRow(const QString &sql, const QVariantHash &vars, Ap
     appRow.groupIndex = stmt.columnInt(22);
     appRow.alerted = stmt.columnBool(23);
     appRow.ruleName = stmt.columnText(24);
+    appRow.speedLimitIn = stmt.columnUInt(25);
+    appRow.speedLimitOut = stmt.columnUInt(26);
+    appRow.quotaDayMb = stmt.columnUInt(27);
+    appRow.quotaMonthMb = stmt.columnUInt(28);
+    appRow.quotaThrottleGroup = quint8(stmt.columnInt(29));
 
     return true;
 }
@@ -308,7 +313,12 @@ QString AppListModel::sqlBase() const
            "    t.creat_time,"
            "    g.order_index as group_index,"
            "    (a.app_id IS NOT NULL) as alerted,"
-           "    r.name as rule_name"
+           "    r.name as rule_name,"
+           "    t.speed_limit_in,"
+           "    t.speed_limit_out,"
+           "    t.quota_day_mb,"
+           "    t.quota_month_mb,"
+           "    t.quota_throttle_group"
            "  FROM app t"
            "    JOIN app_group g ON g.app_group_id = t.app_group_id"
            "    LEFT JOIN app_alert a ON a.app_id = t.app_id"
@@ -127,7 +127,7 @@ QVariant AppStatModel::dataDisplay(const QModelIndex &index) const
         return tr("All");
 
     const auto &appPath = list().at(row);
-    return appInfoCache()->appName(appPath);
+    return appInfoCache()->appName(appPath, /*loadFromFs=*/false);
 }
 
 QVariant AppStatModel::dataDecoration(const QModelIndex &index) const
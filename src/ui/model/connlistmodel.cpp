@@ -26,7 +26,7 @@ QString formatIpPort(const ip_addr_t ip, quint16 port, bool isIPv6, bool resolve
 {
     QString address = NetFormatUtil::ipToText(ip, isIPv6);
     if (resolveAddress) {
-        const QString hostName = IoC<HostInfoCache>()->hostName(address);
+        const QString hostName = IoC<HostInfoCache>()->hostName(ip, isIPv6);
         if (!hostName.isEmpty()) {
             address = hostName;
         }
@@ -51,10 +51,11 @@ QString reasonIconPath(const ConnRow &connRow)
         ":/icons/script_code.png",
         ":/icons/script_code_red.png",
         ":/icons/help.png",
+        ":/icons/chart_bar.png",
     };
 
     if (connRow.reason >= FORT_CONN_REASON_IP_INET
-            && connRow.reason <= FORT_CONN_REASON_ASK_LIMIT) {
+            && connRow.reason <= FORT_CONN_REASON_APP_QUOTA) {
         const int index = connRow.reason - FORT_CONN_REASON_IP_INET;
         return reasonIcons[index];
     }
@@ -74,7 +75,7 @@ QString directionIconPath(const ConnRow &connRow)
 
 QVariant dataDisplayAppName(const ConnRow &connRow, bool /*resolveAddress*/, int /*role*/)
 {
-    return IoC<AppInfoCache>()->appName(connRow.appPath);
+    return IoC<AppInfoCache>()->appName(connRow.appPath, /*loadFromFs=*/false);
 }
 
 QVariant dataDisplayProcessId(const ConnRow &connRow, bool /*resolveAddress*/, int /*role*/)
@@ -477,9 +478,10 @@ QString ConnListModel::reasonText(FortConnReason reason)
         QT_TR_NOOP("Global Rule before App Rules"),
         QT_TR_NOOP("Global Rule after App Rules"),
         QT_TR_NOOP("Limit of Ask to Connect"),
+        QT_TR_NOOP("Traffic quota"),
     };
 
-    if (reason >= FORT_CONN_REASON_IP_INET && reason <= FORT_CONN_REASON_ASK_LIMIT) {
+    if (reason >= FORT_CONN_REASON_IP_INET && reason <= FORT_CONN_REASON_APP_QUOTA) {
         const int index = reason - FORT_CONN_REASON_IP_INET;
         return tr(reasonTexts[index]);
     }
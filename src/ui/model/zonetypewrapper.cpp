@@ -37,6 +37,11 @@ QString ZoneTypeWrapper::pattern() const
     return valueText("pattern");
 }
 
+bool ZoneTypeWrapper::ip4FastPath() const
+{
+    return valueBool("ip4FastPath");
+}
+
 int ZoneTypeWrapper::emptyNetMask() const
 {
     return valueInt("emptyNetMask");
@@ -21,6 +21,7 @@ public:
     QString description() const;
     bool sort() const;
     QString pattern() const;
+    bool ip4FastPath() const;
     int emptyNetMask() const;
 
     static int idByCode(const QString &code);
@@ -9,6 +9,10 @@ class AskPendingManagerRpc : public AskPendingManager
 
 public:
     explicit AskPendingManagerRpc(QObject *parent = nullptr);
+
+protected:
+    void setupConfManager() override { }
+    void setupDriverManager() override { }
 };
 
 #endif // ASKPENDINGMANAGERRPC_H
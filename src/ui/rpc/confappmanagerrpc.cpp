@@ -3,14 +3,68 @@
 #include <conf/app.h>
 #include <conf/firewallconf.h>
 #include <conf/zone.h>
+#include <control/controlcodec.h>
 #include <fortsettings.h>
 #include <rpc/rpcmanager.h>
 #include <task/taskmanager.h>
 #include <util/ioc/ioccontainer.h>
-#include <util/variantutil.h>
 
 namespace {
 
+enum AppFlag : quint32 {
+    AppWildcard = (1 << 0),
+    AppApplyParent = (1 << 1),
+    AppApplyChild = (1 << 2),
+    AppApplySpecChild = (1 << 3),
+    AppKillChild = (1 << 4),
+    AppLanOnly = (1 << 5),
+    AppParked = (1 << 6),
+    AppLogAllowedConn = (1 << 7),
+    AppLogBlockedConn = (1 << 8),
+    AppBlocked = (1 << 9),
+    AppKillProcess = (1 << 10),
+    AppHasScheduleTime = (1 << 11),
+};
+
+inline quint32 appFlag(bool on, AppFlag flag)
+{
+    return on ? flag : 0;
+}
+
+QByteArray appIdListToBytes(const QVector<qint64> &appIdList)
+{
+    QByteArray data;
+
+    ControlCodec::writeVarUInt(data, appIdList.size());
+
+    for (const qint64 appId : appIdList) {
+        ControlCodec::writeVarInt(data, appId);
+    }
+
+    return data;
+}
+
+bool bytesToAppIdList(const QByteArray &data, QVector<qint64> &appIdList)
+{
+    ControlCodecReader reader(data);
+
+    quint64 count;
+    if (!reader.readCount(count))
+        return false;
+
+    appIdList.reserve(qsizetype(count));
+
+    while (count-- > 0) {
+        qint64 appId;
+        if (!reader.readVarInt(appId))
+            return false;
+
+        appIdList.append(appId);
+    }
+
+    return reader.atEnd();
+}
+
 bool processConfAppManager_addOrUpdateAppPath(
         ConfAppManager *confAppManager, const ProcessCommandArgs &p, QVariantList & /*resArgs*/)
 {
@@ -27,7 +81,9 @@ bool processConfAppManager_deleteAppPath(
 bool processConfAppManager_addOrUpdateApp(
         ConfAppManager *confAppManager, const ProcessCommandArgs &p, QVariantList & /*resArgs*/)
 {
-    App app = ConfAppManagerRpc::varListToApp(p.args.value(0).toList());
+    App app;
+    if (!ConfAppManagerRpc::bytesToApp(p.args.value(0).toByteArray(), app))
+        return false;
 
     return confAppManager->addOrUpdateApp(app, p.args.value(1).toBool());
 }
@@ -35,7 +91,9 @@ bool processConfAppManager_addOrUpdateApp(
 bool processConfAppManager_updateApp(
         ConfAppManager *confAppManager, const ProcessCommandArgs &p, QVariantList & /*resArgs*/)
 {
-    App app = ConfAppManagerRpc::varListToApp(p.args);
+    App app;
+    if (!ConfAppManagerRpc::bytesToApp(p.args.value(0).toByteArray(), app))
+        return false;
 
     return confAppManager->updateApp(app);
 }
@@ -50,7 +108,8 @@ bool processConfAppManager_deleteApps(
         ConfAppManager *confAppManager, const ProcessCommandArgs &p, QVariantList & /*resArgs*/)
 {
     QVector<qint64> appIdList;
-    VariantUtil::listToVector(p.args.value(0).toList(), appIdList);
+    if (!bytesToAppIdList(p.args.value(0).toByteArray(), appIdList))
+        return false;
 
     return confAppManager->deleteApps(appIdList);
 }
@@ -71,7 +130,8 @@ bool processConfAppManager_updateAppsBlocked(
         ConfAppManager *confAppManager, const ProcessCommandArgs &p, QVariantList & /*resArgs*/)
 {
     QVector<qint64> appIdList;
-    VariantUtil::listToVector(p.args.value(0).toList(), appIdList);
+    if (!bytesToAppIdList(p.args.value(0).toByteArray(), appIdList))
+        return false;
 
     return confAppManager->updateAppsBlocked(
             appIdList, p.args.value(1).toBool(), p.args.value(2).toBool());
@@ -129,12 +189,13 @@ bool ConfAppManagerRpc::deleteAppPath(const QString &appOriginPath)
 bool ConfAppManagerRpc::addOrUpdateApp(App &app, bool onlyUpdate)
 {
     return IoC<RpcManager>()->doOnServer(
-            Control::Rpc_ConfAppManager_addOrUpdateApp, { appToVarList(app), onlyUpdate });
+            Control::Rpc_ConfAppManager_addOrUpdateApp, { appToBytes(app), onlyUpdate });
 }
 
 bool ConfAppManagerRpc::updateApp(App &app)
 {
-    return IoC<RpcManager>()->doOnServer(Control::Rpc_ConfAppManager_updateApp, appToVarList(app));
+    return IoC<RpcManager>()->doOnServer(
+            Control::Rpc_ConfAppManager_updateApp, { appToBytes(app) });
 }
 
 bool ConfAppManagerRpc::updateAppName(qint64 appId, const QString &appName)
@@ -145,13 +206,8 @@ bool ConfAppManagerRpc::updateAppName(qint64 appId, const QString &appName)
 
 bool ConfAppManagerRpc::deleteApps(const QVector<qint64> &appIdList)
 {
-    QVariantList appIdVarList;
-    VariantUtil::vectorToList(appIdList, appIdVarList);
-
-    QVariantList args;
-    VariantUtil::addToList(args, QVariant(appIdVarList));
-
-    return IoC<RpcManager>()->doOnServer(Control::Rpc_ConfAppManager_deleteApps, args);
+    return IoC<RpcManager>()->doOnServer(
+            Control::Rpc_ConfAppManager_deleteApps, { appIdListToBytes(appIdList) });
 }
 
 bool ConfAppManagerRpc::clearAlerts()
@@ -167,14 +223,8 @@ bool ConfAppManagerRpc::purgeApps()
 bool ConfAppManagerRpc::updateAppsBlocked(
         const QVector<qint64> &appIdList, bool blocked, bool killProcess)
 {
-    QVariantList appIdVarList;
-    VariantUtil::vectorToList(appIdList, appIdVarList);
-
-    QVariantList args;
-    VariantUtil::addToList(args, QVariant(appIdVarList));
-    args << blocked << killProcess;
-
-    return IoC<RpcManager>()->doOnServer(Control::Rpc_ConfAppManager_updateAppsBlocked, args);
+    return IoC<RpcManager>()->doOnServer(Control::Rpc_ConfAppManager_updateAppsBlocked,
+            { appIdListToBytes(appIdList), blocked, killProcess });
 }
 
 bool ConfAppManagerRpc::importAppsBackup(const QString &path)
@@ -182,41 +232,91 @@ bool ConfAppManagerRpc::importAppsBackup(const QString &path)
     return IoC<RpcManager>()->doOnServer(Control::Rpc_ConfAppManager_importAppsBackup, { path });
 }
 
-QVariantList ConfAppManagerRpc::appToVarList(const App &app)
+QByteArray ConfAppManagerRpc::appToBytes(const App &app)
 {
-    return { app.isWildcard, app.applyParent, app.applyChild, app.applySpecChild, app.killChild,
-        app.lanOnly, app.parked, app.logAllowedConn, app.logBlockedConn, app.blocked,
-        app.killProcess, app.groupIndex, app.acceptZones, app.rejectZones, app.ruleId, app.appId,
-        app.appOriginPath, app.appPath, app.appName, app.notes, app.scheduleAction,
-        app.scheduleTime };
+    const bool hasScheduleTime = app.scheduleTime.isValid();
+
+    const quint32 flags = appFlag(app.isWildcard, AppWildcard)
+            | appFlag(app.applyParent, AppApplyParent) | appFlag(app.applyChild, AppApplyChild)
+            | appFlag(app.applySpecChild, AppApplySpecChild)
+            | appFlag(app.killChild, AppKillChild) | appFlag(app.lanOnly, AppLanOnly)
+            | appFlag(app.parked, AppParked) | appFlag(app.logAllowedConn, AppLogAllowedConn)
+            | appFlag(app.logBlockedConn, AppLogBlockedConn) | appFlag(app.blocked, AppBlocked)
+            | appFlag(app.killProcess, AppKillProcess)
+            | appFlag(hasScheduleTime, AppHasScheduleTime);
+
+    QByteArray data;
+
+    ControlCodec::writeVarUInt(data, flags);
+    ControlCodec::writeVarInt(data, app.groupIndex);
+    ControlCodec::writeVarUInt(data, app.acceptZones);
+    ControlCodec::writeVarUInt(data, app.rejectZones);
+    ControlCodec::writeVarUInt(data, app.ruleId);
+    ControlCodec::writeVarInt(data, app.appId);
+    ControlCodec::writeString(data, app.appOriginPath);
+    ControlCodec::writeString(data, app.appPath);
+    ControlCodec::writeString(data, app.appName);
+    ControlCodec::writeString(data, app.notes);
+    ControlCodec::writeVarInt(data, app.scheduleAction);
+    if (hasScheduleTime) {
+        ControlCodec::writeVarInt(data, app.scheduleTime.toMSecsSinceEpoch());
+    }
+    ControlCodec::writeVarUInt(data, app.speedLimitIn);
+    ControlCodec::writeVarUInt(data, app.speedLimitOut);
+    ControlCodec::writeVarUInt(data, app.quotaDayMb);
+    ControlCodec::writeVarUInt(data, app.quotaMonthMb);
+    ControlCodec::writeVarUInt(data, app.quotaThrottleGroup);
+
+    return data;
 }
 
-App ConfAppManagerRpc::varListToApp(const QVariantList &v)
+bool ConfAppManagerRpc::bytesToApp(const QByteArray &data, App &app)
 {
-    App app;
-    app.isWildcard = v.value(0).toBool();
-    app.applyParent = v.value(1).toBool();
-    app.applyChild = v.value(2).toBool();
-    app.applySpecChild = v.value(3).toBool();
-    app.killChild = v.value(4).toBool();
-    app.lanOnly = v.value(5).toBool();
-    app.parked = v.value(6).toBool();
-    app.logAllowedConn = v.value(7).toBool();
-    app.logBlockedConn = v.value(8).toBool();
-    app.blocked = v.value(9).toBool();
-    app.killProcess = v.value(10).toBool();
-    app.groupIndex = v.value(11).toInt();
-    app.acceptZones = v.value(12).toUInt();
-    app.rejectZones = v.value(13).toUInt();
-    app.ruleId = v.value(14).toUInt();
-    app.appId = v.value(15).toLongLong();
-    app.appOriginPath = v.value(16).toString();
-    app.appPath = v.value(17).toString();
-    app.appName = v.value(18).toString();
-    app.notes = v.value(19).toString();
-    app.scheduleAction = v.value(20).toInt();
-    app.scheduleTime = v.value(21).toDateTime();
-    return app;
+    ControlCodecReader reader(data);
+
+    quint64 flags, acceptZones, rejectZones, ruleId;
+    qint64 groupIndex, appId, scheduleAction, scheduleTime = 0;
+    quint64 speedLimitIn, speedLimitOut, quotaDayMb, quotaMonthMb, quotaThrottleGroup;
+
+    if (!(reader.readVarUInt(flags) && reader.readVarInt(groupIndex)
+                && reader.readVarUInt(acceptZones) && reader.readVarUInt(rejectZones)
+                && reader.readVarUInt(ruleId) && reader.readVarInt(appId)
+                && reader.readString(app.appOriginPath) && reader.readString(app.appPath)
+                && reader.readString(app.appName) && reader.readString(app.notes)
+                && reader.readVarInt(scheduleAction)
+                && ((flags & AppHasScheduleTime) == 0 || reader.readVarInt(scheduleTime))
+                && reader.readVarUInt(speedLimitIn) && reader.readVarUInt(speedLimitOut)
+                && reader.readVarUInt(quotaDayMb) && reader.readVarUInt(quotaMonthMb)
+                && reader.readVarUInt(quotaThrottleGroup) && reader.atEnd()))
+        return false;
+
+    app.isWildcard = (flags & AppWildcard) != 0;
+    app.applyParent = (flags & AppApplyParent) != 0;
+    app.applyChild = (flags & AppApplyChild) != 0;
+    app.applySpecChild = (flags & AppApplySpecChild) != 0;
+    app.killChild = (flags & AppKillChild) != 0;
+    app.lanOnly = (flags & AppLanOnly) != 0;
+    app.parked = (flags & AppParked) != 0;
+    app.logAllowedConn = (flags & AppLogAllowedConn) != 0;
+    app.logBlockedConn = (flags & AppLogBlockedConn) != 0;
+    app.blocked = (flags & AppBlocked) != 0;
+    app.killProcess = (flags & AppKillProcess) != 0;
+    app.groupIndex = qint8(groupIndex);
+    app.acceptZones = quint32(acceptZones);
+    app.rejectZones = quint32(rejectZones);
+    app.ruleId = quint16(ruleId);
+    app.appId = appId;
+    app.scheduleAction = qint8(scheduleAction);
+    app.scheduleTime = (flags & AppHasScheduleTime) != 0
+            ? QDateTime::fromMSecsSinceEpoch(scheduleTime)
+            : QDateTime();
+    app.speedLimitIn = quint32(speedLimitIn);
+    app.speedLimitOut = quint32(speedLimitOut);
+    app.quotaDayMb = quint32(quotaDayMb);
+    app.quotaMonthMb = quint32(quotaMonthMb);
+    app.quotaThrottleGroup = quint8(quotaThrottleGroup);
+
+    return true;
 }
 
 bool ConfAppManagerRpc::processServerCommand(
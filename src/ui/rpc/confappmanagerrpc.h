@@ -30,8 +30,8 @@ public:
 
     bool updateDriverConf(bool /*onlyFlags*/ = false) override { return false; }
 
-    static QVariantList appToVarList(const App &app);
-    static App varListToApp(const QVariantList &v);
+    static QByteArray appToBytes(const App &app);
+    static bool bytesToApp(const QByteArray &data, App &app);
 
     static bool processServerCommand(
             const ProcessCommandArgs &p, QVariantList &resArgs, bool &ok, bool &isSendResult);
@@ -1,16 +1,32 @@
 #include "confrulemanagerrpc.h"
 
 #include <conf/rule.h>
+#include <control/controlcodec.h>
 #include <rpc/rpcmanager.h>
 #include <util/ioc/ioccontainer.h>
-#include <util/variantutil.h>
 
 namespace {
 
+enum RuleFlag : quint32 {
+    RuleEnabled = (1 << 0),
+    RuleBlocked = (1 << 1),
+    RuleExclusive = (1 << 2),
+    RuleTerminate = (1 << 3),
+    RuleTerminateBlocked = (1 << 4),
+    RuleSetEdited = (1 << 5),
+};
+
+inline quint32 ruleFlag(bool on, RuleFlag flag)
+{
+    return on ? flag : 0;
+}
+
 bool processConfRuleManager_addOrUpdateRule(
         ConfRuleManager *confRuleManager, const ProcessCommandArgs &p, QVariantList &resArgs)
 {
-    Rule rule = ConfRuleManagerRpc::varListToRule(p.args);
+    Rule rule;
+    if (!ConfRuleManagerRpc::bytesToRule(p.args.value(0).toByteArray(), rule))
+        return false;
 
     const bool ok = confRuleManager->addOrUpdateRule(rule);
     resArgs = { rule.ruleId };
@@ -66,7 +82,7 @@ bool ConfRuleManagerRpc::addOrUpdateRule(Rule &rule)
     QVariantList resArgs;
 
     if (!IoC<RpcManager>()->doOnServer(
-                Control::Rpc_ConfRuleManager_addOrUpdateRule, ruleToVarList(rule), &resArgs))
+                Control::Rpc_ConfRuleManager_addOrUpdateRule, { ruleToBytes(rule) }, &resArgs))
         return false;
 
     rule.ruleId = resArgs.value(0).toInt();
@@ -91,34 +107,74 @@ bool ConfRuleManagerRpc::updateRuleEnabled(int ruleId, bool enabled)
             Control::Rpc_ConfRuleManager_updateRuleEnabled, { ruleId, enabled });
 }
 
-QVariantList ConfRuleManagerRpc::ruleToVarList(const Rule &rule)
+QByteArray ConfRuleManagerRpc::ruleToBytes(const Rule &rule)
 {
-    QVariantList ruleSetList;
-    VariantUtil::vectorToList(rule.ruleSet, ruleSetList);
+    const quint32 flags = ruleFlag(rule.enabled, RuleEnabled)
+            | ruleFlag(rule.blocked, RuleBlocked) | ruleFlag(rule.exclusive, RuleExclusive)
+            | ruleFlag(rule.terminate, RuleTerminate)
+            | ruleFlag(rule.terminateBlocked, RuleTerminateBlocked)
+            | ruleFlag(rule.ruleSetEdited, RuleSetEdited);
+
+    QByteArray data;
+
+    ControlCodec::writeVarUInt(data, flags);
+    ControlCodec::writeVarInt(data, rule.ruleType);
+    ControlCodec::writeVarInt(data, rule.ruleId);
+    ControlCodec::writeVarUInt(data, rule.acceptZones);
+    ControlCodec::writeVarUInt(data, rule.rejectZones);
+    ControlCodec::writeString(data, rule.ruleName);
+    ControlCodec::writeString(data, rule.notes);
+    ControlCodec::writeString(data, rule.ruleText);
+
+    ControlCodec::writeVarUInt(data, rule.ruleSet.size());
+    for (const quint16 ruleId : rule.ruleSet) {
+        ControlCodec::writeVarUInt(data, ruleId);
+    }
 
-    return { rule.enabled, rule.blocked, rule.exclusive, rule.terminate, rule.terminateBlocked,
-        rule.ruleSetEdited, rule.ruleType, rule.ruleId, rule.acceptZones, rule.rejectZones,
-        rule.ruleName, rule.notes, rule.ruleText, ruleSetList };
+    return data;
 }
 
-Rule ConfRuleManagerRpc::varListToRule(const QVariantList &v)
+bool ConfRuleManagerRpc::bytesToRule(const QByteArray &data, Rule &rule)
 {
-    Rule rule;
-    rule.enabled = v.value(0).toBool();
-    rule.blocked = v.value(1).toBool();
-    rule.exclusive = v.value(2).toBool();
-    rule.terminate = v.value(3).toBool();
-    rule.terminateBlocked = v.value(4).toBool();
-    rule.ruleSetEdited = v.value(5).toBool();
-    rule.ruleType = Rule::RuleType(v.value(6).toInt());
-    rule.ruleId = v.value(7).toInt();
-    rule.acceptZones = v.value(8).toUInt();
-    rule.rejectZones = v.value(9).toUInt();
-    rule.ruleName = v.value(10).toString();
-    rule.notes = v.value(11).toString();
-    rule.ruleText = v.value(12).toString();
-    VariantUtil::listToVector(v.value(13).toList(), rule.ruleSet);
-    return rule;
+    ControlCodecReader reader(data);
+
+    quint64 flags, acceptZones, rejectZones, ruleSetCount;
+    qint64 ruleType, ruleId;
+
+    if (!(reader.readVarUInt(flags) && reader.readVarInt(ruleType) && reader.readVarInt(ruleId)
+                && reader.readVarUInt(acceptZones) && reader.readVarUInt(rejectZones)
+                && reader.readString(rule.ruleName) && reader.readString(rule.notes)
+                && reader.readString(rule.ruleText) && reader.readCount(ruleSetCount)))
+        return false;
+
+    if (ruleType < 0 || ruleType >= Rule::RuleTypeCount)
+        return false;
+
+    rule.ruleSet.reserve(qsizetype(ruleSetCount));
+
+    while (ruleSetCount-- > 0) {
+        quint64 setRuleId;
+        if (!reader.readVarUInt(setRuleId))
+            return false;
+
+        rule.ruleSet.append(quint16(setRuleId));
+    }
+
+    if (!reader.atEnd())
+        return false;
+
+    rule.enabled = (flags & RuleEnabled) != 0;
+    rule.blocked = (flags & RuleBlocked) != 0;
+    rule.exclusive = (flags & RuleExclusive) != 0;
+    rule.terminate = (flags & RuleTerminate) != 0;
+    rule.terminateBlocked = (flags & RuleTerminateBlocked) != 0;
+    rule.ruleSetEdited = (flags & RuleSetEdited) != 0;
+    rule.ruleType = Rule::RuleType(ruleType);
+    rule.ruleId = int(ruleId);
+    rule.acceptZones = quint32(acceptZones);
+    rule.rejectZones = quint32(rejectZones);
+
+    return true;
 }
 
 bool ConfRuleManagerRpc::processServerCommand(
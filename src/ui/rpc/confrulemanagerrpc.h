@@ -19,8 +19,8 @@ public:
     bool updateRuleName(int ruleId, const QString &ruleName) override;
     bool updateRuleEnabled(int ruleId, bool enabled) override;
 
-    static QVariantList ruleToVarList(const Rule &rule);
-    static Rule varListToRule(const QVariantList &v);
+    static QByteArray ruleToBytes(const Rule &rule);
+    static bool bytesToRule(const QByteArray &data, Rule &rule);
 
     static bool processServerCommand(
             const ProcessCommandArgs &p, QVariantList &resArgs, bool &ok, bool &isSendResult);
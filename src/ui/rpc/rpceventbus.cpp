@@ -0,0 +1,149 @@
+#include "rpceventbus.h"
+
+#include <QLoggingCategory>
+
+#include <control/controlcodec.h>
+
+namespace {
+
+const QLoggingCategory LC("rpc.eventBus");
+
+constexpr int batchMaxEvents = 1024; // keep the batch below the control data limit
+constexpr int eventMaxArgs = 32;
+
+}
+
+RpcEventBus::RpcEventBus(QObject *parent) : QObject(parent), m_flushTimer(DefaultInterval)
+{
+    connect(&m_flushTimer, &QTimer::timeout, this, &RpcEventBus::flush);
+}
+
+void RpcEventBus::postEvent(
+        Control::Command command, const QVariantList &args, CoalesceType coalesceType)
+{
+    ++m_postedCount;
+
+    if (!coalesceEvent(command, args, coalesceType)) {
+        m_events.append({ .command = command, .args = args });
+    }
+
+    if (m_events.size() >= batchMaxEvents) {
+        flush();
+    } else {
+        m_flushTimer.startTrigger();
+    }
+}
+
+QByteArray RpcEventBus::takeBatch()
+{
+    if (m_events.isEmpty())
+        return {};
+
+    const QByteArray data = encodeEvents(m_events);
+
+    m_sentCount += m_events.size();
+    ++m_batchesCount;
+    m_batchesBytes += data.size();
+
+    m_events.clear();
+
+    return data;
+}
+
+void RpcEventBus::flush()
+{
+    m_flushTimer.stop();
+
+    const QByteArray data = takeBatch();
+    if (data.isEmpty())
+        return;
+
+    emit batchReady(data);
+}
+
+bool RpcEventBus::coalesceEvent(
+        Control::Command command, const QVariantList &args, CoalesceType coalesceType)
+{
+    switch (coalesceType) {
+    case CoalesceUnique: {
+        for (const RpcEvent &event : std::as_const(m_events)) {
+            if (event.command == command && event.args == args)
+                return true;
+        }
+    } break;
+    case CoalesceTraffic: {
+        // Only the last event may be merged to keep the events order
+        if (m_events.isEmpty())
+            break;
+
+        RpcEvent &event = m_events.last();
+        if (event.command != command || event.args.value(0) != args.value(0))
+            break;
+
+        event.args[1] = event.args[1].toUInt() + args.value(1).toUInt();
+        event.args[2] = event.args[2].toUInt() + args.value(2).toUInt();
+        return true;
+    }
+    default:
+        break;
+    }
+
+    return false;
+}
+
+QByteArray RpcEventBus::encodeEvents(const RpcEvents &events)
+{
+    QByteArray data;
+
+    ControlCodec::writeVarUInt(data, quint64(events.size()));
+
+    for (const RpcEvent &event : events) {
+        data.append(char(event.command));
+        data.append(char(event.args.size()));
+
+        for (const QVariant &arg : event.args) {
+            ControlCodec::writeArg(data, arg);
+        }
+    }
+
+    return data;
+}
+
+bool RpcEventBus::decodeEvents(const QByteArray &data, RpcEvents &events)
+{
+    ControlCodecReader reader(data);
+
+    quint64 eventsCount;
+    if (!reader.readVarUInt(eventsCount) || eventsCount > quint64(batchMaxEvents)) {
+        qCWarning(LC) << "Bad batch events count";
+        return false;
+    }
+
+    events.reserve(events.size() + int(eventsCount));
+
+    while (eventsCount-- > 0) {
+        quint8 command, argsCount;
+        if (!reader.readByte(command) || !reader.readByte(argsCount)
+                || command == Control::CommandNone || command >= Control::CommandCount
+                || argsCount > eventMaxArgs) {
+            qCWarning(LC) << "Bad batch event header";
+            return false;
+        }
+
+        RpcEvent event = { .command = Control::Command(command) };
+
+        while (argsCount-- > 0) {
+            QVariant arg;
+            if (!reader.readArg(arg)) {
+                qCWarning(LC) << "Bad batch event arg:" << event.command;
+                return false;
+            }
+
+            event.args.append(arg);
+        }
+
+        events.append(event);
+    }
+
+    return true;
+}
@@ -0,0 +1,71 @@
+#ifndef RPCEVENTBUS_H
+#define RPCEVENTBUS_H
+
+#include <QObject>
+#include <QVariant>
+#include <QVector>
+
+#include <control/control.h>
+#include <util/triggertimer.h>
+
+struct RpcEvent
+{
+    Control::Command command = Control::CommandNone;
+    QVariantList args;
+};
+
+using RpcEvents = QVector<RpcEvent>;
+
+// Gathers the server's events over a short window to send them to clients in one batch
+class RpcEventBus : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum CoalesceType : qint8 {
+        CoalesceNone = 0, // deliver every event
+        CoalesceUnique, // deliver a pending event only once
+        CoalesceTraffic, // sum the in/out bytes of pending events with the same time
+    };
+
+    constexpr static int DefaultInterval = 100; // milliseconds
+
+    explicit RpcEventBus(QObject *parent = nullptr);
+
+    const RpcEvents &events() const { return m_events; }
+
+    quint64 postedCount() const { return m_postedCount; }
+    quint64 sentCount() const { return m_sentCount; }
+    quint64 batchesCount() const { return m_batchesCount; }
+    quint64 batchesBytes() const { return m_batchesBytes; }
+
+    void postEvent(Control::Command command, const QVariantList &args = {},
+            CoalesceType coalesceType = CoalesceNone);
+
+    QByteArray takeBatch();
+
+    static QByteArray encodeEvents(const RpcEvents &events);
+    static bool decodeEvents(const QByteArray &data, RpcEvents &events);
+
+signals:
+    void batchReady(const QByteArray &batchData);
+
+public slots:
+    void flush();
+
+private:
+    bool coalesceEvent(Control::Command command, const QVariantList &args,
+            CoalesceType coalesceType);
+
+private:
+    quint64 m_postedCount = 0;
+    quint64 m_sentCount = 0;
+    quint64 m_batchesCount = 0;
+    quint64 m_batchesBytes = 0;
+
+    RpcEvents m_events;
+
+    TriggerTimer m_flushTimer;
+};
+
+#endif // RPCEVENTBUS_H
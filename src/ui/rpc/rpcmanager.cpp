@@ -66,6 +66,7 @@ RpcManager::RpcManager(QObject *parent) : QObject(parent) { }
 void RpcManager::setUp()
 {
     if (IoC<FortSettings>()->isService()) {
+        setupEventBus();
         setupServerSignals();
     } else {
         setupClient();
@@ -92,6 +93,15 @@ void RpcManager::setupServerSignals()
     TaskManagerRpc::setupServerSignals(this);
 }
 
+void RpcManager::setupEventBus()
+{
+    m_eventBus = new RpcEventBus(this);
+
+    connect(m_eventBus, &RpcEventBus::batchReady, this, [&](const QByteArray &batchData) {
+        invokeOnClients(Control::Rpc_RpcManager_eventBatch, { batchData });
+    });
+}
+
 void RpcManager::setupClient()
 {
     auto controlManager = IoCDependency<ControlManager>();
@@ -172,6 +182,11 @@ void RpcManager::invokeOnClients(Control::Command cmd, const QVariantList &args)
     if (clients.isEmpty())
         return;
 
+    // Keep the events order
+    if (cmd != Control::Rpc_RpcManager_eventBatch && m_eventBus) {
+        m_eventBus->flush();
+    }
+
     const QByteArray buffer = ControlWorker::buildCommandData(cmd, args);
     if (buffer.isEmpty()) {
         qCWarning(LC) << "Bad RPC command to invoke:" << cmd << args;
@@ -185,6 +200,20 @@ void RpcManager::invokeOnClients(Control::Command cmd, const QVariantList &args)
     }
 }
 
+void RpcManager::postOnClients(
+        Control::Command cmd, const QVariantList &args, RpcEventBus::CoalesceType coalesceType)
+{
+    if (!m_eventBus) {
+        invokeOnClients(cmd, args);
+        return;
+    }
+
+    if (IoC<ControlManager>()->clients().isEmpty())
+        return;
+
+    m_eventBus->postEvent(cmd, args, coalesceType);
+}
+
 bool RpcManager::checkClientValidated(ControlWorker *w) const
 {
     return !IoC<FortSettings>()->isPasswordRequired() || w->isClientValidated();
@@ -198,6 +227,35 @@ void RpcManager::initClientOnServer(ControlWorker *w) const
     DriverManagerRpc::processInitClient(w);
 }
 
+bool RpcManager::processEventBatch(const ProcessCommandArgs &p)
+{
+    // Only the service posts the events to its clients
+    if (p.worker != client()) {
+        p.errorMessage = "Unexpected event batch";
+        return false;
+    }
+
+    RpcEvents events;
+    if (!RpcEventBus::decodeEvents(p.args.value(0).toByteArray(), events)) {
+        p.errorMessage = "Bad event batch";
+        return false;
+    }
+
+    for (const RpcEvent &event : std::as_const(events)) {
+        const ProcessCommandArgs eventArgs = {
+            .worker = p.worker,
+            .command = event.command,
+            .args = event.args,
+            .errorMessage = p.errorMessage,
+        };
+
+        if (!processManagerRpc(eventArgs))
+            return false;
+    }
+
+    return true;
+}
+
 bool RpcManager::processCommandRpc(const ProcessCommandArgs &p)
 {
     switch (p.command) {
@@ -211,6 +269,9 @@ bool RpcManager::processCommandRpc(const ProcessCommandArgs &p)
         initClientOnServer(p.worker);
         return true;
     }
+    case Control::Rpc_RpcManager_eventBatch: {
+        return processEventBatch(p);
+    }
     default:
         return processManagerRpc(p);
     }
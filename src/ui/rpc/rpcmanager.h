@@ -7,6 +7,8 @@
 #include <control/control.h>
 #include <util/ioc/iocservice.h>
 
+#include "rpceventbus.h"
+
 struct ProcessCommandArgs;
 class ControlWorker;
 
@@ -25,6 +27,8 @@ public:
 
     ControlWorker *client() const { return m_client; }
 
+    RpcEventBus *eventBus() const { return m_eventBus; }
+
     void setUp() override;
     void tearDown() override;
 
@@ -37,6 +41,10 @@ public:
 
     void invokeOnClients(Control::Command cmd, const QVariantList &args = {});
 
+    // Batched with other frequent events, see RpcEventBus
+    void postOnClients(Control::Command cmd, const QVariantList &args = {},
+            RpcEventBus::CoalesceType coalesceType = RpcEventBus::CoalesceNone);
+
     bool processCommandRpc(const ProcessCommandArgs &p);
 
     template<typename F>
@@ -52,6 +60,7 @@ public:
 
 private:
     void setupServerSignals();
+    void setupEventBus();
 
     void setupClient();
     void closeClient();
@@ -59,6 +68,8 @@ private:
     bool checkClientValidated(ControlWorker *w) const;
     void initClientOnServer(ControlWorker *w) const;
 
+    bool processEventBatch(const ProcessCommandArgs &p);
+
     bool processManagerRpc(const ProcessCommandArgs &p);
 
 private:
@@ -66,6 +77,7 @@ private:
     QVariantList m_resultArgs;
 
     ControlWorker *m_client = nullptr;
+    RpcEventBus *m_eventBus = nullptr;
 };
 
 #endif // RPCMANAGER_H
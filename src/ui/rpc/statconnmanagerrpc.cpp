@@ -53,6 +53,8 @@ void StatConnManagerRpc::setupServerSignals(RpcManager *rpcManager)
 {
     auto statConnManager = IoC<StatConnManager>();
 
-    connect(statConnManager, &StatConnManager::connChanged, rpcManager,
-            [=] { rpcManager->invokeOnClients(Control::Rpc_StatConnManager_connChanged); });
+    connect(statConnManager, &StatConnManager::connChanged, rpcManager, [=] {
+        rpcManager->postOnClients(Control::Rpc_StatConnManager_connChanged, /*args=*/{},
+                RpcEventBus::CoalesceUnique);
+    });
 }
@@ -127,13 +127,12 @@ void StatManagerRpc::setupServerSignals(RpcManager *rpcManager)
     });
     connect(statManager, &StatManager::appCreated, rpcManager,
             [=](qint64 appId, const QString &appPath) {
-                rpcManager->invokeOnClients(
-                        Control::Rpc_StatManager_appCreated, { appId, appPath });
+                rpcManager->postOnClients(Control::Rpc_StatManager_appCreated, { appId, appPath });
             });
     connect(statManager, &StatManager::trafficAdded, rpcManager,
             [=](qint64 unixTime, quint32 inBytes, quint32 outBytes) {
-                rpcManager->invokeOnClients(
-                        Control::Rpc_StatManager_trafficAdded, { unixTime, inBytes, outBytes });
+                rpcManager->postOnClients(Control::Rpc_StatManager_trafficAdded,
+                        { unixTime, inBytes, outBytes }, RpcEventBus::CoalesceTraffic);
             });
     connect(statManager, &StatManager::appTrafTotalsResetted, rpcManager,
             [=] { rpcManager->invokeOnClients(Control::Rpc_StatManager_appTrafTotalsResetted); });
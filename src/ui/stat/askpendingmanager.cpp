@@ -2,53 +2,190 @@
 
 #include <QLoggingCategory>
 
-#include <sqlite/sqlitedb.h>
-#include <sqlite/sqlitestmt.h>
+#include <common/fortconf.h>
 
+#include <conf/confmanager.h>
+#include <conf/inioptions.h>
+#include <driver/drivermanager.h>
+#include <log/logentryconn.h>
+#include <util/conf/confbuffer.h>
+#include <util/dateutil.h>
+#include <util/fileutil.h>
 #include <util/ioc/ioccontainer.h>
 
-#include "logconnjob.h"
-#include "statsql.h"
-
 namespace {
 
 const QLoggingCategory LC("pendingManager");
 
 }
 
-AskPendingManager::AskPendingManager(QObject *parent) :
-    QObject(parent), m_sqliteDb(new SqliteDb(":memory:"))
+AskPendingManager::AskPendingManager(QObject *parent) : QObject(parent)
+{
+    m_expireTimer.setSingleShot(true);
+
+    connect(&m_flushTimer, &QTimer::timeout, this, &AskPendingManager::flushDecisions);
+    connect(&m_expireTimer, &QTimer::timeout, this, &AskPendingManager::pruneExpiredApps);
+}
+
+void AskPendingManager::setLimits(const PendingLimits &limits)
 {
+    m_limits = limits;
+    m_limitsChanged = true;
+
+    m_flushTimer.startTrigger();
 }
 
 void AskPendingManager::setUp()
 {
-    setupDb();
+    setupConfManager();
+    setupDriverManager();
 }
 
-bool AskPendingManager::setupDb()
+void AskPendingManager::setupConfManager()
 {
-    if (!sqliteDb()->open()) {
-        qCCritical(LC) << "File open error:" << sqliteDb()->filePath()
-                       << sqliteDb()->errorMessage();
-        return false;
-    }
+    auto confManager = IoCDependency<ConfManager>();
+
+    connect(confManager, &ConfManager::iniChanged, this, &AskPendingManager::setupByConf);
+}
+
+void AskPendingManager::setupDriverManager()
+{
+    auto driverManager = IoCDependency<DriverManager>();
+
+    connect(driverManager, &DriverManager::isDeviceOpenedChanged, this,
+            &AskPendingManager::onDeviceOpenedChanged);
+}
 
-    SqliteDb::MigrateOptions opt = {
-        .sqlDir = ":/stat/migrations/block",
-        .recreate = true,
+void AskPendingManager::setupByConf(const IniOptions &ini)
+{
+    const PendingLimits limits = {
+        .appsMax = quint16(ini.askPendingAppsMax()),
+        .appPacketsMax = quint16(ini.askPendingAppPacketsMax()),
+        .expireSecs = quint16(ini.askPendingExpireSecs()),
     };
 
-    if (!sqliteDb()->migrate(opt)) {
-        qCCritical(LC) << "Migration error" << sqliteDb()->filePath();
-        return false;
-    }
+    setLimits(limits);
+}
 
-    return true;
+void AskPendingManager::onDeviceOpenedChanged()
+{
+    // The driver's pending apps are completed on close
+    m_pendingApps.clear();
+    m_decisions.clear();
+
+    m_expireTimer.stop();
+
+    emit pendingAppsChanged();
+
+    // The reopened driver has the default limits
+    if (IoC<DriverManager>()->isDeviceOpened()) {
+        setLimits(m_limits);
+    }
 }
 
 void AskPendingManager::logConn(const LogEntryConn &entry)
 {
-    // TODO
-    Q_UNUSED(entry);
+    // The driver aggregates the pending connections by app
+    PendingApp &app = m_pendingApps[entry.kernelPath()];
+
+    // The expired app is asked again
+    if (app.expireTime <= entry.connTime()) {
+        app.connCount = 0;
+        app.expireTime = entry.connTime() + expireSecs();
+        app.appPath = FileUtil::normalizePath(FileUtil::realPath(entry.path()));
+    }
+
+    app.pid = entry.pid();
+    app.connTime = entry.connTime();
+    ++app.connCount;
+
+    if (!m_expireTimer.isActive()) {
+        m_expireTimer.start(expireSecs() * 1000);
+    }
+
+    emit pendingAppsChanged();
+}
+
+void AskPendingManager::decideApp(const QString &kernelPath, bool allow)
+{
+    if (!m_pendingApps.remove(kernelPath))
+        return; // already expired or decided
+
+    m_decisions.insert(kernelPath, allow);
+
+    m_flushTimer.startTrigger();
+
+    emit pendingAppsChanged();
+}
+
+void AskPendingManager::decideAppPath(const QString &appPath, bool allow)
+{
+    QStringList kernelPaths;
+
+    for (auto it = m_pendingApps.constBegin(); it != m_pendingApps.constEnd(); ++it) {
+        if (it->appPath == appPath) {
+            kernelPaths.append(it.key());
+        }
+    }
+
+    for (const QString &kernelPath : kernelPaths) {
+        decideApp(kernelPath, allow);
+    }
+}
+
+void AskPendingManager::flushDecisions()
+{
+    if (m_decisions.isEmpty() && !m_limitsChanged)
+        return;
+
+    ConfBuffer confBuf;
+
+    confBuf.writePendingDecisions(m_decisions, m_limits);
+
+    // Answer all the batched apps by one request
+    if (!IoC<DriverManager>()->writePending(confBuf.buffer())) {
+        qCWarning(LC) << "Pending decisions error:" << IoC<DriverManager>()->errorMessage();
+    }
+
+    m_decisions.clear();
+    m_limitsChanged = false;
+}
+
+void AskPendingManager::pruneExpiredApps()
+{
+    const qint64 unixTime = DateUtil::getUnixTime();
+
+    qint64 nextExpireTime = 0;
+    bool changed = false;
+
+    // The driver has denied the unanswered apps
+    for (auto it = m_pendingApps.begin(); it != m_pendingApps.end();) {
+        const qint64 expireTime = it->expireTime;
+
+        if (expireTime <= unixTime) {
+            it = m_pendingApps.erase(it);
+            changed = true;
+            continue;
+        }
+
+        if (nextExpireTime == 0 || expireTime < nextExpireTime) {
+            nextExpireTime = expireTime;
+        }
+        ++it;
+    }
+
+    if (nextExpireTime != 0) {
+        m_expireTimer.start(int(nextExpireTime - unixTime) * 1000);
+    }
+
+    if (changed) {
+        emit pendingAppsChanged();
+    }
+}
+
+int AskPendingManager::expireSecs() const
+{
+    return (m_limits.expireSecs != 0)
+            ? qMin(int(m_limits.expireSecs), FORT_PENDING_EXPIRE_SECS_MAX)
+            : FORT_PENDING_EXPIRE_SECS;
 }
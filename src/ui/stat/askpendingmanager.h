@@ -1,15 +1,28 @@
 #ifndef ASKPENDINGMANAGER_H
 #define ASKPENDINGMANAGER_H
 
+#include <QHash>
 #include <QObject>
-
-#include <sqlite/sqlite_types.h>
+#include <QTimer>
 
 #include <util/classhelpers.h>
+#include <util/conf/conf_types.h>
 #include <util/ioc/iocservice.h>
+#include <util/triggertimer.h>
 
+class IniOptions;
 class LogEntryConn;
 
+struct PendingApp
+{
+    quint32 pid = 0;
+    int connCount = 0;
+    qint64 connTime = 0;
+    qint64 expireTime = 0;
+
+    QString appPath; // normalized, as of the conf's app
+};
+
 class AskPendingManager : public QObject, public IocService
 {
     Q_OBJECT
@@ -18,17 +31,49 @@ public:
     explicit AskPendingManager(QObject *parent = nullptr);
     CLASS_DELETE_COPY_MOVE(AskPendingManager)
 
-    SqliteDb *sqliteDb() const { return m_sqliteDb.data(); }
+    // Pending apps by kernel path
+    const QHash<QString, PendingApp> &pendingApps() const { return m_pendingApps; }
+
+    const PendingLimits &limits() const { return m_limits; }
+    void setLimits(const PendingLimits &limits);
 
     void setUp() override;
 
     void logConn(const LogEntryConn &entry);
 
+    // The app must be added to the conf before, to match its re-authorized connections
+    void decideApp(const QString &kernelPath, bool allow);
+    void decideAppPath(const QString &appPath, bool allow);
+
+signals:
+    void pendingAppsChanged();
+
+public slots:
+    void flushDecisions();
+
+protected:
+    virtual void setupConfManager();
+    virtual void setupDriverManager();
+
 private:
-    bool setupDb();
+    void setupByConf(const IniOptions &ini);
+
+    void onDeviceOpenedChanged();
+
+    void pruneExpiredApps();
+
+    int expireSecs() const;
 
 private:
-    SqliteDbPtr m_sqliteDb;
+    bool m_limitsChanged = false;
+
+    PendingLimits m_limits;
+
+    QHash<QString, PendingApp> m_pendingApps;
+    QHash<QString, bool> m_decisions; // batched till the next flush
+
+    TriggerTimer m_flushTimer;
+    QTimer m_expireTimer;
 };
 
 #endif // ASKPENDINGMANAGER_H
@@ -15,6 +15,8 @@ public:
     StatConnManager *manager() const { return m_manager; }
     SqliteDb *sqliteDb() const;
 
+    JobPriority priority() const override { return PriorityLow; }
+
     bool mergeJob(const WorkerJob &job) override;
 
     void doJob(WorkerObject &worker) override;
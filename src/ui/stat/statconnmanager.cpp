@@ -132,6 +132,7 @@ WorkerObject *StatConnManager::createWorker()
 void StatConnManager::setupWorker()
 {
     setMaxWorkersCount(1);
+    setPoolPriority(-1); // bulk writes
 
     connect(this, &StatConnManager::logConnFinished, this, &StatConnManager::onLogConnFinished);
     connect(this, &StatConnManager::deleteConnFinished, this,
@@ -579,6 +579,27 @@ void StatManager::getTraffic(
     stmt->reset();
 }
 
+void StatManager::getAppQuotaTraffic(const QString &appPath, qint64 &dayBytes, qint64 &monthBytes)
+{
+    dayBytes = monthBytes = 0;
+
+    const qint64 appId = getAppId(appPath);
+    if (appId == INVALID_APP_ID)
+        return;
+
+    const qint64 unixTime = DateUtil::getUnixTime();
+    const qint32 trafDay = DateUtil::getUnixDay(unixTime);
+    const qint32 trafMonth = DateUtil::getUnixMonth(unixTime, ini()->monthStart());
+
+    qint64 inBytes, outBytes;
+
+    getTraffic(StatSql::sqlSelectTrafAppDay, trafDay, inBytes, outBytes, appId);
+    dayBytes = inBytes + outBytes;
+
+    getTraffic(StatSql::sqlSelectTrafAppMonth, trafMonth, inBytes, outBytes, appId);
+    monthBytes = inBytes + outBytes;
+}
+
 SqliteStmt *StatManager::getStmt(const char *sql)
 {
     return sqliteDb()->stmt(sql);
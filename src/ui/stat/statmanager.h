@@ -49,6 +49,9 @@ public:
     void getTraffic(
             const char *sql, qint32 trafTime, qint64 &inBytes, qint64 &outBytes, qint64 appId = 0);
 
+    // Current day's and month's in+out bytes of the app to seed the driver's quota counters
+    void getAppQuotaTraffic(const QString &appPath, qint64 &dayBytes, qint64 &monthBytes);
+
 signals:
     void trafficCleared();
 
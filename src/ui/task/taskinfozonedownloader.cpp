@@ -1,6 +1,7 @@
 #include "taskinfozonedownloader.h"
 
 #include <QDir>
+#include <QFile>
 #include <QLoggingCategory>
 
 #include <conf/confzonemanager.h>
@@ -19,11 +20,15 @@ namespace {
 
 const QLoggingCategory LC("task.zoneDownloader");
 
+constexpr qint64 zoneCheckBlockSize = 1024 * 1024;
+
 }
 
 TaskInfoZoneDownloader::TaskInfoZoneDownloader(TaskManager &taskManager) :
     TaskInfo(ZoneDownloader, taskManager)
 {
+    // Check a block of the cached zones data per event loop iteration
+    connect(&m_checkTimer, &QTimer::timeout, this, &TaskInfoZoneDownloader::checkZoneBlock);
 }
 
 TaskZoneDownloader *TaskInfoZoneDownloader::zoneDownloader() const
@@ -39,6 +44,9 @@ ZoneListModel *TaskInfoZoneDownloader::zoneListModel() const
 void TaskInfoZoneDownloader::initialize()
 {
     loadZones();
+
+    // The loaded zones are sent to the driver on startup, before the timer's first shot
+    startZoneChecks();
 }
 
 bool TaskInfoZoneDownloader::processResult(bool success)
@@ -74,6 +82,7 @@ void TaskInfoZoneDownloader::setupTaskWorker()
     m_zoneNames.clear();
 
     clearSubResults();
+    clearZoneChecks();
 
     setupNextTaskWorker();
 }
@@ -103,8 +112,11 @@ void TaskInfoZoneDownloader::setupTaskWorkerByZone(TaskZoneDownloader *worker)
     const ZoneSourceWrapper zoneSource(zoneListModel()->zoneSourceByCode(zoneRow.sourceCode));
     const ZoneTypeWrapper zoneType(zoneListModel()->zoneTypeByCode(zoneSource.zoneType()));
 
+    const bool isCorrupt = containsZoneId(m_corruptZonesMask, zoneRow.zoneId);
+
     worker->setZoneEnabled(zoneRow.enabled);
     worker->setSort(zoneType.sort());
+    worker->setVerifyCache(isCorrupt);
     worker->setEmptyNetMask(zoneType.emptyNetMask());
     worker->setZoneId(zoneRow.zoneId);
     worker->setZoneName(zoneRow.zoneName);
@@ -112,6 +124,7 @@ void TaskInfoZoneDownloader::setupTaskWorkerByZone(TaskZoneDownloader *worker)
     worker->setFormData(zoneRow.customUrl ? zoneRow.formData : zoneSource.formData());
     worker->setTextInline(zoneRow.textInline);
     worker->setPattern(zoneType.pattern());
+    worker->setIp4FastPath(zoneType.ip4FastPath());
     worker->setAddressCount(zoneRow.addressCount);
     worker->setTextChecksum(zoneRow.textChecksum);
     worker->setBinChecksum(zoneRow.binChecksum);
@@ -119,6 +132,12 @@ void TaskInfoZoneDownloader::setupTaskWorkerByZone(TaskZoneDownloader *worker)
     worker->setSourceModTime(zoneRow.sourceModTime);
     worker->setLastSuccess(zoneRow.lastSuccess);
 
+    // Re-store the corrupt cache file
+    if (isCorrupt) {
+        worker->setTextChecksum({});
+        worker->setSourceModTime({});
+    }
+
     insertZoneId(m_zonesMask, zoneRow.zoneId);
 }
 
@@ -160,6 +179,8 @@ void TaskInfoZoneDownloader::processSubResult(bool success)
     IoC<ConfZoneManager>()->updateZoneResult(zone);
 
     addSubResult(worker, success);
+
+    m_corruptZonesMask &= ~(quint32(1) << (zone.zoneId - 1));
 }
 
 void TaskInfoZoneDownloader::clearSubResults()
@@ -168,6 +189,7 @@ void TaskInfoZoneDownloader::clearSubResults()
     m_enabledMask = 0;
     m_dataSize = 0;
     m_zonesData.clear();
+    m_zoneFiles.clear();
 }
 
 void TaskInfoZoneDownloader::addSubResult(TaskZoneDownloader *worker, bool success)
@@ -187,6 +209,17 @@ void TaskInfoZoneDownloader::addSubResult(TaskZoneDownloader *worker, bool succe
     m_dataSize += size;
     m_zonesData.append(zoneData);
 
+    if (const auto &zoneFile = worker->zoneFile()) {
+        m_zoneFiles.append(zoneFile);
+
+        if (!worker->verifyCache()) {
+            m_zoneChecks.append({ .zoneId = worker->zoneId(),
+                    .binChecksum = worker->binChecksum(),
+                    .zoneData = zoneData,
+                    .zoneFile = zoneFile });
+        }
+    }
+
     insertZoneId(m_dataZonesMask, worker->zoneId());
 
     if (worker->zoneEnabled()) {
@@ -201,6 +234,61 @@ void TaskInfoZoneDownloader::emitZonesUpdated()
     removeOrphanCacheFiles();
 
     clearSubResults();
+
+    startZoneChecks();
+}
+
+void TaskInfoZoneDownloader::startZoneChecks()
+{
+    if (!m_zoneChecks.isEmpty()) {
+        m_checkTimer.start();
+    }
+}
+
+void TaskInfoZoneDownloader::clearZoneChecks()
+{
+    m_checkTimer.stop();
+    m_checkHash.reset();
+    m_checkOffset = 0;
+    m_zoneChecks.clear();
+}
+
+void TaskInfoZoneDownloader::checkZoneBlock()
+{
+    if (m_zoneChecks.isEmpty()) {
+        m_checkTimer.stop();
+        return;
+    }
+
+    const ZoneCacheCheck &check = m_zoneChecks.first();
+    const QByteArray &data = check.zoneData;
+
+    const qint64 blockSize = qMin(zoneCheckBlockSize, data.size() - m_checkOffset);
+
+    m_checkHash.addData(QByteArrayView(data.constData() + m_checkOffset, blockSize));
+    m_checkOffset += blockSize;
+
+    if (m_checkOffset < data.size())
+        return;
+
+    if (check.binChecksum != QString::fromLatin1(m_checkHash.result().toHex())) {
+        qCWarning(LC) << "Corrupt cache file of zone:" << check.zoneId;
+
+        insertZoneId(m_corruptZonesMask, check.zoneId);
+    }
+
+    m_checkHash.reset();
+    m_checkOffset = 0;
+    m_zoneChecks.removeFirst();
+
+    if (m_zoneChecks.isEmpty()) {
+        m_checkTimer.stop();
+
+        // Re-store the corrupt zones and send them again
+        if (m_corruptZonesMask != 0) {
+            run();
+        }
+    }
 }
 
 void TaskInfoZoneDownloader::insertZoneId(quint32 &zonesMask, int zoneId)
@@ -2,12 +2,28 @@
 #define TASKINFOZONEDOWNLOADER_H
 
 #include <QByteArray>
+#include <QCryptographicHash>
+#include <QSharedPointer>
+#include <QTimer>
 
 #include "taskinfo.h"
 
+QT_FORWARD_DECLARE_CLASS(QFile)
+
 class TaskZoneDownloader;
 class ZoneListModel;
 
+// Zone data, loaded from the cache file, to be checked after sending to the driver
+struct ZoneCacheCheck
+{
+    int zoneId = 0;
+
+    QString binChecksum;
+
+    QByteArray zoneData;
+    QSharedPointer<QFile> zoneFile;
+};
+
 class TaskInfoZoneDownloader : public TaskInfo
 {
     Q_OBJECT
@@ -52,6 +68,10 @@ private:
 
     void emitZonesUpdated();
 
+    void startZoneChecks();
+    void clearZoneChecks();
+    void checkZoneBlock();
+
     void removeOrphanCacheFiles();
 
     QString cachePath() const;
@@ -65,8 +85,16 @@ private:
     quint32 m_enabledMask = 0;
     quint32 m_dataSize = 0;
 
+    quint32 m_corruptZonesMask = 0; // to be re-stored by the next run
+
+    qint64 m_checkOffset = 0;
+    QCryptographicHash m_checkHash { QCryptographicHash::Sha256 };
+    QList<ZoneCacheCheck> m_zoneChecks;
+    QTimer m_checkTimer;
+
     QStringList m_zoneNames;
     QList<QByteArray> m_zonesData;
+    QList<QSharedPointer<QFile>> m_zoneFiles; // mapped files of the zones data
 };
 
 #endif // TASKINFOZONEDOWNLOADER_H
@@ -1,6 +1,7 @@
 #include "taskzonedownloader.h"
 
 #include <QCryptographicHash>
+#include <QFile>
 #include <QLoggingCategory>
 #include <QUrl>
 
@@ -11,7 +12,86 @@
 #include <util/stringutil.h>
 
 namespace {
+
 const QLoggingCategory LC("task.zoneDownloader");
+
+constexpr int hashChunkSize = 64 * 1024;
+
+// Check the "1.2.3.4" or "1.2.3.0/24" line, trailing whitespaces are trimmed
+bool isPlainIp4Line(QStringView &line)
+{
+    line = line.trimmed();
+
+    int dotCount = 0;
+    bool hasMask = false;
+    bool isPartEmpty = true;
+
+    for (const QChar c : line) {
+        if (c.isDigit()) {
+            isPartEmpty = false;
+            continue;
+        }
+
+        if (isPartEmpty || hasMask)
+            return false;
+
+        if (c == '.' && dotCount < 3) {
+            ++dotCount;
+        } else if (c == '/' && dotCount == 3) {
+            hasMask = true;
+        } else {
+            return false;
+        }
+
+        isPartEmpty = true;
+    }
+
+    return dotCount == 3 && !isPartEmpty;
+}
+
+void addLatin1Data(QByteArray &buf, const QStringView text)
+{
+    for (const QChar c : text) {
+        buf.append(c.toLatin1());
+    }
+}
+
+constexpr qint64 zoneCacheHashBlockSize = 1024 * 1024;
+
+QString zoneDataChecksum(const char *data, qint64 size)
+{
+    QCryptographicHash cryptoHash(QCryptographicHash::Sha256);
+
+    // Hash by blocks to not touch the whole mapped file at once
+    for (qint64 off = 0; off < size; off += zoneCacheHashBlockSize) {
+        const qint64 blockSize = qMin(zoneCacheHashBlockSize, size - off);
+
+        cryptoHash.addData(QByteArrayView(data + off, blockSize));
+    }
+
+    return QString::fromLatin1(cryptoHash.result().toHex());
+}
+
+bool writeZoneCache(const QString &filePath, const QByteArray &zoneData)
+{
+    FileUtil::makePathForFile(filePath);
+
+    QFile file(filePath);
+    if (!file.open(QFile::WriteOnly | QFile::Truncate))
+        return false;
+
+    QByteArray headerData(TaskZoneDownloader::CacheDataOffset, '\0');
+
+    auto header = reinterpret_cast<TaskZoneDownloader::CacheHeader *>(headerData.data());
+    header->magic = TaskZoneDownloader::CacheMagic;
+    header->version = TaskZoneDownloader::CacheVersion;
+    header->dataOffset = TaskZoneDownloader::CacheDataOffset;
+    header->dataSize = quint32(zoneData.size());
+
+    return file.write(headerData) == headerData.size() && file.write(zoneData) == zoneData.size()
+            && file.flush();
+}
+
 }
 
 TaskZoneDownloader::TaskZoneDownloader(QObject *parent) : TaskDownloader(parent) { }
@@ -85,6 +165,9 @@ StringViewList TaskZoneDownloader::parseAddresses(const QString &text, QString &
     StringViewList list;
     QCryptographicHash cryptoHash(QCryptographicHash::Sha256);
 
+    QByteArray hashBuf;
+    hashBuf.reserve(hashChunkSize + 64);
+
     // Parse lines
     const QRegularExpression re(pattern());
 
@@ -94,17 +177,31 @@ StringViewList TaskZoneDownloader::parseAddresses(const QString &text, QString &
         if (line.startsWith('#') || line.startsWith(';')) // commented line
             continue;
 
-        const auto match = StringUtil::match(re, line);
-        if (!match.hasMatch())
-            continue;
+        QStringView ip = line;
+
+        // Skip the pattern matching for plain IPv4 lines
+        if (!(ip4FastPath() && line.front().isDigit() && isPlainIp4Line(ip))) {
+            const auto match = StringUtil::match(re, line);
+            if (!match.hasMatch())
+                continue;
+
+            ip = line.mid(match.capturedStart(1), match.capturedLength(1));
+        }
 
-        const auto ip = line.mid(match.capturedStart(1), match.capturedLength(1));
         list.append(ip);
 
-        cryptoHash.addData(ip.toLatin1());
-        cryptoHash.addData("\n");
+        // Hash the addresses by chunks
+        addLatin1Data(hashBuf, ip);
+        hashBuf.append('\n');
+
+        if (hashBuf.size() >= hashChunkSize) {
+            cryptoHash.addData(hashBuf);
+            hashBuf.resize(0);
+        }
     }
 
+    cryptoHash.addData(hashBuf);
+
     checksum = QString::fromLatin1(cryptoHash.result().toHex());
 
     return list;
@@ -120,6 +217,8 @@ bool TaskZoneDownloader::storeAddresses(const StringViewList &list)
         return false;
     }
 
+    m_zoneFile.reset();
+
     FileUtil::removeFile(cacheFileBinPath());
 
     // Store binary file
@@ -131,19 +230,53 @@ bool TaskZoneDownloader::storeAddresses(const StringViewList &list)
     if (m_zoneData.isEmpty())
         return false;
 
-    const auto binData = qCompress(m_zoneData);
-
-    const auto binChecksumData = QCryptographicHash::hash(binData, QCryptographicHash::Sha256);
-    setBinChecksum(QString::fromLatin1(binChecksumData.toHex()));
+    setBinChecksum(zoneDataChecksum(m_zoneData.constData(), m_zoneData.size()));
 
-    return FileUtil::writeFileData(cacheFileBinPath(), binData);
+    return writeZoneCache(cacheFileBinPath(), m_zoneData);
 }
 
 bool TaskZoneDownloader::loadAddresses()
 {
+    m_zoneData.clear();
+    m_zoneFile.reset();
+
     if (!FileUtil::fileExists(cacheFileBinPath()))
         return false;
 
+    QSharedPointer<QFile> file(new QFile(cacheFileBinPath()));
+    if (!file->open(QFile::ReadOnly))
+        return false;
+
+    const qint64 fileSize = file->size();
+
+    const uchar *fileData = (fileSize >= CacheDataOffset) ? file->map(0, fileSize) : nullptr;
+    const auto header = reinterpret_cast<const CacheHeader *>(fileData);
+
+    if (!header || header->magic != CacheMagic) {
+        file.reset();
+        return loadCompressedAddresses();
+    }
+
+    const char *data = reinterpret_cast<const char *>(fileData) + header->dataOffset;
+    const qint64 dataSize = header->dataSize;
+
+    if (header->version != CacheVersion || header->dataOffset < sizeof(CacheHeader)
+            || header->dataOffset + dataSize > fileSize
+            || (verifyCache() && binChecksum() != zoneDataChecksum(data, dataSize))) {
+        file.reset();
+        FileUtil::removeFile(cacheFileBinPath());
+        return false;
+    }
+
+    m_zoneData = QByteArray::fromRawData(data, dataSize);
+    m_zoneFile = file;
+
+    return true;
+}
+
+bool TaskZoneDownloader::loadCompressedAddresses()
+{
+    // Cache file of the previous versions
     const auto binData = FileUtil::readFileData(cacheFileBinPath());
 
     const auto binChecksumData = QCryptographicHash::hash(binData, QCryptographicHash::Sha256);
@@ -2,16 +2,32 @@
 #define TASKZONEDOWNLOADER_H
 
 #include <QDateTime>
+#include <QSharedPointer>
 
 #include <util/util_types.h>
 
 #include "taskdownloader.h"
 
+QT_FORWARD_DECLARE_CLASS(QFile)
+
 class TaskZoneDownloader : public TaskDownloader
 {
     Q_OBJECT
 
 public:
+    constexpr static quint32 CacheMagic = 0x435A5446; // "FTZC"
+    constexpr static quint32 CacheVersion = 1;
+    constexpr static quint32 CacheDataOffset = 4096; // page aligned
+
+    // Header of the cache file, the zone data follows at the data offset
+    struct CacheHeader
+    {
+        quint32 magic;
+        quint32 version;
+        quint32 dataOffset;
+        quint32 dataSize;
+    };
+
     explicit TaskZoneDownloader(QObject *parent = nullptr);
 
     bool zoneEnabled() const { return m_zoneEnabled; }
@@ -20,6 +36,14 @@ public:
     bool sort() const { return m_sort; }
     void setSort(bool v) { m_sort = v; }
 
+    // Hash the whole cached data on load, else it's checked after sending to the driver
+    bool verifyCache() const { return m_verifyCache; }
+    void setVerifyCache(bool v) { m_verifyCache = v; }
+
+    // Plain IPv4 address/network lines are matched by the pattern as a whole
+    bool ip4FastPath() const { return m_ip4FastPath; }
+    void setIp4FastPath(bool v) { m_ip4FastPath = v; }
+
     int emptyNetMask() const { return m_emptyNetMask; }
     void setEmptyNetMask(int v) { m_emptyNetMask = v; }
 
@@ -61,6 +85,9 @@ public:
 
     const QByteArray &zoneData() const { return m_zoneData; }
 
+    // The memory mapped cache file, which holds the loaded zone data
+    const QSharedPointer<QFile> &zoneFile() const { return m_zoneFile; }
+
     StringViewList parseAddresses(const QString &text, QString &textChecksum) const;
 
     bool storeAddresses(const StringViewList &list);
@@ -81,9 +108,13 @@ private:
     void loadTextInline();
     void loadLocalFile();
 
+    bool loadCompressedAddresses();
+
 private:
     bool m_zoneEnabled : 1 = false;
     bool m_sort : 1 = false;
+    bool m_verifyCache : 1 = false;
+    bool m_ip4FastPath : 1 = false;
 
     int m_emptyNetMask = 32;
 
@@ -109,6 +140,7 @@ private:
     QDateTime m_lastSuccess;
 
     QByteArray m_zoneData;
+    QSharedPointer<QFile> m_zoneFile;
 };
 
 #endif // TASKZONEDOWNLOADER_H
@@ -18,6 +18,12 @@ public:
     bool includeIsEmpty() const { return includeRange().isEmpty(); }
     bool excludeIsEmpty() const { return excludeRange().isEmpty(); }
 
+    // The lists can be precomputed only when the dynamic zones are not used
+    bool isCompilable() const
+    {
+        return !m_includeAll && !m_excludeAll && m_includeZones == 0 && m_excludeZones == 0;
+    }
+
     quint32 includeZones() const { return m_includeZones; }
     void setIncludeZones(quint32 v) { m_includeZones = v; }
 
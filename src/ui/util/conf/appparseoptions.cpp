@@ -9,3 +9,27 @@ quint32 &AppParseOptions::appsSize(bool isWild, bool isPrefix)
 {
     return isWild ? wildAppsSize : (isPrefix ? prefixAppsSize : exeAppsSize);
 }
+
+quint16 AppParseOptions::appLimitId(quint32 speedLimitIn, quint32 speedLimitOut)
+{
+    if (speedLimitIn == 0 && speedLimitOut == 0)
+        return 0;
+
+    const quint64 appLimit = (quint64(speedLimitIn) << 32) | speedLimitOut;
+
+    // Share the limits between apps with equal speeds
+    quint16 &limitId = appLimitsMap[appLimit];
+    if (limitId == 0) {
+        appLimits.append(appLimit);
+        limitId = quint16(appLimits.size());
+    }
+
+    return limitId;
+}
+
+quint16 AppParseOptions::addQuota(const FORT_TRAF_QUOTA &quota)
+{
+    quotas.append(quota);
+
+    return quint16(quotas.size());
+}
@@ -1,16 +1,45 @@
 #ifndef APPPARSEOPTIONS_H
 #define APPPARSEOPTIONS_H
 
+#include <QHash>
 #include <QMap>
 #include <QObject>
 #include <QVarLengthArray>
+#include <QVector>
 
 #include <common/fortconf.h>
 
+#include <conf/app.h>
+
 #include "addressrange.h"
 
 using addrranges_arr_t = QVarLengthArray<AddressRange, 2>;
 using appdata_map_t = QMap<QString, FORT_APP_DATA>;
+using applimits_arr_t = QVector<quint64>;
+using applimits_map_t = QHash<quint64, quint16>;
+using quotas_arr_t = QVector<FORT_TRAF_QUOTA>;
+
+struct AppParsedPath
+{
+    bool isWild = false;
+    bool isPrefix = false;
+
+    QString appPath;
+    QString kernelPath;
+};
+
+// App's paths to be parsed in parallel and merged in order
+struct AppParseJob
+{
+    bool isText = false; // parse the expanded text of paths, else the app's path
+
+    App app;
+    QString text;
+
+    QVector<AppParsedPath> paths;
+};
+
+using appparsejobs_arr_t = QVector<AppParseJob>;
 
 class AppParseOptions
 {
@@ -18,6 +47,10 @@ public:
     appdata_map_t &appsMap(bool isWild, bool isPrefix);
     quint32 &appsSize(bool isWild, bool isPrefix);
 
+    quint16 appLimitId(quint32 speedLimitIn, quint32 speedLimitOut);
+
+    quint16 addQuota(const FORT_TRAF_QUOTA &quota);
+
 public:
     bool procWild = false;
 
@@ -28,6 +61,14 @@ public:
     appdata_map_t wildAppsMap;
     appdata_map_t prefixAppsMap;
     appdata_map_t exeAppsMap;
+
+    applimits_arr_t appLimits; // packed in/out speed limits (Kbit/s)
+    applimits_map_t appLimitsMap; // packed in/out speed limits -> 1-based limit id
+
+    quotas_arr_t quotas; // apps' and app groups' traffic quotas
+    quint16 groupQuotaIds[FORT_CONF_GROUP_MAX] = {}; // app group index -> 1-based quota id
+
+    appparsejobs_arr_t appJobs;
 };
 
 #endif // APPPARSEOPTIONS_H
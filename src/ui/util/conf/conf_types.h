@@ -6,3 +6,11 @@ using longs_arr_t = QVector<quint32>;
 using shorts_arr_t = QVector<quint16>;
 using bytes_arr_t = QVector<quint8>;
 using chars_arr_t = QVector<qint8>;
+
+// Limits of the driver's pending connections, 0 - keep the current value
+struct PendingLimits
+{
+    quint16 appsMax = 0;
+    quint16 appPacketsMax = 0;
+    quint16 expireSecs = 0;
+};
@@ -13,6 +13,12 @@ class ConfAppsWalker
 {
 public:
     virtual bool walkApps(const std::function<walkAppsCallback> &func) const = 0;
+
+    // Already logged traffic of the app to seed its quota counters
+    virtual void appQuotaTraffic(const App & /*app*/, quint64 &dayBytes, quint64 &monthBytes) const
+    {
+        dayBytes = monthBytes = 0;
+    }
 };
 
 #endif // CONFAPPSWALKER_H
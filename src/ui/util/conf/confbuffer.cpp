@@ -2,6 +2,8 @@
 
 #include <QHash>
 #include <QMap>
+#include <QSemaphore>
+#include <QThreadPool>
 
 #include <fort_version.h>
 
@@ -28,6 +30,46 @@
 
 namespace {
 
+// Distinguishes groups' quota keys from apps' ones
+constexpr quint32 groupQuotaKeyFlag = 0x80000000;
+
+constexpr quint64 quotaMbToBytes(quint32 mb)
+{
+    return quint64(mb) * 1024 * 1024;
+}
+
+quint16 addAppQuota(const ConfAppsWalker *confAppsWalker, const App &app, AppParseOptions &opt)
+{
+    if (!app.hasQuota())
+        return 0;
+
+    FORT_TRAF_QUOTA quota = {
+        .key = quint32(app.appId),
+        .throttle_group = app.quotaThrottleGroup,
+        .day_bytes = quotaMbToBytes(app.quotaDayMb),
+        .month_bytes = quotaMbToBytes(app.quotaMonthMb),
+    };
+
+    // The driver keeps the used bytes on conf updates, seed them after its reload
+    confAppsWalker->appQuotaTraffic(app, quota.day_used, quota.month_used);
+
+    return opt.addQuota(quota);
+}
+
+quint16 addAppGroupQuota(const AppGroup *appGroup, AppParseOptions &opt)
+{
+    if (!appGroup->hasQuota())
+        return 0;
+
+    const FORT_TRAF_QUOTA quota = {
+        .key = groupQuotaKeyFlag | quint32(appGroup->id()),
+        .day_bytes = quotaMbToBytes(appGroup->quotaDayMb()),
+        .month_bytes = quotaMbToBytes(appGroup->quotaMonthMb()),
+    };
+
+    return opt.addQuota(quota);
+}
+
 int writeServicesHeader(char *data, int servicesCount)
 {
     PFORT_SERVICE_INFO_LIST infoList = (PFORT_SERVICE_INFO_LIST) data;
@@ -41,7 +83,8 @@ int writeServiceInfo(char *data, const ServiceInfo &serviceInfo)
 {
     PFORT_SERVICE_INFO info = (PFORT_SERVICE_INFO) data;
 
-    info->process_id = serviceInfo.processId;
+    // Stopped service has no process
+    info->process_id = serviceInfo.isRunning ? serviceInfo.processId : 0;
 
     const quint16 nameLen = quint16(serviceInfo.serviceName.size() * sizeof(char16_t));
     info->name_len = nameLen;
@@ -51,6 +94,94 @@ int writeServiceInfo(char *data, const ServiceInfo &serviceInfo)
     return FORT_SERVICE_INFO_NAME_OFF + FORT_CONF_STR_DATA_SIZE(nameLen);
 }
 
+int writePendingDecision(char *data, const QString &kernelPath, bool allow)
+{
+    PFORT_PENDING_DECISION decision = (PFORT_PENDING_DECISION) data;
+
+    decision->allow = allow;
+
+    const quint16 pathLen = quint16(kernelPath.size() * sizeof(char16_t));
+    decision->path_len = pathLen;
+
+    memcpy(decision->path, kernelPath.utf16(), pathLen);
+
+    return FORT_PENDING_DECISION_PATH_OFF + FORT_CONF_STR_DATA_SIZE(pathLen);
+}
+
+constexpr int parallelChunkMinSize = 1024;
+
+// Run the task in the thread pool or by the calling thread, when the pool is busy
+void startTask(const std::function<void()> &task)
+{
+    if (!QThreadPool::globalInstance()->tryStart(task)) {
+        task();
+    }
+}
+
+// Run the function on chunks of [0, count) in the thread pool and wait for them
+void parallelFor(int count, const std::function<void(int begin, int end)> &func)
+{
+    QThreadPool *pool = QThreadPool::globalInstance();
+
+    const int chunksCount = qBound(1, count / parallelChunkMinSize, pool->maxThreadCount());
+    if (chunksCount <= 1) {
+        func(0, count);
+        return;
+    }
+
+    const int chunkSize = (count + chunksCount - 1) / chunksCount;
+
+    QSemaphore done;
+    int tasksCount = 0;
+
+    for (int begin = chunkSize; begin < count; begin += chunkSize) {
+        const int end = qMin(begin + chunkSize, count);
+
+        startTask([&, begin, end] {
+            func(begin, end);
+            done.release();
+        });
+        ++tasksCount;
+    }
+
+    // The first chunk is processed by the calling thread
+    func(0, chunkSize);
+
+    done.acquire(tasksCount);
+}
+
+void parseAppPathLine(const QStringView line, QVector<AppParsedPath> &paths)
+{
+    AppParsedPath path;
+
+    path.appPath = ConfUtil::parseAppPath(line, path.isWild, path.isPrefix);
+    if (path.appPath.isEmpty())
+        return;
+
+    path.kernelPath = FileUtil::pathToKernelPath(path.appPath);
+
+    paths.append(path);
+}
+
+void parseAppJob(AppParseJob &job)
+{
+    if (!job.isText) {
+        job.paths.append({ .appPath = job.app.appPath,
+                .kernelPath = FileUtil::pathToKernelPath(job.app.appPath) });
+        return;
+    }
+
+    const auto lines = StringUtil::tokenizeView(job.text, QLatin1Char('\n'));
+
+    for (const auto &line : lines) {
+        const auto lineTrimmed = line.trimmed();
+        if (lineTrimmed.isEmpty() || lineTrimmed.startsWith('#')) // commented line
+            continue;
+
+        parseAppPathLine(lineTrimmed, job.paths);
+    }
+}
+
 }
 
 ConfBuffer::ConfBuffer(const QByteArray &buffer, QObject *parent) :
@@ -94,6 +225,63 @@ void ConfBuffer::writeServices(const QVector<ServiceInfo> &services, int running
     buffer().resize(outSize); // shrink to actual size
 }
 
+void ConfBuffer::writeServiceChanges(const QVector<ServiceInfo> &services)
+{
+    // Resize the buffer to max size
+    const int servicesCount = services.size();
+    const int servicesSize =
+            FORT_SERVICE_INFO_LIST_MIN_SIZE + servicesCount * FORT_SERVICE_INFO_MAX_SIZE;
+
+    buffer().resize(servicesSize);
+
+    // Fill the buffer
+    char *data = buffer().data();
+
+    int outSize = writeServicesHeader(data, servicesCount);
+
+    for (const ServiceInfo &info : services) {
+        outSize += writeServiceInfo(data + outSize, info);
+    }
+
+    buffer().resize(outSize); // shrink to actual size
+}
+
+void ConfBuffer::writePendingDecisions(
+        const QHash<QString, bool> &decisions, const PendingLimits &limits)
+{
+    // Resize the buffer to max size
+    const int decisionsCount = decisions.size();
+    const int decisionsSize =
+            FORT_PENDING_DECISION_LIST_DATA_OFF + decisionsCount * FORT_PENDING_DECISION_MAX_SIZE;
+
+    buffer().resize(decisionsSize);
+
+    // Fill the buffer
+    PFORT_PENDING_DECISION_LIST decisionList = (PFORT_PENDING_DECISION_LIST) buffer().data();
+
+    decisionList->limits.apps_max = limits.appsMax;
+    decisionList->limits.app_packets_max = limits.appPacketsMax;
+    decisionList->limits.expire_secs = limits.expireSecs;
+
+    char *data = buffer().data();
+    int outSize = FORT_PENDING_DECISION_LIST_DATA_OFF;
+    int outCount = 0;
+
+    for (auto it = decisions.constBegin(); it != decisions.constEnd(); ++it) {
+        const QString &kernelPath = it.key();
+
+        if (kernelPath.size() > APP_PATH_MAX)
+            continue;
+
+        outSize += writePendingDecision(data + outSize, kernelPath, it.value());
+        ++outCount;
+    }
+
+    decisionList->decisions_n = outCount;
+
+    buffer().resize(outSize); // shrink to actual size
+}
+
 bool ConfBuffer::writeConf(
         const FirewallConf &conf, const ConfAppsWalker *confAppsWalker, EnvManager &envManager)
 {
@@ -102,17 +290,31 @@ bool ConfBuffer::writeConf(
         .ad = { .addressRanges = addrranges_arr_t(conf.addressGroups().size()) },
     };
 
+    // Parse the address groups in parallel with the apps
+    ConfBuffer addressConfBuf;
     quint32 addressGroupsSize = 0;
+    bool addressGroupsOk = false;
+    QSemaphore addressGroupsDone;
 
-    if (!parseAddressGroups(conf.addressGroups(), wca.ad, addressGroupsSize))
-        return false;
+    startTask([&] {
+        addressGroupsOk =
+                addressConfBuf.parseAddressGroups(conf.addressGroups(), wca.ad, addressGroupsSize);
+        addressGroupsDone.release();
+    });
 
     AppParseOptions opt;
 
-    if (!parseExeApps(envManager, confAppsWalker, opt))
+    const bool appsOk = parseExeApps(envManager, confAppsWalker, opt)
+            && parseAppGroups(envManager, conf.appGroups(), opt) && parseAppJobs(opt);
+
+    addressGroupsDone.acquire();
+
+    if (!addressGroupsOk) {
+        setErrorMessage(addressConfBuf.errorMessage());
         return false;
+    }
 
-    if (!parseAppGroups(envManager, conf.appGroups(), opt))
+    if (!appsOk)
         return false;
 
     const quint32 appsSize = opt.wildAppsSize + opt.prefixAppsSize + opt.exeAppsSize;
@@ -121,12 +323,24 @@ bool ConfBuffer::writeConf(
         return false;
     }
 
+    if (opt.appLimits.size() > FORT_CONF_APP_LIMIT_MAX) {
+        setErrorMessage(tr("Too many application speed limits"));
+        return false;
+    }
+
+    if (opt.quotas.size() > FORT_CONF_QUOTA_MAX) {
+        setErrorMessage(tr("Too many traffic quotas"));
+        return false;
+    }
+
     // Resize the buffer
     const int confIoSize = int(FORT_CONF_IO_CONF_OFF + FORT_CONF_DATA_OFF + addressGroupsSize
             + FORT_CONF_STR_DATA_SIZE(opt.wildAppsSize)
             + FORT_CONF_STR_HEADER_SIZE(opt.prefixAppsMap.size())
             + FORT_CONF_STR_DATA_SIZE(opt.prefixAppsSize)
-            + FORT_CONF_STR_DATA_SIZE(opt.exeAppsSize));
+            + FORT_CONF_STR_DATA_SIZE(opt.exeAppsSize)
+            + FORT_CONF_APP_LIMITS_SIZE(opt.appLimits.size())
+            + FORT_CONF_QUOTAS_SIZE(opt.quotas.size()));
 
     buffer().resize(confIoSize);
 
@@ -152,12 +366,19 @@ void ConfBuffer::writeFlags(const FirewallConf &conf)
 }
 
 bool ConfBuffer::writeAppEntry(const App &app, bool isNew)
+{
+    return writeAppEntries({ app }, isNew);
+}
+
+bool ConfBuffer::writeAppEntries(const QVector<App> &apps, bool isNew)
 {
     appdata_map_t appsMap;
     quint32 appsSize = 0;
 
-    if (!addApp(app, isNew, appsMap, appsSize))
-        return false;
+    for (const App &app : apps) {
+        if (!addApp(app, isNew, appsMap, appsSize))
+            return false;
+    }
 
     // Resize the buffer
     buffer().resize(appsSize);
@@ -274,6 +495,12 @@ bool ConfBuffer::parseAddressGroups(const QList<AddressGroup *> &addressGroups,
             return false;
         }
 
+        // Check one "include minus exclude" list instead of both
+        if (addressRange.isCompilable()) {
+            addressRange.includeRange().subtract(addressRange.excludeRange());
+            addressRange.excludeRange().clear();
+        }
+
         const IpRange &incRange = addressRange.includeRange();
         const IpRange &excRange = addressRange.excludeRange();
 
@@ -321,22 +548,21 @@ bool ConfBuffer::parseAppGroups(
         app.logBlockedConn = appGroup->logBlocked();
         app.groupIndex = i;
 
+        opt.groupQuotaIds[i] = addAppGroupQuota(appGroup, opt);
+
         app.appOriginPath = appGroup->killText();
         app.blocked = true;
         app.killProcess = true;
-        if (!parseAppsText(envManager, app, opt))
-            return false;
+        addAppTextJob(envManager, app, opt);
 
         app.appOriginPath = appGroup->blockText();
         app.blocked = true;
         app.killProcess = false;
-        if (!parseAppsText(envManager, app, opt))
-            return false;
+        addAppTextJob(envManager, app, opt);
 
         app.appOriginPath = appGroup->allowText();
         app.blocked = false;
-        if (!parseAppsText(envManager, app, opt))
-            return false;
+        addAppTextJob(envManager, app, opt);
     }
 
     return true;
@@ -349,57 +575,87 @@ bool ConfBuffer::parseExeApps(
         return true;
 
     return confAppsWalker->walkApps([&](App &app) -> bool {
+        app.speedLimitId = opt.appLimitId(app.speedLimitIn, app.speedLimitOut);
+        app.quotaId = addAppQuota(confAppsWalker, app, opt);
+
         if (app.isWildcard) {
-            return parseAppsText(envManager, app, opt);
+            addAppTextJob(envManager, app, opt);
         } else {
-            return addApp(app, /*isNew=*/true, opt.exeAppsMap, opt.exeAppsSize);
+            opt.appJobs.append({ .app = app });
         }
+
+        return true;
     });
 }
 
-bool ConfBuffer::parseAppsText(EnvManager &envManager, App &app, AppParseOptions &opt)
+void ConfBuffer::addAppTextJob(EnvManager &envManager, const App &app, AppParseOptions &opt)
 {
-    const auto text = envManager.expandString(app.appOriginPath);
-    const auto lines = StringUtil::tokenizeView(text, QLatin1Char('\n'));
+    // The environment is expanded by the calling thread only
+    opt.appJobs.append(
+            { .isText = true, .app = app, .text = envManager.expandString(app.appOriginPath) });
+}
 
-    for (const auto &line : lines) {
-        const auto lineTrimmed = line.trimmed();
-        if (lineTrimmed.isEmpty() || lineTrimmed.startsWith('#')) // commented line
-            continue;
+bool ConfBuffer::parseAppJobs(AppParseOptions &opt)
+{
+    appparsejobs_arr_t &jobs = opt.appJobs;
 
-        if (!parseAppLine(app, lineTrimmed, opt))
+    parallelFor(jobs.size(), [&](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+            parseAppJob(jobs[i]);
+        }
+    });
+
+    // Merge in the jobs order: the first app path wins
+    for (AppParseJob &job : jobs) {
+        if (!mergeAppJob(job, opt))
             return false;
     }
 
+    jobs.clear();
+
     return true;
 }
 
-bool ConfBuffer::parseAppLine(App &app, const QStringView line, AppParseOptions &opt)
+bool ConfBuffer::mergeAppJob(AppParseJob &job, AppParseOptions &opt)
 {
-    bool isWild = false;
-    bool isPrefix = false;
-    const QString appPath = ConfUtil::parseAppPath(line, isWild, isPrefix);
-    if (appPath.isEmpty())
-        return true;
+    App &app = job.app;
 
-    app.appPath = appPath;
+    for (const AppParsedPath &path : std::as_const(job.paths)) {
+        app.appPath = path.appPath;
 
-    if (isWild || isPrefix) {
-        if (app.isProcWild()) {
-            opt.procWild = true;
+        if (!job.isText) {
+            if (!addAppPath(app, path.kernelPath, /*isNew=*/true, opt.exeAppsMap,
+                        opt.exeAppsSize))
+                return false;
+            continue;
         }
-    }
 
-    appdata_map_t &appsMap = opt.appsMap(isWild, isPrefix);
-    quint32 &appsSize = opt.appsSize(isWild, isPrefix);
+        if (path.isWild || path.isPrefix) {
+            if (app.isProcWild()) {
+                opt.procWild = true;
+            }
+        }
 
-    return addApp(app, /*isNew=*/true, appsMap, appsSize);
+        appdata_map_t &appsMap = opt.appsMap(path.isWild, path.isPrefix);
+        quint32 &appsSize = opt.appsSize(path.isWild, path.isPrefix);
+
+        if (!addAppPath(app, path.kernelPath, /*isNew=*/true, appsMap, appsSize))
+            return false;
+    }
+
+    return true;
 }
 
 bool ConfBuffer::addApp(const App &app, bool isNew, appdata_map_t &appsMap, quint32 &appsSize)
 {
     const QString kernelPath = FileUtil::pathToKernelPath(app.appPath);
 
+    return addAppPath(app, kernelPath, isNew, appsMap, appsSize);
+}
+
+bool ConfBuffer::addAppPath(const App &app, const QString &kernelPath, bool isNew,
+        appdata_map_t &appsMap, quint32 &appsSize)
+{
     if (appsMap.contains(kernelPath))
         return true;
 
@@ -433,6 +689,8 @@ bool ConfBuffer::addApp(const App &app, bool isNew, appdata_map_t &appsMap, quin
         .rule_id = app.ruleId,
         .accept_zones = quint16(app.acceptZones),
         .reject_zones = quint16(app.rejectZones),
+        .limit_id = app.speedLimitId,
+        .quota_id = app.quotaId,
     };
 
     appsMap.insert(kernelPath, appData);
@@ -2,6 +2,7 @@
 #define CONFBUFFER_H
 
 #include <QByteArray>
+#include <QHash>
 
 #include <util/conf/confappswalker.h>
 #include <util/conf/confruleswalker.h>
@@ -36,11 +37,16 @@ public slots:
     void writeVersion();
 
     void writeServices(const QVector<ServiceInfo> &services, int runningServicesCount);
+    void writeServiceChanges(const QVector<ServiceInfo> &services);
+
+    void writePendingDecisions(
+            const QHash<QString, bool> &decisions, const PendingLimits &limits = {});
 
     bool writeConf(
             const FirewallConf &conf, const ConfAppsWalker *confAppsWalker, EnvManager &envManager);
     void writeFlags(const FirewallConf &conf);
     bool writeAppEntry(const App &app, bool isNew = false);
+    bool writeAppEntries(const QVector<App> &apps, bool isNew = false);
 
     void writeZone(const IpRange &ipRange);
     void writeZones(quint32 zonesMask, quint32 enabledMask, quint32 dataSize,
@@ -66,11 +72,14 @@ private:
     bool parseExeApps(
             EnvManager &envManager, const ConfAppsWalker *confAppsWalker, AppParseOptions &opt);
 
-    bool parseAppsText(EnvManager &envManager, App &app, AppParseOptions &opt);
+    void addAppTextJob(EnvManager &envManager, const App &app, AppParseOptions &opt);
 
-    bool parseAppLine(App &app, const QStringView line, AppParseOptions &opt);
+    bool parseAppJobs(AppParseOptions &opt);
+    bool mergeAppJob(AppParseJob &job, AppParseOptions &opt);
 
     bool addApp(const App &app, bool isNew, appdata_map_t &appsMap, quint32 &appsSize);
+    bool addAppPath(const App &app, const QString &kernelPath, bool isNew,
+            appdata_map_t &appsMap, quint32 &appsSize);
 
     bool writeRule(const Rule &rule, const WalkRulesArgs &wra);
     bool writeRuleText(const QString &ruleText, int &filtersCount);
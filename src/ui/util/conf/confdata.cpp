@@ -55,6 +55,15 @@ void writeLimitOut(PFORT_SPEED_LIMIT limit, const AppGroup *appGroup)
     writeLimitBps(limit, appGroup->speedLimitOut());
 }
 
+void writeAppLimit(PFORT_SPEED_LIMIT limit, quint32 kBits)
+{
+    limit->plr = 0;
+    limit->latency_ms = 0;
+    limit->buffer_bytes = (kBits != 0) ? DEFAULT_LIMIT_BUFFER_SIZE : 0;
+
+    writeLimitBps(limit, kBits);
+}
+
 void writeLimits(PFORT_CONF_GROUP out, const QList<AppGroup *> &appGroups)
 {
     PFORT_SPEED_LIMIT limits = out->limits;
@@ -101,6 +110,8 @@ void ConfData::writeConf(const WriteConfArgs &wca, AppParseOptions &opt)
 
     quint32 addrGroupsOff;
     quint32 wildAppsOff, prefixAppsOff, exeAppsOff;
+    quint32 appLimitsOff;
+    quint32 quotasOff;
 
     m_data = drvConf->data;
     resetBase();
@@ -118,25 +129,42 @@ void ConfData::writeConf(const WriteConfArgs &wca, AppParseOptions &opt)
     exeAppsOff = dataOffset();
     writeApps(opt.exeAppsMap);
 
+    appLimitsOff = dataOffset();
+    writeAppLimits(opt.appLimits);
+
+    quotasOff = dataOffset();
+    writeQuotas(opt.quotas);
+
     PFORT_CONF_GROUP conf_group = &drvConfIo->conf_group;
 
     writeAppGroupFlags(conf_group, wca.conf);
 
     writeLimits(conf_group, wca.conf.appGroups());
 
+    memcpy(conf_group->quota_ids, opt.groupQuotaIds, sizeof(conf_group->quota_ids));
+
     ConfData(&drvConf->flags).writeConfFlags(wca.conf);
 
     drvConf->proc_wild = opt.procWild;
 
     drvConf->wild_apps_n = quint16(opt.wildAppsMap.size());
     drvConf->prefix_apps_n = quint16(opt.prefixAppsMap.size());
-    drvConf->exe_apps_n = quint16(opt.exeAppsMap.size());
+    drvConf->exe_apps_n = quint32(opt.exeAppsMap.size());
+
+    drvConf->app_limits_n = quint16(opt.appLimits.size());
+
+    drvConf->quotas_n = quint16(opt.quotas.size());
+    drvConf->quota_month_start = quint8(wca.conf.ini().monthStart());
 
     drvConf->addr_groups_off = addrGroupsOff;
 
     drvConf->wild_apps_off = wildAppsOff;
     drvConf->prefix_apps_off = prefixAppsOff;
     drvConf->exe_apps_off = exeAppsOff;
+
+    drvConf->app_limits_off = appLimitsOff;
+
+    drvConf->quotas_off = quotasOff;
 }
 
 void ConfData::writeConfFlags(const FirewallConf &conf)
@@ -324,6 +352,25 @@ void ConfData::writeApps(const appdata_map_t &appsMap, bool useHeader)
     m_data += offTableSize + FORT_CONF_STR_DATA_SIZE(off);
 }
 
+void ConfData::writeAppLimits(const applimits_arr_t &appLimits)
+{
+    PFORT_SPEED_LIMIT limits = PFORT_SPEED_LIMIT(m_data);
+
+    for (const quint64 appLimit : appLimits) {
+        writeAppLimit(&limits[0], quint32(appLimit >> 32)); // in
+        writeAppLimit(&limits[1], quint32(appLimit)); // out
+
+        limits += 2;
+    }
+
+    m_data += FORT_CONF_APP_LIMITS_SIZE(appLimits.size());
+}
+
+void ConfData::writeQuotas(const quotas_arr_t &quotas)
+{
+    writeData(quotas.constData(), quotas.size(), sizeof(FORT_TRAF_QUOTA));
+}
+
 void ConfData::migrateZoneData(const QByteArray &zoneData)
 {
     PFORT_CONF_ADDR_LIST addr_list = PFORT_CONF_ADDR_LIST(zoneData.data());
@@ -57,6 +57,8 @@ public:
     void writeProfileRange(const ProfileRange &profileRange);
 
     void writeApps(const appdata_map_t &appsMap, bool useHeader = false);
+    void writeAppLimits(const applimits_arr_t &appLimits);
+    void writeQuotas(const quotas_arr_t &quotas);
 
     void migrateZoneData(const QByteArray &zoneData);
 
@@ -20,39 +20,256 @@ inline bool checkIp6MaskBitsCount(const int nbits)
     return (nbits >= 0 && nbits <= 128);
 }
 
+// Parse the "1.2.3.4" or "1.2.3.4/24" line without the regular expression
+bool parseIp4Plain(const QStringView line, ip4_t &ip, QStringView &mask)
+{
+    const QChar *cp = line.begin();
+    const QChar *end = line.end();
+
+    ip = 0;
+
+    for (int i = 0; i < 4; ++i) {
+        if (i > 0) {
+            if (cp == end || *cp != '.')
+                return false;
+            ++cp;
+        }
+
+        const QChar *partBegin = cp;
+        uint part = 0;
+
+        while (cp != end && cp->isDigit() && cp - partBegin < 3) {
+            part = part * 10 + cp->digitValue();
+            ++cp;
+        }
+
+        const int partLen = int(cp - partBegin);
+        if (partLen == 0 || part > 255 || (partLen > 1 && *partBegin == '0'))
+            return false;
+
+        ip = (ip << 8) | part;
+    }
+
+    const QChar *maskBegin = cp;
+
+    if (cp != end && *cp == '/') {
+        ++maskBegin;
+        ++cp;
+
+        while (cp != end && cp->isDigit()) {
+            ++cp;
+        }
+
+        if (cp == maskBegin)
+            return false;
+    }
+
+    mask = QStringView(maskBegin, cp);
+
+    // Trailing whitespaces only
+    for (; cp != end; ++cp) {
+        if (!cp->isSpace())
+            return false;
+    }
+
+    return true;
+}
+
+void sortIp4PairArray(ip4_pair_arr_t &pairArray)
+{
+    const int arraySize = pairArray.size();
+
+    if (arraySize < 1024) {
+        std::stable_sort(pairArray.begin(), pairArray.end(),
+                [](const Ip4Pair &l, const Ip4Pair &r) { return l.from < r.from; });
+        return;
+    }
+
+    // LSD radix sort by the "from" address in two 16-bit passes
+    ip4_pair_arr_t tmpArray(arraySize);
+    QVector<int> offsets(0x10000);
+
+    for (const int shift : { 0, 16 }) {
+        offsets.fill(0);
+
+        for (const Ip4Pair &pair : std::as_const(pairArray)) {
+            ++offsets[(pair.from >> shift) & 0xFFFF];
+        }
+
+        int offset = 0;
+        for (int &count : offsets) {
+            const int n = count;
+            count = offset;
+            offset += n;
+        }
+
+        for (const Ip4Pair &pair : std::as_const(pairArray)) {
+            tmpArray[offsets[(pair.from >> shift) & 0xFFFF]++] = pair;
+        }
+
+        pairArray.swap(tmpArray);
+    }
+}
+
 inline bool compareLessIp6(const ip6_addr_t &l, const ip6_addr_t &r)
 {
     return fort_ip6_cmp(&l, &r) < 0;
 }
 
-inline void sortIp6Array(ip6_arr_t &array)
+struct Ip4Ops
+{
+    static bool less(const ip4_t l, const ip4_t r) { return l < r; }
+    static ip4_t next(const ip4_t v) { return v + 1; }
+    static ip4_t prev(const ip4_t v) { return v - 1; }
+};
+
+struct Ip6Ops
+{
+    static bool less(const ip6_addr_t &l, const ip6_addr_t &r) { return compareLessIp6(l, r); }
+
+    static ip6_addr_t next(ip6_addr_t v)
+    {
+        for (int i = sizeof(v.data); --i >= 0;) {
+            if (++v.data[i] != 0)
+                break;
+        }
+        return v;
+    }
+
+    static ip6_addr_t prev(ip6_addr_t v)
+    {
+        for (int i = sizeof(v.data); --i >= 0;) {
+            if (v.data[i]-- != 0)
+                break;
+        }
+        return v;
+    }
+};
+
+template<typename T>
+using pair_arr_t = QVector<ValuePair<T>>;
+
+// Merge the overlapping and adjacent pairs, which are sorted by the "from" values
+template<typename T, typename Ops>
+void mergeSortedPairs(pair_arr_t<T> &pairs)
+{
+    int count = 0;
+
+    for (const ValuePair<T> &v : std::as_const(pairs)) {
+        if (count > 0) {
+            ValuePair<T> &prevPair = pairs[count - 1];
+
+            if (!Ops::less(prevPair.to, v.from) || !Ops::less(Ops::next(prevPair.to), v.from)) {
+                if (Ops::less(prevPair.to, v.to)) {
+                    prevPair.to = v.to;
+                }
+                continue;
+            }
+        }
+
+        pairs[count++] = v;
+    }
+
+    pairs.resize(count);
+}
+
+template<typename T, typename Ops>
+pair_arr_t<T> toSortedPairs(const QVector<T> &valuesArray, const QVector<T> &pairFromArray,
+        const QVector<T> &pairToArray)
 {
-    std::sort(array.begin(), array.end(), compareLessIp6);
+    pair_arr_t<T> pairs;
+    pairs.reserve(valuesArray.size() + pairFromArray.size());
+
+    for (const T &v : valuesArray) {
+        pairs.append({ v, v });
+    }
+
+    for (int i = 0, n = pairFromArray.size(); i < n; ++i) {
+        pairs.append({ pairFromArray[i], pairToArray[i] });
+    }
+
+    std::sort(pairs.begin(), pairs.end(),
+            [](const ValuePair<T> &l, const ValuePair<T> &r) { return Ops::less(l.from, r.from); });
+
+    mergeSortedPairs<T, Ops>(pairs);
+
+    return pairs;
 }
 
-void sortIp6PairArray(ip6_arr_t &fromArray, ip6_arr_t &toArray)
+template<typename T, typename Ops>
+pair_arr_t<T> subtractPairs(const pair_arr_t<T> &pairs, const pair_arr_t<T> &excludePairs)
 {
-    Q_ASSERT(fromArray.size() == toArray.size());
+    pair_arr_t<T> result;
+    result.reserve(pairs.size());
+
+    const int excludeCount = excludePairs.size();
+    int j = 0;
+
+    for (const ValuePair<T> &v : pairs) {
+        // Skip the exclusions before the pair
+        while (j < excludeCount && Ops::less(excludePairs[j].to, v.from)) {
+            ++j;
+        }
+
+        T from = v.from;
+        bool covered = false;
+
+        for (int k = j; k < excludeCount && !Ops::less(v.to, excludePairs[k].from); ++k) {
+            const ValuePair<T> &ex = excludePairs[k];
 
-    const int arraySize = fromArray.size();
+            if (Ops::less(from, ex.from)) {
+                result.append({ from, Ops::prev(ex.from) });
+            }
 
-    ip6_pair_arr_t pairArray;
-    pairArray.reserve(arraySize);
+            if (!Ops::less(ex.to, v.to)) {
+                covered = true;
+                break;
+            }
 
-    for (int i = 0; i < arraySize; ++i) {
-        pairArray.append(Ip6Pair { fromArray[i], toArray[i] });
+            from = Ops::next(ex.to);
+        }
+
+        if (!covered) {
+            result.append({ from, v.to });
+        }
     }
 
-    std::sort(pairArray.begin(), pairArray.end(),
-            [](const Ip6Pair &l, const Ip6Pair &r) { return compareLessIp6(l.from, r.from); });
+    return result;
+}
 
-    for (int i = 0; i < arraySize; ++i) {
-        const Ip6Pair &pair = pairArray[i];
-        fromArray[i] = pair.from;
-        toArray[i] = pair.to;
+template<typename T, typename Ops>
+void fillFromPairs(const pair_arr_t<T> &pairs, QVector<T> &valuesArray, QVector<T> &pairFromArray,
+        QVector<T> &pairToArray)
+{
+    valuesArray.clear();
+    pairFromArray.clear();
+    pairToArray.clear();
+
+    for (const ValuePair<T> &v : pairs) {
+        if (Ops::less(v.from, v.to)) {
+            pairFromArray.append(v.from);
+            pairToArray.append(v.to);
+        } else {
+            valuesArray.append(v.from);
+        }
     }
 }
 
+template<typename T, typename Ops>
+void subtractArrays(QVector<T> &valuesArray, QVector<T> &pairFromArray, QVector<T> &pairToArray,
+        const QVector<T> &exValuesArray, const QVector<T> &exPairFromArray,
+        const QVector<T> &exPairToArray)
+{
+    if (exValuesArray.isEmpty() && exPairFromArray.isEmpty())
+        return;
+
+    const auto pairs = toSortedPairs<T, Ops>(valuesArray, pairFromArray, pairToArray);
+    const auto excludePairs = toSortedPairs<T, Ops>(exValuesArray, exPairFromArray, exPairToArray);
+
+    fillFromPairs<T, Ops>(
+            subtractPairs<T, Ops>(pairs, excludePairs), valuesArray, pairFromArray, pairToArray);
+}
+
 }
 
 IpRange::IpRange(QObject *parent) : ValueRange(parent) { }
@@ -86,6 +303,15 @@ void IpRange::clear()
     m_pair6ToArray.clear();
 }
 
+void IpRange::subtract(const IpRange &range)
+{
+    subtractArrays<ip4_t, Ip4Ops>(m_ip4Array, m_pair4FromArray, m_pair4ToArray,
+            range.ip4Array(), range.pair4FromArray(), range.pair4ToArray());
+
+    subtractArrays<ip6_addr_t, Ip6Ops>(m_ip6Array, m_pair6FromArray, m_pair6ToArray,
+            range.ip6Array(), range.pair6FromArray(), range.pair6ToArray());
+}
+
 void IpRange::toList(QStringList &list) const
 {
     for (int i = 0, n = ip4Size(); i < n; ++i) {
@@ -119,8 +345,8 @@ bool IpRange::fromList(const StringViewList &list, bool sort)
 {
     clear();
 
-    ip4range_map_t ip4RangeMap;
-    int pair4Size = 0;
+    ip4_pair_arr_t ip4PairArray;
+    ip4PairArray.reserve(list.size());
 
     int lineNo = 0;
     for (const auto &line : list) {
@@ -130,32 +356,41 @@ bool IpRange::fromList(const StringViewList &list, bool sort)
         if (lineTrimmed.isEmpty() || lineTrimmed.startsWith('#')) // commented line
             continue;
 
-        if (parseIpLine(line, ip4RangeMap, pair4Size) != ErrorOk) {
+        if (parseIpLine(line, ip4PairArray) != ErrorOk) {
             appendErrorDetails(QString("line='%1'").arg(line));
             setErrorLineNo(lineNo);
             return false;
         }
     }
 
-    fillRangeArrays<ip4_t>({
-            .rangeMap = ip4RangeMap,
-            .valuesArray = m_ip4Array,
-            .pairFromArray = m_pair4FromArray,
-            .pairToArray = m_pair4ToArray,
-            .pairSize = pair4Size,
-    });
+    // Normalize the addresses to the union of disjoint ranges
+    sortIp4PairArray(ip4PairArray);
+    mergeSortedPairs<ip4_t, Ip4Ops>(ip4PairArray);
+
+    fillFromPairs<ip4_t, Ip4Ops>(ip4PairArray, m_ip4Array, m_pair4FromArray, m_pair4ToArray);
 
     if (sort) {
-        sortIp6Array(m_ip6Array);
-        sortIp6PairArray(m_pair6FromArray, m_pair6ToArray);
+        const auto ip6PairArray =
+                toSortedPairs<ip6_addr_t, Ip6Ops>(m_ip6Array, m_pair6FromArray, m_pair6ToArray);
+
+        fillFromPairs<ip6_addr_t, Ip6Ops>(
+                ip6PairArray, m_ip6Array, m_pair6FromArray, m_pair6ToArray);
     }
 
     return true;
 }
 
-IpRange::ParseError IpRange::parseIpLine(
-        const QStringView line, ip4range_map_t &ip4RangeMap, int &pair4Size)
+IpRange::ParseError IpRange::parseIpLine(const QStringView line, ip4_pair_arr_t &ip4PairArray)
 {
+    // Fast path for the plain IPv4 address or network
+    {
+        ip4_t ip4;
+        QStringView mask;
+
+        if (parseIp4Plain(line, ip4, mask))
+            return addIp4Address(ip4, mask, ip4PairArray, mask.isEmpty() ? '\0' : '/');
+    }
+
     static const QRegularExpression ipRe(R"(^\[?([A-Fa-f\d:.]+)\]?\s*([\/-]?)\s*(\S*))");
 
     const auto match = StringUtil::match(ipRe, line);
@@ -178,31 +413,33 @@ IpRange::ParseError IpRange::parseIpLine(
     const bool isIPv6 = ip.contains(':');
 
     return isIPv6 ? parseIp6Address(ip, mask, maskSep)
-                  : parseIp4Address(ip, mask, ip4RangeMap, pair4Size, maskSep);
+                  : parseIp4Address(ip, mask, ip4PairArray, maskSep);
 }
 
 IpRange::ParseError IpRange::parseIp4Address(const QStringView ip, const QStringView mask,
-        ip4range_map_t &ip4RangeMap, int &pair4Size, char maskSep)
+        ip4_pair_arr_t &ip4PairArray, char maskSep)
 {
-    ip4_t from, to = 0;
-
     bool ok;
-    from = NetFormatUtil::textToIp4(ip, &ok);
+    const ip4_t from = NetFormatUtil::textToIp4(ip, &ok);
     if (!ok) {
         setErrorMessage(tr("Bad IP address"));
         setErrorDetails(QString("IPv4 ip='%1'").arg(ip));
         return ErrorBadAddress;
     }
 
+    return addIp4Address(from, mask, ip4PairArray, maskSep);
+}
+
+IpRange::ParseError IpRange::addIp4Address(
+        ip4_t from, const QStringView mask, ip4_pair_arr_t &ip4PairArray, char maskSep)
+{
+    ip4_t to = 0;
+
     const ParseError err = parseIp4AddressMask(mask, from, to, maskSep);
     if (err != ErrorOk)
         return err;
 
-    ip4RangeMap.insert(from, to);
-
-    if (from != to) {
-        ++pair4Size;
-    }
+    ip4PairArray.append({ from, to });
 
     return ErrorOk;
 }
@@ -292,7 +529,7 @@ IpRange::ParseError IpRange::parseIp6AddressMask(
 
     switch (maskSep) {
     case '-': // e.g. "::1 - ::2"
-        return parseIp6AddressMaskFull(mask, to, hasMask);
+        return parseIp6AddressMaskFull(mask, from, to, hasMask);
     case '/': // e.g. "::1/24", "::1"
         return parseIp6AddressMaskPrefix(mask, from, to, hasMask);
     default:
@@ -301,7 +538,7 @@ IpRange::ParseError IpRange::parseIp6AddressMask(
 }
 
 IpRange::ParseError IpRange::parseIp6AddressMaskFull(
-        const QStringView mask, ip6_addr_t &to, bool &hasMask)
+        const QStringView mask, const ip6_addr_t &from, ip6_addr_t &to, bool &hasMask)
 {
     bool ok;
     to = NetFormatUtil::textToIp6(mask, &ok);
@@ -311,6 +548,13 @@ IpRange::ParseError IpRange::parseIp6AddressMaskFull(
         return ErrorBadAddress2;
     }
 
+    if (compareLessIp6(to, from)) {
+        setErrorMessage(tr("Bad range"));
+        setErrorDetails(QString("IPv6 from='%1' to='%2'")
+                        .arg(NetFormatUtil::ip6ToText(from), NetFormatUtil::ip6ToText(to)));
+        return ErrorBadRange;
+    }
+
     hasMask = true;
 
     return ErrorOk;
@@ -7,12 +7,12 @@
 
 using ip4_t = quint32;
 
-using ip4range_map_t = QMap<ip4_t, ip4_t>;
-using ip4_arr_t = QVector<ip4_t>;
-
 using Ip4Pair = ValuePair<ip4_t>;
 using Ip6Pair = ValuePair<ip6_addr_t>;
 
+using ip4_pair_arr_t = QVector<Ip4Pair>;
+using ip4_arr_t = QVector<ip4_t>;
+
 using ip6_pair_arr_t = QVector<Ip6Pair>;
 using ip6_arr_t = QVector<ip6_addr_t>;
 
@@ -69,6 +69,9 @@ public:
 
     void clear() override;
 
+    // Remove the addresses of the given range
+    void subtract(const IpRange &range);
+
     void toList(QStringList &list) const override;
 
     bool fromList(const StringViewList &list, bool sort = true) override;
@@ -86,11 +89,12 @@ private:
         ErrorBadRange,
     };
 
-    IpRange::ParseError parseIpLine(
-            const QStringView line, ip4range_map_t &ip4RangeMap, int &pair4Size);
+    IpRange::ParseError parseIpLine(const QStringView line, ip4_pair_arr_t &ip4PairArray);
 
     IpRange::ParseError parseIp4Address(const QStringView ip, const QStringView mask,
-            ip4range_map_t &ip4RangeMap, int &pair4Size, char maskSep);
+            ip4_pair_arr_t &ip4PairArray, char maskSep);
+    IpRange::ParseError addIp4Address(
+            ip4_t from, const QStringView mask, ip4_pair_arr_t &ip4PairArray, char maskSep);
 
     IpRange::ParseError parseIp4AddressMask(
             const QStringView mask, ip4_t &from, ip4_t &to, char maskSep);
@@ -103,7 +107,7 @@ private:
     IpRange::ParseError parseIp6AddressMask(
             const QStringView mask, ip6_addr_t &from, ip6_addr_t &to, bool &hasMask, char maskSep);
     IpRange::ParseError parseIp6AddressMaskFull(
-            const QStringView mask, ip6_addr_t &to, bool &hasMask);
+            const QStringView mask, const ip6_addr_t &from, ip6_addr_t &to, bool &hasMask);
     IpRange::ParseError parseIp6AddressMaskPrefix(
             const QStringView mask, ip6_addr_t &from, ip6_addr_t &to, bool &hasMask);
 
@@ -5,8 +5,6 @@
 
 #include <util/bitutil.h>
 
-#include "netformatutil.h"
-
 bool NetUtil::windowsSockInit()
 {
     WSAData wsadata;
@@ -55,17 +53,27 @@ const ip6_addr_t &NetUtil::arrayViewToIp6(const QByteArrayView &buf)
     return *reinterpret_cast<const ip6_addr_t *>(buf.data());
 }
 
-QString NetUtil::getHostName(const QString &address)
+QString NetUtil::getHostName(const ip_addr_t &ip, bool isIPv6)
 {
     WCHAR hostName[NI_MAXHOST];
 
-    struct sockaddr_in sa;
-    memset(&sa, 0, sizeof(struct sockaddr_in));
-    sa.sin_family = AF_INET;
-    sa.sin_addr.s_addr = htonl(NetFormatUtil::textToIp4(address));
+    SOCKADDR_INET sa;
+    memset(&sa, 0, sizeof(SOCKADDR_INET));
+
+    int saLength;
+    if (isIPv6) {
+        sa.Ipv6.sin6_family = AF_INET6;
+        memcpy(&sa.Ipv6.sin6_addr, ip.v6.data, sizeof(ip6_addr_t));
+        saLength = sizeof(struct sockaddr_in6);
+    } else {
+        sa.Ipv4.sin_family = AF_INET;
+        sa.Ipv4.sin_addr.s_addr = htonl(ip.v4);
+        saLength = sizeof(struct sockaddr_in);
+    }
 
-    if (GetNameInfoW((struct sockaddr *) &sa, sizeof(struct sockaddr), hostName, NI_MAXHOST,
-                nullptr, 0, 0))
+    // Don't return the numeric form of the address to cache the missing name
+    if (GetNameInfoW((struct sockaddr *) &sa, saLength, hostName, NI_MAXHOST, nullptr, 0,
+                NI_NAMEREQD))
         return QString();
 
     return QString::fromWCharArray(hostName);
@@ -21,7 +21,8 @@ public:
     static QByteArrayView ip6ToArrayView(const ip6_addr_t &ip);
     static const ip6_addr_t &arrayViewToIp6(const QByteArrayView &buf);
 
-    static QString getHostName(const QString &address);
+    // Reverse lookup of the address, empty if it has no name
+    static QString getHostName(const ip_addr_t &ip, bool isIPv6 = false);
 
     static QStringList localIpNetworks();
     static QString localIpNetworksText(int count = -1);
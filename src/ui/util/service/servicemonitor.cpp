@@ -11,7 +11,8 @@ inline void startServiceMonitor(const ServiceMonitor &monitor, PSERVICE_NOTIFYW
 {
     const auto serviceHandle = SC_HANDLE(monitor.serviceHandle());
 
-    constexpr DWORD notifyMask = SERVICE_NOTIFY_RUNNING | SERVICE_NOTIFY_DELETE_PENDING;
+    constexpr DWORD notifyMask =
+            SERVICE_NOTIFY_RUNNING | SERVICE_NOTIFY_STOPPED | SERVICE_NOTIFY_DELETE_PENDING;
 
     NotifyServiceStatusChangeW(serviceHandle, notifyMask, notifyBuffer);
 }
@@ -88,6 +89,9 @@ void ServiceMonitor::onServiceNotify(quint32 notificationTriggered, qint32 proce
     case SERVICE_NOTIFY_RUNNING: {
         m_state = ServiceRunning;
     } break;
+    case SERVICE_NOTIFY_STOPPED: {
+        m_state = ServiceStopped;
+    } break;
     case SERVICE_NOTIFY_DELETE_PENDING: {
         m_state = ServiceDeleting;
     } break;
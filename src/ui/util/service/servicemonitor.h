@@ -12,6 +12,7 @@ public:
     enum ServiceState : qint8 {
         ServiceStateUnknown = 0,
         ServiceRunning,
+        ServiceStopped,
         ServiceDeleting,
     };
     Q_ENUM(ServiceState)
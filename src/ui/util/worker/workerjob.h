@@ -10,11 +10,23 @@
 class WorkerJob
 {
 public:
+    enum JobPriority : qint8 {
+        PriorityHigh = 0, // interactive lookups
+        PriorityNormal,
+        PriorityLow, // bulk background writes
+        PriorityCount
+    };
+
     explicit WorkerJob(const QString &text = {});
     virtual ~WorkerJob() = default;
 
     const QString &text() const { return m_text; }
 
+    virtual JobPriority priority() const { return PriorityNormal; }
+
+    quint32 generation() const { return m_generation; }
+    void setGeneration(quint32 v) { m_generation = v; }
+
     virtual bool mergeJob(const WorkerJob &job)
     {
         Q_UNUSED(job);
@@ -25,6 +37,8 @@ public:
     virtual void reportResult(WorkerObject &worker) { Q_UNUSED(worker); }
 
 private:
+    quint32 m_generation = 0;
+
     const QString m_text;
 };
 
@@ -24,7 +24,7 @@ void WorkerManager::setupWorker()
     WorkerObject *worker = createWorker(); // autoDelete = true
     m_workers.append(worker);
 
-    QThreadPool::globalInstance()->start(worker);
+    QThreadPool::globalInstance()->start(worker, poolPriority());
 }
 
 bool WorkerManager::checkNewWorkerNeeded() const
@@ -34,12 +34,35 @@ bool WorkerManager::checkNewWorkerNeeded() const
     if (workersCount == 0)
         return true;
 
-    return workersCount < maxWorkersCount() && !m_jobQueue.isEmpty();
+    return workersCount < maxWorkersCount() && !isJobQueueEmpty();
+}
+
+bool WorkerManager::isJobQueueEmpty() const
+{
+    for (const auto &jobQueue : m_jobQueues) {
+        if (!jobQueue.isEmpty())
+            return false;
+    }
+    return true;
 }
 
 void WorkerManager::clearJobQueue()
 {
-    m_jobQueue.clear();
+    for (auto &jobQueue : m_jobQueues) {
+        jobQueue.clear();
+    }
+
+    // Drop the results of running jobs
+    ++m_jobGeneration;
+}
+
+WorkerJobPtr WorkerManager::takeJob()
+{
+    for (auto &jobQueue : m_jobQueues) {
+        if (!jobQueue.isEmpty())
+            return jobQueue.dequeue();
+    }
+    return nullptr;
 }
 
 void WorkerManager::workerFinished(WorkerObject *worker)
@@ -62,15 +85,28 @@ int WorkerManager::jobCount() const
 {
     QMutexLocker locker(&m_mutex);
 
-    return m_jobQueue.size();
+    int count = 0;
+    for (const auto &jobQueue : m_jobQueues) {
+        count += jobQueue.size();
+    }
+    return count;
 }
 
 bool WorkerManager::mergeJob(WorkerJobPtr job)
 {
-    if (!canMergeJobs() || m_jobQueue.isEmpty())
+    if (!canMergeJobs())
+        return false;
+
+    const auto &jobQueue = m_jobQueues[job->priority()];
+    if (jobQueue.isEmpty())
         return false;
 
-    return m_jobQueue.last()->mergeJob(*job);
+    return jobQueue.last()->mergeJob(*job);
+}
+
+bool WorkerManager::isJobStale(const WorkerJob &job) const
+{
+    return aborted() || job.generation() != m_jobGeneration.loadRelaxed();
 }
 
 void WorkerManager::clear()
@@ -107,7 +143,9 @@ void WorkerManager::enqueueJob(WorkerJobPtr job)
     if (mergeJob(job))
         return;
 
-    m_jobQueue.enqueue(job);
+    job->setGeneration(m_jobGeneration.loadRelaxed());
+
+    m_jobQueues[job->priority()].enqueue(job);
 
     m_jobWaitCondition.wakeOne();
 }
@@ -116,13 +154,14 @@ WorkerJobPtr WorkerManager::dequeueJob()
 {
     QMutexLocker locker(&m_mutex);
 
-    while (!aborted() && m_jobQueue.isEmpty()) {
+    while (!aborted()) {
+        WorkerJobPtr job = takeJob();
+        if (job)
+            return job;
+
         if (!m_jobWaitCondition.wait(&m_mutex, WORKER_TIMEOUT_MSEC))
             break; // timed out
     }
 
-    if (aborted() || m_jobQueue.isEmpty())
-        return nullptr;
-
-    return m_jobQueue.dequeue();
+    return nullptr;
 }
@@ -11,6 +11,7 @@
 #include <util/classhelpers.h>
 
 #include "worker_types.h"
+#include "workerjob.h"
 
 class WorkerManager : public QObject
 {
@@ -26,6 +27,12 @@ public:
     int maxWorkersCount() const { return m_maxWorkersCount; }
     void setMaxWorkersCount(int v) { m_maxWorkersCount = v; }
 
+    // Priority of the manager's workers in the shared thread pool
+    int poolPriority() const { return m_poolPriority; }
+    void setPoolPriority(int v) { m_poolPriority = v; }
+
+    bool isJobStale(const WorkerJob &job) const;
+
     virtual QString workerName() const { return QString(); }
 
 public slots:
@@ -50,16 +57,22 @@ private:
 
     bool checkNewWorkerNeeded() const;
 
+    bool isJobQueueEmpty() const;
     void clearJobQueue();
 
+    WorkerJobPtr takeJob();
+
 private:
     volatile bool m_aborted = false;
 
     int m_maxWorkersCount = 0;
+    int m_poolPriority = 0;
+
+    QAtomicInteger<quint32> m_jobGeneration = 0;
 
     QList<WorkerObject *> m_workers;
 
-    QQueue<WorkerJobPtr> m_jobQueue;
+    QQueue<WorkerJobPtr> m_jobQueues[WorkerJob::PriorityCount];
 
     mutable QMutex m_mutex;
     QWaitCondition m_jobWaitCondition;